@@ -0,0 +1,39 @@
+#pragma once
+
+#include <time.h>
+
+#include "../tests/common.h"
+
+// Each benchmark is run this many times and the best run is reported.
+#define BENCH_RUNS 5
+
+// Results are stored here so that the work can't be optimized away.
+static volatile uint64_t bench_sink;
+
+static inline double bench_now(void) {
+	struct timespec ts;
+	if(clock_gettime(CLOCK_MONOTONIC, &ts))
+		err(EX_OSERR, "clock_gettime");
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Runs a benchmark and prints the time per operation of the best run. The
+// run function returns some value derived from its results.
+static inline void bench(const char *name, size_t operations, uint64_t (*run)(const void *data), const void *data) {
+	double best = 0.0;
+	for(unsigned int u = 0; u < BENCH_RUNS; u++) {
+		double start = bench_now();
+		bench_sink = run(data);
+		double elapsed = bench_now() - start;
+		if(!u || elapsed < best)
+			best = elapsed;
+	}
+	printf("%-28s %8.1f ns\n", name, best / (double)operations);
+	fflush(stdout);
+}
+
+// A simple generator of pseudo-random indices, the same on every run.
+static inline size_t bench_random(uint64_t *state, size_t limit) {
+	*state = *state * UINT64_C(6364136223846793005) + UINT64_C(1442695040888963407);
+	return (size_t)(*state >> 33U) % limit;
+}
@@ -0,0 +1,94 @@
+#include "common.h"
+
+// Sequential iteration over large arrays and objects, with cursors and
+// with indexed access.
+
+#define COUNT SIZE_C(1000000)
+
+static uint64_t run_array_cursor(const void *data) {
+	bijson_array_cursor_t cursor;
+	C(bijson_analyzed_array_cursor_init(&cursor, data));
+	uint64_t sum = 0;
+	for(size_t u = 0; u < COUNT; u++) {
+		bijson_t item;
+		C(bijson_array_cursor_next(&cursor, &item));
+		sum += item.size;
+	}
+	return sum;
+}
+
+static uint64_t run_array_index(const void *data) {
+	uint64_t sum = 0;
+	for(size_t u = 0; u < COUNT; u++) {
+		bijson_t item;
+		C(bijson_analyzed_array_get_index(data, u, &item));
+		sum += item.size;
+	}
+	return sum;
+}
+
+static uint64_t run_object_cursor(const void *data) {
+	bijson_object_cursor_t cursor;
+	C(bijson_analyzed_object_cursor_init(&cursor, data));
+	uint64_t sum = 0;
+	for(size_t u = 0; u < COUNT; u++) {
+		const void *key;
+		size_t len;
+		bijson_t value;
+		C(bijson_object_cursor_next(&cursor, &key, &len, &value));
+		sum += len + value.size;
+	}
+	return sum;
+}
+
+static uint64_t run_object_index(const void *data) {
+	uint64_t sum = 0;
+	for(size_t u = 0; u < COUNT; u++) {
+		const void *key;
+		size_t len;
+		bijson_t value;
+		C(bijson_analyzed_object_get_index(data, u, &key, &len, &value));
+		sum += len + value.size;
+	}
+	return sum;
+}
+
+int main(void) {
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	C(bijson_writer_begin_array(writer));
+	for(size_t u = 0; u < COUNT; u++) {
+		char digits[32];
+		C(bijson_writer_add_decimal_from_string(writer, digits, (size_t)sprintf(digits, "%zu", u)));
+	}
+	C(bijson_writer_end_array(writer));
+	bijson_t array;
+	C(bijson_writer_write_to_malloc(writer, &array));
+	bijson_writer_free(writer);
+
+	C(bijson_writer_alloc(&writer));
+	C(bijson_writer_begin_object(writer));
+	for(size_t u = 0; u < COUNT; u++) {
+		char key[16];
+		C(bijson_writer_add_key(writer, key, (size_t)sprintf(key, "key%zu", u)));
+		C(bijson_writer_add_decimal_from_string(writer, key + 3, strlen(key + 3)));
+	}
+	C(bijson_writer_end_object(writer));
+	bijson_t object;
+	C(bijson_writer_write_to_malloc(writer, &object));
+	bijson_writer_free(writer);
+
+	bijson_array_analysis_t array_analysis;
+	C(bijson_array_analyze(&array, &array_analysis));
+	bench("array cursor n=1M", COUNT, run_array_cursor, &array_analysis);
+	bench("array index n=1M", COUNT, run_array_index, &array_analysis);
+
+	bijson_object_analysis_t object_analysis;
+	C(bijson_object_analyze(&object, &object_analysis));
+	bench("object cursor n=1M", COUNT, run_object_cursor, &object_analysis);
+	bench("object index n=1M", COUNT, run_object_index, &object_analysis);
+
+	bijson_free(&array);
+	bijson_free(&object);
+	return 0;
+}
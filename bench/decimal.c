@@ -0,0 +1,73 @@
+#include <errno.h>
+
+#include "common.h"
+
+// Conversion of decimal integers to int64_t, directly and through JSON text
+// (the way projections used to do it).
+
+#define COUNT SIZE_C(1000000)
+
+static uint64_t run_get_int64(const void *data) {
+	uint64_t sum = 0;
+	for(size_t u = 0; u < COUNT; u++) {
+		bijson_t item;
+		C(bijson_analyzed_array_get_index(data, u, &item));
+		int64_t value;
+		C(bijson_decimal_get_int64(&item, &value));
+		sum += (uint64_t)value;
+	}
+	return sum;
+}
+
+static uint64_t run_text(const void *data) {
+	uint64_t sum = 0;
+	for(size_t u = 0; u < COUNT; u++) {
+		bijson_t item;
+		C(bijson_analyzed_array_get_index(data, u, &item));
+		const void *buffer;
+		size_t size;
+		C(bijson_to_json_malloc(&item, &buffer, &size));
+		char text[32];
+		if(size >= sizeof text)
+			errx(EX_SOFTWARE, "item %zu: unexpectedly long JSON", u);
+		memcpy(text, buffer, size);
+		text[size] = '\0';
+		free(_bijson_no_const(buffer));
+		errno = 0;
+		long long value = strtoll(text, NULL, 10);
+		if(errno)
+			err(EX_SOFTWARE, "strtoll");
+		sum += (uint64_t)value;
+	}
+	return sum;
+}
+
+int main(void) {
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	C(bijson_writer_begin_array(writer));
+	uint64_t state = COUNT;
+	for(size_t u = 0; u < COUNT; u++) {
+		// Values of all magnitudes, half of them negative
+		uint64_t value = (uint64_t)bench_random(&state, SIZE_C(0x80000000)) << 31U;
+		value |= (uint64_t)bench_random(&state, SIZE_C(0x80000000));
+		value >>= bench_random(&state, SIZE_C(62));
+		char digits[32];
+		int len = u % SIZE_C(2)
+			? sprintf(digits, "-%"PRIu64, value)
+			: sprintf(digits, "%"PRIu64, value);
+		C(bijson_writer_add_decimal_from_string(writer, digits, (size_t)len));
+	}
+	C(bijson_writer_end_array(writer));
+	bijson_t array;
+	C(bijson_writer_write_to_malloc(writer, &array));
+	bijson_writer_free(writer);
+
+	bijson_array_analysis_t analysis;
+	C(bijson_array_analyze(&array, &analysis));
+	bench("decimal get_int64 n=1M", COUNT, run_get_int64, &analysis);
+	bench("decimal JSON+strtoll n=1M", COUNT, run_text, &analysis);
+
+	bijson_free(&array);
+	return 0;
+}
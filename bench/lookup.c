@@ -0,0 +1,133 @@
+#include "common.h"
+
+// Random access to objects and arrays of various sizes. Only uses functions
+// that predate the specialized offset widths, so that it can be built
+// against older versions for comparison.
+
+#define LOOKUPS SIZE_C(4000000)
+// Lookups cycle through this many randomly chosen keys or indices
+#define PICKS SIZE_C(65536)
+
+typedef struct pick {
+	char key[16];
+	size_t len;
+	size_t index;
+} pick_t;
+
+typedef struct object_data {
+	bijson_object_analysis_t analysis;
+	pick_t *picks;
+} object_data_t;
+
+typedef struct array_data {
+	bijson_array_analysis_t analysis;
+	pick_t *picks;
+} array_data_t;
+
+static uint64_t run_object_key(const void *data) {
+	const object_data_t *object = data;
+	uint64_t sum = 0;
+	for(size_t u = 0; u < LOOKUPS; u++) {
+		const pick_t *pick = object->picks + u % PICKS;
+		bijson_t value;
+		C(bijson_analyzed_object_get_key(&object->analysis, pick->key, pick->len, &value));
+		sum += value.size;
+	}
+	return sum;
+}
+
+static uint64_t run_object_index(const void *data) {
+	const object_data_t *object = data;
+	uint64_t sum = 0;
+	for(size_t u = 0; u < LOOKUPS; u++) {
+		const void *key;
+		size_t len;
+		bijson_t value;
+		C(bijson_analyzed_object_get_index(&object->analysis, object->picks[u % PICKS].index, &key, &len, &value));
+		sum += len + value.size;
+	}
+	return sum;
+}
+
+static uint64_t run_array_index(const void *data) {
+	const array_data_t *array = data;
+	uint64_t sum = 0;
+	for(size_t u = 0; u < LOOKUPS; u++) {
+		bijson_t item;
+		C(bijson_analyzed_array_get_index(&array->analysis, array->picks[u % PICKS].index, &item));
+		sum += item.size;
+	}
+	return sum;
+}
+
+static pick_t *pick(size_t count) {
+	pick_t *picks = malloc(PICKS * sizeof *picks);
+	if(!picks)
+		err(EX_OSERR, "malloc");
+	uint64_t state = count;
+	for(size_t u = 0; u < PICKS; u++) {
+		picks[u].index = bench_random(&state, count);
+		picks[u].len = (size_t)sprintf(picks[u].key, "key%zu", picks[u].index);
+	}
+	return picks;
+}
+
+static void bench_object(size_t count, bool keys, bool indices) {
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	C(bijson_writer_begin_object(writer));
+	for(size_t u = 0; u < count; u++) {
+		char key[16];
+		C(bijson_writer_add_key(writer, key, (size_t)sprintf(key, "key%zu", u)));
+		C(bijson_writer_add_decimal_from_string(writer, key + 3, strlen(key + 3)));
+	}
+	C(bijson_writer_end_object(writer));
+	bijson_t bijson;
+	C(bijson_writer_write_to_malloc(writer, &bijson));
+	bijson_writer_free(writer);
+
+	object_data_t object = {.picks = pick(count)};
+	C(bijson_object_analyze(&bijson, &object.analysis));
+	char name[64];
+	if(keys) {
+		snprintf(name, sizeof name, "object key n=%zu", count);
+		bench(name, LOOKUPS, run_object_key, &object);
+	}
+	if(indices) {
+		snprintf(name, sizeof name, "object index n=%zu", count);
+		bench(name, LOOKUPS, run_object_index, &object);
+	}
+	free(object.picks);
+	bijson_free(&bijson);
+}
+
+static void bench_array(size_t count) {
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	C(bijson_writer_begin_array(writer));
+	for(size_t u = 0; u < count; u++) {
+		char digits[32];
+		C(bijson_writer_add_decimal_from_string(writer, digits, (size_t)sprintf(digits, "%zu", u)));
+	}
+	C(bijson_writer_end_array(writer));
+	bijson_t bijson;
+	C(bijson_writer_write_to_malloc(writer, &bijson));
+	bijson_writer_free(writer);
+
+	array_data_t array = {.picks = pick(count)};
+	C(bijson_array_analyze(&bijson, &array.analysis));
+	char name[64];
+	snprintf(name, sizeof name, "array index n=%zu", count);
+	bench(name, LOOKUPS, run_array_index, &array);
+	free(array.picks);
+	bijson_free(&bijson);
+}
+
+int main(void) {
+	bench_object(SIZE_C(16), true, false);
+	bench_object(SIZE_C(4096), true, false);
+	bench_object(SIZE_C(1000000), true, true);
+	bench_array(SIZE_C(16));
+	bench_array(SIZE_C(1000000));
+	return 0;
+}
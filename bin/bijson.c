@@ -37,12 +37,31 @@ static void _c(bijson_error_t error, const char *fmt, ...) {
 }
 #define C(error, ...) do { _c((error), __VA_ARGS__); } while(0)
 
+// Prints each query result as JSON on a line of its own.
+static bijson_error_t query_callback(void *callback_data, const bijson_t *result) {
+	bijson_error_t error = bijson_to_json_FILE(result, stdout);
+	if(error)
+		return error;
+	if(putchar('\n') == EOF)
+		return bijson_error_system;
+	return NULL;
+}
+
+// Prints each index match as JSON on a line of its own.
+static bijson_error_t index_callback(void *callback_data, size_t index, const bijson_t *item) {
+	(void)index;
+	return query_callback(callback_data, item);
+}
+
 static void usage(FILE *fh) {
 	fprintf(fh, "Usage:\n");
 	fprintf(fh, "\t%s help\n", progname);
 	fprintf(fh, "\t%s version\n", progname);
 	fprintf(fh, "\t%s load-json <input.json> <output.bijson>\n", progname);
-	fprintf(fh, "\t%s dump-json <input.bijson> <output.json>\n", progname);
+	fprintf(fh, "\t%s dump-json [-j <threads>] <input.bijson> <output.json>\n", progname);
+	fprintf(fh, "\t%s query <input.bijson> <query>\n", progname);
+	fprintf(fh, "\t%s index <input.bijson> <pointer> <output.index>\n", progname);
+	fprintf(fh, "\t%s lookup <input.bijson> <input.index> <json value>\n", progname);
 	// fprintf(fh, "\t%s load-yaml <input.yaml> <output.bijson>\n", progname);
 	// fprintf(fh, "\t%s dump-yaml <input.bijson> <output.yaml>\n", progname);
 }
@@ -77,6 +96,19 @@ int main(int argc, char **argv) {
 		C(bijson_writer_write_to_filename(writer, argv[3]), "bijson_writer_write_to_filename(%s)", argv[3]);
 		bijson_writer_free(writer);
 	} else if(!strcmp(command, "dump-json")) {
+		size_t threads = 1;
+		if(argc > 3 && !strcmp(argv[2], "-j")) {
+			char *end;
+			unsigned long value = strtoul(argv[3], &end, 10);
+			if(!*argv[3] || *end || !value) {
+				usage(stderr);
+				fprintf(stderr, "%s: invalid thread count %s\n", progname, argv[3]);
+				return EXIT_FAILURE;
+			}
+			threads = value;
+			argv += 2;
+			argc -= 2;
+		}
 		if (argc < 4) {
 			usage(stderr);
 			fprintf(stderr, "%s: missing arguments\n", progname);
@@ -84,8 +116,51 @@ int main(int argc, char **argv) {
 		}
 		bijson_t bijson;
 		C(bijson_open_filename(&bijson, argv[2]), "bijson_open_filename(%s)", argv[2]);
-		C(bijson_to_json_filename(&bijson, argv[3]), "bijson_to_json_filename(%s)", argv[3]);
+		C(bijson_to_json_parallel_filename(&bijson, threads, argv[3]), "bijson_to_json_parallel_filename(%s)", argv[3]);
+		bijson_close(&bijson);
+	} else if(!strcmp(command, "query")) {
+		if (argc < 4) {
+			usage(stderr);
+			fprintf(stderr, "%s: missing arguments\n", progname);
+			return EXIT_FAILURE;
+		}
+		bijson_t bijson;
+		bijson_query_t *query;
+		C(bijson_open_filename(&bijson, argv[2]), "bijson_open_filename(%s)", argv[2]);
+		C(bijson_query_compile(&query, argv[3], strlen(argv[3])), "bijson_query_compile(%s)", argv[3]);
+		C(bijson_query_run(query, &bijson, query_callback, NULL), "bijson_query_run(%s)", argv[3]);
+		bijson_query_free(query);
+		bijson_close(&bijson);
+	} else if(!strcmp(command, "index")) {
+		if (argc < 5) {
+			usage(stderr);
+			fprintf(stderr, "%s: missing arguments\n", progname);
+			return EXIT_FAILURE;
+		}
+		bijson_t bijson;
+		C(bijson_open_filename(&bijson, argv[2]), "bijson_open_filename(%s)", argv[2]);
+		C(bijson_index_build(&bijson, argv[3], strlen(argv[3]), argv[4]), "bijson_index_build(%s)", argv[4]);
+		bijson_close(&bijson);
+	} else if(!strcmp(command, "lookup")) {
+		if (argc < 5) {
+			usage(stderr);
+			fprintf(stderr, "%s: missing arguments\n", progname);
+			return EXIT_FAILURE;
+		}
+		bijson_writer_t *writer;
+		bijson_t value;
+		C(bijson_writer_alloc(&writer), "bijson_writer_alloc()");
+		C(bijson_parse_json(writer, argv[4], strlen(argv[4]), NULL), "bijson_parse_json(%s)", argv[4]);
+		C(bijson_writer_write_to_malloc(writer, &value), "bijson_writer_write_to_malloc()");
+		bijson_writer_free(writer);
+		bijson_t bijson;
+		bijson_index_t *index;
+		C(bijson_open_filename(&bijson, argv[2]), "bijson_open_filename(%s)", argv[2]);
+		C(bijson_index_open(&index, &bijson, argv[3]), "bijson_index_open(%s)", argv[3]);
+		C(bijson_index_lookup(index, &value, index_callback, NULL), "bijson_index_lookup(%s)", argv[4]);
+		bijson_index_close(index);
 		bijson_close(&bijson);
+		bijson_free(&value);
 	} else {
 		usage(stderr);
 		fprintf(stderr, "%s: unknown command %s\n", progname, command);
@@ -1,4 +1,5 @@
 #include <inttypes.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -7,7 +8,15 @@
 #include <string.h>
 #include <stdarg.h>
 
+#include "../include/reader.h"
+
 #include "../lib/common.h"
+#include "../lib/reader.h"
+#include "../lib/writer.h"
+#include "../lib/io.h"
+#include "../lib/reader/binary.h"
+#include "../lib/reader/index.h"
+#include "../lib/reader/string.h"
 
 __attribute__((format(printf, 1, 2)))
 static void xprintf(const char *format, ...) {
@@ -203,9 +212,729 @@ static void test_uint64_str(void) {
 	}
 }
 
+static void test_read_minimal_int(void) {
+	static const byte_t buffer[] = {
+		BYTE_C(0x01), BYTE_C(0x23), BYTE_C(0x45), BYTE_C(0x67),
+		BYTE_C(0x89), BYTE_C(0xAB), BYTE_C(0xCD), BYTE_C(0xEF),
+		BYTE_C(0xFF),
+	};
+
+	for(size_t offset = 0; offset < SIZE_C(2); offset++) {
+		for(size_t nbytes = 1; nbytes <= sizeof(uint64_t); nbytes++) {
+			uint64_t ref = 0;
+			for(size_t u = 0; u < nbytes; u++)
+				ref |= (uint64_t)buffer[offset + u] << (u * SIZE_C(8));
+			uint64_t test = _bijson_read_minimal_int(buffer + offset, nbytes);
+			if(test == ref)
+				xprintf("ok %"PRIu64" - %zu byte read at offset %zu matches reference\n", test_index++, nbytes, offset);
+			else
+				xprintf("not ok %"PRIu64" - %zu byte read at offset %zu (%"PRIx64") does not match reference (%"PRIx64")\n", test_index++, nbytes, offset, test, ref);
+		}
+	}
+}
+
+static void test_fit_uint64(void) {
+	for(unsigned int bits = 0; bits <= 64U; bits++) {
+		uint64_t value = bits ? UINT64_MAX >> (64U - bits) : UINT64_C(0);
+		size_t ref = bits ? (bits + 7U) / 8U : 1U;
+		size_t test = _bijson_fit_uint64(value);
+		if(test == ref)
+			xprintf("ok %"PRIu64" - %u bit value fits in %zu bytes\n", test_index++, bits, test);
+		else
+			xprintf("not ok %"PRIu64" - %u bit value reported to fit in %zu bytes instead of %zu\n", test_index++, bits, test, ref);
+	}
+}
+
+static void test_decimal_get_int64(void) {
+	static const struct {
+		byte_t buffer[12];
+		size_t size;
+		bijson_error_t error;
+		int64_t value;
+	} tests[] = {
+		// 0, -0, 1, -1
+		{{BYTE_C(0x1A)}, 1, NULL, INT64_C(0)},
+		{{BYTE_C(0x1B)}, 1, NULL, INT64_C(0)},
+		{{BYTE_C(0x1A), BYTE_C(0x00)}, 2, NULL, INT64_C(1)},
+		{{BYTE_C(0x1B), BYTE_C(0x00)}, 2, NULL, INT64_C(-1)},
+		// INT64_MAX, INT64_MAX + 1, INT64_MIN
+		{{BYTE_C(0x1A), BYTE_C(0xFE), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0x7F)},
+			9, NULL, INT64_MAX},
+		{{BYTE_C(0x1A), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0x7F)},
+			9, bijson_error_value_out_of_range, INT64_C(0)},
+		{{BYTE_C(0x1B), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0xFF), BYTE_C(0x7F)},
+			9, NULL, INT64_MIN},
+		// 10^19 (two words)
+		{{BYTE_C(0x1A), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00)},
+			10, bijson_error_value_out_of_range, INT64_C(0)},
+		// 12e2, -12e2, 15e-1, 200e-2
+		{{BYTE_C(0x20), BYTE_C(0x00), BYTE_C(0x01), BYTE_C(0x0B)}, 4, NULL, INT64_C(1200)},
+		{{BYTE_C(0x24), BYTE_C(0x00), BYTE_C(0x01), BYTE_C(0x0B)}, 4, NULL, INT64_C(-1200)},
+		{{BYTE_C(0x28), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x0E)}, 4, bijson_error_value_out_of_range, INT64_C(0)},
+		{{BYTE_C(0x28), BYTE_C(0x00), BYTE_C(0x01), BYTE_C(0xC7)}, 4, NULL, INT64_C(2)},
+		// 1e19
+		{{BYTE_C(0x20), BYTE_C(0x00), BYTE_C(0x12), BYTE_C(0x00)}, 4, bijson_error_value_out_of_range, INT64_C(0)},
+		// null
+		{{BYTE_C(0x01)}, 1, bijson_error_type_mismatch, INT64_C(0)},
+	};
+
+	for(size_t u = 0; u < _BIJSON_ARRAY_COUNT(tests); u++) {
+		bijson_t bijson = {tests[u].buffer, tests[u].size};
+		int64_t value = 0;
+		bijson_error_t error = bijson_decimal_get_int64(&bijson, &value);
+		if(error != tests[u].error)
+			xprintf("not ok %"PRIu64" - decimal %zu returned %s\n", test_index++, u, error ? error : "no error");
+		else if(!error && value != tests[u].value)
+			xprintf("not ok %"PRIu64" - decimal %zu decoded as %"PRId64" instead of %"PRId64"\n", test_index++, u, value, tests[u].value);
+		else
+			xprintf("ok %"PRIu64" - decimal %zu decoded correctly\n", test_index++, u);
+	}
+}
+
+// Encodes the digits as words of 19 digits, least significant first, with
+// the most significant one minus 1 in as few bytes as possible.
+static size_t test_encode_decimal_part(byte_t *buffer, const char *digits, size_t len) {
+	size_t size = 0;
+	for(size_t end = len; end;) {
+		size_t start = end > SIZE_C(19) ? end - SIZE_C(19) : SIZE_C(0);
+		uint64_t word = 0;
+		for(size_t u = start; u < end; u++)
+			word = word * UINT64_C(10) + (uint64_t)(digits[u] - '0');
+		size_t nbytes = SIZE_C(8);
+		if(!start)
+			nbytes = _bijson_fit_uint64(--word);
+		for(size_t u = 0; u < nbytes; u++, word >>= 8U)
+			buffer[size++] = (byte_t)(word & UINT64_C(0xFF));
+		end = start;
+	}
+	return size;
+}
+
+// Encodes a number like "-15e-1" the way the writer would. Integers are
+// encoded as decimal integers, anything with an exponent as a decimal.
+static size_t test_encode_decimal(byte_t *buffer, const char *text) {
+	bool negative = *text == '-';
+	if(negative)
+		text++;
+	const char *e = strchr(text, 'e');
+	size_t len = e ? _bijson_ptrdiff(e, text) : strlen(text);
+	if(len == SIZE_C(1) && *text == '0')
+		len = 0;
+	if(!e) {
+		buffer[0] = negative ? BYTE_C(0x1B) : BYTE_C(0x1A);
+		return SIZE_C(1) + test_encode_decimal_part(buffer + SIZE_C(1), text, len);
+	}
+	bool exponent_negative = e[1] == '-';
+	const char *exponent = e + (exponent_negative ? 2 : 1);
+	buffer[0] = (byte_t)(BYTE_C(0x20) | (negative ? BYTE_C(0x4) : BYTE_C(0)) | (exponent_negative ? BYTE_C(0x8) : BYTE_C(0)));
+	size_t exponent_size = test_encode_decimal_part(buffer + SIZE_C(2), exponent, strlen(exponent));
+	buffer[1] = (byte_t)(exponent_size - SIZE_C(1));
+	return SIZE_C(2) + exponent_size + test_encode_decimal_part(buffer + SIZE_C(2) + exponent_size, text, len);
+}
+
+typedef enum test_integer_type {
+	test_int8,
+	test_uint8,
+	test_uint8_signed,
+	test_int16,
+	test_uint16,
+	test_uint16_signed,
+	test_int32,
+	test_uint32,
+	test_uint32_signed,
+	test_int64,
+	test_uint64,
+	test_uint64_signed,
+	test_int128,
+	test_uint128,
+	test_uint128_signed,
+} test_integer_type_t;
+
+#ifdef __SIZEOF_INT128__
+static void test_uint128_str(char *dst, bool negative, uint128_t value) {
+	char digits[40];
+	size_t len = 0;
+	do {
+		digits[len++] = (char)('0' + (int)(value % 10U));
+		value /= 10U;
+	} while(value);
+	if(negative)
+		*dst++ = '-';
+	while(len)
+		*dst++ = digits[--len];
+	*dst = '\0';
+}
+#endif
+
+// Calls the getter for the type and formats the result as text. The
+// _signed variants pass a negative_result and show the sign it reports.
+static bijson_error_t test_decimal_get_integer(const bijson_t *bijson, test_integer_type_t type, char *result) {
+	bool negative = false;
+	switch(type) {
+#define TEST_GET_INTEGER(bits) \
+		case test_int##bits: { \
+			int##bits##_t value; \
+			_BIJSON_RETURN_ON_ERROR(bijson_decimal_get_int##bits(bijson, &value)); \
+			xsprintf(result, "%"PRId64, (int64_t)value); \
+		} break; \
+		case test_uint##bits: \
+		case test_uint##bits##_signed: { \
+			uint##bits##_t value; \
+			_BIJSON_RETURN_ON_ERROR(bijson_decimal_get_uint##bits(bijson, &value, \
+				type == test_uint##bits##_signed ? &negative : NULL)); \
+			xsprintf(result, "%s%"PRIu64, negative ? "-" : "", (uint64_t)value); \
+		} break;
+		TEST_GET_INTEGER(8)
+		TEST_GET_INTEGER(16)
+		TEST_GET_INTEGER(32)
+		TEST_GET_INTEGER(64)
+#undef TEST_GET_INTEGER
+#ifdef __SIZEOF_INT128__
+		case test_int128: {
+			int128_t value;
+			_BIJSON_RETURN_ON_ERROR(bijson_decimal_get_int128(bijson, &value));
+			test_uint128_str(result, value < 0, value < 0 ? -(uint128_t)value : (uint128_t)value);
+		} break;
+		case test_uint128:
+		case test_uint128_signed: {
+			uint128_t value;
+			_BIJSON_RETURN_ON_ERROR(bijson_decimal_get_uint128(bijson, &value,
+				type == test_uint128_signed ? &negative : NULL));
+			test_uint128_str(result, negative, value);
+		} break;
+#endif
+		default:
+			abort();
+	}
+	return NULL;
+}
+
+static void test_decimal_get_integers(void) {
+	// The expected result is NULL for numbers that are out of range
+	static const struct {
+		test_integer_type_t type;
+		const char *number;
+		const char *result;
+	} tests[] = {
+		{test_int8, "-129", NULL},
+		{test_int8, "-128", "-128"},
+		{test_int8, "-127", "-127"},
+		{test_int8, "126", "126"},
+		{test_int8, "127", "127"},
+		{test_int8, "128", NULL},
+		{test_int8, "-0", "0"},
+		{test_int8, "-1", "-1"},
+		{test_int8, "128e-1", NULL},
+		{test_int8, "1270e-1", "127"},
+		{test_int8, "-1280e-1", "-128"},
+		{test_int8, "-13e1", NULL},
+		{test_int8, "1e400", NULL},
+		{test_int8, "1e-400", NULL},
+		{test_uint8, "-1", NULL},
+		{test_uint8, "-0", "0"},
+		{test_uint8, "0", "0"},
+		{test_uint8, "1", "1"},
+		{test_uint8, "254", "254"},
+		{test_uint8, "255", "255"},
+		{test_uint8, "256", NULL},
+		{test_uint8, "255e-1", NULL},
+		{test_uint8, "-255e-1", NULL},
+		{test_uint8_signed, "-256", NULL},
+		{test_uint8_signed, "-255", "-255"},
+		{test_uint8_signed, "-1", "-1"},
+		{test_uint8_signed, "-0", "-0"},
+		{test_uint8_signed, "0", "0"},
+		{test_uint8_signed, "255", "255"},
+		{test_uint8_signed, "256", NULL},
+		{test_uint8_signed, "-15e-1", NULL},
+		{test_int16, "-32769", NULL},
+		{test_int16, "-32768", "-32768"},
+		{test_int16, "-32767", "-32767"},
+		{test_int16, "32766", "32766"},
+		{test_int16, "32767", "32767"},
+		{test_int16, "32768", NULL},
+		{test_int16, "-0", "0"},
+		{test_int16, "32767e-1", NULL},
+		{test_int16, "-32768000e-3", "-32768"},
+		{test_uint16, "-1", NULL},
+		{test_uint16, "-0", "0"},
+		{test_uint16, "65534", "65534"},
+		{test_uint16, "65535", "65535"},
+		{test_uint16, "65536", NULL},
+		{test_uint16, "65535e-4", NULL},
+		{test_uint16_signed, "-65536", NULL},
+		{test_uint16_signed, "-65535", "-65535"},
+		{test_uint16_signed, "-0", "-0"},
+		{test_uint16_signed, "65535", "65535"},
+		{test_uint16_signed, "65536", NULL},
+		{test_int32, "-2147483649", NULL},
+		{test_int32, "-2147483648", "-2147483648"},
+		{test_int32, "-2147483647", "-2147483647"},
+		{test_int32, "2147483646", "2147483646"},
+		{test_int32, "2147483647", "2147483647"},
+		{test_int32, "2147483648", NULL},
+		{test_int32, "-0", "0"},
+		{test_int32, "2147483647e-9", NULL},
+		{test_int32, "3e9", NULL},
+		{test_int32, "-2e9", "-2000000000"},
+		{test_uint32, "-1", NULL},
+		{test_uint32, "-0", "0"},
+		{test_uint32, "4294967294", "4294967294"},
+		{test_uint32, "4294967295", "4294967295"},
+		{test_uint32, "4294967296", NULL},
+		{test_uint32, "5e-1", NULL},
+		{test_uint32_signed, "-4294967296", NULL},
+		{test_uint32_signed, "-4294967295", "-4294967295"},
+		{test_uint32_signed, "-0", "-0"},
+		{test_uint32_signed, "4294967295", "4294967295"},
+		{test_uint32_signed, "4294967296", NULL},
+		{test_int64, "-9223372036854775809", NULL},
+		{test_int64, "-9223372036854775808", "-9223372036854775808"},
+		{test_int64, "-9223372036854775807", "-9223372036854775807"},
+		{test_int64, "9223372036854775806", "9223372036854775806"},
+		{test_int64, "9223372036854775807", "9223372036854775807"},
+		{test_int64, "9223372036854775808", NULL},
+		{test_int64, "-0", "0"},
+		{test_int64, "92233720368547758070e-1", "9223372036854775807"},
+		{test_int64, "92233720368547758071e-1", NULL},
+		{test_uint64, "-1", NULL},
+		{test_uint64, "-0", "0"},
+		{test_uint64, "18446744073709551614", "18446744073709551614"},
+		{test_uint64, "18446744073709551615", "18446744073709551615"},
+		{test_uint64, "18446744073709551616", NULL},
+		{test_uint64, "18446744073709551615e-1", NULL},
+		{test_uint64_signed, "-18446744073709551616", NULL},
+		{test_uint64_signed, "-18446744073709551615", "-18446744073709551615"},
+		{test_uint64_signed, "-0", "-0"},
+		{test_uint64_signed, "18446744073709551615", "18446744073709551615"},
+		{test_uint64_signed, "18446744073709551616", NULL},
+#ifdef __SIZEOF_INT128__
+		{test_int128, "-170141183460469231731687303715884105729", NULL},
+		{test_int128, "-170141183460469231731687303715884105728", "-170141183460469231731687303715884105728"},
+		{test_int128, "-170141183460469231731687303715884105727", "-170141183460469231731687303715884105727"},
+		{test_int128, "170141183460469231731687303715884105726", "170141183460469231731687303715884105726"},
+		{test_int128, "170141183460469231731687303715884105727", "170141183460469231731687303715884105727"},
+		{test_int128, "170141183460469231731687303715884105728", NULL},
+		{test_int128, "-0", "0"},
+		{test_int128, "17e37", "170000000000000000000000000000000000000"},
+		{test_int128, "18e37", NULL},
+		{test_int128, "170141183460469231731687303715884105727e-1", NULL},
+		{test_uint128, "-1", NULL},
+		{test_uint128, "-0", "0"},
+		{test_uint128, "340282366920938463463374607431768211454", "340282366920938463463374607431768211454"},
+		{test_uint128, "340282366920938463463374607431768211455", "340282366920938463463374607431768211455"},
+		{test_uint128, "340282366920938463463374607431768211456", NULL},
+		{test_uint128, "15e-1", NULL},
+		{test_uint128_signed, "-340282366920938463463374607431768211456", NULL},
+		{test_uint128_signed, "-340282366920938463463374607431768211455", "-340282366920938463463374607431768211455"},
+		{test_uint128_signed, "-0", "-0"},
+		{test_uint128_signed, "340282366920938463463374607431768211455", "340282366920938463463374607431768211455"},
+		{test_uint128_signed, "340282366920938463463374607431768211456", NULL},
+#endif
+	};
+
+	for(size_t u = 0; u < _BIJSON_ARRAY_COUNT(tests); u++) {
+		byte_t buffer[64];
+		bijson_t bijson = {buffer, test_encode_decimal(buffer, tests[u].number)};
+		char result[48] = "";
+		bijson_error_t error = test_decimal_get_integer(&bijson, tests[u].type, result);
+		bijson_error_t expected = tests[u].result ? NULL : bijson_error_value_out_of_range;
+		if(error != expected)
+			xprintf("not ok %"PRIu64" - integer %zu (%s) returned %s\n", test_index++, u, tests[u].number, error ? error : "no error");
+		else if(!error && strcmp(result, tests[u].result))
+			xprintf("not ok %"PRIu64" - integer %zu (%s) decoded as %s instead of %s\n", test_index++, u, tests[u].number, result, tests[u].result);
+		else
+			xprintf("ok %"PRIu64" - integer %zu (%s) decoded correctly\n", test_index++, u, tests[u].number);
+	}
+}
+
+static void test_decimal_get_double(void) {
+	static const struct {
+		byte_t buffer[12];
+		size_t size;
+		bijson_error_t error;
+		double value;
+	} tests[] = {
+		{{BYTE_C(0x1A)}, 1, NULL, 0.0},
+		{{BYTE_C(0x1B), BYTE_C(0x00)}, 2, NULL, -1.0},
+		// 15e-1, 1e-1
+		{{BYTE_C(0x28), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x0E)}, 4, NULL, 1.5},
+		{{BYTE_C(0x28), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00)}, 4, NULL, 0.1},
+		// 9007199254740993 (halfway, rounds to even)
+		{{BYTE_C(0x1A), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x20)},
+			8, NULL, 9007199254740992.0},
+		// 1e-400, 1e400
+		{{BYTE_C(0x28), BYTE_C(0x01), BYTE_C(0x8F), BYTE_C(0x01), BYTE_C(0x00)}, 5, NULL, 0.0},
+		{{BYTE_C(0x20), BYTE_C(0x01), BYTE_C(0x8F), BYTE_C(0x01), BYTE_C(0x00)}, 5, bijson_error_value_out_of_range, 0.0},
+	};
+
+	for(size_t u = 0; u < _BIJSON_ARRAY_COUNT(tests); u++) {
+		bijson_t bijson = {tests[u].buffer, tests[u].size};
+		double value = 0.0;
+		bijson_error_t error = bijson_decimal_get_double(&bijson, &value);
+		if(error != tests[u].error)
+			xprintf("not ok %"PRIu64" - decimal %zu returned %s\n", test_index++, u, error ? error : "no error");
+		else if(!error && memcmp(&value, &tests[u].value, sizeof value))
+			xprintf("not ok %"PRIu64" - decimal %zu converted to %.17g instead of %.17g\n", test_index++, u, value, tests[u].value);
+		else
+			xprintf("ok %"PRIu64" - decimal %zu converted correctly\n", test_index++, u);
+	}
+}
+
+static void test_decimal_get_floating(void) {
+	// Compared with the results of strtod(), strtof() and strtold(), which
+	// are correctly rounded. The long numbers are just above or below the
+	// halfway point between two doubles or floats, so the first 19 digits
+	// are not enough to decide how to round them.
+	static const char *const tests[] = {
+		"0",
+		"-0",
+		"1",
+		"-15e-1",
+		"1e-1",
+		"123456789012345678901234567890",
+		// 2^53 + 1 and 2^24 + 1, halfway and so rounded to even
+		"9007199254740993",
+		"16777217",
+		"90071992547409930000000000000000000000000e-25",
+		"9007199254740993000000000000001e-15",
+		"9007199254740992999999999999999e-15",
+		"90071992547409930000000000000000000000001e-25",
+		"-90071992547409929999999999999999999999999e-25",
+		"16777217000000000000000001e-18",
+		"16777216999999999999999999e-18",
+		"-1677721700000000000000000000000000000000000001e-38",
+		// 2^-1074, halfway below it, smallest normal double
+		"49406564584124654e-340",
+		"24703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435931802849936536152500319370457678249219365623669863658480757001585769269903706311928279558551332927834338409351978015531246597263579574622766465272827220056374006485499977096599470454020828166226237857393450736339007967761930577506740176324673600968951340535537458516661134223766678604162159680461914467291840300530057530849048765391711386591646239524912623653881879636239373280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186948667994968324049705821028513185451396213837722826145437693412532098591327667236328125e-1074",
+		"22250738585072014e-324",
+		// The largest double, halfway above it, the largest float
+		"17976931348623157e292",
+		"179769313486231580793728971405303415079934132710037826936173778980444968292764750946649017977587207096330286416692887910946555547851940402630657488671505820681908902000708383676273854845817711531764475730270069855571366959622842914819860834936475292719074168444365510704342711559699508093042880177904174497792",
+		"179769313486231580793728971405303415079934132710037826936173778980444968292764750946649017977587207096330286416692887910946555547851940402630657488671505820681908902000708383676273854845817711531764475730270069855571366959622842914819860834936475292719074168444365510704342711559699508093042880177904174497791",
+		"34028234663852886e22",
+		"340282356779733661637539395458142568448",
+		"340282356779733661637539395458142568447",
+		"1e400",
+		"-1e400",
+		"1e-400",
+	};
+
+	for(size_t u = 0; u < _BIJSON_ARRAY_COUNT(tests); u++) {
+		static byte_t buffer[1024];
+		bijson_t bijson = {buffer, test_encode_decimal(buffer, tests[u])};
+
+		double d = 0.0, d_ref = strtod(tests[u], NULL);
+		bijson_error_t error = bijson_decimal_get_double(&bijson, &d);
+		bijson_error_t expected = isinf(d_ref) ? bijson_error_value_out_of_range : NULL;
+		if(error != expected)
+			xprintf("not ok %"PRIu64" - double %zu returned %s\n", test_index++, u, error ? error : "no error");
+		else if(!error && memcmp(&d, &d_ref, sizeof d))
+			xprintf("not ok %"PRIu64" - double %zu converted to %a instead of %a\n", test_index++, u, d, d_ref);
+		else
+			xprintf("ok %"PRIu64" - double %zu converted correctly\n", test_index++, u);
+
+		float f = 0.0f, f_ref = strtof(tests[u], NULL);
+		error = bijson_decimal_get_float(&bijson, &f);
+		expected = isinf(f_ref) ? bijson_error_value_out_of_range : NULL;
+		if(error != expected)
+			xprintf("not ok %"PRIu64" - float %zu returned %s\n", test_index++, u, error ? error : "no error");
+		else if(!error && memcmp(&f, &f_ref, sizeof f))
+			xprintf("not ok %"PRIu64" - float %zu converted to %a instead of %a\n", test_index++, u, (double)f, (double)f_ref);
+		else
+			xprintf("ok %"PRIu64" - float %zu converted correctly\n", test_index++, u);
+
+#ifdef LDBL_DIG
+		// There is no fast path for long doubles; they are converted by
+		// formatting the number as text and calling strtold().
+		long double l = 0.0L, l_ref = strtold(tests[u], NULL);
+		error = bijson_decimal_get_long_double(&bijson, &l);
+		expected = isinf(l_ref) ? bijson_error_value_out_of_range : NULL;
+		if(error != expected)
+			xprintf("not ok %"PRIu64" - long double %zu returned %s\n", test_index++, u, error ? error : "no error");
+		else if(!error && l != l_ref)
+			xprintf("not ok %"PRIu64" - long double %zu converted to %La instead of %La\n", test_index++, u, l, l_ref);
+		else
+			xprintf("ok %"PRIu64" - long double %zu converted correctly\n", test_index++, u);
+#endif
+	}
+}
+
+static void test_decimal_compare(void) {
+	static const struct {
+		byte_t a[12];
+		size_t a_size;
+		byte_t b[12];
+		size_t b_size;
+		int result;
+	} tests[] = {
+		// 0, -0
+		{{BYTE_C(0x1A)}, 1, {BYTE_C(0x1B)}, 1, 0},
+		// 1, 10e-1
+		{{BYTE_C(0x1A), BYTE_C(0x00)}, 2, {BYTE_C(0x28), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x09)}, 4, 0},
+		// 15e-1, 1
+		{{BYTE_C(0x28), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x0E)}, 4, {BYTE_C(0x1A), BYTE_C(0x00)}, 2, 1},
+		// -1, 1e-1
+		{{BYTE_C(0x1B), BYTE_C(0x00)}, 2, {BYTE_C(0x28), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00)}, 4, -1},
+		// -2, -1
+		{{BYTE_C(0x1B), BYTE_C(0x01)}, 2, {BYTE_C(0x1B), BYTE_C(0x00)}, 2, -1},
+		// 10000000000000000000, 9999999999999999999
+		{{BYTE_C(0x1A), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00)}, 10,
+			{BYTE_C(0x1A), BYTE_C(0xFE), BYTE_C(0xFF), BYTE_C(0xE7), BYTE_C(0x89), BYTE_C(0x04), BYTE_C(0x23), BYTE_C(0xC7), BYTE_C(0x8A)}, 9, 1},
+		// 1e400, 10000000000000000000
+		{{BYTE_C(0x20), BYTE_C(0x01), BYTE_C(0x8F), BYTE_C(0x01), BYTE_C(0x00)}, 5,
+			{BYTE_C(0x1A), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00), BYTE_C(0x00)}, 10, 1},
+		// 1e-400, 0
+		{{BYTE_C(0x28), BYTE_C(0x01), BYTE_C(0x8F), BYTE_C(0x01), BYTE_C(0x00)}, 5, {BYTE_C(0x1A)}, 1, 1},
+	};
+
+	for(size_t u = 0; u < _BIJSON_ARRAY_COUNT(tests); u++) {
+		bijson_t a = {tests[u].a, tests[u].a_size};
+		bijson_t b = {tests[u].b, tests[u].b_size};
+		int result, reverse;
+		bijson_error_t error = bijson_decimal_compare(&a, &b, &result);
+		if(!error)
+			error = bijson_decimal_compare(&b, &a, &reverse);
+		if(error)
+			xprintf("not ok %"PRIu64" - comparison %zu returned %s\n", test_index++, u, error);
+		else if((result > 0) - (result < 0) != tests[u].result || (reverse > 0) - (reverse < 0) != -tests[u].result)
+			xprintf("not ok %"PRIu64" - comparison %zu returned %d and %d instead of %d\n", test_index++, u, result, reverse, tests[u].result);
+		else
+			xprintf("ok %"PRIu64" - comparison %zu is correct\n", test_index++, u);
+	}
+}
+
+typedef struct test_output {
+	byte_t buffer[4096];
+	size_t len;
+} test_output_t;
+
+static bijson_error_t test_output_callback(void *callback_data, const void *data, size_t len) {
+	test_output_t *output = callback_data;
+	if(len > sizeof output->buffer - output->len)
+		abort();
+	memcpy(output->buffer + output->len, data, len);
+	output->len += len;
+	return NULL;
+}
+
+// Checks the escaping of strings of various lengths (to exercise both the
+// vectorized and the scalar scanners) against a straightforward version.
+static void test_raw_string_to_json(void) {
+	static const size_t lengths[] = {0, 1, 7, 8, 15, 16, 31, 32, 33, 63, 64, 65, 100, 255, 256, 257, 600};
+	for(size_t u = 0; u < _BIJSON_ARRAY_COUNT(lengths); u++) {
+		size_t len = lengths[u];
+		byte_t string[600];
+		test_output_t expected = {.len = 0};
+		expected.buffer[expected.len++] = '"';
+		for(size_t v = 0; v < len; v++) {
+			byte_t c = (byte_t)('a' + v % SIZE_C(26));
+			if(v % SIZE_C(100) == SIZE_C(3))
+				c = '"';
+			else if(v % SIZE_C(100) == SIZE_C(4))
+				c = '\\';
+			else if(v % SIZE_C(100) == SIZE_C(5))
+				c = '\n';
+			else if(v % SIZE_C(200) == SIZE_C(150) || v == len - SIZE_C(1))
+				c = BYTE_C(0x1F);
+			string[v] = c;
+			if(c == '"' || c == '\\') {
+				expected.buffer[expected.len++] = '\\';
+				expected.buffer[expected.len++] = c;
+			} else if(c == '\n') {
+				expected.len += (size_t)xsprintf((char *)expected.buffer + expected.len, "\\n");
+			} else if(c < BYTE_C(0x20)) {
+				expected.len += (size_t)xsprintf((char *)expected.buffer + expected.len, "\\u%04X", (unsigned int)c);
+			} else {
+				expected.buffer[expected.len++] = c;
+			}
+		}
+		expected.buffer[expected.len++] = '"';
+
+		test_output_t output = {.len = 0};
+		bijson_t bijson = {string, len};
+		bijson_error_t error = _bijson_raw_string_to_json(&bijson, test_output_callback, &output);
+		if(error)
+			xprintf("not ok %"PRIu64" - string of length %zu returned %s\n", test_index++, len, error);
+		else if(output.len != expected.len || memcmp(output.buffer, expected.buffer, output.len))
+			xprintf("not ok %"PRIu64" - string of length %zu was escaped incorrectly\n", test_index++, len);
+		else
+			xprintf("ok %"PRIu64" - string of length %zu was escaped correctly\n", test_index++, len);
+
+		// The same string in two parts
+		test_output_t parts = {.len = 0};
+		bijson_t head = {string, len / SIZE_C(2)};
+		bijson_t tail = {string + head.size, len - head.size};
+		error = _bijson_raw_string_part_to_json(&head, true, false, test_output_callback, &parts);
+		if(!error)
+			error = _bijson_raw_string_part_to_json(&tail, false, true, test_output_callback, &parts);
+		if(error)
+			xprintf("not ok %"PRIu64" - split string of length %zu returned %s\n", test_index++, len, error);
+		else if(parts.len != expected.len || memcmp(parts.buffer, expected.buffer, parts.len))
+			xprintf("not ok %"PRIu64" - split string of length %zu was escaped incorrectly\n", test_index++, len);
+		else
+			xprintf("ok %"PRIu64" - split string of length %zu was escaped correctly\n", test_index++, len);
+	}
+}
+
+// Checks binary integers and IEEE 754 floats, including integers that need
+// more than 64 bits and floats that need all 17 digits to round-trip.
+static void test_binary_to_json(void) {
+	static const struct {
+		byte_t bijson[20];
+		size_t size;
+		const char *json;
+	} tests[] = {
+		{{0x18}, 1, "0"},
+		{{0x19, 0x00}, 2, "-0"},
+		{{0x18, 0x2A}, 2, "42"},
+		{{0x19, 0x2A, 0x00, 0x00}, 4, "-42"},
+		{{0x18, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, 9, "18446744073709551615"},
+		{{0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01}, 10, "18446744073709551616"},
+		{{0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, 17,
+			"-340282366920938463463374607431768211455"},
+		{{0x18, 0x00, 0x00, 0x00, 0x00, 0x10, 0x9F, 0x4B, 0xB3, 0x15, 0x07, 0xC9, 0x7B, 0xCE, 0x97, 0xC0}, 16, "1000000000000000000000000000000000000"},
+		{{0x0A, 0x00, 0x3C}, 3, "1"},
+		{{0x0A, 0xCD, 0xCC, 0xCC, 0x3D}, 5, "0.1"},
+		{{0x0A, 0xEE, 0xE3, 0x6C, 0x80}, 5, "-1e-38"},
+		{{0x0A, 0x9A, 0x99, 0x99, 0x99, 0x99, 0x99, 0xB9, 0x3F}, 9, "0.1"},
+		{{0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80}, 9, "-0"},
+		{{0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x59, 0x40}, 9, "100"},
+		{{0x0A, 0x50, 0xEF, 0xE2, 0xD6, 0xE4, 0x1A, 0x4B, 0x44}, 9, "1e21"},
+		{{0x0A, 0x8D, 0xED, 0xB5, 0xA0, 0xF7, 0xC6, 0xB0, 0x3E}, 9, "0.000001"},
+		{{0x0A, 0x8D, 0xED, 0xB5, 0xA0, 0xF7, 0xC6, 0xB0, 0xBE}, 9, "-0.000001"},
+		{{0x0A, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0xD3, 0x3F}, 9, "0.3"},
+		{{0x0A, 0x34, 0x33, 0x33, 0x33, 0x33, 0x33, 0xD3, 0x3F}, 9, "0.30000000000000004"},
+		{{0x0A, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, 9, "5e-324"},
+		{{0x0A, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0x7F}, 9, "1.7976931348623157e308"},
+		{{0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0x7F}, 9, NULL},
+		{{0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x7F}, 9, NULL},
+	};
+
+	for(size_t u = 0; u < _BIJSON_ARRAY_COUNT(tests); u++) {
+		test_output_t output = {.len = 0};
+		bijson_t bijson = {tests[u].bijson, tests[u].size};
+		bijson_error_t error = tests[u].bijson[0] == BYTE_C(0x0A)
+			? _bijson_binary_float_to_json(&bijson, test_output_callback, &output)
+			: _bijson_binary_integer_to_json(&bijson, test_output_callback, &output);
+		const char *json = tests[u].json;
+		if(!json) {
+			if(error)
+				xprintf("ok %"PRIu64" - number %zu is rejected\n", test_index++, u);
+			else
+				xprintf("not ok %"PRIu64" - number %zu is not rejected\n", test_index++, u);
+		} else if(error) {
+			xprintf("not ok %"PRIu64" - number %zu returned %s\n", test_index++, u, error);
+		} else if(output.len != strlen(json) || memcmp(output.buffer, json, output.len)) {
+			xprintf("not ok %"PRIu64" - number %zu was converted to %.*s instead of %s\n", test_index++, u, (int)output.len, output.buffer, json);
+		} else {
+			xprintf("ok %"PRIu64" - number %zu was converted to %s\n", test_index++, u, json);
+		}
+	}
+}
+
+typedef struct test_buffered_output {
+	byte_t *buffer;
+	size_t len;
+	size_t calls;
+} test_buffered_output_t;
+
+static bijson_error_t test_buffered_output_callback(void *callback_data, const void *data, size_t len) {
+	test_buffered_output_t *output = callback_data;
+	memcpy(output->buffer + output->len, data, len);
+	output->len += len;
+	output->calls++;
+	return NULL;
+}
+
+static void test_index_estimate(void) {
+	static const uint64_t hashes[] = {
+		UINT64_C(0), UINT64_C(1), UINT64_C(0xFFFFFFFF), UINT64_C(0x100000000),
+		UINT64_C(0x8000000000000000), UINT64_C(0x9E3779B97F4A7C15), UINT64_MAX,
+	};
+	static const uint64_t counts[] = {
+		UINT64_C(1), UINT64_C(2), UINT64_C(1000), UINT64_C(0xFFFFFFFF),
+		UINT64_C(0x100000000), UINT64_C(0x100000001), UINT64_C(0x123456789ABCDEF),
+	};
+
+	for(size_t c = 0; c < _BIJSON_ARRAY_COUNT(counts); c++) {
+		if(counts[c] > (uint64_t)SIZE_MAX)
+			continue;
+		size_t count = (size_t)counts[c];
+		bool ok = true;
+		for(size_t h = 0; h < _BIJSON_ARRAY_COUNT(hashes); h++) {
+			size_t narrow = _bijson_index_estimate_narrow(hashes[h], count);
+			if(narrow >= count || narrow != _bijson_index_estimate(hashes[h], count)) {
+				xprintf("not ok %"PRIu64" - estimate for hash %016"PRIx64" among %zu entries is %zu\n", test_index++, hashes[h], count, narrow);
+				ok = false;
+			}
+		}
+		if(ok)
+			xprintf("ok %"PRIu64" - estimates among %zu entries are in range\n", test_index++, count);
+	}
+}
+
+#define TEST_BUFFERED_LARGE (_BIJSON_IO_BUFFERED_SIZE + SIZE_C(100))
+#define TEST_BUFFERED_TOTAL (SIZE_C(20000) * SIZE_C(7) + TEST_BUFFERED_LARGE)
+
+// Writes lots of small pieces with one piece larger than the buffer in the
+// middle, using the same output function as the emitters.
+static bijson_error_t test_buffered_action(
+	void *action_callback_data,
+	bijson_output_callback_t output_callback,
+	void *output_callback_data
+) {
+	const byte_t *source = action_callback_data;
+	size_t offset = 0;
+	for(size_t u = 0; u < SIZE_C(20000); u++) {
+		if(u == SIZE_C(10000)) {
+			_BIJSON_RETURN_ON_ERROR(_bijson_io_output(output_callback, output_callback_data, source + offset, TEST_BUFFERED_LARGE));
+			offset += TEST_BUFFERED_LARGE;
+		}
+		_BIJSON_RETURN_ON_ERROR(_bijson_io_output(output_callback, output_callback_data, source + offset, SIZE_C(7)));
+		offset += SIZE_C(7);
+	}
+	return NULL;
+}
+
+// Checks that buffered output arrives complete, in order and in few calls.
+static void test_io_write_buffered(void) {
+	byte_t *source = malloc(TEST_BUFFERED_TOTAL);
+	byte_t *buffer = malloc(TEST_BUFFERED_TOTAL);
+	if(!source || !buffer)
+		abort();
+	for(size_t u = 0; u < TEST_BUFFERED_TOTAL; u++)
+		source[u] = (byte_t)(u * SIZE_C(31) + (u >> 8U));
+
+	test_buffered_output_t output = {buffer, 0, 0};
+	bijson_error_t error = _bijson_io_write_buffered(test_buffered_action, source, test_buffered_output_callback, &output);
+	if(error)
+		xprintf("not ok %"PRIu64" - buffered output returned %s\n", test_index++, error);
+	else if(output.len != TEST_BUFFERED_TOTAL || memcmp(output.buffer, source, output.len))
+		xprintf("not ok %"PRIu64" - buffered output was garbled\n", test_index++);
+	else if(output.calls > SIZE_C(8))
+		xprintf("not ok %"PRIu64" - buffered output used %zu calls\n", test_index++, output.calls);
+	else
+		xprintf("ok %"PRIu64" - buffered output is correct\n", test_index++);
+
+	free(buffer);
+	free(source);
+}
+
 int main(void) {
 	test_check_valid_utf8();
 	test_uint64_str();
+	test_read_minimal_int();
+	test_fit_uint64();
+	test_decimal_get_int64();
+	test_decimal_get_integers();
+	test_decimal_get_double();
+	test_decimal_get_floating();
+	test_decimal_compare();
+	test_raw_string_to_json();
+	test_binary_to_json();
+	test_index_estimate();
+	test_io_write_buffered();
 
 	xprintf("1..%"PRIu64"\n", test_index);
 
@@ -31,6 +31,9 @@ extern const char bijson_error_bad_root[];
 extern const char bijson_error_out_of_virtual_memory[];
 extern const char bijson_error_type_mismatch[];
 extern const char bijson_error_duplicate_key[];
+extern const char bijson_error_invalid_pointer_syntax[];
+extern const char bijson_error_invalid_query_syntax[];
+extern const char bijson_error_index_mismatch[];
 
 typedef bijson_error_t (*bijson_output_callback_t)(
 	void *output_callback_data,
@@ -9,14 +9,31 @@
 
 typedef struct bijson_array_analysis {
 	// Opaque structure, do not access.
-	size_t v[6];
+	size_t v[8];
 } bijson_array_analysis_t;
 
 typedef struct bijson_object_analysis {
 	// Opaque structure, do not access.
-	size_t v[10];
+	size_t v[14];
 } bijson_object_analysis_t;
 
+typedef struct bijson_array_cursor {
+	// Opaque structure, do not access.
+	size_t v[10];
+} bijson_array_cursor_t;
+
+typedef struct bijson_object_cursor {
+	// Opaque structure, do not access.
+	size_t v[17];
+} bijson_object_cursor_t;
+
+typedef struct bijson_key {
+	// Fill in using bijson_key_prepare().
+	const void *key;
+	size_t len;
+	uint64_t hash;
+} bijson_key_t;
+
 typedef enum bijson_value_type {
 	// Basic bijson types
 	bijson_value_type_null,
@@ -46,11 +63,19 @@ extern bijson_error_t bijson_open_filename_at(bijson_t *bijson, int dir_fd, cons
 
 extern bijson_error_t bijson_get_value_type(const bijson_t *bijson, bijson_value_type_t *result);
 
+// Checks the entire document for structural validity. Documents that pass
+// can be accessed using the _nocheck variants, which skip validation.
+extern bijson_error_t bijson_verify(const bijson_t *bijson);
+
 
 extern bijson_error_t bijson_string_get(const bijson_t *bijson, const char **result, size_t *size_result);
 extern bijson_error_t bijson_string_get_nocheck(const bijson_t *bijson, const char **result, size_t *size_result);
 extern bijson_error_t bijson_string_get_malloc(const bijson_t *bijson, const char **result);
 
+// Integer getters are exact: numbers with a fractional part or that do not
+// fit the type return bijson_error_value_out_of_range. The unsigned variants
+// return the magnitude and store the sign in *negative_result; if that is
+// NULL, negative numbers other than -0 are out of range.
 extern bijson_error_t bijson_decimal_get_int8(const bijson_t *bijson, int8_t *result);
 extern bijson_error_t bijson_decimal_get_uint8(const bijson_t *bijson, uint8_t *result, bool *negative_result);
 extern bijson_error_t bijson_decimal_get_int16(const bijson_t *bijson, int16_t *result);
@@ -64,12 +89,19 @@ extern bijson_error_t bijson_decimal_get_int128(const bijson_t *bijson, __int128
 extern bijson_error_t bijson_decimal_get_uint128(const bijson_t *bijson, __uint128_t *result, bool *negative_result);
 #endif
 
+// Floating point getters are correctly rounded. Numbers too large for the
+// type return bijson_error_value_out_of_range; tiny ones become zero.
 extern bijson_error_t bijson_decimal_get_float(const bijson_t *bijson, float *result);
 extern bijson_error_t bijson_decimal_get_double(const bijson_t *bijson, double *result);
 #ifdef LDBL_DIG
 extern bijson_error_t bijson_decimal_get_long_double(const bijson_t *bijson, long double *result);
 #endif
 
+// Compares two numbers (decimals or decimal integers) by value, storing a
+// negative, zero or positive result if a is less than, equal to or greater
+// than b. Zero and negative zero are equal.
+extern bijson_error_t bijson_decimal_compare(const bijson_t *a, const bijson_t *b, int *result);
+
 extern bijson_error_t bijson_bytes_get(const bijson_t *bijson, const char **result, size_t *size_result);
 extern bijson_error_t bijson_integer_get(const bijson_t *bijson, const char **result, size_t *size_result, bool *negative_result);
 extern bijson_error_t bijson_iee754_2008_float_get(const bijson_t *bijson, const char **result, size_t *size_result);
@@ -96,6 +128,184 @@ extern bijson_error_t bijson_analyzed_array_count(
 	size_t *result
 );
 
+// Cursors visit all items in order. This is cheaper than calling
+// bijson_analyzed_array_get_index() for each index because every offset
+// is read only once. bijson_array_cursor_next() returns
+// bijson_error_index_out_of_range once all items have been visited.
+extern bijson_error_t bijson_array_cursor_init(
+	bijson_array_cursor_t *cursor,
+	const bijson_t *bijson
+);
+extern bijson_error_t bijson_analyzed_array_cursor_init(
+	bijson_array_cursor_t *cursor,
+	const bijson_array_analysis_t *analysis
+);
+extern bijson_error_t bijson_array_cursor_next(
+	bijson_array_cursor_t *cursor,
+	bijson_t *result
+);
+
+// Projection extracts the value of one key from every object in an array
+// into a plain C array, for column-oriented processing. The result buffer
+// must have room for at least as many items as the array has (capacity is
+// counted in items, not bytes):
+//	bijson_projection_type_int64: int64_t
+//	bijson_projection_type_double: double
+//	bijson_projection_type_string: bijson_string_view_t
+// Bit (u % 8) of present[u / 8] is set if item u is an object that contains
+// the key and its value could be converted to the requested type; if not,
+// the value is zeroed. Decimals, binary integers and IEEE floats are all
+// converted. Numbers that do not fit in an int64_t (or have a fractional
+// part) are treated as missing, as are IEEE NaN and infinities. String
+// views point into the bijson buffer and are validated UTF-8.
+// With threads > 1 the array is split into that many ranges that are
+// processed concurrently.
+typedef enum bijson_projection_type {
+	bijson_projection_type_int64,
+	bijson_projection_type_double,
+	bijson_projection_type_string,
+} bijson_projection_type_t;
+
+typedef struct bijson_string_view {
+	const char *buffer;
+	size_t size;
+} bijson_string_view_t;
+
+extern bijson_error_t bijson_array_project(
+	const bijson_t *bijson,
+	const bijson_key_t *key,
+	bijson_projection_type_t type,
+	void *result,
+	uint8_t *present,
+	size_t capacity,
+	size_t threads
+);
+extern bijson_error_t bijson_analyzed_array_project(
+	const bijson_array_analysis_t *analysis,
+	const bijson_key_t *key,
+	bijson_projection_type_t type,
+	void *result,
+	uint8_t *present,
+	size_t capacity,
+	size_t threads
+);
+
+// Predicates select the objects in an array that satisfy all of a set of
+// conditions on their fields, such as .status == "active" and .score > 10.
+// Field names are hashed once when the condition is added. Items that are
+// not objects or lack the field never satisfy a condition; values of another
+// type than the one compared against only satisfy ne. Numbers are compared
+// exactly, taking the double as the shortest decimal that converts back to
+// it (so 0.1 matches a stored 0.1). Strings are compared bytewise.
+// Conditions are checked in the order they were added, so add the most
+// selective ones first.
+typedef struct bijson_predicate bijson_predicate_t;
+
+typedef enum bijson_predicate_operator {
+	bijson_predicate_operator_eq,
+	bijson_predicate_operator_ne,
+	bijson_predicate_operator_lt,
+	bijson_predicate_operator_le,
+	bijson_predicate_operator_gt,
+	bijson_predicate_operator_ge,
+} bijson_predicate_operator_t;
+
+extern bijson_error_t bijson_predicate_alloc(bijson_predicate_t **result);
+extern void bijson_predicate_free(bijson_predicate_t *predicate);
+// The field is present (with any value).
+extern bijson_error_t bijson_predicate_add_exists(
+	bijson_predicate_t *predicate,
+	const void *field,
+	size_t field_len
+);
+// The field has a value of the given type.
+extern bijson_error_t bijson_predicate_add_type(
+	bijson_predicate_t *predicate,
+	const void *field,
+	size_t field_len,
+	bijson_value_type_t type
+);
+extern bijson_error_t bijson_predicate_add_number(
+	bijson_predicate_t *predicate,
+	const void *field,
+	size_t field_len,
+	bijson_predicate_operator_t op,
+	double number
+);
+extern bijson_error_t bijson_predicate_add_string(
+	bijson_predicate_t *predicate,
+	const void *field,
+	size_t field_len,
+	bijson_predicate_operator_t op,
+	const void *string,
+	size_t string_len
+);
+
+// Evaluates the predicate for each item of an array. Bit (u % 8) of
+// matches[u / 8] is set if item u matches; capacity is the size of the
+// bitmap in items. The number of matches is stored in count_result (if not
+// NULL). With threads > 1 the threads take turns claiming blocks of items,
+// so that uneven item sizes do not leave threads idle.
+extern bijson_error_t bijson_array_scan(
+	const bijson_t *bijson,
+	const bijson_predicate_t *predicate,
+	uint8_t *matches,
+	size_t capacity,
+	size_t threads,
+	size_t *count_result
+);
+extern bijson_error_t bijson_analyzed_array_scan(
+	const bijson_array_analysis_t *analysis,
+	const bijson_predicate_t *predicate,
+	uint8_t *matches,
+	size_t capacity,
+	size_t threads,
+	size_t *count_result
+);
+// Like bijson_array_scan(), but produces a list of the indices of the
+// matching items in ascending order. Free it using free().
+extern bijson_error_t bijson_array_scan_indices(
+	const bijson_t *bijson,
+	const bijson_predicate_t *predicate,
+	size_t threads,
+	size_t **result,
+	size_t *count_result
+);
+extern bijson_error_t bijson_analyzed_array_scan_indices(
+	const bijson_array_analysis_t *analysis,
+	const bijson_predicate_t *predicate,
+	size_t threads,
+	size_t **result,
+	size_t *count_result
+);
+
+#ifdef __SIZEOF_INT128__
+// Summary statistics of the numbers in an array. Items that are not numbers
+// are counted in skipped but otherwise ignored. If sum_exact is true, the sum
+// is exactly sum * 10^sum_exponent; this holds unless the sum needs more
+// than 128 bits or a number has more than 19 significant digits. sum_double
+// is always filled in, correctly rounded if sum_exact is true. min and max
+// refer to items with the lowest and highest values (any of them, if there
+// are several), compared exactly, and have a NULL buffer if the array
+// contains no numbers.
+typedef struct bijson_aggregate {
+	size_t count;
+	size_t skipped;
+	__int128_t sum;
+	int64_t sum_exponent;
+	bool sum_exact;
+	double sum_double;
+	bijson_t min;
+	bijson_t max;
+} bijson_aggregate_t;
+
+extern bijson_error_t bijson_array_aggregate(const bijson_t *bijson, bijson_aggregate_t *result);
+extern bijson_error_t bijson_analyzed_array_aggregate(
+	const bijson_array_analysis_t *analysis,
+	bijson_aggregate_t *result
+);
+#endif
+
 extern bijson_error_t bijson_object_count(const bijson_t *bijson, size_t *result);
 extern bijson_error_t bijson_object_get_index(
 	const bijson_t *bijson,
@@ -108,6 +318,10 @@ extern bijson_error_t bijson_object_analyze(
 	const bijson_t *bijson,
 	bijson_object_analysis_t *result
 );
+extern bijson_error_t bijson_object_analyze_nocheck(
+	const bijson_t *bijson,
+	bijson_object_analysis_t *result
+);
 extern bijson_error_t bijson_analyzed_object_get_index(
 	const bijson_object_analysis_t *analysis,
 	size_t index,
@@ -115,6 +329,24 @@ extern bijson_error_t bijson_analyzed_object_get_index(
 	size_t *key_size_result,
 	bijson_t *value_result
 );
+
+// Like the array cursors, but for objects. Keys are validated only once.
+// Cursors initialized from an analysis made with
+// bijson_object_analyze_nocheck() skip key validation entirely.
+extern bijson_error_t bijson_object_cursor_init(
+	bijson_object_cursor_t *cursor,
+	const bijson_t *bijson
+);
+extern bijson_error_t bijson_analyzed_object_cursor_init(
+	bijson_object_cursor_t *cursor,
+	const bijson_object_analysis_t *analysis
+);
+extern bijson_error_t bijson_object_cursor_next(
+	bijson_object_cursor_t *cursor,
+	const void **key_buffer_result,
+	size_t *key_size_result,
+	bijson_t *value_result
+);
 extern bijson_error_t bijson_analyzed_object_get_key(
 	const bijson_object_analysis_t *analysis,
 	const char *key,
@@ -142,16 +374,154 @@ extern bijson_error_t bijson_object_get_key_range(
 	size_t *end_index
 );
 
+extern bijson_error_t bijson_key_prepare(bijson_key_t *result, const void *key, size_t len);
+extern bijson_error_t bijson_analyzed_object_get_prepared_key(
+	const bijson_object_analysis_t *analysis,
+	const bijson_key_t *key,
+	bijson_t *result
+);
+extern bijson_error_t bijson_object_get_prepared_key(
+	const bijson_t *bijson,
+	const bijson_key_t *key,
+	bijson_t *result
+);
+// Looks up multiple keys at once. Keys that are not found result in an
+// entry with a NULL buffer.
+extern bijson_error_t bijson_analyzed_object_get_keys(
+	const bijson_object_analysis_t *analysis,
+	const bijson_key_t *keys,
+	size_t count,
+	bijson_t *results
+);
+extern bijson_error_t bijson_object_get_keys(
+	const bijson_t *bijson,
+	const bijson_key_t *keys,
+	size_t count,
+	bijson_t *results
+);
+extern bijson_error_t bijson_analyzed_object_get_prepared_key_range(
+	const bijson_object_analysis_t *analysis,
+	const bijson_key_t *key,
+	size_t *start_index,
+	size_t *end_index
+);
+extern bijson_error_t bijson_object_get_prepared_key_range(
+	const bijson_t *bijson,
+	const bijson_key_t *key,
+	size_t *start_index,
+	size_t *end_index
+);
+
 extern bijson_error_t bijson_analyzed_object_count(
 	const bijson_object_analysis_t *analysis,
 	size_t *result
 );
 
+// Membership filters for the keys of an object, kept alongside the data.
+// Checking a key that is not in the object costs a single memory access in
+// most cases (well under 1% false positives), which makes them worthwhile for
+// large objects where many lookups are for absent keys.
+// bijson_object_filter_check() stores false if the key is definitely not
+// present.
+typedef struct bijson_object_filter bijson_object_filter_t;
+
+extern bijson_error_t bijson_object_filter_build(bijson_object_filter_t **result, const bijson_t *bijson);
+extern bijson_error_t bijson_analyzed_object_filter_build(
+	bijson_object_filter_t **result,
+	const bijson_object_analysis_t *analysis
+);
+extern bijson_error_t bijson_object_filter_check(
+	const bijson_object_filter_t *filter,
+	const bijson_key_t *key,
+	bool *result
+);
+// Like bijson_analyzed_object_get_prepared_key(), but consults the filter
+// (which must have been built for the same object) first.
+extern bijson_error_t bijson_analyzed_object_get_filtered_key(
+	const bijson_object_analysis_t *analysis,
+	const bijson_object_filter_t *filter,
+	const bijson_key_t *key,
+	bijson_t *result
+);
+extern void bijson_object_filter_free(bijson_object_filter_t *filter);
+
+// Sorted views list the entries of an object in byte-lexical key order
+// (objects themselves are stored in hash order). Positions run from 0 to
+// bijson_object_sorted_view_count() and can be iterated in order with
+// bijson_object_sorted_view_get(), whose result pointers may be NULL.
+// bijson_object_sorted_view_lower_bound() returns the first position with a
+// key that does not sort before the given one; prefix ranges are returned
+// as [start, end) positions. The view refers to the object's buffer, which
+// must remain available.
+typedef struct bijson_object_sorted_view bijson_object_sorted_view_t;
+
+extern bijson_error_t bijson_object_sorted_view_build(bijson_object_sorted_view_t **result, const bijson_t *bijson);
+extern bijson_error_t bijson_analyzed_object_sorted_view_build(
+	bijson_object_sorted_view_t **result,
+	const bijson_object_analysis_t *analysis
+);
+extern size_t bijson_object_sorted_view_count(const bijson_object_sorted_view_t *view) __attribute__((pure));
+extern bijson_error_t bijson_object_sorted_view_get(
+	const bijson_object_sorted_view_t *view,
+	size_t position,
+	size_t *index_result,
+	const void **key_buffer_result,
+	size_t *key_size_result,
+	bijson_t *value_result
+);
+extern bijson_error_t bijson_object_sorted_view_lower_bound(
+	const bijson_object_sorted_view_t *view,
+	const void *key,
+	size_t len,
+	size_t *result
+);
+extern bijson_error_t bijson_object_sorted_view_prefix_range(
+	const bijson_object_sorted_view_t *view,
+	const void *prefix,
+	size_t len,
+	size_t *start_result,
+	size_t *end_result
+);
+extern void bijson_object_sorted_view_free(bijson_object_sorted_view_t *view);
+
+// Visits a complete value in document order without recursion: containers
+// are reported using begin/end callbacks (with their item count), object
+// entries using the key callback followed by the value, and everything else
+// using the scalar callback. Callbacks may be NULL. The walk stops at the
+// first callback that returns an error, which is then returned.
+typedef struct bijson_walk_callbacks {
+	bijson_error_t (*begin_array)(void *callback_data, size_t count);
+	bijson_error_t (*end_array)(void *callback_data);
+	bijson_error_t (*begin_object)(void *callback_data, size_t count);
+	bijson_error_t (*end_object)(void *callback_data);
+	bijson_error_t (*key)(void *callback_data, const char *key, size_t len);
+	bijson_error_t (*scalar)(void *callback_data, const bijson_t *value);
+} bijson_walk_callbacks_t;
+
+extern bijson_error_t bijson_walk(const bijson_t *bijson, const bijson_walk_callbacks_t *callbacks, void *callback_data);
+extern bijson_error_t bijson_walk_nocheck(const bijson_t *bijson, const bijson_walk_callbacks_t *callbacks, void *callback_data);
+
+// Structural equality: containers are equal if their contents are, numbers
+// (decimals and binary integers alike) if they have the same sign and value.
+// Documents produced by the writer are canonical, in which case this mostly
+// amounts to comparing the bytes. bijson_content_hash() is equal for equal
+// values, also if they were written with different hashed object thresholds
+// or encode their numbers differently.
+extern bijson_error_t bijson_equal(const bijson_t *a, const bijson_t *b, bool *result);
+extern bijson_error_t bijson_content_hash(const bijson_t *bijson, uint64_t *result);
+
 extern bijson_error_t bijson_to_json(
 	const bijson_t *bijson,
 	bijson_output_callback_t callback,
 	void *callback_data
 );
+// Like bijson_to_json(), but the output is collected in a large buffer and
+// passed to the callback in big chunks instead of token by token.
+extern bijson_error_t bijson_to_json_buffered(
+	const bijson_t *bijson,
+	bijson_output_callback_t callback,
+	void *callback_data
+);
 extern bijson_error_t bijson_to_json_FILE(const bijson_t *bijson, FILE *file);
 extern bijson_error_t bijson_to_json_fd(const bijson_t *bijson, int fd);
 extern bijson_error_t bijson_to_json_malloc(
@@ -171,5 +541,179 @@ extern bijson_error_t bijson_to_json_bytecounter(
 extern bijson_error_t bijson_to_json_filename(const bijson_t *bijson, const char *filename);
 extern bijson_error_t bijson_to_json_filename_at(const bijson_t *bijson, int dir_fd, const char *filename);
 
+// Renders large arrays and objects using the given number of threads. Their
+// entries are divided into blocks that are rendered concurrently into
+// separate buffers, which are then output in order, so the result is the
+// same as that of bijson_to_json().
+extern bijson_error_t bijson_to_json_parallel(
+	const bijson_t *bijson,
+	size_t threads,
+	bijson_output_callback_t callback,
+	void *callback_data
+);
+extern bijson_error_t bijson_to_json_parallel_filename(const bijson_t *bijson, size_t threads, const char *filename);
+
+// Resumable JSON output for event loops and other callers that cannot block
+// in an output callback. Each call to bijson_encoder_step() fills the given
+// buffer with up to size bytes of output, stores the number of bytes in
+// *len_result and sets *pending_result to whether there is more to come.
+// The encoder keeps its own state (no recursion, no threads) and refers to
+// the buffer of the value, which must remain available. Output may already
+// have been produced when an error is found; after an error, every further
+// step returns the same error.
+typedef struct bijson_encoder bijson_encoder_t;
+
+extern bijson_error_t bijson_encoder_new(bijson_encoder_t **result, const bijson_t *bijson);
+extern bijson_error_t bijson_encoder_new_nocheck(bijson_encoder_t **result, const bijson_t *bijson);
+extern bijson_error_t bijson_encoder_step(
+	bijson_encoder_t *encoder,
+	void *buffer,
+	size_t size,
+	size_t *len_result,
+	bool *pending_result
+);
+extern void bijson_encoder_free(bijson_encoder_t *encoder);
+
+// Caches of rendered JSON for values that are output repeatedly, limited to
+// max_bytes (including some overhead per entry), evicting the least recently
+// used entries first. Values are identified by their address and size, so
+// only values in buffers that do not change can be cached. Small values are
+// never cached. Caches can be used from several threads at once.
+// Once installed, a cache is used by bijson_to_json_malloc(),
+// bijson_to_json_fd() and the other functions that render a value to a
+// buffer, file or file descriptor. bijson_close() and bijson_free() drop
+// the entries for their buffer from the installed cache; for buffers
+// managed otherwise, call bijson_render_cache_invalidate() before they are
+// freed or modified. A cache must not be freed while installed or in use.
+typedef struct bijson_render_cache bijson_render_cache_t;
+
+typedef struct bijson_render_cache_stats {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+	size_t entries;
+	size_t bytes;
+} bijson_render_cache_stats_t;
+
+extern bijson_error_t bijson_render_cache_alloc(bijson_render_cache_t **result, size_t max_bytes);
+extern bijson_error_t bijson_render_cache_to_json(
+	bijson_render_cache_t *cache,
+	const bijson_t *bijson,
+	bijson_output_callback_t callback,
+	void *callback_data
+);
+// Pass NULL to stop using a cache
+extern void bijson_render_cache_install(bijson_render_cache_t *cache);
+// Drops the entries for all values inside the given buffer
+extern void bijson_render_cache_invalidate(bijson_render_cache_t *cache, const bijson_t *bijson);
+extern void bijson_render_cache_clear(bijson_render_cache_t *cache);
+extern void bijson_render_cache_get_stats(bijson_render_cache_t *cache, bijson_render_cache_stats_t *result);
+extern void bijson_render_cache_free(bijson_render_cache_t *cache);
+
+extern bijson_error_t bijson_to_json_nocheck(
+	const bijson_t *bijson,
+	bijson_output_callback_t callback,
+	void *callback_data
+);
+extern bijson_error_t bijson_to_json_nocheck_buffered(
+	const bijson_t *bijson,
+	bijson_output_callback_t callback,
+	void *callback_data
+);
+extern bijson_error_t bijson_to_json_nocheck_FILE(const bijson_t *bijson, FILE *file);
+extern bijson_error_t bijson_to_json_nocheck_fd(const bijson_t *bijson, int fd);
+extern bijson_error_t bijson_to_json_nocheck_malloc(
+	const bijson_t *bijson,
+	const void **result_buffer,
+	size_t *result_size
+);
+extern bijson_error_t bijson_to_json_nocheck_filename(const bijson_t *bijson, const char *filename);
+
+// Compiled RFC 6901 JSON pointers. Compiling parses and hashes all segments
+// once, so that resolving the pointer only needs a single lookup per level.
+// The pointer string does not need to remain valid after compiling.
+typedef struct bijson_pointer bijson_pointer_t;
+
+extern bijson_error_t bijson_pointer_compile(bijson_pointer_t **result, const char *pointer, size_t len);
+extern bijson_error_t bijson_pointer_resolve(
+	const bijson_pointer_t *pointer,
+	const bijson_t *bijson,
+	bijson_t *result
+);
+extern void bijson_pointer_free(bijson_pointer_t *pointer);
+
+// JSONPath-like queries. Supported syntax:
+//   $                 the root value (must come first)
+//   .name ['name']    object member
+//   .* [*]            all object values or array items
+//   ..selector        apply the selector to the value and all descendants
+//   [n]               array item, negative n counts from the end
+//   [start:end:step]  array slice (step must be positive)
+//   [?(@.a.b op lit)] array items/object values where the given field
+//                     compares to a number, 'string', true, false or null
+//                     using ==, !=, <, <=, > or >=. Without op and lit,
+//                     checks whether the field exists. Numbers are
+//                     compared exactly, whatever their size or precision.
+// Results are reported through the callback in document order.
+typedef struct bijson_query bijson_query_t;
+typedef bijson_error_t (*bijson_query_callback_t)(void *callback_data, const bijson_t *result);
+
+extern bijson_error_t bijson_query_compile(bijson_query_t **result, const char *query, size_t len);
+extern bijson_error_t bijson_query_run(
+	const bijson_query_t *query,
+	const bijson_t *bijson,
+	bijson_query_callback_t callback,
+	void *callback_data
+);
+// Like bijson_query_run(), but large arrays are split across the given
+// number of threads. The callback is still invoked from the calling thread,
+// in document order, after each such array has been processed.
+extern bijson_error_t bijson_query_run_parallel(
+	const bijson_query_t *query,
+	const bijson_t *bijson,
+	size_t threads,
+	bijson_query_callback_t callback,
+	void *callback_data
+);
+extern void bijson_query_free(bijson_query_t *query);
+
+// Sidecar equality indexes. bijson_index_build() looks up the value at the
+// given JSON pointer (relative to each item) in every item of an array and
+// writes a file that maps a hash of each value to the indices of the items
+// containing it. Items without that value are not indexed.
+// bijson_index_open() maps such a file for use with the document it was
+// built from, which must remain open while the index is in use. It hashes
+// the whole document and returns bijson_error_index_mismatch if it is not
+// the one the index was built from.
+// bijson_index_lookup() calls the callback for each item whose value equals
+// the given one; candidates are verified against the document, so hash
+// collisions never produce false matches. Values are compared by their
+// encoding, so numbers to look up should be created using the writer.
+typedef struct bijson_index bijson_index_t;
+typedef bijson_error_t (*bijson_index_callback_t)(void *callback_data, size_t index, const bijson_t *item);
+
+extern bijson_error_t bijson_index_build(
+	const bijson_t *bijson,
+	const char *pointer,
+	size_t pointer_len,
+	const char *filename
+);
+extern bijson_error_t bijson_index_open(bijson_index_t **result, const bijson_t *bijson, const char *filename);
+extern bijson_error_t bijson_index_lookup(
+	const bijson_index_t *index,
+	const bijson_t *value,
+	bijson_index_callback_t callback,
+	void *callback_data
+);
+// Convenience function for looking up string values.
+extern bijson_error_t bijson_index_lookup_string(
+	const bijson_index_t *index,
+	const void *string,
+	size_t len,
+	bijson_index_callback_t callback,
+	void *callback_data
+);
+extern void bijson_index_close(bijson_index_t *index);
+
 extern void bijson_free(bijson_t *bijson);
 extern void bijson_close(bijson_t *bijson);
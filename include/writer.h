@@ -11,6 +11,11 @@ typedef struct bijson_writer bijson_writer_t;
 extern void bijson_writer_free(bijson_writer_t *writer);
 extern bijson_error_t bijson_writer_alloc(bijson_writer_t **result);
 
+// Objects with at least this many items are written with a table of key
+// hashes, which speeds up lookups. 0 (the default) disables this.
+// Does nothing if writer is NULL.
+extern void bijson_writer_set_hashed_object_threshold(bijson_writer_t *writer, size_t threshold);
+
 extern bool bijson_writer_expects_value(const bijson_writer_t *writer)  __attribute__((pure));
 extern bool bijson_writer_expects_key(const bijson_writer_t *writer) __attribute__((pure));
 
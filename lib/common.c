@@ -1,5 +1,6 @@
 #include <stdbool.h>
 #include <inttypes.h>
+#include <string.h>
 
 #include "common.h"
 
@@ -112,37 +113,68 @@ inline uint64_t _bijson_uint64_pow10(unsigned int exp) {
 #endif
 }
 
-__attribute__((hot))
-static inline size_t _bijson_uint64_str_impl(byte_t *dst, uint64_t value, bool pad) {
-	byte_t *s = dst;
-#ifdef __GNUC__
-#pragma GCC unroll 20
+// Two digits per step, using a table of all pairs, so that only half as
+// many divisions are needed. Divisions by a constant are compiled into
+// multiplications, and are done in 32 bits once the value fits.
+static const char _bijson_uint64_digit_pairs[200] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+// Number of decimal digits in value, which must not be zero
+__attribute__((const))
+static inline size_t _bijson_uint64_digits(uint64_t value) {
+	assert(value);
+#ifdef HAVE_BUILTIN_CLZLL
+	// 1233 / 4096 approximates log10(2), so this is either the number of
+	// digits or one less than that.
+	unsigned int guess = ((64U - (unsigned int)__builtin_clzll(value)) * 1233U) >> 12U;
+	return (size_t)guess + (value >= _bijson_uint64_pow10(guess));
+#else
+	size_t digits = SIZE_C(1);
+	while(digits < SIZE_C(20) && value >= _bijson_uint64_pow10((unsigned int)digits))
+		digits++;
+	return digits;
 #endif
-	for(unsigned int exp = 19U; exp < 20U; exp--) {
-		uint64_t magnitude = _bijson_uint64_pow10(exp);
-		uint64_t digit = value / magnitude;
-		value -= digit * magnitude;
-		if(digit)
-			pad = true;
-		if(pad)
-			*s++ = (byte_t)('0' + digit);
+}
+
+// Writes value right aligned in len bytes, padded with zeros on the left.
+__attribute__((hot))
+static inline size_t _bijson_uint64_str_impl(byte_t *dst, uint64_t value, size_t len) {
+	byte_t *s = dst + len;
+	while(value > UINT64_C(0xFFFFFFFF)) {
+		uint64_t quotient = value / UINT64_C(100);
+		s -= 2;
+		memcpy(s, _bijson_uint64_digit_pairs + (value - quotient * UINT64_C(100)) * SIZE_C(2), SIZE_C(2));
+		value = quotient;
+	}
+	uint32_compute_t small = (uint32_compute_t)value;
+	while(small >= UINT32_C(100)) {
+		uint32_compute_t quotient = small / UINT32_C(100);
+		s -= 2;
+		memcpy(s, _bijson_uint64_digit_pairs + (small - quotient * UINT32_C(100)) * SIZE_C(2), SIZE_C(2));
+		small = quotient;
 	}
-	return _bijson_ptrdiff(s, dst);
+	if(small >= UINT32_C(10)) {
+		s -= 2;
+		memcpy(s, _bijson_uint64_digit_pairs + small * SIZE_C(2), SIZE_C(2));
+	} else if(small) {
+		*--s = (byte_t)('0' + small);
+	}
+	memset(dst, '0', _bijson_ptrdiff(s, dst));
+	return len;
 }
 
 size_t _bijson_uint64_str(byte_t *dst, uint64_t value) {
-	if(value) {
-		return _bijson_uint64_str_impl(dst, value, false);
-	} else {
-		*dst = '0';
-		return SIZE_C(1);
-	}
+	return _bijson_uint64_str_impl(dst, value, value ? _bijson_uint64_digits(value) : SIZE_C(1));
 }
 
 size_t _bijson_uint64_str_padded(byte_t *dst, uint64_t value) {
-	return _bijson_uint64_str_impl(dst, value, true);
+	return _bijson_uint64_str_impl(dst, value, SIZE_C(20));
 }
 
 size_t _bijson_uint64_str_raw(byte_t *dst, uint64_t value) {
-	return _bijson_uint64_str_impl(dst, value, false);
+	return _bijson_uint64_str_impl(dst, value, value ? _bijson_uint64_digits(value) : SIZE_C(0));
 }
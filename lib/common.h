@@ -45,6 +45,12 @@ typedef unsigned int uint16_compute_t;
 typedef unsigned int uint32_compute_t;
 #endif
 
+#ifdef __SIZEOF_INT128__
+// __extension__ keeps -Wpedantic quiet about the non-ISO type
+__extension__ typedef unsigned __int128 uint128_t;
+__extension__ typedef __int128 int128_t;
+#endif
+
 #ifndef OFF_MAX
 #define OFF_MAX ((((off_t)1 << (sizeof (off_t) * CHAR_BIT - 2)) - (off_t)1) * (off_t)2 + (off_t)1)
 #endif
@@ -115,6 +121,24 @@ static inline size_t _bijson_ptrdiff(const void *end, const void *start) {
 	return (size_t)(end_bytes - start_bytes);
 }
 
+// Full 64x64 bit multiplication; returns the low half of the product.
+static inline uint64_t _bijson_umul128(uint64_t a, uint64_t b, uint64_t *high) {
+#ifdef __SIZEOF_INT128__
+	uint128_t product = (uint128_t)a * (uint128_t)b;
+	*high = (uint64_t)(product >> 64U);
+	return (uint64_t)product;
+#else
+	uint64_t a_low = a & UINT64_C(0xFFFFFFFF), a_high = a >> 32U;
+	uint64_t b_low = b & UINT64_C(0xFFFFFFFF), b_high = b >> 32U;
+	uint64_t low_low = a_low * b_low;
+	uint64_t high_low = a_high * b_low;
+	uint64_t low_high = a_low * b_high;
+	uint64_t middle = (low_low >> 32U) + (high_low & UINT64_C(0xFFFFFFFF)) + low_high;
+	*high = a_high * b_high + (high_low >> 32U) + (middle >> 32U);
+	return (middle << 32U) | (low_low & UINT64_C(0xFFFFFFFF));
+#endif
+}
+
  __attribute__((const))
 static inline size_t _bijson_2log64(uint64_t x) {
 	assert(x > UINT64_C(1));
@@ -20,3 +20,6 @@ const char bijson_error_unmatched_end[] = "unexpected end command";
 const char bijson_error_bad_root[] = "there must be one single root element";
 const char bijson_error_out_of_virtual_memory[] = "out of virtual memory";
 const char bijson_error_type_mismatch[] = "wrong type for operation";
+const char bijson_error_invalid_pointer_syntax[] = "invalid JSON pointer syntax";
+const char bijson_error_invalid_query_syntax[] = "invalid query syntax";
+const char bijson_error_index_mismatch[] = "index does not belong to this document";
@@ -27,6 +27,50 @@ bijson_error_t _bijson_io_write_nul_bytes(bijson_output_callback_t write, void *
 	return NULL;
 }
 
+bijson_error_t _bijson_io_buffered_output_callback(void *write_data, const void *data, size_t len) {
+	_bijson_io_buffered_t *buffered = write_data;
+	size_t fill = buffered->fill;
+	if(len <= sizeof buffered->buffer - fill) {
+		buffered->fill = fill + len;
+		memcpy(buffered->buffer + fill, data, len);
+		return NULL;
+	}
+	if(fill) {
+		_BIJSON_RETURN_ON_ERROR(buffered->callback(buffered->callback_data, buffered->buffer, fill));
+		buffered->fill = 0;
+	}
+	// Large writes bypass the buffer
+	if(len >= sizeof buffered->buffer)
+		return buffered->callback(buffered->callback_data, data, len);
+	memcpy(buffered->buffer, data, len);
+	buffered->fill = len;
+	return NULL;
+}
+
+bijson_error_t _bijson_io_write_buffered(
+	_bijson_output_action_callback_t action_callback,
+	void *action_callback_data,
+	bijson_output_callback_t output_callback,
+	void *output_callback_data
+) {
+	if(!output_callback)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	_bijson_io_buffered_t *buffered = malloc(sizeof *buffered);
+	if(!buffered)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	buffered->callback = output_callback;
+	buffered->callback_data = output_callback_data;
+	buffered->fill = 0;
+
+	bijson_error_t error = action_callback(action_callback_data, _bijson_io_buffered_output_callback, buffered);
+	if(!error && buffered->fill)
+		error = output_callback(output_callback_data, buffered->buffer, buffered->fill);
+
+	free(buffered);
+	return error;
+}
+
 // Must be a power of two.
 #define _BIJSON_WRITE_TO_FD_MAX_BUFFER SIZE_C(1048576)
 
@@ -204,7 +248,8 @@ bijson_error_t _bijson_io_write_to_FILE(
 
 	_bijson_buffer_write_to_FILE_state_t state = {.file = file};
 
-	bijson_error_t error = action_callback(
+	bijson_error_t error = _bijson_io_write_buffered(
+		action_callback,
 		action_callback_data,
 		_bijson_io_write_to_FILE_output_callback,
 		&state
@@ -2,10 +2,13 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "../include/common.h"
 #include "../include/reader.h"
 
+#include "common.h"
+
 typedef bijson_error_t (*_bijson_output_action_callback_t)(
 	void *action_callback_data,
 	bijson_output_callback_t output_callback,
@@ -25,6 +28,53 @@ extern bijson_error_t _bijson_io_bytecounter_output_callback(
 	size_t len
 );
 
+// Write-combining layer: output is collected in a buffer of this size and
+// passed on to the underlying callback in large chunks.
+#define _BIJSON_IO_BUFFERED_SIZE SIZE_C(65536)
+
+typedef struct _bijson_io_buffered {
+	bijson_output_callback_t callback;
+	void *callback_data;
+	size_t fill;
+	byte_t buffer[_BIJSON_IO_BUFFERED_SIZE];
+} _bijson_io_buffered_t;
+
+extern bijson_error_t _bijson_io_buffered_output_callback(
+	void *output_callback_data,
+	const void *data,
+	size_t len
+);
+
+extern bijson_error_t _bijson_io_write_buffered(
+	_bijson_output_action_callback_t action_callback,
+	void *action_callback_data,
+	bijson_output_callback_t output_callback,
+	void *output_callback_data
+);
+
+// Emitters use this instead of calling the output callback directly, so
+// that small writes to a buffered output are a memcpy() instead of an
+// indirect call.
+static inline bijson_error_t _bijson_io_output(
+	bijson_output_callback_t callback,
+	void *callback_data,
+	const void *data,
+	size_t len
+) {
+	if(callback == _bijson_io_buffered_output_callback) {
+		_bijson_io_buffered_t *buffered = callback_data;
+		size_t fill = buffered->fill;
+		// Checking len first lets the compiler drop this branch for large
+		// constant lengths.
+		if(len <= sizeof buffered->buffer && fill <= sizeof buffered->buffer - len) {
+			buffered->fill = fill + len;
+			memcpy(buffered->buffer + fill, data, len);
+			return NULL;
+		}
+	}
+	return callback(callback_data, data, len);
+}
+
 extern bijson_error_t _bijson_io_write_to_fd(
 	_bijson_output_action_callback_t action_callback,
 	void *action_callback_data,
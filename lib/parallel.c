@@ -0,0 +1,177 @@
+#include <pthread.h>
+
+#include "../include/common.h"
+
+#include "common.h"
+#include "parallel.h"
+
+typedef struct _bijson_parallel_chunk {
+	_bijson_parallel_worker_t worker;
+	void *worker_data;
+	size_t chunk;
+	size_t start;
+	size_t end;
+	bijson_error_t error;
+	pthread_t thread;
+	bool started;
+} _bijson_parallel_chunk_t;
+
+static void *_bijson_parallel_thread(void *arg) {
+	_bijson_parallel_chunk_t *chunk = arg;
+	chunk->error = chunk->worker(chunk->worker_data, chunk->chunk, chunk->start, chunk->end);
+	return NULL;
+}
+
+bijson_error_t _bijson_parallel_run(
+	size_t count,
+	size_t chunks,
+	_bijson_parallel_worker_t worker,
+	void *worker_data
+) {
+	if(chunks > count)
+		chunks = count;
+	if(chunks <= SIZE_C(1))
+		return count ? worker(worker_data, SIZE_C(0), SIZE_C(0), count) : NULL;
+
+	if(chunks > SIZE_MAX / sizeof(_bijson_parallel_chunk_t))
+		_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+	_bijson_parallel_chunk_t *state = malloc(chunks * sizeof *state);
+	if(!state)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+
+	size_t chunk_size = count / chunks;
+	size_t remainder = count % chunks;
+	size_t start = 0;
+	for(size_t u = 0; u < chunks; u++) {
+		size_t end = start + chunk_size + (u < remainder);
+		state[u] = (_bijson_parallel_chunk_t){
+			.worker = worker,
+			.worker_data = worker_data,
+			.chunk = u,
+			.start = start,
+			.end = end,
+		};
+		start = end;
+	}
+
+	// If we fail to create a thread, that chunk is processed below instead.
+	for(size_t u = 1; u < chunks; u++)
+		state[u].started = !pthread_create(&state[u].thread, NULL, _bijson_parallel_thread, state + u);
+
+	for(size_t u = 0; u < chunks; u++) {
+		if(state[u].started)
+			pthread_join(state[u].thread, NULL);
+		else
+			_bijson_parallel_thread(state + u);
+	}
+
+	bijson_error_t error = NULL;
+	for(size_t u = 0; u < chunks && !error; u++)
+		error = state[u].error;
+
+	free(state);
+	return error;
+}
+
+typedef struct _bijson_parallel_dynamic {
+	_bijson_parallel_worker_t worker;
+	void *worker_data;
+	size_t count;
+	size_t block_size;
+	size_t next;
+	bool failed;
+} _bijson_parallel_dynamic_t;
+
+typedef struct _bijson_parallel_dynamic_thread {
+	_bijson_parallel_dynamic_t *shared;
+	size_t thread;
+	bijson_error_t error;
+	size_t error_start;
+	pthread_t pthread;
+	bool started;
+} _bijson_parallel_dynamic_thread_t;
+
+static void *_bijson_parallel_dynamic_thread(void *arg) {
+	_bijson_parallel_dynamic_thread_t *thread = arg;
+	_bijson_parallel_dynamic_t *shared = thread->shared;
+	size_t count = shared->count;
+	size_t block_size = shared->block_size;
+
+	while(!__atomic_load_n(&shared->failed, __ATOMIC_RELAXED)) {
+		size_t start = __atomic_fetch_add(&shared->next, block_size, __ATOMIC_RELAXED);
+		if(start >= count)
+			break;
+		size_t end = count - start < block_size ? count : start + block_size;
+		bijson_error_t error = shared->worker(shared->worker_data, thread->thread, start, end);
+		if(error) {
+			thread->error = error;
+			thread->error_start = start;
+			__atomic_store_n(&shared->failed, true, __ATOMIC_RELAXED);
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+bijson_error_t _bijson_parallel_run_dynamic(
+	size_t count,
+	size_t block_size,
+	size_t threads,
+	_bijson_parallel_worker_t worker,
+	void *worker_data
+) {
+	if(!block_size)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_zero);
+
+	size_t blocks = count / block_size + (count % block_size != 0);
+	if(threads > blocks)
+		threads = blocks;
+	if(threads <= SIZE_C(1))
+		return count ? worker(worker_data, SIZE_C(0), SIZE_C(0), count) : NULL;
+
+	// Make sure that claiming blocks can't wrap around
+	if(count > SIZE_MAX - block_size * threads)
+		_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+
+	if(threads > SIZE_MAX / sizeof(_bijson_parallel_dynamic_thread_t))
+		_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+	_bijson_parallel_dynamic_thread_t *state = malloc(threads * sizeof *state);
+	if(!state)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+
+	_bijson_parallel_dynamic_t shared = {
+		.worker = worker,
+		.worker_data = worker_data,
+		.count = count,
+		.block_size = block_size,
+	};
+
+	for(size_t u = 0; u < threads; u++)
+		state[u] = (_bijson_parallel_dynamic_thread_t){
+			.shared = &shared,
+			.thread = u,
+		};
+
+	// Threads that fail to start are simply not there to help.
+	for(size_t u = 1; u < threads; u++)
+		state[u].started = !pthread_create(&state[u].pthread, NULL, _bijson_parallel_dynamic_thread, state + u);
+
+	_bijson_parallel_dynamic_thread(state);
+
+	for(size_t u = 1; u < threads; u++)
+		if(state[u].started)
+			pthread_join(state[u].pthread, NULL);
+
+	bijson_error_t error = NULL;
+	size_t error_start = SIZE_MAX;
+	for(size_t u = 0; u < threads; u++) {
+		if(state[u].error && state[u].error_start < error_start) {
+			error = state[u].error;
+			error_start = state[u].error_start;
+		}
+	}
+
+	free(state);
+	return error;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "common.h"
+
+// Processes the items [start, end) of chunk number chunk.
+typedef bijson_error_t (*_bijson_parallel_worker_t)(
+	void *worker_data,
+	size_t chunk,
+	size_t start,
+	size_t end
+);
+
+// Splits [0, count) into (at most) the given number of contiguous chunks of
+// roughly equal size and runs the worker on each of them in a separate
+// thread. The calling thread processes the first chunk itself. Returns the
+// error of the lowest numbered chunk that failed, if any.
+extern bijson_error_t _bijson_parallel_run(
+	size_t count,
+	size_t chunks,
+	_bijson_parallel_worker_t worker,
+	void *worker_data
+);
+
+// Like _bijson_parallel_run(), but instead of fixed chunks, the threads
+// repeatedly claim the next block of block_size items until none are left.
+// This keeps all threads busy even if some parts of the input take much
+// longer to process than others. The chunk argument of the worker is the
+// number of the thread. Returns the error of the failing block that starts
+// earliest, if any; after a failure no new blocks are claimed.
+extern bijson_error_t _bijson_parallel_run_dynamic(
+	size_t count,
+	size_t block_size,
+	size_t threads,
+	_bijson_parallel_worker_t worker,
+	void *worker_data
+);
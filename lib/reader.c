@@ -9,8 +9,10 @@
 #include "io.h"
 #include "reader.h"
 #include "reader/array.h"
+#include "reader/binary.h"
 #include "reader/decimal.h"
 #include "reader/object.h"
+#include "reader/render_cache.h"
 #include "reader/string.h"
 
 bijson_error_t bijson_get_value_type(const bijson_t *bijson, bijson_value_type_t *result) {
@@ -65,13 +67,17 @@ bijson_error_t bijson_get_value_type(const bijson_t *bijson, bijson_value_type_t
 		case BYTE_C(0x50):
 		case BYTE_C(0x60):
 		case BYTE_C(0x70):
+		case BYTE_C(0x80):
+		case BYTE_C(0x90):
+		case BYTE_C(0xA0):
+		case BYTE_C(0xB0):
 			return *result = bijson_value_type_object, NULL;
 	}
 
 	_BIJSON_RETURN_ERROR(bijson_error_unsupported_data_type);
 }
 
-bijson_error_t bijson_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data) {
+bijson_error_t _bijson_to_json(const bijson_t *bijson, bool nocheck, bijson_output_callback_t callback, void *callback_data) {
 	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
 	const byte_t *buffer = bijson->buffer;
 
@@ -84,17 +90,21 @@ bijson_error_t bijson_to_json(const bijson_t *bijson, bijson_output_callback_t c
 					_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
 				case BYTE_C(0x01):
 				case BYTE_C(0x05): // undefined
-					return callback(callback_data, "null", 4);
+					return _bijson_io_output(callback, callback_data, "null", 4);
 				case BYTE_C(0x02):
-					return callback(callback_data, "false", 5);
+					return _bijson_io_output(callback, callback_data, "false", 5);
 				case BYTE_C(0x03):
-					return callback(callback_data, "true", 4);
+					return _bijson_io_output(callback, callback_data, "true", 4);
 				case BYTE_C(0x08):
-					return _bijson_string_to_json(bijson, callback, callback_data);
+					return _bijson_string_to_json(bijson, nocheck, callback, callback_data);
+				case BYTE_C(0x0A):
+					return _bijson_binary_float_to_json(bijson, callback, callback_data);
 			}
 			break;
 		case BYTE_C(0x10):
 			switch(type & BYTE_C(0xFE)) {
+				case BYTE_C(0x18):
+					return _bijson_binary_integer_to_json(bijson, callback, callback_data);
 				case BYTE_C(0x1A):
 					return _bijson_decimal_integer_to_json(bijson, callback, callback_data);
 			}
@@ -103,21 +113,107 @@ bijson_error_t bijson_to_json(const bijson_t *bijson, bijson_output_callback_t c
 			return _bijson_decimal_to_json(bijson, callback, callback_data);
 			break;
 		case BYTE_C(0x30):
-			return _bijson_array_to_json(bijson, callback, callback_data);
+			return _bijson_array_to_json(bijson, nocheck, callback, callback_data);
 			break;
 		case BYTE_C(0x40):
 		case BYTE_C(0x50):
 		case BYTE_C(0x60):
 		case BYTE_C(0x70):
-			return _bijson_object_to_json(bijson, callback, callback_data);
+		case BYTE_C(0x80):
+		case BYTE_C(0x90):
+		case BYTE_C(0xA0):
+		case BYTE_C(0xB0):
+			return _bijson_object_to_json(bijson, nocheck, callback, callback_data);
 			break;
 	}
 
 	_BIJSON_RETURN_ERROR(bijson_error_unsupported_data_type);
 }
 
+bijson_error_t bijson_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data) {
+	return _bijson_to_json(bijson, false, callback, callback_data);
+}
+
+bijson_error_t bijson_to_json_nocheck(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data) {
+	return _bijson_to_json(bijson, true, callback, callback_data);
+}
+
+// Values of a fixed size (including the type byte) can have one of
+// at most three sizes.
+static inline bijson_error_t _bijson_verify_size(const bijson_t *bijson, size_t a, size_t b, size_t c) {
+	size_t size = bijson->size;
+	if(size != a && size != b && size != c)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+	return NULL;
+}
+
+bijson_error_t _bijson_verify(const bijson_t *bijson) {
+	const byte_t *buffer = bijson->buffer;
+	const byte_compute_t type = *buffer;
+
+	switch(type & BYTE_C(0xF0)) {
+		case BYTE_C(0x00):
+			switch(type) {
+				case BYTE_C(0x00):
+					_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+				case BYTE_C(0x01):
+				case BYTE_C(0x02):
+				case BYTE_C(0x03):
+				case BYTE_C(0x04):
+					return _bijson_verify_size(bijson, SIZE_C(1), SIZE_C(1), SIZE_C(1));
+				case BYTE_C(0x09):
+					return NULL;
+				case BYTE_C(0x0A):
+					// binary16, binary32 and binary64
+					return _bijson_verify_size(bijson, SIZE_C(3), SIZE_C(5), SIZE_C(9));
+				case BYTE_C(0x0B):
+				case BYTE_C(0x0C):
+					// decimal32, decimal64 and decimal128
+					return _bijson_verify_size(bijson, SIZE_C(5), SIZE_C(9), SIZE_C(17));
+				case BYTE_C(0x08):
+					return _bijson_string_verify(bijson);
+			}
+			break;
+		case BYTE_C(0x10):
+			switch(type & BYTE_C(0xFE)) {
+				case BYTE_C(0x10):
+				case BYTE_C(0x12):
+				case BYTE_C(0x14):
+					return _bijson_verify_size(bijson, SIZE_C(1), SIZE_C(1), SIZE_C(1));
+				case BYTE_C(0x18):
+					return NULL;
+				case BYTE_C(0x1A):
+					return _bijson_decimal_integer_verify(bijson);
+			}
+			break;
+		case BYTE_C(0x20):
+			return _bijson_decimal_verify(bijson);
+		case BYTE_C(0x30):
+			return _bijson_array_verify(bijson);
+		case BYTE_C(0x40):
+		case BYTE_C(0x50):
+		case BYTE_C(0x60):
+		case BYTE_C(0x70):
+		case BYTE_C(0x80):
+		case BYTE_C(0x90):
+		case BYTE_C(0xA0):
+		case BYTE_C(0xB0):
+			return _bijson_object_verify(bijson);
+	}
+
+	_BIJSON_RETURN_ERROR(bijson_error_unsupported_data_type);
+}
+
+bijson_error_t bijson_verify(const bijson_t *bijson) {
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
+	return _bijson_verify(bijson);
+}
+
 typedef struct _bijson_to_json_state {
 	const bijson_t *bijson;
+	bool nocheck;
+	// Some writers run the action twice; count the cache lookup only once
+	bool counted;
 } _bijson_to_json_state_t;
 
 static bijson_error_t _bijson_to_json_callback(
@@ -125,13 +221,23 @@ static bijson_error_t _bijson_to_json_callback(
 	bijson_output_callback_t output_callback,
 	void *output_callback_data
 ) {
-	return bijson_to_json(
-		((_bijson_to_json_state_t *)action_callback_data)->bijson,
+	_bijson_to_json_state_t *state = action_callback_data;
+	bool count = !state->counted;
+	state->counted = true;
+	return _bijson_render_cache_to_json_installed(
+		state->bijson,
+		state->nocheck,
+		count,
 		output_callback,
 		output_callback_data
 	);
 }
 
+bijson_error_t bijson_to_json_buffered(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data) {
+	_bijson_to_json_state_t state = {bijson};
+	return _bijson_io_write_buffered(_bijson_to_json_callback, &state, callback, callback_data);
+}
+
 bijson_error_t bijson_to_json_fd(const bijson_t *bijson, int fd) {
 	_bijson_to_json_state_t state = {bijson};
 	return _bijson_io_write_to_fd(_bijson_to_json_callback, &state, fd, NULL);
@@ -192,6 +298,40 @@ bijson_error_t bijson_to_json_filename_at(const bijson_t *bijson, int dir_fd, co
 	return _bijson_io_write_to_filename_at(_bijson_to_json_callback, &state, dir_fd, filename, NULL);
 }
 
+bijson_error_t bijson_to_json_nocheck_buffered(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data) {
+	_bijson_to_json_state_t state = {bijson, true};
+	return _bijson_io_write_buffered(_bijson_to_json_callback, &state, callback, callback_data);
+}
+
+bijson_error_t bijson_to_json_nocheck_fd(const bijson_t *bijson, int fd) {
+	_bijson_to_json_state_t state = {bijson, true};
+	return _bijson_io_write_to_fd(_bijson_to_json_callback, &state, fd, NULL);
+}
+
+bijson_error_t bijson_to_json_nocheck_FILE(const bijson_t *bijson, FILE *file) {
+	_bijson_to_json_state_t state = {bijson, true};
+	return _bijson_io_write_to_FILE(_bijson_to_json_callback, &state, file, NULL);
+}
+
+bijson_error_t bijson_to_json_nocheck_malloc(
+	const bijson_t *bijson,
+	const void **result_buffer,
+	size_t *result_size
+) {
+	_bijson_to_json_state_t state = {bijson, true};
+	return _bijson_io_write_to_malloc(
+		_bijson_to_json_callback,
+		&state,
+		result_buffer,
+		result_size
+	);
+}
+
+bijson_error_t bijson_to_json_nocheck_filename(const bijson_t *bijson, const char *filename) {
+	_bijson_to_json_state_t state = {bijson, true};
+	return _bijson_io_write_to_filename(_bijson_to_json_callback, &state, filename, NULL);
+}
+
 bijson_error_t bijson_open_filename(bijson_t *bijson, const char *filename) {
 	return _bijson_io_read_from_filename(NULL, bijson, filename);
 }
@@ -201,11 +341,13 @@ bijson_error_t bijson_open_filename_at(bijson_t *bijson, int dir_fd, const char
 }
 
 void bijson_close(bijson_t *bijson) {
+	_bijson_render_cache_invalidate_installed(bijson);
 	_bijson_io_close(bijson);
 }
 
 void bijson_free(bijson_t *bijson) {
 	if(bijson) {
+		_bijson_render_cache_invalidate_installed(bijson);
 		free(_bijson_no_const(bijson->buffer));
 		*bijson = bijson_0;
 	}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string.h>
+
 #include "../include/reader.h"
 
 #include "common.h"
@@ -12,7 +14,55 @@ static inline bijson_error_t _bijson_check_bijson(const bijson_t *bijson) {
 	return NULL;
 }
 
+extern bijson_error_t _bijson_to_json(
+	const bijson_t *bijson,
+	bool nocheck,
+	bijson_output_callback_t callback,
+	void *callback_data
+);
+extern bijson_error_t _bijson_verify(const bijson_t *bijson);
+
+// Fixed width little endian loads. The memcpy() compiles to a single
+// (unaligned) load instruction.
+static inline uint16_t _bijson_read_uint16(const byte_t *buffer) {
+	uint16_t r;
+	memcpy(&r, buffer, sizeof r);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	r = __builtin_bswap16(r);
+#endif
+	return r;
+}
+
+static inline uint32_t _bijson_read_uint32(const byte_t *buffer) {
+	uint32_t r;
+	memcpy(&r, buffer, sizeof r);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	r = __builtin_bswap32(r);
+#endif
+	return r;
+}
+
+static inline uint64_t _bijson_read_uint64(const byte_t *buffer) {
+	uint64_t r;
+	memcpy(&r, buffer, sizeof r);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	r = __builtin_bswap64(r);
+#endif
+	return r;
+}
+
+// If nbytes is a compile time constant, this reduces to a single load.
 static inline uint64_t _bijson_read_minimal_int(const byte_t *buffer, size_t nbytes) {
+	switch(nbytes) {
+		case SIZE_C(1):
+			return *buffer;
+		case SIZE_C(2):
+			return _bijson_read_uint16(buffer);
+		case SIZE_C(4):
+			return _bijson_read_uint32(buffer);
+		case SIZE_C(8):
+			return _bijson_read_uint64(buffer);
+	}
 	uint64_t r = 0;
 	for(size_t u = 0; u < nbytes; u++)
 		r |= (uint64_t)buffer[u] << (u * SIZE_C(8));
@@ -0,0 +1,342 @@
+#include <string.h>
+
+#include "../../include/reader.h"
+
+#include "../common.h"
+#include "../reader.h"
+#include "array.h"
+#include "decimal.h"
+
+#ifdef __SIZEOF_INT128__
+
+// Items are decoded in batches of this many. Batches that consist of small
+// numbers with the same exponent (all integers, or all prices in cents, say)
+// are reduced using plain int64_t loops that the compiler can vectorize.
+#define _BIJSON_AGGREGATE_BATCH SIZE_C(256)
+
+typedef struct _bijson_aggregate_value {
+	_bijson_decimal_small_t small;
+	bool is_small;
+} _bijson_aggregate_value_t;
+
+typedef struct _bijson_aggregate_state {
+	bijson_aggregate_t *result;
+	_bijson_aggregate_value_t min;
+	_bijson_aggregate_value_t max;
+	// Used once the sum is no longer exact
+	double approximate_sum;
+} _bijson_aggregate_state_t;
+
+__attribute__((const))
+static inline int64_t _bijson_aggregate_digits(uint64_t significand) {
+	unsigned int digits = 1U;
+	while(digits < 19U && significand >= _bijson_uint64_pow10(digits))
+		digits++;
+	return (int64_t)digits;
+}
+
+// Exact comparison of small decimals.
+__attribute__((pure))
+static int _bijson_aggregate_compare_small(const _bijson_decimal_small_t *a, const _bijson_decimal_small_t *b) {
+	int a_sign = a->significand ? a->negative ? -1 : 1 : 0;
+	int b_sign = b->significand ? b->negative ? -1 : 1 : 0;
+	if(a_sign != b_sign)
+		return a_sign < b_sign ? -1 : 1;
+	if(!a_sign)
+		return 0;
+
+	int cmp;
+	if(a->exponent == b->exponent) {
+		cmp = a->significand == b->significand ? 0 : a->significand < b->significand ? -1 : 1;
+		return a_sign < 0 ? -cmp : cmp;
+	}
+
+	// Compare the magnitudes, first by order, then by significand
+	int64_t a_digits = _bijson_aggregate_digits(a->significand);
+	int64_t b_digits = _bijson_aggregate_digits(b->significand);
+	int64_t a_order = a->exponent + a_digits;
+	int64_t b_order = b->exponent + b_digits;
+	if(a_order != b_order) {
+		cmp = a_order < b_order ? -1 : 1;
+	} else {
+		uint64_t a_significand = a->significand;
+		uint64_t b_significand = b->significand;
+		if(a_digits < b_digits)
+			a_significand *= _bijson_uint64_pow10((unsigned int)(b_digits - a_digits));
+		else
+			b_significand *= _bijson_uint64_pow10((unsigned int)(a_digits - b_digits));
+		cmp = a_significand == b_significand ? 0 : a_significand < b_significand ? -1 : 1;
+	}
+	return a_sign < 0 ? -cmp : cmp;
+}
+
+// Also exact for larger numbers, which are compared through their items.
+static inline bijson_error_t _bijson_aggregate_compare(
+	const _bijson_aggregate_value_t *a,
+	const bijson_t *a_item,
+	const _bijson_aggregate_value_t *b,
+	const bijson_t *b_item,
+	int *result
+) {
+	if(a->is_small && b->is_small) {
+		*result = _bijson_aggregate_compare_small(&a->small, &b->small);
+		return NULL;
+	}
+	return _bijson_decimal_compare(a_item, b_item, result);
+}
+
+static inline bijson_error_t _bijson_aggregate_update_extremes(
+	_bijson_aggregate_state_t *state,
+	const _bijson_aggregate_value_t *value,
+	const bijson_t *item
+) {
+	bijson_aggregate_t *result = state->result;
+	int cmp = -1;
+	if(result->min.buffer)
+		_BIJSON_RETURN_ON_ERROR(_bijson_aggregate_compare(value, item, &state->min, &result->min, &cmp));
+	if(cmp < 0) {
+		state->min = *value;
+		result->min = *item;
+	}
+	cmp = 1;
+	if(result->max.buffer)
+		_BIJSON_RETURN_ON_ERROR(_bijson_aggregate_compare(value, item, &state->max, &result->max, &cmp));
+	if(cmp > 0) {
+		state->max = *value;
+		result->max = *item;
+	}
+	return NULL;
+}
+
+// Multiplies by 10^shift, returns false on overflow.
+static inline bool _bijson_aggregate_scale(int128_t *value, uint64_t shift) {
+	int128_t scaled = *value;
+	if(!scaled)
+		return true;
+	if(shift > UINT64_C(38))
+		return false;
+	while(shift) {
+		unsigned int step = shift > UINT64_C(18) ? 18U : (unsigned int)shift;
+		if(__builtin_mul_overflow(scaled, (int128_t)_bijson_uint64_pow10(step), &scaled))
+			return false;
+		shift -= step;
+	}
+	*value = scaled;
+	return true;
+}
+
+static void _bijson_aggregate_make_inexact(_bijson_aggregate_state_t *state) {
+	bijson_aggregate_t *result = state->result;
+	if(!result->sum_exact)
+		return;
+	result->sum_exact = false;
+	state->approximate_sum = _bijson_decimal_int128_to_double(result->sum, result->sum_exponent);
+	result->sum = 0;
+	result->sum_exponent = 0;
+}
+
+// Adds value * 10^exponent to the sum.
+static void _bijson_aggregate_add(_bijson_aggregate_state_t *state, int128_t value, int64_t exponent) {
+	bijson_aggregate_t *result = state->result;
+	if(!value)
+		return;
+
+	if(result->sum_exact) {
+		int128_t sum = result->sum;
+		if(!sum) {
+			result->sum = value;
+			result->sum_exponent = exponent;
+			return;
+		}
+		int64_t sum_exponent = result->sum_exponent;
+		if(exponent < sum_exponent) {
+			if(_bijson_aggregate_scale(&sum, (uint64_t)(sum_exponent - exponent))
+				&& !__builtin_add_overflow(sum, value, &sum)
+			) {
+				result->sum = sum;
+				result->sum_exponent = exponent;
+				return;
+			}
+		} else {
+			int128_t scaled = value;
+			if(_bijson_aggregate_scale(&scaled, (uint64_t)(exponent - sum_exponent))
+				&& !__builtin_add_overflow(sum, scaled, &sum)
+			) {
+				result->sum = sum;
+				return;
+			}
+		}
+		_bijson_aggregate_make_inexact(state);
+	}
+
+	state->approximate_sum += _bijson_decimal_int128_to_double(value, exponent);
+}
+
+// Handles the numbers that don't fit in the batch.
+static bijson_error_t _bijson_aggregate_item(
+	_bijson_aggregate_state_t *state,
+	const bijson_t *item,
+	_bijson_aggregate_value_t *value
+) {
+	state->result->count++;
+	if(value->is_small) {
+		int128_t significand = (int128_t)value->small.significand;
+		_bijson_aggregate_add(state, value->small.negative ? -significand : significand, value->small.exponent);
+	} else {
+		double approximation;
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_to_double(item, &approximation));
+		_bijson_aggregate_make_inexact(state);
+		state->approximate_sum += approximation;
+	}
+	return _bijson_aggregate_update_extremes(state, value, item);
+}
+
+// Kept separate and free of early exits so that each of them vectorizes.
+
+__attribute__((pure))
+static int128_t _bijson_aggregate_sum_int64(const int64_t *values, size_t count) {
+	// Split each value in halves so that the sums can't overflow
+	uint64_t low = 0;
+	int64_t high = 0;
+	for(size_t u = 0; u < count; u++) {
+		low += (uint64_t)values[u] & UINT64_C(0xFFFFFFFF);
+		high += values[u] >> 32U;
+	}
+	return (int128_t)high * ((int128_t)1 << 32U) + (int128_t)low;
+}
+
+__attribute__((pure))
+static int64_t _bijson_aggregate_min_int64(const int64_t *values, size_t count) {
+	int64_t min = INT64_MAX;
+	for(size_t u = 0; u < count; u++)
+		min = values[u] < min ? values[u] : min;
+	return min;
+}
+
+__attribute__((pure))
+static int64_t _bijson_aggregate_max_int64(const int64_t *values, size_t count) {
+	int64_t max = INT64_MIN;
+	for(size_t u = 0; u < count; u++)
+		max = values[u] > max ? values[u] : max;
+	return max;
+}
+
+__attribute__((pure))
+static size_t _bijson_aggregate_find_int64(const int64_t *values, size_t count, int64_t value) {
+	for(size_t u = 0; u < count; u++)
+		if(values[u] == value)
+			return u;
+	return count;
+}
+
+static bijson_error_t _bijson_aggregate_batch_extreme(
+	_bijson_aggregate_state_t *state,
+	const int64_t *values,
+	const bijson_t *items,
+	size_t count,
+	int64_t exponent,
+	bool is_max
+) {
+	int64_t extreme = is_max
+		? _bijson_aggregate_max_int64(values, count)
+		: _bijson_aggregate_min_int64(values, count);
+	_bijson_aggregate_value_t value = {
+		.small = {
+			.significand = extreme < 0 ? (uint64_t)-extreme : (uint64_t)extreme,
+			.exponent = exponent,
+			.negative = extreme < 0,
+		},
+		.is_small = true,
+	};
+	size_t index = _bijson_aggregate_find_int64(values, count, extreme);
+	bijson_t *current = is_max ? &state->result->max : &state->result->min;
+	_bijson_aggregate_value_t *current_value = is_max ? &state->max : &state->min;
+	if(current->buffer) {
+		int cmp;
+		_BIJSON_RETURN_ON_ERROR(_bijson_aggregate_compare(&value, items + index, current_value, current, &cmp));
+		if(is_max ? cmp <= 0 : cmp >= 0)
+			return NULL;
+	}
+	*current_value = value;
+	*current = items[index];
+	return NULL;
+}
+
+// Small numbers that share the exponent of the first one are collected and
+// reduced together, anything else is handled individually.
+static bijson_error_t _bijson_aggregate_batch(_bijson_aggregate_state_t *state, const bijson_t *items, size_t count) {
+	int64_t values[_BIJSON_AGGREGATE_BATCH];
+	bijson_t batch_items[_BIJSON_AGGREGATE_BATCH];
+	size_t batch_count = 0;
+	int64_t exponent = 0;
+
+	for(size_t u = 0; u < count; u++) {
+		_bijson_aggregate_value_t value;
+		bijson_error_t error = _bijson_decimal_get_small(items + u, &value.small, &value.is_small);
+		if(error == bijson_error_type_mismatch) {
+			state->result->skipped++;
+			continue;
+		}
+		_BIJSON_RETURN_ON_ERROR(error);
+
+		if(value.is_small && value.small.significand <= (uint64_t)INT64_MAX) {
+			if(!batch_count)
+				exponent = value.small.exponent;
+			if(value.small.exponent == exponent) {
+				int64_t significand = (int64_t)value.small.significand;
+				values[batch_count] = value.small.negative ? -significand : significand;
+				batch_items[batch_count++] = items[u];
+				continue;
+			}
+		}
+
+		_BIJSON_RETURN_ON_ERROR(_bijson_aggregate_item(state, items + u, &value));
+	}
+
+	if(!batch_count)
+		return NULL;
+
+	state->result->count += batch_count;
+	_bijson_aggregate_add(state, _bijson_aggregate_sum_int64(values, batch_count), exponent);
+	_BIJSON_RETURN_ON_ERROR(_bijson_aggregate_batch_extreme(state, values, batch_items, batch_count, exponent, false));
+	return _bijson_aggregate_batch_extreme(state, values, batch_items, batch_count, exponent, true);
+}
+
+static bijson_error_t _bijson_analyzed_array_aggregate(const _bijson_array_analysis_t *analysis, bijson_aggregate_t *result) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	*result = (bijson_aggregate_t){.sum_exact = true};
+	_bijson_aggregate_state_t state = {.result = result};
+
+	_bijson_array_cursor_t cursor;
+	_bijson_array_cursor_init(&cursor, analysis);
+	bijson_t items[_BIJSON_AGGREGATE_BATCH];
+	size_t count = analysis->count;
+	for(size_t start = 0; start < count; start += _BIJSON_AGGREGATE_BATCH) {
+		size_t batch = _bijson_size_min(count - start, _BIJSON_AGGREGATE_BATCH);
+		for(size_t u = 0; u < batch; u++)
+			_BIJSON_RETURN_ON_ERROR(_bijson_array_cursor_next(&cursor, items + u));
+		_BIJSON_RETURN_ON_ERROR(_bijson_aggregate_batch(&state, items, batch));
+	}
+
+	result->sum_double = result->sum_exact
+		? _bijson_decimal_int128_to_double(result->sum, result->sum_exponent)
+		: state.approximate_sum;
+
+	return NULL;
+}
+
+bijson_error_t bijson_analyzed_array_aggregate(const bijson_array_analysis_t *analysis, bijson_aggregate_t *result) {
+	if(!analysis)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	return _bijson_analyzed_array_aggregate((const _bijson_array_analysis_t *)analysis, result);
+}
+
+bijson_error_t bijson_array_aggregate(const bijson_t *bijson, bijson_aggregate_t *result) {
+	_bijson_array_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(bijson, &analysis));
+	return _bijson_analyzed_array_aggregate(&analysis, result);
+}
+
+#endif
@@ -4,17 +4,9 @@
 
 #include "../common.h"
 #include "../reader.h"
+#include "../io.h"
 #include "array.h"
 
-typedef struct _bijson_array_analysis {
-	size_t count;
-	size_t count_1;
-	size_t index_item_size;
-	size_t highest_valid_offset;
-	const byte_t *item_index;
-	const byte_t *item_data_start;
-} _bijson_array_analysis_t;
-
 static inline bijson_error_t _bijson_array_analyze_count(const bijson_t *bijson, _bijson_array_analysis_t *analysis) {
 	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
 	if(!analysis)
@@ -67,7 +59,10 @@ bijson_error_t bijson_analyzed_array_count(const bijson_array_analysis_t *analys
 	return NULL;
 }
 
-static inline bijson_error_t _bijson_array_analyze(const bijson_t *bijson, _bijson_array_analysis_t *analysis) {
+static const _bijson_array_get_index_t _bijson_array_get_index_kernels[4];
+static const _bijson_array_cursor_next_t _bijson_array_cursor_next_kernels[4];
+
+bijson_error_t _bijson_array_analyze(const bijson_t *bijson, _bijson_array_analysis_t *analysis) {
 	_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze_count(bijson, analysis));
 	if(!analysis->count)
 		return NULL;
@@ -91,6 +86,8 @@ static inline bijson_error_t _bijson_array_analyze(const bijson_t *bijson, _bijs
 	size_t item_data_size = _bijson_ptrdiff(buffer_end, item_data_start);
 
 	analysis->index_item_size = index_item_size;
+	analysis->get_index = _bijson_array_get_index_kernels[(type >> 2U) & BYTE_C(0x3)];
+	analysis->cursor_next = _bijson_array_cursor_next_kernels[(type >> 2U) & BYTE_C(0x3)];
 	analysis->item_data_start = item_data_start;
 	// This is for comparing the raw offsets to, so it doesn't include
 	// the implicit "+ index" term yet.
@@ -99,15 +96,19 @@ static inline bijson_error_t _bijson_array_analyze(const bijson_t *bijson, _bijs
 	return NULL;
 }
 
-static inline bijson_error_t _bijson_analyzed_array_get_index(const _bijson_array_analysis_t *analysis, size_t index, bijson_t *result) {
-	if(!analysis)
-		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
-
-	if(index >= analysis->count)
-		_BIJSON_RETURN_ERROR(bijson_error_index_out_of_range);
+// The offset width is passed as a compile time constant by the specialized
+// versions below, so that all offset reads reduce to single fixed width loads.
+__attribute__((always_inline))
+static inline bijson_error_t _bijson_analyzed_array_get_index_impl(
+	const _bijson_array_analysis_t *analysis,
+	size_t index,
+	bijson_t *result,
+	size_t index_item_size
+) {
+	assert(index < analysis->count);
 
 	uint64_t raw_start_offset = index
-		? _bijson_read_minimal_int(analysis->item_index + analysis->index_item_size * (index - SIZE_C(1)), analysis->index_item_size)
+		? _bijson_read_minimal_int(analysis->item_index + index_item_size * (index - SIZE_C(1)), index_item_size)
 		: UINT64_C(0);
 	if(raw_start_offset > SIZE_MAX)
 		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
@@ -118,7 +119,7 @@ static inline bijson_error_t _bijson_analyzed_array_get_index(const _bijson_arra
 
 	uint64_t raw_end_offset = index == analysis->count_1
 		? analysis->highest_valid_offset
-		: _bijson_read_minimal_int(analysis->item_index + analysis->index_item_size * index, analysis->index_item_size);
+		: _bijson_read_minimal_int(analysis->item_index + index_item_size * index, index_item_size);
 	if(raw_end_offset > SIZE_MAX)
 		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
 	size_t end_offset = (size_t)raw_end_offset;
@@ -135,6 +136,81 @@ static inline bijson_error_t _bijson_analyzed_array_get_index(const _bijson_arra
 	return NULL;
 }
 
+#define _BIJSON_ARRAY_GET_INDEX_KERNEL(index_item_size) \
+	static bijson_error_t _bijson_analyzed_array_get_index_##index_item_size( \
+		const _bijson_array_analysis_t *analysis, \
+		size_t index, \
+		bijson_t *result \
+	) { \
+		return _bijson_analyzed_array_get_index_impl(analysis, index, result, SIZE_C(index_item_size)); \
+	}
+
+_BIJSON_ARRAY_GET_INDEX_KERNEL(1)
+_BIJSON_ARRAY_GET_INDEX_KERNEL(2)
+_BIJSON_ARRAY_GET_INDEX_KERNEL(4)
+_BIJSON_ARRAY_GET_INDEX_KERNEL(8)
+
+// Indexed by the offset width bits of the type byte.
+static const _bijson_array_get_index_t _bijson_array_get_index_kernels[4] = {
+	_bijson_analyzed_array_get_index_1,
+	_bijson_analyzed_array_get_index_2,
+	_bijson_analyzed_array_get_index_4,
+	_bijson_analyzed_array_get_index_8,
+};
+
+// Like _bijson_analyzed_array_get_index_impl(), but reads only the end
+// offset of each item, because the start is where the previous one ended.
+__attribute__((always_inline))
+static inline bijson_error_t _bijson_array_cursor_next_impl(
+	_bijson_array_cursor_t *cursor,
+	bijson_t *result,
+	size_t index_item_size
+) {
+	const _bijson_array_analysis_t *analysis = &cursor->analysis;
+	size_t index = cursor->index;
+	assert(index < analysis->count);
+
+	uint64_t raw_end_offset = index == analysis->count_1
+		? analysis->highest_valid_offset
+		: _bijson_read_minimal_int(analysis->item_index + index_item_size * index, index_item_size);
+	if(raw_end_offset > analysis->highest_valid_offset)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+	size_t end_offset = (size_t)raw_end_offset + index + SIZE_C(1);
+
+	size_t start_offset = cursor->offset;
+	if(start_offset >= end_offset)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+
+	result->buffer = analysis->item_data_start + start_offset;
+	result->size = end_offset - start_offset;
+
+	cursor->index = index + SIZE_C(1);
+	cursor->offset = end_offset;
+
+	return NULL;
+}
+
+#define _BIJSON_ARRAY_CURSOR_NEXT_KERNEL(index_item_size) \
+	static bijson_error_t _bijson_array_cursor_next_##index_item_size( \
+		_bijson_array_cursor_t *cursor, \
+		bijson_t *result \
+	) { \
+		return _bijson_array_cursor_next_impl(cursor, result, SIZE_C(index_item_size)); \
+	}
+
+_BIJSON_ARRAY_CURSOR_NEXT_KERNEL(1)
+_BIJSON_ARRAY_CURSOR_NEXT_KERNEL(2)
+_BIJSON_ARRAY_CURSOR_NEXT_KERNEL(4)
+_BIJSON_ARRAY_CURSOR_NEXT_KERNEL(8)
+
+// Indexed by the offset width bits of the type byte.
+static const _bijson_array_cursor_next_t _bijson_array_cursor_next_kernels[4] = {
+	_bijson_array_cursor_next_1,
+	_bijson_array_cursor_next_2,
+	_bijson_array_cursor_next_4,
+	_bijson_array_cursor_next_8,
+};
+
 bijson_error_t bijson_array_get_index(const bijson_t *bijson, size_t index, bijson_t *result) {
 	_bijson_array_analysis_t analysis;
 	_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(bijson, &analysis));
@@ -150,20 +226,59 @@ bijson_error_t bijson_array_analyze(const bijson_t *bijson, bijson_array_analysi
 	return _bijson_array_analyze(bijson, (_bijson_array_analysis_t *)result);
 }
 
-bijson_error_t _bijson_array_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data) {
+bijson_error_t bijson_array_cursor_init(bijson_array_cursor_t *cursor, const bijson_t *bijson) {
+	assert(sizeof(_bijson_array_cursor_t) <= sizeof(*cursor));
+	if(!cursor)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	_bijson_array_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(bijson, &analysis));
+	_bijson_array_cursor_init((_bijson_array_cursor_t *)cursor, &analysis);
+	return NULL;
+}
+
+bijson_error_t bijson_analyzed_array_cursor_init(bijson_array_cursor_t *cursor, const bijson_array_analysis_t *analysis) {
+	assert(sizeof(_bijson_array_cursor_t) <= sizeof(*cursor));
+	if(!cursor || !analysis)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	_bijson_array_cursor_init((_bijson_array_cursor_t *)cursor, (const _bijson_array_analysis_t *)analysis);
+	return NULL;
+}
+
+bijson_error_t bijson_array_cursor_next(bijson_array_cursor_t *cursor, bijson_t *result) {
+	return _bijson_array_cursor_next((_bijson_array_cursor_t *)cursor, result);
+}
+
+bijson_error_t _bijson_array_to_json(const bijson_t *bijson, bool nocheck, bijson_output_callback_t callback, void *callback_data) {
 	_bijson_array_analysis_t analysis;
 	_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(bijson, &analysis));
 
-	_BIJSON_RETURN_ON_ERROR(callback(callback_data, "[", 1));
+	_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, "[", 1));
 
+	_bijson_array_cursor_t cursor;
+	_bijson_array_cursor_init(&cursor, &analysis);
 	for(size_t u = 0; u < analysis.count; u++) {
 		if(u)
-			_BIJSON_RETURN_ON_ERROR(callback(callback_data, ",", 1));
+			_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, ",", 1));
+
+		bijson_t item;
+		_BIJSON_RETURN_ON_ERROR(_bijson_array_cursor_next(&cursor, &item));
+		_BIJSON_RETURN_ON_ERROR(_bijson_to_json(&item, nocheck, callback, callback_data));
+	}
+
+	return _bijson_io_output(callback, callback_data, "]", 1);
+}
+
+bijson_error_t _bijson_array_verify(const bijson_t *bijson) {
+	_bijson_array_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(bijson, &analysis));
 
+	_bijson_array_cursor_t cursor;
+	_bijson_array_cursor_init(&cursor, &analysis);
+	for(size_t u = 0; u < analysis.count; u++) {
 		bijson_t item;
-		_BIJSON_RETURN_ON_ERROR(_bijson_analyzed_array_get_index(&analysis, u, &item));
-		_BIJSON_RETURN_ON_ERROR(bijson_to_json(&item, callback, callback_data));
+		_BIJSON_RETURN_ON_ERROR(_bijson_array_cursor_next(&cursor, &item));
+		_BIJSON_RETURN_ON_ERROR(_bijson_verify(&item));
 	}
 
-	return callback(callback_data, "]", 1);
+	return NULL;
 }
@@ -1,5 +1,63 @@
 #pragma once
 
 #include "../common.h"
+#include "../reader.h"
 
-extern bijson_error_t _bijson_array_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data);
+typedef struct _bijson_array_analysis _bijson_array_analysis_t;
+typedef struct _bijson_array_cursor _bijson_array_cursor_t;
+
+// Fetches an item without checking the index against the count.
+typedef bijson_error_t (*_bijson_array_get_index_t)(
+	const _bijson_array_analysis_t *analysis,
+	size_t index,
+	bijson_t *result
+);
+
+// Fetches the next item without checking the index against the count.
+typedef bijson_error_t (*_bijson_array_cursor_next_t)(_bijson_array_cursor_t *cursor, bijson_t *result);
+
+struct _bijson_array_analysis {
+	size_t count;
+	size_t count_1;
+	size_t index_item_size;
+	size_t highest_valid_offset;
+	const byte_t *item_index;
+	const byte_t *item_data_start;
+	// Specialized for the offset width of this array
+	_bijson_array_get_index_t get_index;
+	_bijson_array_cursor_next_t cursor_next;
+};
+
+static inline bijson_error_t _bijson_analyzed_array_get_index(const _bijson_array_analysis_t *analysis, size_t index, bijson_t *result) {
+	if(!analysis)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	if(index >= analysis->count)
+		_BIJSON_RETURN_ERROR(bijson_error_index_out_of_range);
+
+	return analysis->get_index(analysis, index, result);
+}
+
+struct _bijson_array_cursor {
+	_bijson_array_analysis_t analysis;
+	size_t index;
+	// Start of the next item (including the implicit "+ index" term)
+	size_t offset;
+};
+
+static inline void _bijson_array_cursor_init(_bijson_array_cursor_t *cursor, const _bijson_array_analysis_t *analysis) {
+	cursor->analysis = *analysis;
+	cursor->index = SIZE_C(0);
+	cursor->offset = SIZE_C(0);
+}
+
+static inline bijson_error_t _bijson_array_cursor_next(_bijson_array_cursor_t *cursor, bijson_t *result) {
+	if(cursor->index >= cursor->analysis.count)
+		return bijson_error_index_out_of_range;
+
+	return cursor->analysis.cursor_next(cursor, result);
+}
+
+extern bijson_error_t _bijson_array_analyze(const bijson_t *bijson, _bijson_array_analysis_t *analysis);
+extern bijson_error_t _bijson_array_to_json(const bijson_t *bijson, bool nocheck, bijson_output_callback_t callback, void *callback_data);
+extern bijson_error_t _bijson_array_verify(const bijson_t *bijson);
@@ -0,0 +1,603 @@
+#include <stdbool.h>
+#include <limits.h>
+#include <math.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "../common.h"
+#include "../reader.h"
+#include "../io.h"
+#include "binary.h"
+#include "ryu.h"
+
+// Integers that fit in 64 bits are converted directly. Longer ones are split
+// into 32-bit limbs that are divided by 10^9 repeatedly; the remainders are
+// the base 10^9 digits, least significant first.
+#define _BIJSON_BINARY_CHUNK_BASE UINT64_C(1000000000)
+#define _BIJSON_BINARY_CHUNK_DIGITS SIZE_C(9)
+// Decimal significands are stored in base 10^19 words
+#define _BIJSON_BINARY_DECIMAL_WORD_BASE UINT64_C(10000000000000000000)
+#define _BIJSON_BINARY_DECIMAL_WORD_DIGITS SIZE_C(19)
+
+// Zero bytes at the most significant end do not contribute anything
+__attribute__((pure))
+static inline size_t _bijson_binary_magnitude_size(const byte_t *magnitude, size_t size) {
+	while(size && !magnitude[size - SIZE_C(1)])
+		size--;
+	return size;
+}
+
+// Converts a magnitude of more than 64 bits to base 10^9 chunks. Free
+// *chunks_result when done.
+static bijson_error_t _bijson_binary_integer_chunks(
+	const byte_t *magnitude,
+	size_t magnitude_size,
+	uint32_t **chunks_result,
+	size_t *count_result
+) {
+	size_t limbs_count = (magnitude_size + SIZE_C(3)) / SIZE_C(4);
+	// Every chunk holds more than 29 bits, so this is always enough:
+	size_t chunks_max = limbs_count + limbs_count / SIZE_C(8) + SIZE_C(1);
+	if(chunks_max > SIZE_MAX / sizeof(uint32_t) - limbs_count)
+		_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+	uint32_t *limbs = malloc((limbs_count + chunks_max) * sizeof *limbs);
+	if(!limbs)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	uint32_t *chunks = limbs + limbs_count;
+
+	for(size_t u = 0; u < limbs_count; u++) {
+		size_t offset = u * SIZE_C(4);
+		limbs[u] = (uint32_t)_bijson_read_minimal_int(magnitude + offset, _bijson_size_min(SIZE_C(4), magnitude_size - offset));
+	}
+
+	size_t chunks_count = 0;
+	do {
+		uint64_t remainder = 0;
+		for(size_t u = limbs_count; u--;) {
+			uint64_t current = remainder << 32U | limbs[u];
+			limbs[u] = (uint32_t)(current / _BIJSON_BINARY_CHUNK_BASE);
+			remainder = current % _BIJSON_BINARY_CHUNK_BASE;
+		}
+		chunks[chunks_count++] = (uint32_t)remainder;
+		while(limbs_count && !limbs[limbs_count - SIZE_C(1)])
+			limbs_count--;
+	} while(limbs_count);
+
+	// The chunks go where the limbs were
+	memmove(limbs, chunks, chunks_count * sizeof *chunks);
+	*chunks_result = limbs;
+	*count_result = chunks_count;
+	return NULL;
+}
+
+bijson_error_t _bijson_binary_integer_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data) {
+	const byte_t *buffer = bijson->buffer;
+	size_t size = bijson->size;
+
+	byte_compute_t type = *buffer;
+	if(type & BYTE_C(0x1))
+		_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, "-", SIZE_C(1)));
+
+	const byte_t *magnitude = buffer + SIZE_C(1);
+	size_t magnitude_size = _bijson_binary_magnitude_size(magnitude, size - SIZE_C(1));
+
+	byte_t chars[20];
+	if(magnitude_size <= sizeof(uint64_t)) {
+		uint64_t value = magnitude_size ? _bijson_read_minimal_int(magnitude, magnitude_size) : 0;
+		return _bijson_io_output(callback, callback_data, chars, _bijson_uint64_str(chars, value));
+	}
+
+	uint32_t *chunks;
+	size_t chunks_count;
+	_BIJSON_RETURN_ON_ERROR(_bijson_binary_integer_chunks(magnitude, magnitude_size, &chunks, &chunks_count));
+
+	chunks_count--;
+	_BIJSON_CLEANUP_AND_RETURN_ON_ERROR(
+		_bijson_io_output(callback, callback_data, chars, _bijson_uint64_str(chars, chunks[chunks_count])),
+		free(chunks)
+	);
+	while(chunks_count--) {
+		_bijson_uint64_str_padded(chars, chunks[chunks_count]);
+		_BIJSON_CLEANUP_AND_RETURN_ON_ERROR(
+			_bijson_io_output(
+				callback,
+				callback_data,
+				chars + sizeof chars - _BIJSON_BINARY_CHUNK_DIGITS,
+				_BIJSON_BINARY_CHUNK_DIGITS
+			),
+			free(chunks)
+		);
+	}
+
+	free(chunks);
+	return NULL;
+}
+
+// Appends a word of a decimal significand: all but the most significant one
+// take 8 bytes, the most significant one is stored minus one in as few bytes
+// as possible.
+static inline byte_t *_bijson_binary_put_decimal_word(byte_t *buffer, uint64_t word, bool top) {
+	if(!top) {
+		for(size_t u = 0; u < sizeof word; u++)
+			*buffer++ = (byte_t)(word >> (u * SIZE_C(8)));
+		return buffer;
+	}
+	word--;
+	do {
+		*buffer++ = (byte_t)word;
+		word >>= 8U;
+	} while(word);
+	return buffer;
+}
+
+bijson_error_t _bijson_binary_integer_to_decimal(const bijson_t *bijson, byte_t *small, bijson_t *result) {
+	const byte_t *buffer = bijson->buffer;
+	const byte_t *magnitude = buffer + SIZE_C(1);
+	size_t magnitude_size = _bijson_binary_magnitude_size(magnitude, bijson->size - SIZE_C(1));
+	small[0] = BYTE_C(0x1A) | (*buffer & BYTE_C(0x1));
+
+	if(magnitude_size <= sizeof(uint64_t)) {
+		uint64_t value = magnitude_size ? _bijson_read_minimal_int(magnitude, magnitude_size) : UINT64_C(0);
+		byte_t *end = small + SIZE_C(1);
+		if(value >= _BIJSON_BINARY_DECIMAL_WORD_BASE) {
+			end = _bijson_binary_put_decimal_word(end, value % _BIJSON_BINARY_DECIMAL_WORD_BASE, false);
+			end = _bijson_binary_put_decimal_word(end, value / _BIJSON_BINARY_DECIMAL_WORD_BASE, true);
+		} else if(value) {
+			end = _bijson_binary_put_decimal_word(end, value, true);
+		}
+		result->buffer = small;
+		result->size = _bijson_ptrdiff(end, small);
+		return NULL;
+	}
+
+	uint32_t *chunks;
+	size_t chunks_count;
+	_BIJSON_RETURN_ON_ERROR(_bijson_binary_integer_chunks(magnitude, magnitude_size, &chunks, &chunks_count));
+
+	// Regroup the base 10^9 chunks into base 10^19 words, one digit at a time
+	size_t digits = (chunks_count - SIZE_C(1)) * _BIJSON_BINARY_CHUNK_DIGITS;
+	for(uint32_t top = chunks[chunks_count - SIZE_C(1)]; top; top /= UINT32_C(10))
+		digits++;
+	size_t words_count = (digits + _BIJSON_BINARY_DECIMAL_WORD_DIGITS - SIZE_C(1)) / _BIJSON_BINARY_DECIMAL_WORD_DIGITS;
+	// Room for the type byte and all words
+	byte_t *decimal = malloc(SIZE_C(1) + words_count * sizeof(uint64_t));
+	if(!decimal) {
+		free(chunks);
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	}
+	decimal[0] = small[0];
+	byte_t *end = decimal + SIZE_C(1);
+	uint64_t word = 0;
+	for(size_t u = 0; u < digits; u++) {
+		uint64_t digit = chunks[u / _BIJSON_BINARY_CHUNK_DIGITS]
+			/ _bijson_uint64_pow10((unsigned int)(u % _BIJSON_BINARY_CHUNK_DIGITS)) % UINT64_C(10);
+		word += digit * _bijson_uint64_pow10((unsigned int)(u % _BIJSON_BINARY_DECIMAL_WORD_DIGITS));
+		if(u + SIZE_C(1) == digits) {
+			end = _bijson_binary_put_decimal_word(end, word, true);
+		} else if((u + SIZE_C(1)) % _BIJSON_BINARY_DECIMAL_WORD_DIGITS == SIZE_C(0)) {
+			end = _bijson_binary_put_decimal_word(end, word, false);
+			word = 0;
+		}
+	}
+	free(chunks);
+
+	result->buffer = decimal;
+	result->size = _bijson_ptrdiff(end, decimal);
+	return NULL;
+}
+
+bijson_error_t _bijson_binary_integer_to_int64(const bijson_t *bijson, int64_t *result) {
+	const byte_t *buffer = bijson->buffer;
+	bool negative = *buffer & BYTE_C(0x1);
+	const byte_t *magnitude = buffer + SIZE_C(1);
+	size_t magnitude_size = _bijson_binary_magnitude_size(magnitude, bijson->size - SIZE_C(1));
+	if(magnitude_size > sizeof(uint64_t))
+		_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+
+	uint64_t value = magnitude_size ? _bijson_read_minimal_int(magnitude, magnitude_size) : UINT64_C(0);
+	if(negative) {
+		if(value > (uint64_t)INT64_MAX + UINT64_C(1))
+			_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+		// Avoids overflow for INT64_MIN
+		*result = value ? -(int64_t)(value - UINT64_C(1)) - INT64_C(1) : INT64_C(0);
+	} else {
+		if(value > (uint64_t)INT64_MAX)
+			_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+		*result = (int64_t)value;
+	}
+	return NULL;
+}
+
+bijson_error_t _bijson_binary_integer_to_double(const bijson_t *bijson, double *result) {
+	const byte_t *buffer = bijson->buffer;
+	bool negative = *buffer & BYTE_C(0x1);
+	const byte_t *magnitude = buffer + SIZE_C(1);
+	size_t magnitude_size = _bijson_binary_magnitude_size(magnitude, bijson->size - SIZE_C(1));
+
+	double value;
+	if(magnitude_size <= sizeof(uint64_t)) {
+		uint64_t integer = magnitude_size ? _bijson_read_minimal_int(magnitude, magnitude_size) : UINT64_C(0);
+		value = (double)integer;
+	} else {
+		// The most significant byte is not zero, so the top 64 bits hold at
+		// least 57 significant bits. Folding everything below them into the
+		// lowest bit makes them round the same way as the whole magnitude.
+		size_t low_size = magnitude_size - sizeof(uint64_t);
+		uint64_t top = _bijson_read_uint64(magnitude + low_size);
+		for(size_t u = 0; u < low_size; u++) {
+			if(magnitude[u]) {
+				top |= UINT64_C(1);
+				break;
+			}
+		}
+		if(low_size > (size_t)INT_MAX / SIZE_C(8))
+			value = HUGE_VAL;
+		else
+			value = ldexp((double)top, (int)(low_size * SIZE_C(8)));
+	}
+
+	*result = negative ? -value : value;
+	return NULL;
+}
+
+bijson_error_t _bijson_binary_float_to_double(const bijson_t *bijson, double *result) {
+	const byte_t *bits = (const byte_t *)bijson->buffer + SIZE_C(1);
+	double value;
+	switch(bijson->size - SIZE_C(1)) {
+		case SIZE_C(2): {
+			uint16_t half = _bijson_read_uint16(bits);
+			uint32_t exponent = (uint32_t)(half >> 10U) & UINT32_C(0x1F);
+			uint32_t mantissa = (uint32_t)half & UINT32_C(0x3FF);
+			if(exponent == UINT32_C(0x1F))
+				_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+			value = exponent
+				? ldexp((double)(mantissa | UINT32_C(0x400)), (int)exponent - 25)
+				: ldexp((double)mantissa, -24);
+			if(half & UINT16_C(0x8000))
+				value = -value;
+		} break;
+		case SIZE_C(4): {
+			uint32_t bits32 = _bijson_read_uint32(bits);
+			float single;
+			memcpy(&single, &bits32, sizeof single);
+			value = (double)single;
+		} break;
+		case SIZE_C(8): {
+			uint64_t bits64 = _bijson_read_uint64(bits);
+			memcpy(&value, &bits64, sizeof value);
+		} break;
+		default:
+			_BIJSON_RETURN_ERROR(bijson_error_unsupported_data_type);
+	}
+
+	if(!isfinite(value))
+		_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+
+	*result = value;
+	return NULL;
+}
+
+bijson_error_t _bijson_binary_float_to_int64(const bijson_t *bijson, int64_t *result) {
+	double value;
+	_BIJSON_RETURN_ON_ERROR(_bijson_binary_float_to_double(bijson, &value));
+	// Both bounds are powers of two and therefore exact
+	if(value != trunc(value) || value < -0x1p63 || value >= 0x1p63)
+		_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+	*result = (int64_t)value;
+	return NULL;
+}
+
+// Floats are converted to the shortest decimal that rounds back to the same
+// value using Ryu (Ulf Adams, "Ryū: fast float-to-string conversion", PLDI
+// 2018). The tables are the ones for binary64, which are precise enough for
+// the smaller formats as well, so one implementation serves all of them.
+
+// ceil(log2(5^e)), or 1 for e == 0. Valid for e <= 3528.
+__attribute__((const))
+static inline uint32_t _bijson_binary_pow5_bits(uint32_t e) {
+	return ((e * UINT32_C(1217359)) >> 19U) + UINT32_C(1);
+}
+
+// floor(log10(2^e)). Valid for e <= 1650.
+__attribute__((const))
+static inline uint32_t _bijson_binary_log10_pow2(uint32_t e) {
+	return (e * UINT32_C(78913)) >> 18U;
+}
+
+// floor(log10(5^e)). Valid for e <= 2620.
+__attribute__((const))
+static inline uint32_t _bijson_binary_log10_pow5(uint32_t e) {
+	return (e * UINT32_C(732923)) >> 20U;
+}
+
+__attribute__((const))
+static inline bool _bijson_binary_multiple_of_pow5(uint64_t value, uint32_t p) {
+	uint32_t count = 0;
+	while(value && !(value % UINT64_C(5))) {
+		value /= UINT64_C(5);
+		count++;
+	}
+	return count >= p;
+}
+
+__attribute__((const))
+static inline bool _bijson_binary_multiple_of_pow2(uint64_t value, uint32_t p) {
+	return !(value & ((UINT64_C(1) << p) - UINT64_C(1)));
+}
+
+// Computes (m * mul) >> j, where mul is a {low, high} pair and 64 < j < 128
+__attribute__((pure))
+static inline uint64_t _bijson_binary_mul_shift(uint64_t m, const uint64_t *mul, uint32_t j) {
+	assert(j > 64U && j < 128U);
+	uint64_t high, low_high;
+	uint64_t low = _bijson_umul128(m, mul[1], &high);
+	_bijson_umul128(m, mul[0], &low_high);
+	uint64_t sum = low_high + low;
+	if(sum < low_high)
+		high++;
+	uint32_t shift = j - 64U;
+	return (high << (64U - shift)) | (sum >> shift);
+}
+
+// Finds the shortest decimal significand and exponent in the rounding
+// interval of an IEEE 754 value that is finite and not zero.
+static inline void _bijson_binary_shortest(
+	uint64_t ieee_mantissa,
+	uint32_t ieee_exponent,
+	uint32_t mantissa_bits,
+	uint32_t bias,
+	uint64_t *significand_result,
+	int32_t *exponent_result
+) {
+	// Two extra bits so that the bounds of the interval are integers too
+	int32_t e2;
+	uint64_t m2;
+	if(ieee_exponent) {
+		e2 = (int32_t)ieee_exponent - (int32_t)(bias + mantissa_bits + UINT32_C(2));
+		m2 = (UINT64_C(1) << mantissa_bits) | ieee_mantissa;
+	} else {
+		e2 = INT32_C(1) - (int32_t)(bias + mantissa_bits + UINT32_C(2));
+		m2 = ieee_mantissa;
+	}
+	bool accept_bounds = !(m2 & UINT64_C(1));
+
+	// The interval is [mv - 1 - mm_shift, mv + 2] in units of 2^e2; the
+	// lower bound is closer where the exponent steps up.
+	uint64_t mv = m2 * UINT64_C(4);
+	uint32_t mm_shift = ieee_mantissa || ieee_exponent <= UINT32_C(1);
+
+	// Scale the interval by a power of ten
+	uint64_t vr, vp, vm;
+	int32_t e10;
+	bool vm_trailing_zeros = false;
+	bool vr_trailing_zeros = false;
+	if(e2 >= 0) {
+		uint32_t q = _bijson_binary_log10_pow2((uint32_t)e2) - (e2 > 3 ? UINT32_C(1) : UINT32_C(0));
+		e10 = (int32_t)q;
+		uint32_t k = _BIJSON_BINARY_POW5_INV_BITCOUNT + _bijson_binary_pow5_bits(q) - UINT32_C(1);
+		uint32_t i = q + k - (uint32_t)e2;
+		const uint64_t *mul = _bijson_binary_pow5_inv[q];
+		vr = _bijson_binary_mul_shift(mv, mul, i);
+		vp = _bijson_binary_mul_shift(mv + UINT64_C(2), mul, i);
+		vm = _bijson_binary_mul_shift(mv - UINT64_C(1) - mm_shift, mul, i);
+		if(q <= UINT32_C(21)) {
+			// At most one of mv, mp and mm can be a multiple of 5
+			if(!(mv % UINT64_C(5)))
+				vr_trailing_zeros = _bijson_binary_multiple_of_pow5(mv, q);
+			else if(accept_bounds)
+				vm_trailing_zeros = _bijson_binary_multiple_of_pow5(mv - UINT64_C(1) - mm_shift, q);
+			else
+				vp -= _bijson_binary_multiple_of_pow5(mv + UINT64_C(2), q);
+		}
+	} else {
+		uint32_t minus_e2 = (uint32_t)-e2;
+		uint32_t q = _bijson_binary_log10_pow5(minus_e2) - (minus_e2 > UINT32_C(1) ? UINT32_C(1) : UINT32_C(0));
+		e10 = (int32_t)q + e2;
+		uint32_t i = minus_e2 - q;
+		uint32_t j = q + _BIJSON_BINARY_POW5_BITCOUNT - _bijson_binary_pow5_bits(i);
+		const uint64_t *mul = _bijson_binary_pow5[i];
+		vr = _bijson_binary_mul_shift(mv, mul, j);
+		vp = _bijson_binary_mul_shift(mv + UINT64_C(2), mul, j);
+		vm = _bijson_binary_mul_shift(mv - UINT64_C(1) - mm_shift, mul, j);
+		if(q <= UINT32_C(1)) {
+			// mv has at least two trailing zero bits, mp one and mm one if
+			// mm_shift is set.
+			vr_trailing_zeros = true;
+			if(accept_bounds)
+				vm_trailing_zeros = mm_shift;
+			else
+				vp--;
+		} else if(q < UINT32_C(63)) {
+			vr_trailing_zeros = _bijson_binary_multiple_of_pow2(mv, q);
+		}
+	}
+
+	// Remove digits for as long as the interval still contains a number
+	int32_t removed = 0;
+	uint64_t output;
+	if(vm_trailing_zeros || vr_trailing_zeros) {
+		// Rare: the bounds or the value itself may be exact
+		uint64_t last_removed_digit = 0;
+		while(vp / UINT64_C(10) > vm / UINT64_C(10)) {
+			vm_trailing_zeros &= !(vm % UINT64_C(10));
+			vr_trailing_zeros &= !last_removed_digit;
+			last_removed_digit = vr % UINT64_C(10);
+			vr /= UINT64_C(10);
+			vp /= UINT64_C(10);
+			vm /= UINT64_C(10);
+			removed++;
+		}
+		if(vm_trailing_zeros) {
+			while(!(vm % UINT64_C(10))) {
+				vr_trailing_zeros &= !last_removed_digit;
+				last_removed_digit = vr % UINT64_C(10);
+				vr /= UINT64_C(10);
+				vp /= UINT64_C(10);
+				vm /= UINT64_C(10);
+				removed++;
+			}
+		}
+		// Round to even if the exact value is halfway
+		if(vr_trailing_zeros && last_removed_digit == UINT64_C(5) && !(vr & UINT64_C(1)))
+			last_removed_digit = UINT64_C(4);
+		output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed_digit >= UINT64_C(5));
+	} else {
+		bool round_up = false;
+		if(vp / UINT64_C(100) > vm / UINT64_C(100)) {
+			round_up = vr % UINT64_C(100) >= UINT64_C(50);
+			vr /= UINT64_C(100);
+			vp /= UINT64_C(100);
+			vm /= UINT64_C(100);
+			removed += 2;
+		}
+		while(vp / UINT64_C(10) > vm / UINT64_C(10)) {
+			round_up = vr % UINT64_C(10) >= UINT64_C(5);
+			vr /= UINT64_C(10);
+			vp /= UINT64_C(10);
+			vm /= UINT64_C(10);
+			removed++;
+		}
+		output = vr + (vr == vm || round_up);
+	}
+
+	// Rounding up may have produced a trailing zero
+	while(!(output % UINT64_C(10))) {
+		output /= UINT64_C(10);
+		removed++;
+	}
+
+	*significand_result = output;
+	*exponent_result = e10 + removed;
+}
+
+// Formats significand * 10^exponent like JavaScript does: plain notation
+// for numbers from 1e-6 up to 1e21, exponential notation otherwise.
+static inline bijson_error_t _bijson_binary_decimal_to_json(
+	bool negative,
+	uint64_t significand,
+	int32_t exponent,
+	bijson_output_callback_t callback,
+	void *callback_data
+) {
+	byte_t digits[20];
+	size_t count = _bijson_uint64_str(digits, significand);
+	// Position of the decimal point relative to the first digit
+	int32_t point = exponent + (int32_t)count;
+
+	byte_t chars[32];
+	byte_t *s = chars;
+	if(negative)
+		*s++ = '-';
+	if(exponent >= 0 && point <= 21) {
+		memcpy(s, digits, count);
+		s += count;
+		memset(s, '0', (size_t)exponent);
+		s += exponent;
+	} else if(point > 0 && point <= 21) {
+		memcpy(s, digits, (size_t)point);
+		s += point;
+		*s++ = '.';
+		memcpy(s, digits + point, count - (size_t)point);
+		s += count - (size_t)point;
+	} else if(point > -6 && point <= 0) {
+		*s++ = '0';
+		*s++ = '.';
+		memset(s, '0', (size_t)-point);
+		s += -point;
+		memcpy(s, digits, count);
+		s += count;
+	} else {
+		*s++ = digits[0];
+		if(count > SIZE_C(1)) {
+			*s++ = '.';
+			memcpy(s, digits + SIZE_C(1), count - SIZE_C(1));
+			s += count - SIZE_C(1);
+		}
+		*s++ = 'e';
+		int32_t e = point - 1;
+		if(e < 0) {
+			*s++ = '-';
+			e = -e;
+		}
+		s += _bijson_uint64_str(s, (uint64_t)e);
+	}
+
+	return _bijson_io_output(callback, callback_data, chars, _bijson_ptrdiff(s, chars));
+}
+
+bijson_error_t _bijson_binary_float_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data) {
+	const byte_t *buffer = bijson->buffer;
+	size_t size = bijson->size - SIZE_C(1);
+
+	uint32_t mantissa_bits, exponent_bits;
+	switch(size) {
+		case SIZE_C(2):
+			mantissa_bits = UINT32_C(10);
+			exponent_bits = UINT32_C(5);
+			break;
+		case SIZE_C(4):
+			mantissa_bits = UINT32_C(23);
+			exponent_bits = UINT32_C(8);
+			break;
+		case SIZE_C(8):
+			mantissa_bits = UINT32_C(52);
+			exponent_bits = UINT32_C(11);
+			break;
+		default:
+			_BIJSON_RETURN_ERROR(bijson_error_unsupported_data_type);
+	}
+
+	uint64_t bits = _bijson_read_minimal_int(buffer + SIZE_C(1), size);
+	bool negative = (bits >> (mantissa_bits + exponent_bits)) & UINT64_C(1);
+	uint64_t ieee_mantissa = bits & ((UINT64_C(1) << mantissa_bits) - UINT64_C(1));
+	uint32_t exponent_max = (UINT32_C(1) << exponent_bits) - UINT32_C(1);
+	uint32_t ieee_exponent = (uint32_t)(bits >> mantissa_bits) & exponent_max;
+
+	if(ieee_exponent == exponent_max)
+		_BIJSON_RETURN_ERROR(bijson_error_unsupported_data_type);
+
+	if(!ieee_exponent && !ieee_mantissa)
+		return negative
+			? _bijson_io_output(callback, callback_data, "-0", SIZE_C(2))
+			: _bijson_io_output(callback, callback_data, "0", SIZE_C(1));
+
+	uint64_t significand;
+	int32_t exponent;
+	_bijson_binary_shortest(ieee_mantissa, ieee_exponent, mantissa_bits, exponent_max >> 1U, &significand, &exponent);
+	return _bijson_binary_decimal_to_json(negative, significand, exponent, callback, callback_data);
+}
+
+bijson_error_t _bijson_binary_double_to_decimal(double value, byte_t *small, bijson_t *result) {
+	if(!isfinite(value))
+		_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof bits);
+	bool negative = bits >> 63U;
+	uint64_t ieee_mantissa = bits & ((UINT64_C(1) << 52U) - UINT64_C(1));
+	uint32_t ieee_exponent = (uint32_t)(bits >> 52U) & UINT32_C(0x7FF);
+
+	byte_t *end = small + SIZE_C(1);
+	small[0] = negative ? BYTE_C(0x1B) : BYTE_C(0x1A);
+	if(ieee_exponent || ieee_mantissa) {
+		uint64_t significand;
+		int32_t exponent;
+		_bijson_binary_shortest(ieee_mantissa, ieee_exponent, UINT32_C(52), UINT32_C(1023), &significand, &exponent);
+		if(exponent) {
+			small[0] = (byte_t)(BYTE_C(0x20)
+				| (negative ? BYTE_C(0x4) : BYTE_C(0x0))
+				| (exponent < 0 ? BYTE_C(0x8) : BYTE_C(0x0)));
+			// The exponent is a single word of at most two bytes, so its
+			// size fits in the one byte size field
+			uint64_t magnitude = exponent < 0 ? (uint64_t)-(int64_t)exponent : (uint64_t)exponent;
+			end = _bijson_binary_put_decimal_word(small + SIZE_C(2), magnitude, true);
+			small[1] = (byte_t)(_bijson_ptrdiff(end, small + SIZE_C(2)) - SIZE_C(1));
+		}
+		// At most 17 digits, so a single word
+		end = _bijson_binary_put_decimal_word(end, significand, true);
+	}
+
+	result->buffer = small;
+	result->size = _bijson_ptrdiff(end, small);
+	return NULL;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../common.h"
+#include "../reader.h"
+
+// Binary integers (0x18..0x19) of any length:
+extern bijson_error_t _bijson_binary_integer_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data);
+// Decimal integers take a type byte and 8 bytes per base 10^19 word, so
+// any 64-bit magnitude fits in this many bytes:
+#define _BIJSON_BINARY_DECIMAL_SMALL_SIZE SIZE_C(17)
+// Converts to the decimal integer (0x1A..0x1B) with the same value, for
+// comparing and hashing. The result is stored in small if it fits and
+// allocated otherwise; free it if result->buffer != small.
+extern bijson_error_t _bijson_binary_integer_to_decimal(const bijson_t *bijson, byte_t *small, bijson_t *result);
+// Sets *result to the number itself if it is a decimal, or to the decimal
+// with the same value if it is a binary integer. Release it with
+// _bijson_binary_decimal_free().
+static inline bijson_error_t _bijson_binary_as_decimal(
+	const bijson_t *number,
+	bijson_value_type_t type,
+	byte_t *small,
+	bijson_t *result
+) {
+	*result = *number;
+	if(type == bijson_value_type_integer)
+		return _bijson_binary_integer_to_decimal(number, small, result);
+	return NULL;
+}
+static inline void _bijson_binary_decimal_free(const bijson_t *number, const byte_t *small, const bijson_t *decimal) {
+	if(decimal->buffer != number->buffer && decimal->buffer != small)
+		free(_bijson_no_const(decimal->buffer));
+}
+// The decimal with the shortest representation that converts back to the
+// same double, which always fits in small. Infinity and NaN are reported as
+// bijson_error_value_out_of_range.
+extern bijson_error_t _bijson_binary_double_to_decimal(double value, byte_t *small, bijson_t *result);
+// Exact, or bijson_error_value_out_of_range if the value does not fit:
+extern bijson_error_t _bijson_binary_integer_to_int64(const bijson_t *bijson, int64_t *result);
+// Correctly rounded. Out of range values become infinite.
+extern bijson_error_t _bijson_binary_integer_to_double(const bijson_t *bijson, double *result);
+// IEEE 754 binary16, binary32 and binary64 floats (0x0A), using the shortest
+// representation that reads back as the same value. NaN and infinity have
+// no JSON representation and are reported as unsupported.
+extern bijson_error_t _bijson_binary_float_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data);
+// Exact. NaN and infinity are reported as bijson_error_value_out_of_range,
+// and so are values that are not integers or do not fit in an int64_t.
+extern bijson_error_t _bijson_binary_float_to_double(const bijson_t *bijson, double *result);
+extern bijson_error_t _bijson_binary_float_to_int64(const bijson_t *bijson, int64_t *result);
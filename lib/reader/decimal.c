@@ -1,231 +1,253 @@
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <float.h>
+
 #include "../common.h"
 #include "../reader.h"
+#include "../io.h"
+#include "../rapidhash.h"
 #include "decimal.h"
+#include "pow5.h"
 
-typedef struct _bijson_decimal_analysis {
-	bijson_t exponent;
-	bijson_t significand;
-	bool exponent_negative;
-	bool significand_negative;
-} _bijson_decimal_analysis;
-
-static inline bijson_error_t _bijson_decimal_analyze(const bijson_t *bijson, _bijson_decimal_analysis *analysis) {
-	const byte_t *buffer = bijson->buffer;
-	const byte_t *buffer_end = buffer + bijson->size;
-
-	byte_compute_t type = *buffer;
-	analysis->significand_negative = type & BYTE_C(0x4);
-	analysis->exponent_negative = type & BYTE_C(0x8);
-
-	const byte_t *exponent_size_location = buffer + SIZE_C(1);
-	if(exponent_size_location == buffer_end)
-		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
-
-	size_t exponent_size_size = SIZE_C(1) << (type & BYTE_C(0x3));
-	const byte_t *exponent_start = exponent_size_location + exponent_size_size;
-	if(exponent_start + SIZE_C(1) > buffer_end)
-		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
-	uint64_t raw_exponent_size = _bijson_read_minimal_int(exponent_size_location, exponent_size_size);
-	if(raw_exponent_size > SIZE_MAX - SIZE_C(1))
-		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
-	size_t exponent_size = (size_t)raw_exponent_size + SIZE_C(1);
-	if(exponent_size > _bijson_ptrdiff(buffer_end, exponent_start) - SIZE_C(1))
-		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+#define _BIJSON_DECIMAL_WORD_DIGITS 19U
+#define _BIJSON_DECIMAL_WORD_MAX UINT64_C(9999999999999999999)
+#define _BIJSON_DECIMAL_WORD_BASE UINT64_C(10000000000000000000)
 
-	const byte_t *significand_start = exponent_start + exponent_size;
-	analysis->significand.buffer = significand_start;
-	analysis->significand.size = _bijson_ptrdiff(buffer_end, significand_start);
-
-	analysis->exponent.buffer = exponent_start;
-	analysis->exponent.size = exponent_size;
+// Integers are accumulated in the widest type available so that the same
+// code serves all getters.
+#ifdef __SIZEOF_INT128__
+typedef uint128_t _bijson_decimal_magnitude_t;
+#else
+typedef uint64_t _bijson_decimal_magnitude_t;
+#endif
 
+// Reads word index (least significant first) of a significand or exponent
+// that consists of count words. The most significant word is stored minus
+// one and can be shorter than 8 bytes.
+static inline bijson_error_t _bijson_decimal_part_word(const bijson_t *part, size_t count, size_t index, uint64_t *result) {
+	const byte_t *buffer = part->buffer;
+	size_t offset = index * sizeof(uint64_t);
+	if(index == count - SIZE_C(1)) {
+		uint64_t word = _bijson_read_minimal_int(buffer + offset, part->size - offset);
+		if(word > _BIJSON_DECIMAL_WORD_MAX - UINT64_C(1))
+			_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+		*result = word + UINT64_C(1);
+	} else {
+		uint64_t word = _bijson_read_minimal_int(buffer + offset, sizeof(uint64_t));
+		if(word > _BIJSON_DECIMAL_WORD_MAX)
+			_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+		*result = word;
+	}
 	return NULL;
 }
 
-#if 0
-
-// bijson_error_t bijson_decimal_get_int8(const bijson_t *bijson, int8_t *result);
-// bijson_error_t bijson_decimal_get_uint8(const bijson_t *bijson, uint8_t *result, bool *negative_result);
-// bijson_error_t bijson_decimal_get_int16(const bijson_t *bijson, int16_t *result);
-// bijson_error_t bijson_decimal_get_uint16(const bijson_t *bijson, uint16_t *result, bool *negative_result);
-// bijson_error_t bijson_decimal_get_int32(const bijson_t *bijson, int32_t *result);
-// bijson_error_t bijson_decimal_get_uint32(const bijson_t *bijson, uint32_t *result, bool *negative_result);
-// bijson_error_t bijson_decimal_get_int64(const bijson_t *bijson, int64_t *result);
+__attribute__((pure))
+static inline size_t _bijson_decimal_part_count(const bijson_t *part) {
+	return (part->size + sizeof(uint64_t) - SIZE_C(1)) / sizeof(uint64_t);
+}
 
-bijson_error_t bijson_decimal_get_uint64(const bijson_t *bijson, uint64_t *result, bool *negative_result) {
-	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
+__attribute__((const))
+static inline unsigned int _bijson_decimal_word_digits(uint64_t word) {
+	unsigned int digits = 1U;
+	while(digits < _BIJSON_DECIMAL_WORD_DIGITS && word >= _bijson_uint64_pow10(digits))
+		digits++;
+	return digits;
+}
 
-	if(!result)
-		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+// Computes *result = *result * factor + addend, unless that would exceed max.
+static inline bool _bijson_decimal_multiply_add(
+	_bijson_decimal_magnitude_t *result,
+	uint64_t factor,
+	uint64_t addend,
+	_bijson_decimal_magnitude_t max
+) {
+	if(addend > max || *result > (max - addend) / factor)
+		return false;
+	*result = *result * factor + addend;
+	return true;
+}
 
+// Decodes a decimal that is an integer with a magnitude of at most max.
+// Anything else (including numbers with a fractional part) is out of range.
+static bijson_error_t _bijson_decimal_get_magnitude(
+	const bijson_t *bijson,
+	_bijson_decimal_magnitude_t max,
+	_bijson_decimal_magnitude_t *result,
+	bool *negative_result
+) {
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
 	const byte_t *buffer = bijson->buffer;
+	size_t size = bijson->size;
 	byte_compute_t type = *buffer;
 
-	uint64_t value = UINT64_C(0);
+	bijson_t significand;
+	uint64_t exponent = 0;
+	bool exponent_negative = false;
 
-	if((type & BYTE_C(0xF0)) == BYTE_C(0x20)) {
-		struct _bijson_decimal_analysis analysis;
+	if((type & BYTE_C(0xFE)) == BYTE_C(0x1A)) {
+		*negative_result = type & BYTE_C(0x1);
+		// Fast path for integers of up to 19 digits
+		if(size <= SIZE_C(9)) {
+			if(size == SIZE_C(1))
+				return *result = 0, NULL;
+			uint64_t word = _bijson_read_minimal_int(buffer + SIZE_C(1), size - SIZE_C(1));
+			if(word > _BIJSON_DECIMAL_WORD_MAX - UINT64_C(1))
+				_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+			word++;
+			if(word > max)
+				_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+			return *result = word, NULL;
+		}
+		significand.buffer = buffer + SIZE_C(1);
+		significand.size = size - SIZE_C(1);
+	} else if((type & BYTE_C(0xF0)) == BYTE_C(0x20)) {
+		_bijson_decimal_analysis analysis;
 		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_analyze(bijson, &analysis));
-
-		if(negative_result)
-			*negative_result = analysis.significand_negative;
-		else if(analysis.significand_negative)
+		*negative_result = analysis.significand_negative;
+		significand = analysis.significand;
+		// An empty significand denotes 0
+		if(!significand.size)
+			return *result = 0, NULL;
+		// The significand is not zero, so multiplying it by more than
+		// 10^(19 * 8) overflows any integer type and dividing it by that
+		// leaves a fractional part.
+		if(analysis.exponent.size > sizeof(uint64_t))
 			_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&analysis.exponent, SIZE_C(1), SIZE_C(0), &exponent));
+		exponent_negative = analysis.exponent_negative;
+	} else {
+		_BIJSON_RETURN_ERROR(bijson_error_type_mismatch);
+	}
 
-		if(!analysis.significand.size) {
-			*result = UINT64_C(0);
-			return NULL;
-		}
-
-		if(analysis.significand.size > SIZE_MAX - ((size_t)sizeof(uint64_t) - SIZE_C(1))
-			return bijson_error_value_out_of_range;
+	size_t count = _bijson_decimal_part_count(&significand);
+	_bijson_decimal_magnitude_t magnitude = 0;
 
-		size_t num_words = (analysis.significand.size + (size_t)sizeof(uint64_t) - SIZE_C(1))
-			/ (size_t)sizeof(uint64_t);
-		size_t last_word_index = num_words - SIZE_C(1);
-		size_t last_word_offset = last_word_index * (size_t)sizeof(uint64_t);
-		uint64_t last_word = _bijson_read_minimal_int(
-			analysis.significand.buffer + last_word_offset,
-			analysis.significand.size - last_word_offset
-		);
+	if(exponent_negative) {
+		// The value is only integral if the lowest exponent digits are zero
+		if(exponent >= (uint64_t)count * _BIJSON_DECIMAL_WORD_DIGITS)
+			_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+		size_t skip = (size_t)(exponent / _BIJSON_DECIMAL_WORD_DIGITS);
+		unsigned int shift = (unsigned int)(exponent % _BIJSON_DECIMAL_WORD_DIGITS);
 
-		if(last_word > UINT64_C(9999999999999999998))
-			_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
-		last_word++;
-
-		if(analysis.exponent_negative) {
-			if(analysis.exponent.size > sizeof(size_t)) {
-				*result = UINT64_C(0);
-				return NULL;
-			}
-			size_t exponent = (size_t)_bijson_read_minimal_int(analysis.exponent.buffer, analysis.exponent.size);
-			size_t shift_skip = exponent / SIZE_C(19);
-			size_t shift = exponent - shift_skip * SIZE_C(19);
-
-			if(shift_skip >= num_words) {
-				*result = UINT64_C(0);
-				return NULL;
-			}
-
-			if(num_words - shift_skip > SIZE_C(2)) // adjust for larger types
-				return bijson_error_value_out_of_range;
-
-			if(shift) {
-				for(size_t word_index = shift_skip; word_index <= last_word_index; word_index++) {
-					uint64_t word = word_index == last_word_index
-						? last_word
-						: _bijson_read_minimal_int(
-								analysis.significand.buffer + word_index * sizeof(uint64_t),
-								sizeof(uint64_t)
-							);
-					if(word > UINT64_C(9999999999999999999))
-						_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
-
-					if(word_index == shift_skip)
-						word /= _bijson_uint64_pow10(shift);
-					else
-						// FIXME: check for overflow
-						word *= _bijson_uint64_pow10(SIZE_C(19) * (word_index - shift_skip) - shift);
-					value += word; // FIXME: check for overflow
-				}
-			} else {
-				for(size_t word_index = shift_skip; word_index <= last_word_index; word_index++) {
-					uint64_t word = word_index == last_word_index
-						? last_word
-						: _bijson_read_minimal_int(
-								analysis.significand.buffer + word_index * sizeof(uint64_t),
-								sizeof(uint64_t)
-							);
-					if(word_index != shift_skip)
-						// FIXME: check for overflow
-						word *= _bijson_uint64_pow10(SIZE_C(19) * (word_index - shift_skip));
-					value += word; // FIXME: check for overflow
-				}
-			}
-		} else {
-			if(num_words > SIZE_C(2)) // adjust for larger types
-				return bijson_error_value_out_of_range;
-			if(exponent_size > sizeof(size_t))
-				return bijson_error_value_out_of_range;
-			size_t exponent = SIZE_C(10);
-			if(exponent + last_word_index * SIZE_C(19) > SIZE_C(19)) // adjust for larger types
-				return bijson_error_value_out_of_range;
-
-			for(size_t word_index = SIZE_C(0); word_index <= last_word_index; word_index++) {
-				uint64_t word = word_index == last_word_index
-					? last_word
-					: _bijson_read_minimal_int(
-							analysis.significand.buffer + word_index * sizeof(uint64_t),
-							sizeof(uint64_t)
-						);
-				// FIXME: check for overflow
-				word *= _bijson_uint64_pow10(SIZE_C(19) * word_index + exponent);
-				value += word; // FIXME: check for overflow
-			}
+		uint64_t word;
+		for(size_t u = 0; u < skip; u++) {
+			_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&significand, count, u, &word));
+			if(word)
+				_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
 		}
-	} else if((type & BYTE_C(0xFE)) == BYTE_C(0x1A)) {
-		bool significand_negative = type & BYTE_C(0x1);
-		if(negative_result)
-			*negative_result = significand_negative;
-		else if(significand_negative)
+
+		uint64_t low;
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&significand, count, skip, &low));
+		uint64_t divisor = _bijson_uint64_pow10(shift);
+		if(low % divisor)
 			_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+		low /= divisor;
 
-		size_t significand_size = buffer.size - SIZE_C(1);
-		if(significand_size > SIZE_MAX - ((size_t)sizeof(uint64_t) - SIZE_C(1))
-			return bijson_error_value_out_of_range;
-
-		size_t num_words = (significand_size + (size_t)sizeof(uint64_t) - SIZE_C(1))
-			/ (size_t)sizeof(uint64_t);
-		size_t last_word_index = num_words - SIZE_C(1);
-		size_t last_word_offset = last_word_index * (size_t)sizeof(uint64_t);
-		uint64_t last_word = _bijson_read_minimal_int(
-			buffer + SIZE_C(1) + last_word_offset,
-			analysis.significand_size - last_word_offset
-		);
-
-		if(num_words > SIZE_C(2))  // adjust for larger types
-			return bijson_error_value_out_of_range;
-
-		for(size_t word_index = SIZE_C(0); word_index <= last_word_index; word_index++) {
-			uint64_t word = word_index == last_word_index
-				? last_word
-				: _bijson_read_minimal_int(
-						analysis.significand.buffer + word_index * sizeof(uint64_t),
-						sizeof(uint64_t)
-					);
-			// FIXME: check for overflow
-			word *= _bijson_uint64_pow10(SIZE_C(19) * word_index);
-			value += word; // FIXME: check for overflow
+		for(size_t u = count - SIZE_C(1); u > skip; u--) {
+			_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&significand, count, u, &word));
+			if(!_bijson_decimal_multiply_add(&magnitude, _BIJSON_DECIMAL_WORD_BASE, word, max))
+				_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
 		}
+		// The remaining digits of the lowest word that is not skipped
+		uint64_t factor = skip < count - SIZE_C(1)
+			? _bijson_uint64_pow10(_BIJSON_DECIMAL_WORD_DIGITS - shift)
+			: UINT64_C(1);
+		if(!_bijson_decimal_multiply_add(&magnitude, factor, low, max))
+			_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
 	} else {
-		_BIJSON_RETURN_ERROR(bijson_error_type_mismatch);
+		for(size_t u = count; u; u--) {
+			uint64_t word;
+			_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&significand, count, u - SIZE_C(1), &word));
+			if(!_bijson_decimal_multiply_add(&magnitude, _BIJSON_DECIMAL_WORD_BASE, word, max))
+				_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+		}
+		// The magnitude is at least 1 here, so each step multiplies it by
+		// at least 10 and this loop runs at most 39 times.
+		for(; exponent; exponent--)
+			if(!_bijson_decimal_multiply_add(&magnitude, UINT64_C(10), UINT64_C(0), max))
+				_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
 	}
 
-	*result = value;
+	*result = magnitude;
 	return NULL;
 }
 
-#ifdef __SIZEOF_INT128__
+#define _BIJSON_DECIMAL_GET_INTEGER(bits) \
+	bijson_error_t bijson_decimal_get_int##bits(const bijson_t *bijson, int##bits##_t *result) { \
+		if(!result) \
+			_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null); \
+		_bijson_decimal_magnitude_t magnitude; \
+		bool negative; \
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_get_magnitude( \
+			bijson, \
+			(_bijson_decimal_magnitude_t)INT##bits##_MAX + 1U, \
+			&magnitude, \
+			&negative \
+		)); \
+		if(negative) { \
+			/* Negate without overflowing for the minimum value */ \
+			*result = magnitude \
+				? (int##bits##_t)(-(int##bits##_t)(magnitude - 1U) - 1) \
+				: (int##bits##_t)0; \
+		} else { \
+			if(magnitude > INT##bits##_MAX) \
+				_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range); \
+			*result = (int##bits##_t)magnitude; \
+		} \
+		return NULL; \
+	} \
+	\
+	bijson_error_t bijson_decimal_get_uint##bits(const bijson_t *bijson, uint##bits##_t *result, bool *negative_result) { \
+		if(!result) \
+			_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null); \
+		_bijson_decimal_magnitude_t magnitude; \
+		bool negative; \
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_get_magnitude(bijson, UINT##bits##_MAX, &magnitude, &negative)); \
+		if(negative_result) \
+			*negative_result = negative; \
+		else if(negative && magnitude) \
+			_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range); \
+		*result = (uint##bits##_t)magnitude; \
+		return NULL; \
+	}
 
-__attribute__((const))
-inline __uint128_t _bijson_uint128_pow10(unsigned int exp) {
-	assert(exp < 39U);
-	__uint128_t magnitude = 1U;
-	__uint128_t magnitude_base = 10U;
-	// integer exponentiation
-	while(exp) {
-		if(exp & 1U)
-			magnitude *= magnitude_base;
-		magnitude_base *= magnitude_base;
-		exp >>= 1U;
+_BIJSON_DECIMAL_GET_INTEGER(8)
+_BIJSON_DECIMAL_GET_INTEGER(16)
+_BIJSON_DECIMAL_GET_INTEGER(32)
+_BIJSON_DECIMAL_GET_INTEGER(64)
+
+#ifdef __SIZEOF_INT128__
+bijson_error_t bijson_decimal_get_int128(const bijson_t *bijson, int128_t *result) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	uint128_t magnitude;
+	bool negative;
+	uint128_t min_magnitude = (uint128_t)1 << 127U;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_get_magnitude(bijson, min_magnitude, &magnitude, &negative));
+	if(negative) {
+		*result = magnitude ? -(int128_t)(magnitude - 1U) - 1 : 0;
+	} else {
+		if(magnitude == min_magnitude)
+			_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+		*result = (int128_t)magnitude;
 	}
-	return magnitude;
+	return NULL;
 }
 
-bijson_error_t bijson_decimal_get_int128(const bijson_t *bijson, __int128_t *result);
-bijson_error_t bijson_decimal_get_uint128(const bijson_t *bijson, __uint128_t *result, bool *negative_result);
-#endif
-
+bijson_error_t bijson_decimal_get_uint128(const bijson_t *bijson, uint128_t *result, bool *negative_result) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	uint128_t magnitude;
+	bool negative;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_get_magnitude(bijson, ~(uint128_t)0, &magnitude, &negative));
+	if(negative_result)
+		*negative_result = negative;
+	else if(negative && magnitude)
+		_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+	*result = magnitude;
+	return NULL;
+}
 #endif
 
 // Convert separate numeric bits (mantissa, exponent) to JSON
@@ -242,7 +264,8 @@ static inline bijson_error_t _bijson_decimal_part_to_json(const bijson_t *bijson
 	last_word++;
 
 	byte_t word_chars[20];
-	_BIJSON_RETURN_ON_ERROR(callback(
+	_BIJSON_RETURN_ON_ERROR(_bijson_io_output(
+		callback,
 		callback_data,
 		word_chars,
 		_bijson_uint64_str(word_chars, last_word)
@@ -254,10 +277,13 @@ static inline bijson_error_t _bijson_decimal_part_to_json(const bijson_t *bijson
 		uint64_t word = _bijson_read_minimal_int(word_start, sizeof(uint64_t));
 		if(word > UINT64_C(9999999999999999999))
 			_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
-		_BIJSON_RETURN_ON_ERROR(callback(
+		// Words hold 19 digits, so the first of the 20 padded digits is
+		// always zero.
+		_BIJSON_RETURN_ON_ERROR(_bijson_io_output(
+			callback,
 			callback_data,
-			word_chars,
-			_bijson_uint64_str_padded(word_chars, word)
+			word_chars + SIZE_C(1),
+			_bijson_uint64_str_padded(word_chars, word) - SIZE_C(1)
 		));
 	}
 
@@ -270,11 +296,11 @@ bijson_error_t _bijson_decimal_to_json(const bijson_t *bijson, bijson_output_cal
 	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_analyze(bijson, &analysis));
 
 	if(analysis.significand_negative)
-		_BIJSON_RETURN_ON_ERROR(callback(callback_data, "-", SIZE_C(1)));
+		_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, "-", SIZE_C(1)));
 	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_to_json(&analysis.significand, callback, callback_data));
-	_BIJSON_RETURN_ON_ERROR(callback(callback_data, "e", SIZE_C(1)));
+	_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, "e", SIZE_C(1)));
 	if(analysis.exponent_negative)
-		_BIJSON_RETURN_ON_ERROR(callback(callback_data, "-", SIZE_C(1)));
+		_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, "-", SIZE_C(1)));
 	return _bijson_decimal_part_to_json(&analysis.exponent, callback, callback_data);
 }
 
@@ -285,10 +311,10 @@ bijson_error_t _bijson_decimal_integer_to_json(const bijson_t *bijson, bijson_ou
 
 	byte_compute_t type = *buffer;
 	if(type & BYTE_C(0x1))
-		_BIJSON_RETURN_ON_ERROR(callback(callback_data, "-", SIZE_C(1)));
+		_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, "-", SIZE_C(1)));
 
 	if(size == SIZE_C(1))
-		return callback(callback_data, "0", SIZE_C(1));
+		return _bijson_io_output(callback, callback_data, "0", SIZE_C(1));
 
 	bijson_t integer = {
 		buffer + SIZE_C(1),
@@ -296,3 +322,728 @@ bijson_error_t _bijson_decimal_integer_to_json(const bijson_t *bijson, bijson_ou
 	};
 	return _bijson_decimal_part_to_json(&integer, callback, callback_data);
 }
+
+// Check that all words of a numeric part are in range
+static inline bijson_error_t _bijson_decimal_part_verify(const bijson_t *bijson) {
+	const byte_t *buffer = bijson->buffer;
+	size_t size = bijson->size;
+
+	size_t last_word_size = ((size - SIZE_C(1)) & SIZE_C(0x7)) + SIZE_C(1);
+
+	const byte_t *last_word_start = buffer + size - last_word_size;
+	uint64_t last_word = _bijson_read_minimal_int(last_word_start, last_word_size);
+	if(last_word > UINT64_C(9999999999999999998))
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+
+	for(const byte_t *word_start = buffer; word_start < last_word_start; word_start += sizeof(uint64_t))
+		if(_bijson_read_minimal_int(word_start, sizeof(uint64_t)) > UINT64_C(9999999999999999999))
+			_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+
+	return NULL;
+}
+
+__attribute__((pure))
+bijson_error_t _bijson_decimal_verify(const bijson_t *bijson) {
+	struct _bijson_decimal_analysis analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_analyze(bijson, &analysis));
+
+	// An empty significand denotes 0
+	if(analysis.significand.size)
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_verify(&analysis.significand));
+	return _bijson_decimal_part_verify(&analysis.exponent);
+}
+
+__attribute__((pure))
+bijson_error_t _bijson_decimal_integer_verify(const bijson_t *bijson) {
+	if(bijson->size == SIZE_C(1))
+		return NULL;
+
+	bijson_t integer = {
+		(const byte_t *)bijson->buffer + SIZE_C(1),
+		bijson->size - SIZE_C(1),
+	};
+	return _bijson_decimal_part_verify(&integer);
+}
+
+typedef struct _bijson_decimal_text {
+	char small[64];
+	char *buffer;
+	size_t used;
+	size_t size;
+} _bijson_decimal_text_t;
+
+static bijson_error_t _bijson_decimal_text_output_callback(void *output_callback_data, const void *data, size_t len) {
+	_bijson_decimal_text_t *text = output_callback_data;
+	// Keep one byte for the terminating NUL
+	if(len >= text->size - text->used) {
+		if(len > SIZE_MAX / SIZE_C(2) - text->used)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		size_t size = (text->used + len) * SIZE_C(2);
+		char *buffer = text->buffer == text->small ? malloc(size) : realloc(text->buffer, size);
+		if(!buffer)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+		if(text->buffer == text->small)
+			memcpy(buffer, text->small, text->used);
+		text->buffer = buffer;
+		text->size = size;
+	}
+	memcpy(text->buffer + text->used, data, len);
+	text->used += len;
+	return NULL;
+}
+
+// On success, the caller must free text->buffer if it's not text->small.
+static bijson_error_t _bijson_decimal_text(const bijson_t *bijson, _bijson_decimal_text_t *text) {
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
+
+	text->buffer = text->small;
+	text->used = 0;
+	text->size = sizeof text->small;
+
+	byte_compute_t type = *(const byte_t *)bijson->buffer;
+	bijson_error_t error;
+	if((type & BYTE_C(0xF0)) == BYTE_C(0x20))
+		error = _bijson_decimal_to_json(bijson, _bijson_decimal_text_output_callback, text);
+	else if((type & BYTE_C(0xFE)) == BYTE_C(0x1A))
+		error = _bijson_decimal_integer_to_json(bijson, _bijson_decimal_text_output_callback, text);
+	else
+		_BIJSON_RETURN_ERROR(bijson_error_type_mismatch);
+
+	if(error) {
+		if(text->buffer != text->small)
+			free(text->buffer);
+		return error;
+	}
+
+	text->buffer[text->used] = '\0';
+	return NULL;
+}
+
+bijson_error_t _bijson_decimal_get_double_text(const bijson_t *bijson, double *result) {
+	_bijson_decimal_text_t text;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_text(bijson, &text));
+	*result = strtod(text.buffer, NULL);
+	if(text.buffer != text.small)
+		free(text.buffer);
+	return NULL;
+}
+
+bijson_error_t _bijson_decimal_get_float_text(const bijson_t *bijson, float *result) {
+	_bijson_decimal_text_t text;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_text(bijson, &text));
+	*result = strtof(text.buffer, NULL);
+	if(text.buffer != text.small)
+		free(text.buffer);
+	return NULL;
+}
+
+#ifdef LDBL_DIG
+static bijson_error_t _bijson_decimal_get_long_double_text(const bijson_t *bijson, long double *result) {
+	_bijson_decimal_text_t text;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_text(bijson, &text));
+	*result = strtold(text.buffer, NULL);
+	if(text.buffer != text.small)
+		free(text.buffer);
+	return NULL;
+}
+#endif
+
+// Exponents beyond this overflow or underflow any supported floating point
+// type, no matter the significand.
+#define _BIJSON_DECIMAL_EXPONENT_LIMIT INT64_C(100000)
+
+// A decimal reduced to at most 19 significant digits: its value is
+// significand * 10^exponent, or slightly more if truncated is set.
+typedef struct _bijson_decimal_approximation {
+	uint64_t significand;
+	int64_t exponent;
+	bool negative;
+	bool truncated;
+} _bijson_decimal_approximation_t;
+
+__attribute__((const))
+static inline int64_t _bijson_decimal_clamp_exponent(int64_t exponent) {
+	if(exponent > _BIJSON_DECIMAL_EXPONENT_LIMIT)
+		return _BIJSON_DECIMAL_EXPONENT_LIMIT;
+	if(exponent < -_BIJSON_DECIMAL_EXPONENT_LIMIT)
+		return -_BIJSON_DECIMAL_EXPONENT_LIMIT;
+	return exponent;
+}
+
+static bijson_error_t _bijson_decimal_approximate(const bijson_t *bijson, _bijson_decimal_approximation_t *result) {
+	const byte_t *buffer = bijson->buffer;
+	size_t size = bijson->size;
+	byte_compute_t type = *buffer;
+
+	bijson_t significand;
+	int64_t exponent = 0;
+
+	if((type & BYTE_C(0xFE)) == BYTE_C(0x1A)) {
+		result->negative = type & BYTE_C(0x1);
+		significand.buffer = buffer + SIZE_C(1);
+		significand.size = size - SIZE_C(1);
+	} else if((type & BYTE_C(0xF0)) == BYTE_C(0x20)) {
+		_bijson_decimal_analysis analysis;
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_analyze(bijson, &analysis));
+		result->negative = analysis.significand_negative;
+		significand = analysis.significand;
+		if(analysis.exponent.size > sizeof(uint64_t)) {
+			exponent = _BIJSON_DECIMAL_EXPONENT_LIMIT;
+		} else {
+			uint64_t word;
+			_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&analysis.exponent, SIZE_C(1), SIZE_C(0), &word));
+			exponent = word > (uint64_t)_BIJSON_DECIMAL_EXPONENT_LIMIT
+				? _BIJSON_DECIMAL_EXPONENT_LIMIT
+				: (int64_t)word;
+		}
+		if(analysis.exponent_negative)
+			exponent = -exponent;
+	} else {
+		_BIJSON_RETURN_ERROR(bijson_error_type_mismatch);
+	}
+
+	result->truncated = false;
+	if(!significand.size) {
+		result->significand = 0;
+		result->exponent = 0;
+		return NULL;
+	}
+
+	size_t count = _bijson_decimal_part_count(&significand);
+	uint64_t top;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&significand, count, count - SIZE_C(1), &top));
+	if(count == SIZE_C(1)) {
+		result->significand = top;
+		result->exponent = exponent;
+		return NULL;
+	}
+
+	// Fill up the top word with the leading digits of the next one
+	unsigned int digits = _bijson_decimal_word_digits(top);
+	uint64_t next;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&significand, count, count - SIZE_C(2), &next));
+	uint64_t divisor = _bijson_uint64_pow10(digits);
+	result->significand = top * _bijson_uint64_pow10(_BIJSON_DECIMAL_WORD_DIGITS - digits) + next / divisor;
+	result->truncated = next % divisor;
+	for(size_t u = count - SIZE_C(2); u && !result->truncated; u--) {
+		uint64_t word;
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&significand, count, u - SIZE_C(1), &word));
+		result->truncated = word;
+	}
+
+	// The number of digits that were dropped
+	size_t dropped_words = count - SIZE_C(2);
+	int64_t dropped = dropped_words > (size_t)(_BIJSON_DECIMAL_EXPONENT_LIMIT / _BIJSON_DECIMAL_WORD_DIGITS)
+		? _BIJSON_DECIMAL_EXPONENT_LIMIT
+		: (int64_t)dropped_words * _BIJSON_DECIMAL_WORD_DIGITS + (int64_t)digits;
+	result->exponent = _bijson_decimal_clamp_exponent(exponent + dropped);
+	return NULL;
+}
+
+typedef struct _bijson_decimal_binary_format {
+	unsigned int mantissa_bits;
+	int minimum_exponent;
+	int infinite_power;
+	// Outside this range the result is always zero or infinity
+	int64_t smallest_power;
+	int64_t largest_power;
+	// Only in this range can a product be exactly halfway between two
+	// representable values.
+	int64_t min_round_to_even;
+	int64_t max_round_to_even;
+} _bijson_decimal_binary_format_t;
+
+static const _bijson_decimal_binary_format_t _bijson_decimal_binary64 = {52U, -1023, 0x7FF, -342, 308, -4, 23};
+static const _bijson_decimal_binary_format_t _bijson_decimal_binary32 = {23U, -127, 0xFF, -65, 38, -17, 10};
+
+__attribute__((const))
+static inline unsigned int _bijson_decimal_clz64(uint64_t x) {
+#ifdef HAVE_BUILTIN_CLZLL
+	return (unsigned int)__builtin_clzll(x);
+#else
+	unsigned int result = 0U;
+	while(!(x & UINT64_C(0x8000000000000000))) {
+		x <<= 1U;
+		result++;
+	}
+	return result;
+#endif
+}
+
+// The Eisel-Lemire algorithm: computes the correctly rounded binary
+// representation (without the sign) of significand * 10^exponent, for a
+// non-zero significand. Mushtak and Lemire have shown that the 128-bit
+// product is always precise enough for binary32 and binary64, so this never
+// needs to give up.
+static uint64_t _bijson_decimal_eisel_lemire(const _bijson_decimal_binary_format_t *format, uint64_t significand, int64_t exponent) {
+	unsigned int mantissa_bits = format->mantissa_bits;
+	if(exponent < format->smallest_power)
+		return 0;
+	if(exponent > format->largest_power)
+		return (uint64_t)format->infinite_power << mantissa_bits;
+
+	unsigned int leading_zeros = _bijson_decimal_clz64(significand);
+	significand <<= leading_zeros;
+
+	const uint64_t *power = _bijson_decimal_pow5[exponent - _BIJSON_DECIMAL_POW5_MIN];
+	uint64_t high;
+	uint64_t low = _bijson_umul128(significand, power[0], &high);
+	uint64_t precision_mask = UINT64_MAX >> (mantissa_bits + 3U);
+	if((high & precision_mask) == precision_mask) {
+		// The lower bits are all ones, so the carry from the rest of the
+		// product matters.
+		uint64_t second_high;
+		_bijson_umul128(significand, power[1], &second_high);
+		low += second_high;
+		if(second_high > low)
+			high++;
+	}
+
+	unsigned int upper_bit = (unsigned int)(high >> 63U);
+	unsigned int shift = upper_bit + 64U - mantissa_bits - 3U;
+	uint64_t mantissa = high >> shift;
+	// floor(log2(10^exponent)) + 63, computed as in the paper
+	int64_t power2 = ((INT64_C(217706) * exponent) >> 16U) + 63
+		+ (int64_t)upper_bit - (int64_t)leading_zeros - format->minimum_exponent;
+
+	if(power2 <= 0) {
+		// Subnormal (or zero)
+		if(-power2 + 1 >= 64)
+			return 0;
+		mantissa >>= -power2 + 1;
+		mantissa += mantissa & UINT64_C(1);
+		mantissa >>= 1U;
+		// Rounding up may have made it the smallest normal number, in
+		// which case the mantissa overflows into the exponent.
+		return mantissa;
+	}
+
+	// Exactly halfway between two values: round to even
+	if(low <= UINT64_C(1)
+		&& exponent >= format->min_round_to_even
+		&& exponent <= format->max_round_to_even
+		&& (mantissa & UINT64_C(3)) == UINT64_C(1)
+		&& (mantissa << shift) == high
+	)
+		mantissa &= ~UINT64_C(1);
+
+	mantissa += mantissa & UINT64_C(1);
+	mantissa >>= 1U;
+	if(mantissa >= UINT64_C(2) << mantissa_bits) {
+		mantissa = UINT64_C(1) << mantissa_bits;
+		power2++;
+	}
+	mantissa &= ~(UINT64_C(1) << mantissa_bits);
+	if(power2 >= format->infinite_power)
+		return (uint64_t)format->infinite_power << mantissa_bits;
+
+	return mantissa | (uint64_t)power2 << mantissa_bits;
+}
+
+// Like _bijson_decimal_eisel_lemire(), but returns false if the significand
+// was truncated and that affects the result.
+static inline bool _bijson_decimal_binary(
+	const _bijson_decimal_binary_format_t *format,
+	const _bijson_decimal_approximation_t *approximation,
+	uint64_t *result
+) {
+	uint64_t bits = _bijson_decimal_eisel_lemire(format, approximation->significand, approximation->exponent);
+	if(approximation->truncated
+		&& bits != _bijson_decimal_eisel_lemire(format, approximation->significand + UINT64_C(1), approximation->exponent)
+	)
+		return false;
+	*result = bits;
+	return true;
+}
+
+bijson_error_t _bijson_decimal_to_double(const bijson_t *bijson, double *result) {
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
+	_bijson_decimal_approximation_t approximation;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_approximate(bijson, &approximation));
+
+	double value;
+	if(!approximation.significand) {
+		value = 0.0;
+	} else if(!approximation.truncated && _bijson_decimal_small_to_double(approximation.significand, approximation.exponent, &value)) {
+		// Exact
+	} else {
+		uint64_t bits;
+		if(!_bijson_decimal_binary(&_bijson_decimal_binary64, &approximation, &bits))
+			return _bijson_decimal_get_double_text(bijson, result);
+		memcpy(&value, &bits, sizeof value);
+	}
+
+	*result = approximation.negative ? -value : value;
+	return NULL;
+}
+
+bijson_error_t _bijson_decimal_to_float(const bijson_t *bijson, float *result) {
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
+	_bijson_decimal_approximation_t approximation;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_approximate(bijson, &approximation));
+
+	float value;
+	if(!approximation.significand) {
+		value = 0.0f;
+	} else if(!approximation.truncated && _bijson_decimal_small_to_float(approximation.significand, approximation.exponent, &value)) {
+		// Exact
+	} else {
+		uint64_t bits;
+		if(!_bijson_decimal_binary(&_bijson_decimal_binary32, &approximation, &bits))
+			return _bijson_decimal_get_float_text(bijson, result);
+		uint32_t bits32 = (uint32_t)bits;
+		memcpy(&value, &bits32, sizeof value);
+	}
+
+	*result = approximation.negative ? -value : value;
+	return NULL;
+}
+
+#ifdef __SIZEOF_INT128__
+double _bijson_decimal_int128_to_double(int128_t value, int64_t exponent) {
+	if(!value)
+		return 0.0;
+
+	bool negative = value < 0;
+	uint128_t magnitude = negative ? -(uint128_t)value : (uint128_t)value;
+
+	// Reduce to at most 19 digits
+	_bijson_decimal_approximation_t approximation = {.negative = negative};
+	uint128_t reduced = magnitude;
+	int64_t dropped = 0;
+	while(reduced > (uint128_t)_BIJSON_DECIMAL_WORD_MAX) {
+		if(reduced % 10U)
+			approximation.truncated = true;
+		reduced /= 10U;
+		dropped++;
+	}
+	approximation.significand = (uint64_t)reduced;
+	approximation.exponent = _bijson_decimal_clamp_exponent(_bijson_decimal_clamp_exponent(exponent) + dropped);
+
+	double result;
+	uint64_t bits;
+	if(!approximation.truncated && _bijson_decimal_small_to_double(approximation.significand, approximation.exponent, &result)) {
+		// Exact
+	} else if(_bijson_decimal_binary(&_bijson_decimal_binary64, &approximation, &bits)) {
+		memcpy(&result, &bits, sizeof result);
+	} else {
+		// Too close to call with 19 digits, so write out all of them
+		char digits[40];
+		size_t count = 0;
+		do {
+			digits[count++] = (char)('0' + (int)(magnitude % 10U));
+			magnitude /= 10U;
+		} while(magnitude);
+		char text[64];
+		size_t len = 0;
+		while(count)
+			text[len++] = digits[--count];
+		snprintf(text + len, sizeof text - len, "e%" PRId64, exponent);
+		result = strtod(text, NULL);
+	}
+
+	return negative ? -result : result;
+}
+#endif
+
+bijson_error_t bijson_decimal_get_double(const bijson_t *bijson, double *result) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	double value;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_to_double(bijson, &value));
+	if(isinf(value))
+		_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+	*result = value;
+	return NULL;
+}
+
+bijson_error_t bijson_decimal_get_float(const bijson_t *bijson, float *result) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	float value;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_to_float(bijson, &value));
+	if(isinf(value))
+		_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+	*result = value;
+	return NULL;
+}
+
+#ifdef LDBL_DIG
+bijson_error_t bijson_decimal_get_long_double(const bijson_t *bijson, long double *result) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
+	byte_compute_t type = *(const byte_t *)bijson->buffer;
+	if((type & BYTE_C(0xFE)) != BYTE_C(0x1A) && (type & BYTE_C(0xF0)) != BYTE_C(0x20))
+		_BIJSON_RETURN_ERROR(bijson_error_type_mismatch);
+	long double value;
+	// There is no fast path for the many different long double formats
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_get_long_double_text(bijson, &value));
+	if(isinf(value))
+		_BIJSON_RETURN_ERROR(bijson_error_value_out_of_range);
+	*result = value;
+	return NULL;
+}
+#endif
+
+// Decimals are ordered by sign, then by the position of their leading digit
+// (the exponent plus the number of significand digits) and finally digit by
+// digit, 19 at a time. Positions are computed exactly up to a limit; beyond
+// that they are clamped and ties between clamped positions are broken by
+// the exponent and then the number of digits, so for exponents that large
+// the order is consistent but not numerically exact.
+#ifdef __SIZEOF_INT128__
+typedef int128_t _bijson_decimal_position_t;
+#define _BIJSON_DECIMAL_POSITION_LIMIT ((_bijson_decimal_magnitude_t)1 << 100U)
+#else
+typedef int64_t _bijson_decimal_position_t;
+#define _BIJSON_DECIMAL_POSITION_LIMIT ((_bijson_decimal_magnitude_t)1 << 61U)
+#endif
+
+typedef struct _bijson_decimal_order {
+	bijson_t significand;
+	bijson_t exponent;
+	size_t significand_count;
+	size_t exponent_count;
+	// Digits in the most significant word of the significand
+	unsigned int digits;
+	_bijson_decimal_position_t position;
+	bool negative;
+	bool exponent_negative;
+	bool clamped;
+} _bijson_decimal_order_t;
+
+static bijson_error_t _bijson_decimal_order_analyze(const bijson_t *bijson, _bijson_decimal_order_t *result) {
+	const byte_t *buffer = bijson->buffer;
+	byte_compute_t type = *buffer;
+
+	if((type & BYTE_C(0xFE)) == BYTE_C(0x1A)) {
+		result->significand.buffer = buffer + SIZE_C(1);
+		result->significand.size = bijson->size - SIZE_C(1);
+		result->exponent = bijson_0;
+		result->negative = type & BYTE_C(0x1);
+		result->exponent_negative = false;
+	} else if((type & BYTE_C(0xF0)) == BYTE_C(0x20)) {
+		_bijson_decimal_analysis analysis;
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_analyze(bijson, &analysis));
+		result->significand = analysis.significand;
+		result->exponent = analysis.exponent;
+		result->negative = analysis.significand_negative;
+		result->exponent_negative = analysis.exponent_negative;
+	} else {
+		_BIJSON_RETURN_ERROR(bijson_error_type_mismatch);
+	}
+
+	size_t count = _bijson_decimal_part_count(&result->significand);
+	result->significand_count = count;
+	result->exponent_count = _bijson_decimal_part_count(&result->exponent);
+	result->digits = 0;
+	result->position = 0;
+	result->clamped = false;
+	// An empty significand denotes 0
+	if(!count)
+		return NULL;
+
+	uint64_t top;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&result->significand, count, count - SIZE_C(1), &top));
+	result->digits = _bijson_decimal_word_digits(top);
+
+	_bijson_decimal_magnitude_t exponent = 0;
+	for(size_t u = result->exponent_count; u; u--) {
+		uint64_t word;
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&result->exponent, result->exponent_count, u - SIZE_C(1), &word));
+		if(!_bijson_decimal_multiply_add(&exponent, _BIJSON_DECIMAL_WORD_BASE, word, _BIJSON_DECIMAL_POSITION_LIMIT)) {
+			exponent = _BIJSON_DECIMAL_POSITION_LIMIT;
+			result->clamped = true;
+			break;
+		}
+	}
+
+	_bijson_decimal_magnitude_t digits = (_bijson_decimal_magnitude_t)(count - SIZE_C(1));
+	if(!_bijson_decimal_multiply_add(&digits, _BIJSON_DECIMAL_WORD_DIGITS, result->digits, _BIJSON_DECIMAL_POSITION_LIMIT)) {
+		digits = _BIJSON_DECIMAL_POSITION_LIMIT;
+		result->clamped = true;
+	}
+
+	// Both are at most the limit, so this cannot overflow
+	result->position = result->exponent_negative
+		? (_bijson_decimal_position_t)digits - (_bijson_decimal_position_t)exponent
+		: (_bijson_decimal_position_t)digits + (_bijson_decimal_position_t)exponent;
+	return NULL;
+}
+
+// Returns the digits at positions 19 * index up to 19 * (index + 1) counted
+// from the leading digit, padded with zeros after the last digit.
+static inline bijson_error_t _bijson_decimal_order_chunk(const _bijson_decimal_order_t *order, size_t index, uint64_t *result) {
+	size_t count = order->significand_count;
+	uint64_t high;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&order->significand, count, count - index - SIZE_C(1), &high));
+	unsigned int digits = order->digits;
+	if(digits == _BIJSON_DECIMAL_WORD_DIGITS)
+		return *result = high, NULL;
+
+	uint64_t low = 0;
+	if(index + SIZE_C(1) < count)
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&order->significand, count, count - index - SIZE_C(2), &low));
+	uint64_t divisor = _bijson_uint64_pow10(digits);
+	*result = high % divisor * _bijson_uint64_pow10(_BIJSON_DECIMAL_WORD_DIGITS - digits) + low / divisor;
+	return NULL;
+}
+
+// Compares the exact exponents, for when positions were clamped
+static bijson_error_t _bijson_decimal_order_compare_exponents(
+	const _bijson_decimal_order_t *a,
+	const _bijson_decimal_order_t *b,
+	int *result
+) {
+	int sign_a = a->exponent_count ? a->exponent_negative ? -1 : 1 : 0;
+	int sign_b = b->exponent_count ? b->exponent_negative ? -1 : 1 : 0;
+	if(sign_a != sign_b)
+		return *result = sign_a < sign_b ? -1 : 1, NULL;
+
+	// The most significant word is never zero, so longer is larger
+	size_t count = a->exponent_count;
+	int c = 0;
+	if(count != b->exponent_count) {
+		c = count < b->exponent_count ? -1 : 1;
+	} else {
+		for(size_t u = count; u && !c; u--) {
+			uint64_t word_a, word_b;
+			_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&a->exponent, count, u - SIZE_C(1), &word_a));
+			_BIJSON_RETURN_ON_ERROR(_bijson_decimal_part_word(&b->exponent, count, u - SIZE_C(1), &word_b));
+			c = word_a < word_b ? -1 : word_a > word_b;
+		}
+	}
+	*result = sign_a < 0 ? -c : c;
+	return NULL;
+}
+
+// Compares the magnitudes of two nonzero decimals
+static bijson_error_t _bijson_decimal_order_compare(
+	const _bijson_decimal_order_t *a,
+	const _bijson_decimal_order_t *b,
+	int *result
+) {
+	if(a->position != b->position)
+		return *result = a->position < b->position ? -1 : 1, NULL;
+
+	if(a->clamped || b->clamped) {
+		int c;
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_order_compare_exponents(a, b, &c));
+		if(!c && a->significand_count != b->significand_count)
+			c = a->significand_count < b->significand_count ? -1 : 1;
+		if(!c && a->digits != b->digits)
+			c = a->digits < b->digits ? -1 : 1;
+		if(c)
+			return *result = c, NULL;
+	}
+
+	// The leading digits line up, so compare 19 digits at a time
+	size_t count = _bijson_size_min(a->significand_count, b->significand_count);
+	for(size_t u = 0; u < count; u++) {
+		uint64_t chunk_a, chunk_b;
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_order_chunk(a, u, &chunk_a));
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_order_chunk(b, u, &chunk_b));
+		if(chunk_a != chunk_b)
+			return *result = chunk_a < chunk_b ? -1 : 1, NULL;
+	}
+
+	// Any remaining nonzero digits make the longer significand larger
+	const _bijson_decimal_order_t *longer = a->significand_count > count ? a : b;
+	for(size_t u = count; u < longer->significand_count; u++) {
+		uint64_t chunk;
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_order_chunk(longer, u, &chunk));
+		if(chunk)
+			return *result = longer == a ? 1 : -1, NULL;
+	}
+
+	*result = 0;
+	return NULL;
+}
+
+// Compares the magnitudes of two nonzero small decimals by scaling the one
+// with the larger exponent to the exponent of the other.
+__attribute__((const))
+static inline int _bijson_decimal_small_compare(uint64_t significand_a, int64_t exponent_a, uint64_t significand_b, int64_t exponent_b) {
+	if(exponent_a == exponent_b)
+		return significand_a < significand_b ? -1 : significand_a > significand_b;
+	if(exponent_a < exponent_b)
+		return -_bijson_decimal_small_compare(significand_b, exponent_b, significand_a, exponent_a);
+	// Exponents are limited to 62 bits, so this does not overflow.
+	// Significands are below 10^19, so scaling by 10^20 always exceeds them.
+	int64_t shift = exponent_a - exponent_b;
+	if(shift >= 20)
+		return 1;
+	uint64_t high;
+	uint64_t low = _bijson_umul128(significand_a, _bijson_uint64_pow10((unsigned int)shift), &high);
+	if(high)
+		return 1;
+	return low < significand_b ? -1 : low > significand_b;
+}
+
+bijson_error_t _bijson_decimal_compare(const bijson_t *a, const bijson_t *b, int *result) {
+	_bijson_decimal_small_t small_a = {0}, small_b = {0};
+	bool is_small_a, is_small_b;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_get_small(a, &small_a, &is_small_a));
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_get_small(b, &small_b, &is_small_b));
+	if(is_small_a && is_small_b) {
+		int sign_a = small_a.significand ? small_a.negative ? -1 : 1 : 0;
+		int sign_b = small_b.significand ? small_b.negative ? -1 : 1 : 0;
+		if(sign_a != sign_b)
+			return *result = sign_a < sign_b ? -1 : 1, NULL;
+		if(!sign_a)
+			return *result = 0, NULL;
+		int c = _bijson_decimal_small_compare(small_a.significand, small_a.exponent, small_b.significand, small_b.exponent);
+		return *result = sign_a < 0 ? -c : c, NULL;
+	}
+
+	_bijson_decimal_order_t order_a, order_b;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_order_analyze(a, &order_a));
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_order_analyze(b, &order_b));
+
+	// Zero and negative zero are equal
+	int sign_a = order_a.significand_count ? order_a.negative ? -1 : 1 : 0;
+	int sign_b = order_b.significand_count ? order_b.negative ? -1 : 1 : 0;
+	if(sign_a != sign_b)
+		return *result = sign_a < sign_b ? -1 : 1, NULL;
+	if(!sign_a)
+		return *result = 0, NULL;
+
+	int c;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_order_compare(&order_a, &order_b, &c));
+	*result = sign_a < 0 ? -c : c;
+	return NULL;
+}
+
+// Hashes the sign, the position of the leading digit and the digits up to
+// the last nonzero one. Values that _bijson_decimal_compare() considers
+// equal agree on all of these, whatever their encoding.
+bijson_error_t _bijson_decimal_hash(const bijson_t *bijson, uint64_t *result) {
+	_bijson_decimal_order_t order;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_order_analyze(bijson, &order));
+
+	_bijson_decimal_position_t position = order.position;
+	uint64_t hash = rapid_mix(
+		(uint64_t)order.negative ^ UINT64_C(0x9E3779B97F4A7C15),
+		(uint64_t)position ^ (uint64_t)(position >> 32U >> 32U) ^ UINT64_C(0x27D4EB2F165667C5)
+	);
+	uint64_t trimmed = hash;
+	for(size_t u = 0; u < order.significand_count; u++) {
+		uint64_t chunk;
+		_BIJSON_RETURN_ON_ERROR(_bijson_decimal_order_chunk(&order, u, &chunk));
+		hash = rapid_mix(hash ^ UINT64_C(0xC2B2AE3D27D4EB4F), chunk ^ UINT64_C(0x165667B19E3779F9));
+		if(chunk)
+			trimmed = hash;
+	}
+
+	*result = trimmed;
+	return NULL;
+}
+
+bijson_error_t bijson_decimal_compare(const bijson_t *a, const bijson_t *b, int *result) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(a));
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(b));
+	return _bijson_decimal_compare(a, b, result);
+}
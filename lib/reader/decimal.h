@@ -1,6 +1,174 @@
 #pragma once
 
+#include <float.h>
+
 #include "../common.h"
+#include "../reader.h"
+
+typedef struct _bijson_decimal_analysis {
+	bijson_t exponent;
+	bijson_t significand;
+	bool exponent_negative;
+	bool significand_negative;
+} _bijson_decimal_analysis;
+
+static inline bijson_error_t _bijson_decimal_analyze(const bijson_t *bijson, _bijson_decimal_analysis *analysis) {
+	const byte_t *buffer = bijson->buffer;
+	const byte_t *buffer_end = buffer + bijson->size;
+
+	byte_compute_t type = *buffer;
+	analysis->significand_negative = type & BYTE_C(0x4);
+	analysis->exponent_negative = type & BYTE_C(0x8);
+
+	const byte_t *exponent_size_location = buffer + SIZE_C(1);
+	if(exponent_size_location == buffer_end)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+
+	size_t exponent_size_size = SIZE_C(1) << (type & BYTE_C(0x3));
+	const byte_t *exponent_start = exponent_size_location + exponent_size_size;
+	if(exponent_start + SIZE_C(1) > buffer_end)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+	uint64_t raw_exponent_size = _bijson_read_minimal_int(exponent_size_location, exponent_size_size);
+	if(raw_exponent_size > SIZE_MAX - SIZE_C(1))
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+	size_t exponent_size = (size_t)raw_exponent_size + SIZE_C(1);
+	if(exponent_size > _bijson_ptrdiff(buffer_end, exponent_start) - SIZE_C(1))
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+
+	const byte_t *significand_start = exponent_start + exponent_size;
+	analysis->significand.buffer = significand_start;
+	analysis->significand.size = _bijson_ptrdiff(buffer_end, significand_start);
+
+	analysis->exponent.buffer = exponent_start;
+	analysis->exponent.size = exponent_size;
+
+	return NULL;
+}
 
 extern bijson_error_t _bijson_decimal_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data);
 extern bijson_error_t _bijson_decimal_integer_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data);
+extern bijson_error_t _bijson_decimal_verify(const bijson_t *bijson);
+extern bijson_error_t _bijson_decimal_integer_verify(const bijson_t *bijson);
+// Conversions that go through the JSON representation of the number:
+extern bijson_error_t _bijson_decimal_get_double_text(const bijson_t *bijson, double *result);
+extern bijson_error_t _bijson_decimal_get_float_text(const bijson_t *bijson, float *result);
+// Correctly rounded conversions that only fall back to the JSON
+// representation for significands of more than 19 digits that are too
+// close to halfway between two values. Out of range values become infinite.
+extern bijson_error_t _bijson_decimal_to_double(const bijson_t *bijson, double *result);
+extern bijson_error_t _bijson_decimal_to_float(const bijson_t *bijson, float *result);
+#ifdef __SIZEOF_INT128__
+// Correctly rounded conversion of value * 10^exponent.
+extern double _bijson_decimal_int128_to_double(int128_t value, int64_t exponent);
+#endif
+// Like bijson_decimal_compare(), without checking the arguments:
+extern bijson_error_t _bijson_decimal_compare(const bijson_t *a, const bijson_t *b, int *result);
+// Equal for all decimals that compare equal and have the same sign:
+extern bijson_error_t _bijson_decimal_hash(const bijson_t *bijson, uint64_t *result);
+
+// Whether the sign is negative, which includes negative zero
+__attribute__((pure))
+static inline bool _bijson_decimal_negative(const bijson_t *bijson) {
+	byte_compute_t type = *(const byte_t *)bijson->buffer;
+	if((type & BYTE_C(0xFE)) == BYTE_C(0x1A))
+		return type & BYTE_C(0x1);
+	return type & BYTE_C(0x4);
+}
+
+typedef struct _bijson_decimal_small {
+	uint64_t significand;
+	int64_t exponent;
+	bool negative;
+} _bijson_decimal_small_t;
+
+// Decodes decimals (and decimal integers) whose significand and exponent
+// each fit in a single word, which covers nearly all numbers found in
+// practice. Sets *small to false for anything larger. The exponent is
+// limited to 62 bits so that callers can compare and subtract exponents
+// without overflow.
+static inline bijson_error_t _bijson_decimal_get_small(const bijson_t *bijson, _bijson_decimal_small_t *result, bool *small) {
+	const byte_t *buffer = bijson->buffer;
+	size_t size = bijson->size;
+	byte_compute_t type = *buffer;
+
+	if((type & BYTE_C(0xFE)) == BYTE_C(0x1A)) {
+		result->negative = type & BYTE_C(0x1);
+		result->exponent = 0;
+		if(size == SIZE_C(1)) {
+			result->significand = 0;
+			*small = true;
+			return NULL;
+		}
+		if(size > SIZE_C(9)) {
+			*small = false;
+			return NULL;
+		}
+		uint64_t significand = _bijson_read_minimal_int(buffer + SIZE_C(1), size - SIZE_C(1));
+		if(significand > UINT64_C(9999999999999999998))
+			_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+		result->significand = significand + UINT64_C(1);
+		*small = true;
+		return NULL;
+	}
+
+	if((type & BYTE_C(0xF0)) != BYTE_C(0x20))
+		_BIJSON_RETURN_ERROR(bijson_error_type_mismatch);
+
+	_bijson_decimal_analysis analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_analyze(bijson, &analysis));
+	if(analysis.significand.size > sizeof(uint64_t) || analysis.exponent.size > sizeof(uint64_t)) {
+		*small = false;
+		return NULL;
+	}
+
+	uint64_t significand = _bijson_read_minimal_int(analysis.significand.buffer, analysis.significand.size);
+	uint64_t exponent = _bijson_read_minimal_int(analysis.exponent.buffer, analysis.exponent.size);
+	if(significand > UINT64_C(9999999999999999998) || exponent > UINT64_C(9999999999999999998))
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+	exponent++;
+	if(exponent > UINT64_C(0x3FFFFFFFFFFFFFFF)) {
+		*small = false;
+		return NULL;
+	}
+
+	result->significand = significand + UINT64_C(1);
+	result->exponent = analysis.exponent_negative ? -(int64_t)exponent : (int64_t)exponent;
+	result->negative = analysis.significand_negative;
+	*small = true;
+	return NULL;
+}
+
+// Exact conversions for significands that fit in the mantissa and
+// exponents whose power of ten is exactly representable (Clinger's fast
+// path). Return false if that does not apply. This relies on arithmetic
+// being done in the precision of the type.
+static inline bool _bijson_decimal_small_to_double(uint64_t significand, int64_t exponent, double *result) {
+#if FLT_EVAL_METHOD == 0
+	static const double powers[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+	};
+	if(significand > UINT64_C(1) << 53U || exponent < -22 || exponent > 22)
+		return false;
+	double value = (double)significand;
+	*result = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+	return true;
+#else
+	return false;
+#endif
+}
+
+static inline bool _bijson_decimal_small_to_float(uint64_t significand, int64_t exponent, float *result) {
+#if FLT_EVAL_METHOD == 0
+	static const float powers[] = {
+		1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+	};
+	if(significand > UINT64_C(1) << 24U || exponent < -10 || exponent > 10)
+		return false;
+	float value = (float)significand;
+	*result = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+	return true;
+#else
+	return false;
+#endif
+}
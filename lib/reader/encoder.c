@@ -0,0 +1,305 @@
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "../../include/reader.h"
+
+#include "../common.h"
+#include "../reader.h"
+#include "array.h"
+#include "object.h"
+#include "object/cursor.h"
+#include "string.h"
+
+// Resumable JSON output. All state that bijson_to_json() keeps on the C
+// stack lives in the encoder instead: containers are kept on a heap
+// allocated stack of cursors, like in bijson_walk(), and strings are escaped
+// in slices of at most _BIJSON_ENCODER_STRING_SLICE bytes. Output goes
+// straight into the caller's buffer; whatever does not fit is kept in a
+// spill buffer that is drained first on the next step. Because every piece
+// of output is small (except for very long numbers), so is the spill buffer.
+
+#define _BIJSON_ENCODER_INITIAL_DEPTH SIZE_C(32)
+#define _BIJSON_ENCODER_STRING_SLICE SIZE_C(4096)
+
+typedef struct _bijson_encoder_frame {
+	union {
+		_bijson_array_cursor_t array;
+		_bijson_object_cursor_t object;
+	} cursor;
+	bool object;
+} _bijson_encoder_frame_t;
+
+struct bijson_encoder {
+	bool nocheck;
+	bijson_error_t error;
+
+	_bijson_encoder_frame_t *stack;
+	size_t depth;
+	size_t capacity;
+
+	// The value to be output next, if any
+	bijson_t value;
+	bool value_pending;
+
+	// The remainder of a string (or key) that is being output
+	const byte_t *string;
+	const byte_t *string_end;
+	bool string_started;
+	bool string_key;
+
+	// Where output goes during a step
+	byte_t *output;
+	size_t output_room;
+
+	// Output that did not fit in the caller's buffer
+	byte_t *spill;
+	size_t spill_start;
+	size_t spill_end;
+	size_t spill_capacity;
+};
+
+static bijson_error_t _bijson_encoder_output_callback(void *callback_data, const void *data, size_t len) {
+	bijson_encoder_t *encoder = callback_data;
+	const byte_t *bytes = data;
+
+	if(encoder->spill_start == encoder->spill_end) {
+		size_t direct = _bijson_size_min(len, encoder->output_room);
+		memcpy(encoder->output, bytes, direct);
+		encoder->output += direct;
+		encoder->output_room -= direct;
+		bytes += direct;
+		len -= direct;
+		if(!len)
+			return NULL;
+	}
+
+	size_t spill_end = encoder->spill_end;
+	if(len > encoder->spill_capacity - spill_end) {
+		if(len > SIZE_MAX / SIZE_C(2) - spill_end)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		size_t capacity = (spill_end + len) * SIZE_C(2);
+		byte_t *spill = realloc(encoder->spill, capacity);
+		if(!spill)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+		encoder->spill = spill;
+		encoder->spill_capacity = capacity;
+	}
+	memcpy(encoder->spill + spill_end, bytes, len);
+	encoder->spill_end = spill_end + len;
+	return NULL;
+}
+
+static inline bijson_error_t _bijson_encoder_output(bijson_encoder_t *encoder, const char *data, size_t len) {
+	return _bijson_encoder_output_callback(encoder, data, len);
+}
+
+static bijson_error_t _bijson_encoder_push(bijson_encoder_t *encoder, _bijson_encoder_frame_t **result) {
+	if(encoder->depth == encoder->capacity) {
+		size_t capacity = encoder->capacity ? encoder->capacity * SIZE_C(2) : _BIJSON_ENCODER_INITIAL_DEPTH;
+		if(capacity > SIZE_MAX / sizeof *encoder->stack)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		_bijson_encoder_frame_t *stack = realloc(encoder->stack, capacity * sizeof *stack);
+		if(!stack)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+		encoder->stack = stack;
+		encoder->capacity = capacity;
+	}
+	*result = encoder->stack + encoder->depth++;
+	return NULL;
+}
+
+// Outputs the next slice of the current string, stopping early so that
+// multibyte UTF-8 sequences are not split up.
+static bijson_error_t _bijson_encoder_string(bijson_encoder_t *encoder) {
+	const byte_t *string = encoder->string;
+	const byte_t *string_end = encoder->string_end;
+	const byte_t *slice_end = string_end;
+	if(_bijson_ptrdiff(string_end, string) > _BIJSON_ENCODER_STRING_SLICE) {
+		slice_end = string + _BIJSON_ENCODER_STRING_SLICE;
+		for(size_t u = 0; u < SIZE_C(3) && (*slice_end & BYTE_C(0xC0)) == BYTE_C(0x80); u++)
+			slice_end--;
+	}
+
+	bijson_t slice = {string, _bijson_ptrdiff(slice_end, string)};
+	if(!encoder->nocheck && !encoder->string_key)
+		_BIJSON_RETURN_ON_ERROR(_bijson_check_valid_utf8(slice.buffer, slice.size));
+
+	bool last = slice_end == string_end;
+	_BIJSON_RETURN_ON_ERROR(_bijson_raw_string_part_to_json(
+		&slice,
+		!encoder->string_started,
+		last,
+		_bijson_encoder_output_callback,
+		encoder
+	));
+	encoder->string = slice_end;
+	encoder->string_started = true;
+
+	if(last) {
+		encoder->string = NULL;
+		if(encoder->string_key)
+			return _bijson_encoder_output(encoder, ":", SIZE_C(1));
+	}
+	return NULL;
+}
+
+// Outputs a scalar, or the start of a container, which is then pushed.
+static bijson_error_t _bijson_encoder_value(bijson_encoder_t *encoder, const bijson_t *value) {
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(value));
+	const byte_t *buffer = value->buffer;
+	const byte_compute_t type = *buffer;
+
+	if(type == BYTE_C(0x08)) {
+		encoder->string = buffer + SIZE_C(1);
+		encoder->string_end = buffer + value->size;
+		encoder->string_started = false;
+		encoder->string_key = false;
+		return _bijson_encoder_string(encoder);
+	} else if((type & BYTE_C(0xF0)) == BYTE_C(0x30)) {
+		_bijson_array_analysis_t analysis;
+		_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(value, &analysis));
+		_bijson_encoder_frame_t *frame;
+		_BIJSON_RETURN_ON_ERROR(_bijson_encoder_push(encoder, &frame));
+		_bijson_array_cursor_init(&frame->cursor.array, &analysis);
+		frame->object = false;
+		return _bijson_encoder_output(encoder, "[", SIZE_C(1));
+	} else if(type >= BYTE_C(0x40) && type < BYTE_C(0xC0)) {
+		_bijson_object_analysis_t analysis;
+		_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(value, &analysis));
+		analysis.nocheck = encoder->nocheck;
+		_bijson_encoder_frame_t *frame;
+		_BIJSON_RETURN_ON_ERROR(_bijson_encoder_push(encoder, &frame));
+		_bijson_object_cursor_init(&frame->cursor.object, &analysis);
+		frame->object = true;
+		return _bijson_encoder_output(encoder, "{", SIZE_C(1));
+	}
+
+	return _bijson_to_json(value, encoder->nocheck, _bijson_encoder_output_callback, encoder);
+}
+
+// Produces the next piece of output: a string slice, a scalar, the start or
+// end of a container, or the separator and key before the next entry.
+static bijson_error_t _bijson_encoder_advance(bijson_encoder_t *encoder) {
+	if(encoder->string)
+		return _bijson_encoder_string(encoder);
+
+	if(encoder->value_pending) {
+		encoder->value_pending = false;
+		return _bijson_encoder_value(encoder, &encoder->value);
+	}
+
+	_bijson_encoder_frame_t *frame = encoder->stack + encoder->depth - SIZE_C(1);
+	if(frame->object) {
+		_bijson_object_cursor_t *cursor = &frame->cursor.object;
+		if(cursor->index == cursor->analysis.count) {
+			encoder->depth--;
+			return _bijson_encoder_output(encoder, "}", SIZE_C(1));
+		}
+		if(cursor->index)
+			_BIJSON_RETURN_ON_ERROR(_bijson_encoder_output(encoder, ",", SIZE_C(1)));
+		const void *key;
+		size_t key_size;
+		_BIJSON_RETURN_ON_ERROR(_bijson_object_cursor_next(cursor, &key, &key_size, &encoder->value));
+		encoder->value_pending = true;
+		encoder->string = key;
+		encoder->string_end = encoder->string + key_size;
+		encoder->string_started = false;
+		encoder->string_key = true;
+		return _bijson_encoder_string(encoder);
+	} else {
+		_bijson_array_cursor_t *cursor = &frame->cursor.array;
+		if(cursor->index == cursor->analysis.count) {
+			encoder->depth--;
+			return _bijson_encoder_output(encoder, "]", SIZE_C(1));
+		}
+		if(cursor->index)
+			_BIJSON_RETURN_ON_ERROR(_bijson_encoder_output(encoder, ",", SIZE_C(1)));
+		_BIJSON_RETURN_ON_ERROR(_bijson_array_cursor_next(cursor, &encoder->value));
+		return _bijson_encoder_value(encoder, &encoder->value);
+	}
+}
+
+__attribute__((pure))
+static inline bool _bijson_encoder_finished(const bijson_encoder_t *encoder) {
+	return !encoder->string && !encoder->value_pending && !encoder->depth;
+}
+
+static bijson_error_t _bijson_encoder_step(bijson_encoder_t *encoder, bool *pending_result) {
+	size_t spill_len = encoder->spill_end - encoder->spill_start;
+	if(spill_len) {
+		size_t len = _bijson_size_min(spill_len, encoder->output_room);
+		memcpy(encoder->output, encoder->spill + encoder->spill_start, len);
+		encoder->output += len;
+		encoder->output_room -= len;
+		encoder->spill_start += len;
+		if(len < spill_len) {
+			*pending_result = true;
+			return NULL;
+		}
+		encoder->spill_start = encoder->spill_end = 0;
+	}
+
+	while(encoder->output_room && !_bijson_encoder_finished(encoder))
+		_BIJSON_RETURN_ON_ERROR(_bijson_encoder_advance(encoder));
+
+	*pending_result = encoder->spill_start != encoder->spill_end || !_bijson_encoder_finished(encoder);
+	return NULL;
+}
+
+static bijson_error_t _bijson_encoder_new(bijson_encoder_t **result, const bijson_t *bijson, bool nocheck) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
+
+	bijson_encoder_t *encoder = calloc(SIZE_C(1), sizeof *encoder);
+	if(!encoder)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	encoder->nocheck = nocheck;
+	encoder->value = *bijson;
+	encoder->value_pending = true;
+
+	*result = encoder;
+	return NULL;
+}
+
+bijson_error_t bijson_encoder_new(bijson_encoder_t **result, const bijson_t *bijson) {
+	return _bijson_encoder_new(result, bijson, false);
+}
+
+bijson_error_t bijson_encoder_new_nocheck(bijson_encoder_t **result, const bijson_t *bijson) {
+	return _bijson_encoder_new(result, bijson, true);
+}
+
+bijson_error_t bijson_encoder_step(
+	bijson_encoder_t *encoder,
+	void *buffer,
+	size_t size,
+	size_t *len_result,
+	bool *pending_result
+) {
+	if(!encoder || !buffer || !len_result || !pending_result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	if(!size)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_zero);
+	if(encoder->error)
+		_BIJSON_RETURN_ERROR(encoder->error);
+
+	encoder->output = buffer;
+	encoder->output_room = size;
+	bijson_error_t error = _bijson_encoder_step(encoder, pending_result);
+	*len_result = size - encoder->output_room;
+	encoder->output = NULL;
+	encoder->output_room = 0;
+	if(error)
+		encoder->error = error;
+	return error;
+}
+
+void bijson_encoder_free(bijson_encoder_t *encoder) {
+	if(encoder) {
+		free(encoder->stack);
+		free(encoder->spill);
+		free(encoder);
+	}
+}
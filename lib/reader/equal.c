@@ -0,0 +1,300 @@
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "../../include/reader.h"
+
+#include "../common.h"
+#include "../reader.h"
+#include "../rapidhash.h"
+#include "array.h"
+#include "binary.h"
+#include "decimal.h"
+#include "object.h"
+#include "object/cursor.h"
+
+// The writer produces a canonical encoding (hash ordered keys, minimal
+// offset widths, normalized decimals), so equal values almost always have
+// identical bytes and a single memcmp() settles it. Other encoders may use
+// wider offsets or unnormalized decimals though, so if the bytes differ the
+// values are compared structurally. Containers that are being compared are
+// kept on a heap allocated stack, like in bijson_walk().
+
+#define _BIJSON_EQUAL_INITIAL_DEPTH SIZE_C(32)
+
+typedef struct _bijson_equal_frame {
+	union {
+		_bijson_array_cursor_t array[2];
+		_bijson_object_cursor_t object[2];
+	} cursors;
+	bool object;
+} _bijson_equal_frame_t;
+
+typedef struct _bijson_equal {
+	_bijson_equal_frame_t *stack;
+	size_t depth;
+	size_t capacity;
+} _bijson_equal_t;
+
+static bijson_error_t _bijson_equal_push(_bijson_equal_t *equal, _bijson_equal_frame_t **result) {
+	if(equal->depth == equal->capacity) {
+		size_t capacity = equal->capacity ? equal->capacity * SIZE_C(2) : _BIJSON_EQUAL_INITIAL_DEPTH;
+		if(capacity > SIZE_MAX / sizeof *equal->stack)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		_bijson_equal_frame_t *stack = realloc(equal->stack, capacity * sizeof *stack);
+		if(!stack)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+		equal->stack = stack;
+		equal->capacity = capacity;
+	}
+	*result = equal->stack + equal->depth++;
+	return NULL;
+}
+
+// Decimals are equal if they have the same sign and value. Unlike
+// bijson_decimal_compare(), zero and negative zero are not equal here,
+// because they are not the same JSON value.
+static bijson_error_t _bijson_equal_decimal(const bijson_t *a, const bijson_t *b, bool *result) {
+	int c;
+	_BIJSON_RETURN_ON_ERROR(_bijson_decimal_compare(a, b, &c));
+	*result = !c && _bijson_decimal_negative(a) == _bijson_decimal_negative(b);
+	return NULL;
+}
+
+// Binary integers are compared and hashed as the equivalent decimal
+// integers, so that a number is equal to itself in either encoding.
+__attribute__((const))
+static inline bool _bijson_equal_is_number(bijson_value_type_t type) {
+	return type == bijson_value_type_decimal || type == bijson_value_type_integer;
+}
+
+static bijson_error_t _bijson_equal_number(
+	const bijson_t *a,
+	bijson_value_type_t type_a,
+	const bijson_t *b,
+	bijson_value_type_t type_b,
+	bool *result
+) {
+	byte_t small_a[_BIJSON_BINARY_DECIMAL_SMALL_SIZE], small_b[_BIJSON_BINARY_DECIMAL_SMALL_SIZE];
+	bijson_t decimal_a, decimal_b;
+	_BIJSON_RETURN_ON_ERROR(_bijson_binary_as_decimal(a, type_a, small_a, &decimal_a));
+	bijson_error_t error = _bijson_binary_as_decimal(b, type_b, small_b, &decimal_b);
+	if(!error) {
+		error = _bijson_equal_decimal(&decimal_a, &decimal_b, result);
+		_bijson_binary_decimal_free(b, small_b, &decimal_b);
+	}
+	_bijson_binary_decimal_free(a, small_a, &decimal_a);
+	return error;
+}
+
+// Compares two values. Scalars are compared right away; for containers of
+// equal size a frame is pushed so that their contents are compared later.
+static bijson_error_t _bijson_equal_value(_bijson_equal_t *equal, const bijson_t *a, const bijson_t *b, bool *result) {
+	if(a->size == b->size && !memcmp(a->buffer, b->buffer, a->size)) {
+		*result = true;
+		return NULL;
+	}
+
+	bijson_value_type_t type_a, type_b;
+	_BIJSON_RETURN_ON_ERROR(bijson_get_value_type(a, &type_a));
+	_BIJSON_RETURN_ON_ERROR(bijson_get_value_type(b, &type_b));
+	if(_bijson_equal_is_number(type_a) && _bijson_equal_is_number(type_b))
+		return _bijson_equal_number(a, type_a, b, type_b, result);
+	if(type_a != type_b) {
+		*result = false;
+		return NULL;
+	}
+
+	switch(type_a) {
+		case bijson_value_type_array: {
+			_bijson_array_analysis_t analysis_a, analysis_b;
+			_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(a, &analysis_a));
+			_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(b, &analysis_b));
+			if(analysis_a.count != analysis_b.count) {
+				*result = false;
+				return NULL;
+			}
+			_bijson_equal_frame_t *frame;
+			_BIJSON_RETURN_ON_ERROR(_bijson_equal_push(equal, &frame));
+			_bijson_array_cursor_init(&frame->cursors.array[0], &analysis_a);
+			_bijson_array_cursor_init(&frame->cursors.array[1], &analysis_b);
+			frame->object = false;
+		} break;
+		case bijson_value_type_object: {
+			_bijson_object_analysis_t analysis_a, analysis_b;
+			_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(a, &analysis_a));
+			_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(b, &analysis_b));
+			if(analysis_a.count != analysis_b.count) {
+				*result = false;
+				return NULL;
+			}
+			_bijson_equal_frame_t *frame;
+			_BIJSON_RETURN_ON_ERROR(_bijson_equal_push(equal, &frame));
+			_bijson_object_cursor_init(&frame->cursors.object[0], &analysis_a);
+			_bijson_object_cursor_init(&frame->cursors.object[1], &analysis_b);
+			frame->object = true;
+		} break;
+		default:
+			// All other types have a single encoding per value
+			*result = false;
+			return NULL;
+	}
+
+	*result = true;
+	return NULL;
+}
+
+static bijson_error_t _bijson_equal_run(_bijson_equal_t *equal, const bijson_t *a, const bijson_t *b, bool *result) {
+	bool equal_value;
+	_BIJSON_RETURN_ON_ERROR(_bijson_equal_value(equal, a, b, &equal_value));
+
+	while(equal_value && equal->depth) {
+		// Only valid until the next push
+		_bijson_equal_frame_t *frame = equal->stack + equal->depth - SIZE_C(1);
+		bijson_t value_a, value_b;
+		if(frame->object) {
+			_bijson_object_cursor_t *cursors = frame->cursors.object;
+			if(cursors[0].index == cursors[0].analysis.count) {
+				equal->depth--;
+				continue;
+			}
+			// Objects are stored in a fixed (hash) order, so equal objects
+			// have their keys at the same positions.
+			const void *key_a, *key_b;
+			size_t key_size_a, key_size_b;
+			_BIJSON_RETURN_ON_ERROR(_bijson_object_cursor_next(&cursors[0], &key_a, &key_size_a, &value_a));
+			_BIJSON_RETURN_ON_ERROR(_bijson_object_cursor_next(&cursors[1], &key_b, &key_size_b, &value_b));
+			if(key_size_a != key_size_b || memcmp(key_a, key_b, key_size_a)) {
+				equal_value = false;
+				break;
+			}
+		} else {
+			_bijson_array_cursor_t *cursors = frame->cursors.array;
+			if(cursors[0].index == cursors[0].analysis.count) {
+				equal->depth--;
+				continue;
+			}
+			_BIJSON_RETURN_ON_ERROR(_bijson_array_cursor_next(&cursors[0], &value_a));
+			_BIJSON_RETURN_ON_ERROR(_bijson_array_cursor_next(&cursors[1], &value_b));
+		}
+		_BIJSON_RETURN_ON_ERROR(_bijson_equal_value(equal, &value_a, &value_b, &equal_value));
+	}
+
+	*result = equal_value;
+	return NULL;
+}
+
+bijson_error_t bijson_equal(const bijson_t *a, const bijson_t *b, bool *result) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(a));
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(b));
+
+	_bijson_equal_t equal = {0};
+	bijson_error_t error = _bijson_equal_run(&equal, a, b, result);
+	free(equal.stack);
+	return error;
+}
+
+// Containers are hashed from the hashes of their contents instead of their
+// bytes, because objects are encoded differently depending on whether they
+// store key hashes (see bijson_writer_set_hashed_object_threshold()). Each
+// container that is being visited has its running hash on a stack.
+
+#define _BIJSON_CONTENT_HASH_ARRAY UINT64_C(0x9E3779B97F4A7C15)
+#define _BIJSON_CONTENT_HASH_OBJECT UINT64_C(0xC2B2AE3D27D4EB4F)
+#define _BIJSON_CONTENT_HASH_COUNT UINT64_C(0x165667B19E3779F9)
+#define _BIJSON_CONTENT_HASH_ITEM UINT64_C(0x27D4EB2F165667C5)
+#define _BIJSON_CONTENT_HASH_VALUE UINT64_C(0x85EBCA77C2B2AE63)
+
+typedef struct _bijson_content_hash {
+	uint64_t *stack;
+	size_t depth;
+	size_t capacity;
+	uint64_t result;
+} _bijson_content_hash_t;
+
+// Folds the hash of a key or value into that of the enclosing container.
+static inline void _bijson_content_hash_add(_bijson_content_hash_t *hash, uint64_t value) {
+	if(hash->depth) {
+		uint64_t *top = hash->stack + hash->depth - SIZE_C(1);
+		*top = rapid_mix(*top ^ _BIJSON_CONTENT_HASH_ITEM, value ^ _BIJSON_CONTENT_HASH_VALUE);
+	} else {
+		hash->result = value;
+	}
+}
+
+static bijson_error_t _bijson_content_hash_begin(_bijson_content_hash_t *hash, uint64_t type, size_t count) {
+	if(hash->depth == hash->capacity) {
+		size_t capacity = hash->capacity ? hash->capacity * SIZE_C(2) : _BIJSON_EQUAL_INITIAL_DEPTH;
+		if(capacity > SIZE_MAX / sizeof *hash->stack)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		uint64_t *stack = realloc(hash->stack, capacity * sizeof *stack);
+		if(!stack)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+		hash->stack = stack;
+		hash->capacity = capacity;
+	}
+	hash->stack[hash->depth++] = rapid_mix(type, (uint64_t)count ^ _BIJSON_CONTENT_HASH_COUNT);
+	return NULL;
+}
+
+static bijson_error_t _bijson_content_hash_begin_array(void *callback_data, size_t count) {
+	return _bijson_content_hash_begin(callback_data, _BIJSON_CONTENT_HASH_ARRAY, count);
+}
+
+static bijson_error_t _bijson_content_hash_begin_object(void *callback_data, size_t count) {
+	return _bijson_content_hash_begin(callback_data, _BIJSON_CONTENT_HASH_OBJECT, count);
+}
+
+static bijson_error_t _bijson_content_hash_end(void *callback_data) {
+	_bijson_content_hash_t *hash = callback_data;
+	uint64_t value = hash->stack[--hash->depth];
+	_bijson_content_hash_add(hash, value);
+	return NULL;
+}
+
+static bijson_error_t _bijson_content_hash_key(void *callback_data, const char *key, size_t len) {
+	_bijson_content_hash_add(callback_data, rapidhash(key, len));
+	return NULL;
+}
+
+// Numbers are hashed by value, everything else by its encoding.
+static bijson_error_t _bijson_content_hash_scalar(void *callback_data, const bijson_t *value) {
+	bijson_value_type_t type;
+	_BIJSON_RETURN_ON_ERROR(bijson_get_value_type(value, &type));
+	if(!_bijson_equal_is_number(type)) {
+		_bijson_content_hash_add(callback_data, rapidhash(value->buffer, value->size));
+		return NULL;
+	}
+
+	byte_t small[_BIJSON_BINARY_DECIMAL_SMALL_SIZE];
+	bijson_t decimal;
+	_BIJSON_RETURN_ON_ERROR(_bijson_binary_as_decimal(value, type, small, &decimal));
+	uint64_t hash;
+	bijson_error_t error = _bijson_decimal_hash(&decimal, &hash);
+	_bijson_binary_decimal_free(value, small, &decimal);
+	_BIJSON_RETURN_ON_ERROR(error);
+	_bijson_content_hash_add(callback_data, hash);
+	return NULL;
+}
+
+bijson_error_t bijson_content_hash(const bijson_t *bijson, uint64_t *result) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	static const bijson_walk_callbacks_t callbacks = {
+		.begin_array = _bijson_content_hash_begin_array,
+		.end_array = _bijson_content_hash_end,
+		.begin_object = _bijson_content_hash_begin_object,
+		.end_object = _bijson_content_hash_end,
+		.key = _bijson_content_hash_key,
+		.scalar = _bijson_content_hash_scalar,
+	};
+	_bijson_content_hash_t hash = {0};
+	bijson_error_t error = bijson_walk(bijson, &callbacks, &hash);
+	free(hash.stack);
+	_BIJSON_RETURN_ON_ERROR(error);
+	*result = hash.result;
+	return NULL;
+}
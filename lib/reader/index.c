@@ -0,0 +1,404 @@
+#include <string.h>
+
+#include "../../include/reader.h"
+
+#include "../common.h"
+#include "../io.h"
+#include "../reader.h"
+#include "../rapidhash.h"
+#include "array.h"
+#include "index.h"
+
+// Sidecar index files consist of 64-bit little endian integers:
+//	the magic "bijsonix"
+//	the format version (2)
+//	the size of the document that was indexed
+//	the rapidhash of the document that was indexed
+//	the number of entries
+//	the length of the JSON pointer, followed by the pointer itself
+//	(padded with NUL bytes to a multiple of 8)
+//	the entries: the rapidhash of the encoded value and the index of the
+//	item, sorted by hash and then by index.
+// Lookups can then start at the position that the hash would have if the
+// hashes were evenly spread, which is usually very close.
+
+#define _BIJSON_INDEX_MAGIC "bijsonix"
+#define _BIJSON_INDEX_VERSION UINT64_C(2)
+#define _BIJSON_INDEX_HEADER_SIZE SIZE_C(48)
+#define _BIJSON_INDEX_ENTRY_SIZE SIZE_C(16)
+// Radix sort digit size
+#define _BIJSON_INDEX_RADIX_BITS 11U
+#define _BIJSON_INDEX_RADIX_SIZE (SIZE_C(1) << _BIJSON_INDEX_RADIX_BITS)
+
+typedef struct _bijson_index_entry {
+	uint64_t hash;
+	uint64_t index;
+} _bijson_index_entry_t;
+
+struct bijson_index {
+	bijson_t file;
+	bijson_t bijson;
+	_bijson_array_analysis_t analysis;
+	bijson_pointer_t *pointer;
+	const byte_t *entries;
+	size_t count;
+};
+
+__attribute__((pure))
+static inline uint64_t _bijson_index_value_hash(const bijson_t *value) {
+	return rapidhash(value->buffer, value->size);
+}
+
+static inline void _bijson_index_put_uint64(byte_t *buffer, uint64_t value) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	value = __builtin_bswap64(value);
+#endif
+	memcpy(buffer, &value, sizeof value);
+}
+
+__attribute__((const))
+static inline size_t _bijson_index_pad(size_t len) {
+	return (len + SIZE_C(7)) & ~SIZE_C(7);
+}
+
+// Stable LSD radix sort on the hash. Entries with the same hash stay in
+// index order.
+static void _bijson_index_sort(_bijson_index_entry_t *entries, _bijson_index_entry_t *scratch, size_t count) {
+	if(count < SIZE_C(2))
+		return;
+
+	static const size_t mask = _BIJSON_INDEX_RADIX_SIZE - SIZE_C(1);
+	size_t histogram[_BIJSON_INDEX_RADIX_SIZE];
+	_bijson_index_entry_t *source = entries;
+	_bijson_index_entry_t *destination = scratch;
+
+	for(unsigned int shift = 0; shift < 64U; shift += _BIJSON_INDEX_RADIX_BITS) {
+		memset(histogram, 0, sizeof histogram);
+		for(size_t u = 0; u < count; u++)
+			histogram[(source[u].hash >> shift) & mask]++;
+
+		// Nothing to do if all entries share this digit
+		if(histogram[(source[0].hash >> shift) & mask] == count)
+			continue;
+
+		size_t offset = 0;
+		for(size_t u = 0; u < _BIJSON_INDEX_RADIX_SIZE; u++) {
+			size_t digit_count = histogram[u];
+			histogram[u] = offset;
+			offset += digit_count;
+		}
+
+		for(size_t u = 0; u < count; u++)
+			destination[histogram[(source[u].hash >> shift) & mask]++] = source[u];
+
+		_bijson_index_entry_t *swap = source;
+		source = destination;
+		destination = swap;
+	}
+
+	if(source != entries)
+		memcpy(entries, source, count * sizeof *entries);
+}
+
+typedef struct _bijson_index_writer {
+	const char *pointer;
+	size_t pointer_len;
+	size_t document_size;
+	uint64_t document_hash;
+	const _bijson_index_entry_t *entries;
+	size_t count;
+} _bijson_index_writer_t;
+
+static bijson_error_t _bijson_index_write(void *action_callback_data, bijson_output_callback_t write, void *write_data) {
+	const _bijson_index_writer_t *writer = action_callback_data;
+
+	byte_t header[_BIJSON_INDEX_HEADER_SIZE];
+	memcpy(header, _BIJSON_INDEX_MAGIC, SIZE_C(8));
+	_bijson_index_put_uint64(header + SIZE_C(8), _BIJSON_INDEX_VERSION);
+	_bijson_index_put_uint64(header + SIZE_C(16), writer->document_size);
+	_bijson_index_put_uint64(header + SIZE_C(24), writer->document_hash);
+	_bijson_index_put_uint64(header + SIZE_C(32), writer->count);
+	_bijson_index_put_uint64(header + SIZE_C(40), writer->pointer_len);
+	_BIJSON_RETURN_ON_ERROR(write(write_data, header, sizeof header));
+
+	if(writer->pointer_len)
+		_BIJSON_RETURN_ON_ERROR(write(write_data, writer->pointer, writer->pointer_len));
+	_BIJSON_RETURN_ON_ERROR(_bijson_io_write_nul_bytes(write, write_data,
+		_bijson_index_pad(writer->pointer_len) - writer->pointer_len));
+
+	byte_t buffer[SIZE_C(256) * _BIJSON_INDEX_ENTRY_SIZE];
+	const _bijson_index_entry_t *entries = writer->entries;
+	size_t count = writer->count;
+	for(size_t start = 0; start < count; start += SIZE_C(256)) {
+		size_t batch = _bijson_size_min(count - start, SIZE_C(256));
+		for(size_t u = 0; u < batch; u++) {
+			_bijson_index_put_uint64(buffer + u * _BIJSON_INDEX_ENTRY_SIZE, entries[start + u].hash);
+			_bijson_index_put_uint64(buffer + u * _BIJSON_INDEX_ENTRY_SIZE + SIZE_C(8), entries[start + u].index);
+		}
+		_BIJSON_RETURN_ON_ERROR(write(write_data, buffer, batch * _BIJSON_INDEX_ENTRY_SIZE));
+	}
+
+	return NULL;
+}
+
+// Missing values are simply not indexed.
+__attribute__((pure))
+static inline bool _bijson_index_is_missing(bijson_error_t error) {
+	return error == bijson_error_key_not_found
+		|| error == bijson_error_index_out_of_range
+		|| error == bijson_error_type_mismatch;
+}
+
+static bijson_error_t _bijson_index_collect(
+	const _bijson_array_analysis_t *analysis,
+	const bijson_pointer_t *pointer,
+	_bijson_index_entry_t *entries,
+	size_t *count_result
+) {
+	_bijson_array_cursor_t cursor;
+	_bijson_array_cursor_init(&cursor, analysis);
+	size_t count = 0;
+	for(size_t u = 0; u < analysis->count; u++) {
+		bijson_t item;
+		_BIJSON_RETURN_ON_ERROR(_bijson_array_cursor_next(&cursor, &item));
+		bijson_t value;
+		bijson_error_t error = bijson_pointer_resolve(pointer, &item, &value);
+		if(_bijson_index_is_missing(error))
+			continue;
+		_BIJSON_RETURN_ON_ERROR(error);
+		entries[count++] = (_bijson_index_entry_t){_bijson_index_value_hash(&value), u};
+	}
+	*count_result = count;
+	return NULL;
+}
+
+bijson_error_t bijson_index_build(
+	const bijson_t *bijson,
+	const char *pointer,
+	size_t pointer_len,
+	const char *filename
+) {
+	if(!filename)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	_bijson_array_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(bijson, &analysis));
+
+	bijson_pointer_t *compiled;
+	_BIJSON_RETURN_ON_ERROR(bijson_pointer_compile(&compiled, pointer, pointer_len));
+
+	size_t count = analysis.count;
+	if(count > SIZE_MAX / sizeof(_bijson_index_entry_t) / SIZE_C(2)) {
+		bijson_pointer_free(compiled);
+		_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+	}
+	// Never allocate 0 bytes
+	size_t entries_size = (count ? count : SIZE_C(1)) * sizeof(_bijson_index_entry_t);
+	_bijson_index_entry_t *entries = malloc(entries_size * SIZE_C(2));
+	if(!entries) {
+		bijson_pointer_free(compiled);
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	}
+
+	size_t indexed;
+	bijson_error_t error = _bijson_index_collect(&analysis, compiled, entries, &indexed);
+	bijson_pointer_free(compiled);
+
+	if(!error) {
+		_bijson_index_sort(entries, entries + (count ? count : SIZE_C(1)), indexed);
+		_bijson_index_writer_t writer = {
+			.pointer = pointer,
+			.pointer_len = pointer_len,
+			.document_size = bijson->size,
+			.document_hash = rapidhash(bijson->buffer, bijson->size),
+			.entries = entries,
+			.count = indexed,
+		};
+		error = _bijson_io_write_to_filename(_bijson_index_write, &writer, filename, NULL);
+	}
+
+	free(entries);
+	return error;
+}
+
+static bijson_error_t _bijson_index_open(bijson_index_t *index, const bijson_t *bijson) {
+	const byte_t *buffer = index->file.buffer;
+	size_t size = index->file.size;
+
+	if(size < _BIJSON_INDEX_HEADER_SIZE
+		|| memcmp(buffer, _BIJSON_INDEX_MAGIC, SIZE_C(8))
+		|| _bijson_read_uint64(buffer + SIZE_C(8)) != _BIJSON_INDEX_VERSION
+	)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+
+	// The size check is cheap and catches most mistakes, the hash catches
+	// documents that were modified in place.
+	if(_bijson_read_uint64(buffer + SIZE_C(16)) != bijson->size
+		|| _bijson_read_uint64(buffer + SIZE_C(24)) != rapidhash(bijson->buffer, bijson->size)
+	)
+		_BIJSON_RETURN_ERROR(bijson_error_index_mismatch);
+
+	uint64_t count = _bijson_read_uint64(buffer + SIZE_C(32));
+	uint64_t pointer_len = _bijson_read_uint64(buffer + SIZE_C(40));
+	size_t available = size - _BIJSON_INDEX_HEADER_SIZE;
+	if(pointer_len > available)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+	size_t pointer_size = _bijson_index_pad((size_t)pointer_len);
+	if(pointer_size > available)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+	available -= pointer_size;
+	if(available % _BIJSON_INDEX_ENTRY_SIZE || count != available / _BIJSON_INDEX_ENTRY_SIZE)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+
+	const char *pointer = (const char *)buffer + _BIJSON_INDEX_HEADER_SIZE;
+	_BIJSON_RETURN_ON_ERROR(bijson_pointer_compile(&index->pointer, pointer, (size_t)pointer_len));
+
+	index->entries = buffer + _BIJSON_INDEX_HEADER_SIZE + pointer_size;
+	index->count = (size_t)count;
+	index->bijson = *bijson;
+
+	return _bijson_array_analyze(bijson, &index->analysis);
+}
+
+bijson_error_t bijson_index_open(bijson_index_t **result, const bijson_t *bijson, const char *filename) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
+
+	bijson_index_t *index = calloc(SIZE_C(1), sizeof *index);
+	if(!index)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+
+	bijson_error_t error = _bijson_io_read_from_filename(NULL, &index->file, filename);
+	if(!error)
+		error = _bijson_index_open(index, bijson);
+	if(error) {
+		bijson_index_close(index);
+		return error;
+	}
+
+	*result = index;
+	return NULL;
+}
+
+void bijson_index_close(bijson_index_t *index) {
+	if(!index)
+		return;
+	bijson_pointer_free(index->pointer);
+	_bijson_io_close(&index->file);
+	free(index);
+}
+
+__attribute__((pure))
+static inline uint64_t _bijson_index_entry_hash(const bijson_index_t *index, size_t entry) {
+	return _bijson_read_uint64(index->entries + entry * _BIJSON_INDEX_ENTRY_SIZE);
+}
+
+// Finds the first entry with a hash not lower than the given one, starting
+// from where the hash would be if hashes were perfectly evenly distributed
+// and searching outward with exponentially growing steps.
+__attribute__((pure))
+static size_t _bijson_index_lower_bound(const bijson_index_t *index, uint64_t hash) {
+	size_t count = index->count;
+	if(!count)
+		return 0;
+
+	size_t guess = _bijson_index_estimate(hash, count);
+	size_t low, high;
+	if(_bijson_index_entry_hash(index, guess) < hash) {
+		// The answer is in (guess, count]
+		size_t step = 1;
+		low = guess;
+		high = guess + step;
+		while(high < count && _bijson_index_entry_hash(index, high) < hash) {
+			low = high;
+			step *= SIZE_C(2);
+			high = count - low > step ? low + step : count;
+		}
+		low++;
+	} else {
+		// The answer is in [0, guess]
+		size_t step = 1;
+		high = guess;
+		low = guess;
+		while(low && _bijson_index_entry_hash(index, low - SIZE_C(1)) >= hash) {
+			high = low - SIZE_C(1);
+			low = high > step ? high - step : SIZE_C(0);
+			step *= SIZE_C(2);
+		}
+	}
+
+	// Bisect [low, high): everything before low is lower, high is not lower
+	while(low < high) {
+		size_t middle = low + (high - low) / SIZE_C(2);
+		if(_bijson_index_entry_hash(index, middle) < hash)
+			low = middle + SIZE_C(1);
+		else
+			high = middle;
+	}
+	return low;
+}
+
+bijson_error_t bijson_index_lookup(
+	const bijson_index_t *index,
+	const bijson_t *value,
+	bijson_index_callback_t callback,
+	void *callback_data
+) {
+	if(!index || !callback)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(value));
+
+	uint64_t hash = _bijson_index_value_hash(value);
+	for(size_t entry = _bijson_index_lower_bound(index, hash); entry < index->count; entry++) {
+		const byte_t *entry_buffer = index->entries + entry * _BIJSON_INDEX_ENTRY_SIZE;
+		if(_bijson_read_uint64(entry_buffer) != hash)
+			break;
+
+		uint64_t item_index = _bijson_read_uint64(entry_buffer + SIZE_C(8));
+		if(item_index >= index->analysis.count)
+			_BIJSON_RETURN_ERROR(bijson_error_index_mismatch);
+
+		bijson_t item;
+		_BIJSON_RETURN_ON_ERROR(_bijson_analyzed_array_get_index(&index->analysis, (size_t)item_index, &item));
+		bijson_t candidate;
+		bijson_error_t error = bijson_pointer_resolve(index->pointer, &item, &candidate);
+		if(_bijson_index_is_missing(error))
+			continue;
+		_BIJSON_RETURN_ON_ERROR(error);
+
+		if(candidate.size == value->size && !memcmp(candidate.buffer, value->buffer, value->size))
+			_BIJSON_RETURN_ON_ERROR(callback(callback_data, (size_t)item_index, &item));
+	}
+
+	return NULL;
+}
+
+bijson_error_t bijson_index_lookup_string(
+	const bijson_index_t *index,
+	const void *string,
+	size_t len,
+	bijson_index_callback_t callback,
+	void *callback_data
+) {
+	if(!string && len)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	if(len == SIZE_MAX)
+		_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+
+	// Encode the string as a bijson value
+	byte_t small[256];
+	byte_t *buffer = len < sizeof small ? small : malloc(len + SIZE_C(1));
+	if(!buffer)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	buffer[0] = BYTE_C(0x08);
+	if(len)
+		memcpy(buffer + SIZE_C(1), string, len);
+
+	bijson_t value = {buffer, len + SIZE_C(1)};
+	bijson_error_t error = bijson_index_lookup(index, &value, callback, callback_data);
+
+	if(buffer != small)
+		free(buffer);
+	return error;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../common.h"
+
+// The position that an entry with this hash would have among count entries
+// if the hashes were evenly spread: the upper half of hash * count, which
+// is always less than count. This version only needs 64-bit arithmetic.
+__attribute__((const))
+static inline size_t _bijson_index_estimate_narrow(uint64_t hash, size_t count) {
+	uint64_t hash_low = hash & UINT64_C(0xFFFFFFFF), hash_high = hash >> 32U;
+	uint64_t count_low = (uint64_t)count & UINT64_C(0xFFFFFFFF), count_high = (uint64_t)count >> 32U;
+	uint64_t low_low = hash_low * count_low;
+	uint64_t high_low = hash_high * count_low;
+	uint64_t low_high = hash_low * count_high;
+	uint64_t middle = (low_low >> 32U) + (high_low & UINT64_C(0xFFFFFFFF)) + low_high;
+	return (size_t)(hash_high * count_high + (high_low >> 32U) + (middle >> 32U));
+}
+
+__attribute__((const))
+static inline size_t _bijson_index_estimate(uint64_t hash, size_t count) {
+#ifdef __SIZEOF_INT128__
+	return (size_t)(((uint128_t)hash * (uint128_t)count) >> 64U);
+#else
+	return _bijson_index_estimate_narrow(hash, count);
+#endif
+}
@@ -4,20 +4,25 @@
 
 #include "../common.h"
 #include "../reader.h"
+#include "../io.h"
+#include "../rapidhash.h"
 #include "string.h"
 #include "object/index.h"
+#include "object/cursor.h"
 #include "object.h"
 
 static inline bijson_error_t _bijson_object_analyze_count(const bijson_t *bijson, _bijson_object_analysis_t *analysis) {
 	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
 
 	IF_DEBUG(memset(analysis, 'A', sizeof *analysis));
+	analysis->nocheck = false;
 
 	const byte_t *buffer = bijson->buffer;
 	const byte_t *buffer_end = buffer + bijson->size;
 
 	byte_compute_t type = *buffer;
-	if((type & BYTE_C(0xC0)) != BYTE_C(0x40))
+	byte_compute_t object_type = type & BYTE_C(0xC0);
+	if(object_type != BYTE_C(0x40) && object_type != BYTE_C(0x80))
 		_BIJSON_RETURN_ERROR(bijson_error_type_mismatch);
 
 	const byte_t *count_location = buffer + SIZE_C(1);
@@ -70,16 +75,24 @@ bijson_error_t _bijson_object_analyze(const bijson_t *bijson, _bijson_object_ana
 	size_t count = analysis->count;
 	size_t count_1 = analysis->count_1;
 	size_t index_and_data_size = _bijson_ptrdiff(buffer_end, analysis->key_index);
+	size_t hash_index_item_size = (type & BYTE_C(0x80)) ? sizeof(uint64_t) : SIZE_C(0);
 	size_t key_index_item_size = SIZE_C(1) << ((type >> 2U) & BYTE_C(0x3));
 	size_t value_index_item_size = SIZE_C(1) << ((type >> 4U) & BYTE_C(0x3));
 	// We need at least one key_index_item, one value_index_item, and one
-	// type byte for each item, but the first item does not have a value
-	// index entry, so fake that.
+	// type byte for each item (plus the hash, if present), but the first
+	// item does not have a value index entry, so fake that.
 	if(count > (index_and_data_size + value_index_item_size)
-		/ (key_index_item_size + value_index_item_size + SIZE_C(1))
+		/ (hash_index_item_size + key_index_item_size + value_index_item_size + SIZE_C(1))
 	)
 		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
 
+	if(hash_index_item_size) {
+		analysis->hash_index = analysis->key_index;
+		analysis->key_index += count * hash_index_item_size;
+	} else {
+		analysis->hash_index = NULL;
+	}
+
 	const byte_t *value_index = analysis->key_index + count * key_index_item_size;
 	const byte_t *key_data_start = value_index + count_1 * value_index_item_size;
 
@@ -99,6 +112,8 @@ bijson_error_t _bijson_object_analyze(const bijson_t *bijson, _bijson_object_ana
 	analysis->key_data_start = key_data_start;
 	analysis->value_index = value_index;
 	analysis->value_index_item_size = value_index_item_size;
+	analysis->get_index = _bijson_object_get_index_kernels[(type >> 2U) & BYTE_C(0x3)][(type >> 4U) & BYTE_C(0x3)];
+	analysis->cursor_next = _bijson_object_cursor_next_kernels[(type >> 2U) & BYTE_C(0x3)][(type >> 4U) & BYTE_C(0x3)];
 	analysis->value_data_start = value_data_start;
 	analysis->value_data_size = _bijson_ptrdiff(buffer_end, value_data_start);
 
@@ -110,22 +125,54 @@ bijson_error_t bijson_object_analyze(const bijson_t *bijson, bijson_object_analy
 	return _bijson_object_analyze(bijson, (_bijson_object_analysis_t *)result);
 }
 
-bijson_error_t _bijson_object_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data) {
+bijson_error_t bijson_object_analyze_nocheck(const bijson_t *bijson, bijson_object_analysis_t *result) {
+	assert(sizeof(_bijson_object_analysis_t) <= sizeof(*result));
+	_bijson_object_analysis_t *analysis = (_bijson_object_analysis_t *)result;
+	_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, analysis));
+	analysis->nocheck = true;
+	return NULL;
+}
+
+bijson_error_t _bijson_object_to_json(const bijson_t *bijson, bool nocheck, bijson_output_callback_t callback, void *callback_data) {
 	_bijson_object_analysis_t analysis;
 	_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
+	analysis.nocheck = nocheck;
 
-	_BIJSON_RETURN_ON_ERROR(callback(callback_data, "{", 1));
+	_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, "{", 1));
 
+	_bijson_object_cursor_t cursor;
+	_bijson_object_cursor_init(&cursor, &analysis);
 	for(size_t u = 0; u < analysis.count; u++) {
 		if(u)
-			_BIJSON_RETURN_ON_ERROR(callback(callback_data, ",", 1));
+			_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, ",", 1));
 
 		bijson_t key, value;
-		_BIJSON_RETURN_ON_ERROR(_bijson_analyzed_object_get_index(&analysis, u, &key.buffer, &key.size, &value));
+		_BIJSON_RETURN_ON_ERROR(_bijson_object_cursor_next(&cursor, &key.buffer, &key.size, &value));
 		_BIJSON_RETURN_ON_ERROR(_bijson_raw_string_to_json(&key, callback, callback_data));
-		_BIJSON_RETURN_ON_ERROR(callback(callback_data, ":", 1));
-		_BIJSON_RETURN_ON_ERROR(bijson_to_json(&value, callback, callback_data));
+		_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, ":", 1));
+		_BIJSON_RETURN_ON_ERROR(_bijson_to_json(&value, nocheck, callback, callback_data));
+	}
+
+	return _bijson_io_output(callback, callback_data, "}", 1);
+}
+
+bijson_error_t _bijson_object_verify(const bijson_t *bijson) {
+	_bijson_object_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
+
+	_bijson_object_cursor_t cursor;
+	_bijson_object_cursor_init(&cursor, &analysis);
+	for(size_t u = 0; u < analysis.count; u++) {
+		bijson_t key, value;
+		// This also validates the key:
+		_BIJSON_RETURN_ON_ERROR(_bijson_object_cursor_next(&cursor, &key.buffer, &key.size, &value));
+		if(analysis.hash_index
+			&& _bijson_read_minimal_int(analysis.hash_index + u * sizeof(uint64_t), sizeof(uint64_t))
+				!= rapidhash(key.buffer, key.size)
+		)
+			_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+		_BIJSON_RETURN_ON_ERROR(_bijson_verify(&value));
 	}
 
-	return callback(callback_data, "}", 1);
+	return NULL;
 }
@@ -2,9 +2,31 @@
 
 #include "../common.h"
 
-typedef struct _bijson_object_analysis {
+typedef struct _bijson_object_analysis _bijson_object_analysis_t;
+typedef struct _bijson_object_cursor _bijson_object_cursor_t;
+
+// Fetches an entry without checking the index against the count.
+typedef bijson_error_t (*_bijson_object_get_index_t)(
+	const _bijson_object_analysis_t *analysis,
+	size_t index,
+	const void **key_buffer_result,
+	size_t *key_size_result,
+	bijson_t *value_result
+);
+
+// Fetches the next entry without checking the index against the count.
+typedef bijson_error_t (*_bijson_object_cursor_next_t)(
+	_bijson_object_cursor_t *cursor,
+	const void **key_buffer_result,
+	size_t *key_size_result,
+	bijson_t *value_result
+);
+
+struct _bijson_object_analysis {
 	size_t count;
 	size_t count_1;
+	// Stored key hashes, or NULL if the object does not contain them.
+	const byte_t *hash_index;
 	const byte_t *key_index;
 	size_t key_index_item_size;
 	size_t last_key_end_offset;
@@ -13,7 +35,13 @@ typedef struct _bijson_object_analysis {
 	size_t value_index_item_size;
 	const byte_t *value_data_start;
 	size_t value_data_size;
-} _bijson_object_analysis_t;
+	// Specialized for the offset widths of this object
+	_bijson_object_get_index_t get_index;
+	_bijson_object_cursor_next_t cursor_next;
+	// Skip UTF-8 validation of keys (for verified documents)
+	bool nocheck;
+};
 
 extern bijson_error_t _bijson_object_analyze(const bijson_t *bijson, _bijson_object_analysis_t *analysis);
-extern bijson_error_t _bijson_object_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data);
+extern bijson_error_t _bijson_object_to_json(const bijson_t *bijson, bool nocheck, bijson_output_callback_t callback, void *callback_data);
+extern bijson_error_t _bijson_object_verify(const bijson_t *bijson);
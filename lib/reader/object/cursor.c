@@ -0,0 +1,182 @@
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "../../../include/reader.h"
+
+#include "../../common.h"
+#include "../object.h"
+#include "cursor.h"
+
+// Like _bijson_analyzed_object_get_index_impl(), but reads only the end
+// offsets of each entry, because the starts are where the previous one
+// ended. The offset widths are compile time constants here as well.
+__attribute__((always_inline))
+static inline bijson_error_t _bijson_object_cursor_next_impl(
+	_bijson_object_cursor_t *cursor,
+	const void **key_buffer_result,
+	size_t *key_size_result,
+	bijson_t *value_result,
+	size_t key_index_item_size,
+	size_t value_index_item_size
+) {
+	const _bijson_object_analysis_t *analysis = &cursor->analysis;
+	size_t index = cursor->index;
+	assert(index < analysis->count);
+
+	size_t count_1 = analysis->count_1;
+	size_t last_key_end_offset = analysis->last_key_end_offset;
+
+	uint64_t raw_key_end_offset = index == count_1
+		? last_key_end_offset
+		: _bijson_read_minimal_int(
+			analysis->key_index + key_index_item_size * index,
+			key_index_item_size
+		);
+	if(raw_key_end_offset > last_key_end_offset)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+	size_t key_end_offset = (size_t)raw_key_end_offset;
+
+	size_t key_start_offset = cursor->key_offset;
+	if(key_start_offset > key_end_offset)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+
+	size_t value_data_size = analysis->value_data_size;
+	// This is for comparing the raw offsets to, so it doesn't include
+	// the implicit "+ index" term yet.
+	size_t highest_valid_value_offset = value_data_size - analysis->count;
+
+	uint64_t raw_value_end_offset = index == count_1
+		? highest_valid_value_offset
+		: _bijson_read_minimal_int(
+			analysis->value_index + value_index_item_size * index,
+			value_index_item_size
+		);
+	if(raw_value_end_offset > highest_valid_value_offset)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+	size_t value_end_offset = index == count_1
+		? value_data_size
+		: (size_t)raw_value_end_offset + index + SIZE_C(1);
+
+	size_t value_start_offset = cursor->value_offset;
+	if(value_start_offset >= value_end_offset)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+
+	const byte_t *key_buffer = analysis->key_data_start + key_start_offset;
+	size_t key_size = key_end_offset - key_start_offset;
+
+	if(!analysis->nocheck) {
+		// We could return an UTF-8 error but it's the file that's at fault here:
+		bijson_error_t error = _bijson_check_valid_utf8(key_buffer, key_size);
+		if(error == bijson_error_invalid_utf8)
+			_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+		else if(error)
+			return error;
+	}
+
+	*key_buffer_result = key_buffer;
+	*key_size_result = key_size;
+	value_result->buffer = analysis->value_data_start + value_start_offset;
+	value_result->size = value_end_offset - value_start_offset;
+
+	cursor->index = index + SIZE_C(1);
+	cursor->key_offset = key_end_offset;
+	cursor->value_offset = value_end_offset;
+
+	return NULL;
+}
+
+#define _BIJSON_OBJECT_CURSOR_NEXT_KERNEL(key_index_item_size, value_index_item_size) \
+	static bijson_error_t _bijson_object_cursor_next_##key_index_item_size##_##value_index_item_size( \
+		_bijson_object_cursor_t *cursor, \
+		const void **key_buffer_result, \
+		size_t *key_size_result, \
+		bijson_t *value_result \
+	) { \
+		return _bijson_object_cursor_next_impl( \
+			cursor, \
+			key_buffer_result, \
+			key_size_result, \
+			value_result, \
+			SIZE_C(key_index_item_size), \
+			SIZE_C(value_index_item_size) \
+		); \
+	}
+
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(1, 1)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(1, 2)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(1, 4)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(1, 8)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(2, 1)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(2, 2)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(2, 4)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(2, 8)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(4, 1)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(4, 2)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(4, 4)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(4, 8)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(8, 1)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(8, 2)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(8, 4)
+_BIJSON_OBJECT_CURSOR_NEXT_KERNEL(8, 8)
+
+// Indexed by the key offset width bits and the value offset width bits
+// of the type byte, respectively.
+const _bijson_object_cursor_next_t _bijson_object_cursor_next_kernels[4][4] = {
+	{
+		_bijson_object_cursor_next_1_1,
+		_bijson_object_cursor_next_1_2,
+		_bijson_object_cursor_next_1_4,
+		_bijson_object_cursor_next_1_8,
+	},
+	{
+		_bijson_object_cursor_next_2_1,
+		_bijson_object_cursor_next_2_2,
+		_bijson_object_cursor_next_2_4,
+		_bijson_object_cursor_next_2_8,
+	},
+	{
+		_bijson_object_cursor_next_4_1,
+		_bijson_object_cursor_next_4_2,
+		_bijson_object_cursor_next_4_4,
+		_bijson_object_cursor_next_4_8,
+	},
+	{
+		_bijson_object_cursor_next_8_1,
+		_bijson_object_cursor_next_8_2,
+		_bijson_object_cursor_next_8_4,
+		_bijson_object_cursor_next_8_8,
+	},
+};
+
+bijson_error_t bijson_object_cursor_init(bijson_object_cursor_t *cursor, const bijson_t *bijson) {
+	assert(sizeof(_bijson_object_cursor_t) <= sizeof(*cursor));
+	if(!cursor)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	_bijson_object_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
+	_bijson_object_cursor_init((_bijson_object_cursor_t *)cursor, &analysis);
+	return NULL;
+}
+
+bijson_error_t bijson_analyzed_object_cursor_init(bijson_object_cursor_t *cursor, const bijson_object_analysis_t *analysis) {
+	assert(sizeof(_bijson_object_cursor_t) <= sizeof(*cursor));
+	if(!cursor || !analysis)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	_bijson_object_cursor_init((_bijson_object_cursor_t *)cursor, (const _bijson_object_analysis_t *)analysis);
+	return NULL;
+}
+
+bijson_error_t bijson_object_cursor_next(
+	bijson_object_cursor_t *cursor,
+	const void **key_buffer_result,
+	size_t *key_size_result,
+	bijson_t *value_result
+) {
+	return _bijson_object_cursor_next(
+		(_bijson_object_cursor_t *)cursor,
+		key_buffer_result,
+		key_size_result,
+		value_result
+	);
+}
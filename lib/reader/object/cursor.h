@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../../common.h"
+#include "../../reader.h"
+#include "../object.h"
+
+struct _bijson_object_cursor {
+	_bijson_object_analysis_t analysis;
+	size_t index;
+	// End of the previous key
+	size_t key_offset;
+	// Start of the next value (including the implicit "+ index" term)
+	size_t value_offset;
+};
+
+extern const _bijson_object_cursor_next_t _bijson_object_cursor_next_kernels[4][4];
+
+static inline void _bijson_object_cursor_init(_bijson_object_cursor_t *cursor, const _bijson_object_analysis_t *analysis) {
+	cursor->analysis = *analysis;
+	cursor->index = SIZE_C(0);
+	cursor->key_offset = SIZE_C(0);
+	cursor->value_offset = SIZE_C(0);
+}
+
+static inline bijson_error_t _bijson_object_cursor_next(
+	_bijson_object_cursor_t *cursor,
+	const void **key_buffer_result,
+	size_t *key_size_result,
+	bijson_t *value_result
+) {
+	if(cursor->index >= cursor->analysis.count)
+		return bijson_error_index_out_of_range;
+
+	return cursor->analysis.cursor_next(cursor, key_buffer_result, key_size_result, value_result);
+}
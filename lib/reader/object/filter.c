@@ -0,0 +1,136 @@
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "../../../include/reader.h"
+
+#include "../../common.h"
+#include "../../rapidhash.h"
+#include "../object.h"
+#include "cursor.h"
+
+// A split block bloom filter: each key sets one bit in each of the 8 words
+// of a single 32 byte block, so checking a key touches one cache line.
+// The block is selected using the upper half of the key's rapidhash and the
+// bits using the lower half, multiplied by a different odd constant for
+// each word.
+
+#define _BIJSON_OBJECT_FILTER_BITS_PER_KEY SIZE_C(12)
+#define _BIJSON_OBJECT_FILTER_WORDS SIZE_C(8)
+
+typedef uint32_t _bijson_object_filter_block_t[_BIJSON_OBJECT_FILTER_WORDS];
+
+struct bijson_object_filter {
+	size_t count;
+	_bijson_object_filter_block_t blocks[];
+};
+
+static const uint32_t _bijson_object_filter_salt[_BIJSON_OBJECT_FILTER_WORDS] = {
+	UINT32_C(0x47B6137B), UINT32_C(0x44974D91), UINT32_C(0x8824AD5B), UINT32_C(0xA2B7289D),
+	UINT32_C(0x705495C7), UINT32_C(0x2DF1424B), UINT32_C(0x9EFC4947), UINT32_C(0x5C6BFB31),
+};
+
+// Maps the upper 32 bits onto [0, count) without a division
+__attribute__((const))
+static inline size_t _bijson_object_filter_block(size_t count, uint64_t hash) {
+	return (size_t)(((hash >> 32U) * (uint64_t)count) >> 32U);
+}
+
+__attribute__((const))
+static inline uint32_t _bijson_object_filter_bit(uint64_t hash, size_t word) {
+	uint32_t product = (uint32_t)hash * _bijson_object_filter_salt[word];
+	return UINT32_C(1) << (product >> 27U);
+}
+
+static bijson_error_t _bijson_analyzed_object_filter_build(bijson_object_filter_t **result, const _bijson_object_analysis_t *analysis) {
+	if(!result || !analysis)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	size_t count = analysis->count;
+	if(count > SIZE_MAX / _BIJSON_OBJECT_FILTER_BITS_PER_KEY)
+		_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+	size_t block_bits = sizeof(_bijson_object_filter_block_t) * SIZE_C(8);
+	size_t blocks = (count * _BIJSON_OBJECT_FILTER_BITS_PER_KEY + block_bits - SIZE_C(1)) / block_bits;
+	if(!blocks)
+		blocks = SIZE_C(1);
+	// Only 32 bits of the hash are used to select the block
+	if(blocks > (size_t)UINT32_MAX)
+		blocks = (size_t)UINT32_MAX;
+
+	size_t size = sizeof(bijson_object_filter_t) + blocks * sizeof(_bijson_object_filter_block_t);
+	void *buffer;
+	// Align the blocks to cache lines
+	if(posix_memalign(&buffer, SIZE_C(64), size))
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	memset(buffer, 0, size);
+	bijson_object_filter_t *filter = buffer;
+	filter->count = blocks;
+
+	_bijson_object_cursor_t cursor;
+	_bijson_object_cursor_init(&cursor, analysis);
+	for(size_t u = 0; u < count; u++) {
+		const void *key;
+		size_t key_size;
+		bijson_t value;
+		bijson_error_t error = _bijson_object_cursor_next(&cursor, &key, &key_size, &value);
+		if(error) {
+			free(filter);
+			return error;
+		}
+		uint64_t hash = analysis->hash_index
+			? _bijson_read_minimal_int(analysis->hash_index + u * sizeof(uint64_t), sizeof(uint64_t))
+			: rapidhash(key, key_size);
+		uint32_t *block = filter->blocks[_bijson_object_filter_block(blocks, hash)];
+		for(size_t w = 0; w < _BIJSON_OBJECT_FILTER_WORDS; w++)
+			block[w] |= _bijson_object_filter_bit(hash, w);
+	}
+
+	*result = filter;
+	return NULL;
+}
+
+bijson_error_t bijson_analyzed_object_filter_build(bijson_object_filter_t **result, const bijson_object_analysis_t *analysis) {
+	return _bijson_analyzed_object_filter_build(result, (const _bijson_object_analysis_t *)analysis);
+}
+
+bijson_error_t bijson_object_filter_build(bijson_object_filter_t **result, const bijson_t *bijson) {
+	_bijson_object_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
+	return _bijson_analyzed_object_filter_build(result, &analysis);
+}
+
+static inline bool _bijson_object_filter_check(const bijson_object_filter_t *filter, uint64_t hash) {
+	const uint32_t *block = filter->blocks[_bijson_object_filter_block(filter->count, hash)];
+	// No early exit: checking all words is branchless and the block is in
+	// a single cache line anyway.
+	uint32_t missing = 0;
+	for(size_t w = 0; w < _BIJSON_OBJECT_FILTER_WORDS; w++) {
+		uint32_t bit = _bijson_object_filter_bit(hash, w);
+		missing |= (block[w] & bit) ^ bit;
+	}
+	return !missing;
+}
+
+bijson_error_t bijson_object_filter_check(const bijson_object_filter_t *filter, const bijson_key_t *key, bool *result) {
+	if(!filter || !key || !result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	*result = _bijson_object_filter_check(filter, key->hash);
+	return NULL;
+}
+
+bijson_error_t bijson_analyzed_object_get_filtered_key(
+	const bijson_object_analysis_t *analysis,
+	const bijson_object_filter_t *filter,
+	const bijson_key_t *key,
+	bijson_t *result
+) {
+	if(!analysis || !filter || !key || !result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	if(!_bijson_object_filter_check(filter, key->hash))
+		_BIJSON_RETURN_ERROR(bijson_error_key_not_found);
+	return bijson_analyzed_object_get_prepared_key(analysis, key, result);
+}
+
+void bijson_object_filter_free(bijson_object_filter_t *filter) {
+	free(filter);
+}
@@ -9,19 +9,23 @@
 #include "../object.h"
 #include "index.h"
 
-bijson_error_t _bijson_analyzed_object_get_index(
+// The offset widths are passed as compile time constants by the
+// specialized versions below, so that all offset reads reduce to
+// single fixed width loads.
+__attribute__((always_inline))
+static inline bijson_error_t _bijson_analyzed_object_get_index_impl(
 	const _bijson_object_analysis_t *analysis,
 	size_t index,
 	const void **key_buffer_result,
 	size_t *key_size_result,
-	bijson_t *value_result
+	bijson_t *value_result,
+	size_t key_index_item_size,
+	size_t value_index_item_size
 ) {
 	size_t count = analysis->count;
-	if(index >= count)
-		_BIJSON_RETURN_ERROR(bijson_error_index_out_of_range);
+	assert(index < count);
 
 	const byte_t *key_index = analysis->key_index;
-	size_t key_index_item_size = analysis->key_index_item_size;
 	size_t last_key_end_offset = analysis->last_key_end_offset;
 
 	uint64_t raw_key_start_offset = index
@@ -47,7 +51,6 @@ bijson_error_t _bijson_analyzed_object_get_index(
 		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
 
 	const byte_t *value_index = analysis->value_index;
-	size_t value_index_item_size = analysis->value_index_item_size;
 	size_t value_data_size = analysis->value_data_size;
 
 	// This is for comparing the raw offsets to, so it doesn't include
@@ -84,12 +87,14 @@ bijson_error_t _bijson_analyzed_object_get_index(
 	const byte_t *key_buffer = analysis->key_data_start + key_start_offset;
 	size_t key_size = key_end_offset - key_start_offset;
 
-	// We could return an UTF-8 error but it's the file that's at fault here:
-	bijson_error_t error = _bijson_check_valid_utf8(key_buffer, key_size);
-	if(error == bijson_error_invalid_utf8)
-		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
-	else if(error)
-		return error;
+	if(!analysis->nocheck) {
+		// We could return an UTF-8 error but it's the file that's at fault here:
+		bijson_error_t error = _bijson_check_valid_utf8(key_buffer, key_size);
+		if(error == bijson_error_invalid_utf8)
+			_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+		else if(error)
+			return error;
+	}
 
 	*key_buffer_result = key_buffer;
 	*key_size_result = key_size;
@@ -99,6 +104,68 @@ bijson_error_t _bijson_analyzed_object_get_index(
 	return NULL;
 }
 
+#define _BIJSON_OBJECT_GET_INDEX_KERNEL(key_index_item_size, value_index_item_size) \
+	static bijson_error_t _bijson_analyzed_object_get_index_##key_index_item_size##_##value_index_item_size( \
+		const _bijson_object_analysis_t *analysis, \
+		size_t index, \
+		const void **key_buffer_result, \
+		size_t *key_size_result, \
+		bijson_t *value_result \
+	) { \
+		return _bijson_analyzed_object_get_index_impl( \
+			analysis, \
+			index, \
+			key_buffer_result, \
+			key_size_result, \
+			value_result, \
+			SIZE_C(key_index_item_size), \
+			SIZE_C(value_index_item_size) \
+		); \
+	}
+
+_BIJSON_OBJECT_GET_INDEX_KERNEL(1, 1)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(1, 2)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(1, 4)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(1, 8)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(2, 1)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(2, 2)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(2, 4)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(2, 8)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(4, 1)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(4, 2)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(4, 4)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(4, 8)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(8, 1)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(8, 2)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(8, 4)
+_BIJSON_OBJECT_GET_INDEX_KERNEL(8, 8)
+
+// Indexed by the key offset width bits and the value offset width bits
+// of the type byte, respectively.
+const _bijson_object_get_index_t _bijson_object_get_index_kernels[4][4] = {
+	{
+		_bijson_analyzed_object_get_index_1_1,
+		_bijson_analyzed_object_get_index_1_2,
+		_bijson_analyzed_object_get_index_1_4,
+		_bijson_analyzed_object_get_index_1_8,
+	}, {
+		_bijson_analyzed_object_get_index_2_1,
+		_bijson_analyzed_object_get_index_2_2,
+		_bijson_analyzed_object_get_index_2_4,
+		_bijson_analyzed_object_get_index_2_8,
+	}, {
+		_bijson_analyzed_object_get_index_4_1,
+		_bijson_analyzed_object_get_index_4_2,
+		_bijson_analyzed_object_get_index_4_4,
+		_bijson_analyzed_object_get_index_4_8,
+	}, {
+		_bijson_analyzed_object_get_index_8_1,
+		_bijson_analyzed_object_get_index_8_2,
+		_bijson_analyzed_object_get_index_8_4,
+		_bijson_analyzed_object_get_index_8_8,
+	},
+};
+
 bijson_error_t bijson_object_get_index(
 	const bijson_t *bijson,
 	size_t index,
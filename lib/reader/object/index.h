@@ -3,10 +3,16 @@
 #include "../../common.h"
 #include "../object.h"
 
-extern bijson_error_t _bijson_analyzed_object_get_index(
+extern const _bijson_object_get_index_t _bijson_object_get_index_kernels[4][4];
+
+static inline bijson_error_t _bijson_analyzed_object_get_index(
 	const _bijson_object_analysis_t *analysis,
 	size_t index,
 	const void **key_buffer_result,
 	size_t *key_size_result,
 	bijson_t *value_result
-);
+) {
+	if(index >= analysis->count)
+		_BIJSON_RETURN_ERROR(bijson_error_index_out_of_range);
+	return analysis->get_index(analysis, index, key_buffer_result, key_size_result, value_result);
+}
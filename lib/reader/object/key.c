@@ -21,25 +21,38 @@ int _bijson_get_key_entry_cmp(const _bijson_get_key_entry_t *a, const _bijson_ge
 
 __attribute__((pure))
 size_t _bijson_get_key_guess(_bijson_get_key_entry_t *lower, _bijson_get_key_entry_t *upper, _bijson_get_key_entry_t *target) {
+	size_t range = upper->index - lower->index;
 	if(lower->hash >= upper->hash)
-		return lower->index + ((upper->index - lower->index) >> 1U);
+		return lower->index + (range >> 1U);
+#ifdef __SIZEOF_INT128__
+	size_t offset = (size_t)(
+		(uint128_t)range
+		* (target->hash - lower->hash)
+		/ (upper->hash - lower->hash)
+	);
+#else
 	// Put in a temporary variable to appease -Wbad-function-cast
-	long double offset = floorl(
-		(long double)(upper->index - lower->index)
+	long double raw_offset = floorl(
+		(long double)range
 		* (long double)(target->hash - lower->hash)
 		/ (long double)(upper->hash - lower->hash)
 	);
-	return lower->index + (size_t)offset;
+	size_t offset = (size_t)raw_offset;
+#endif
+	// If target->hash equals upper->hash we would end up at upper->index,
+	// which is not part of the search range.
+	if(offset >= range)
+		offset = range - SIZE_C(1);
+	return lower->index + offset;
 }
 
 static inline bijson_error_t _bijson_analyzed_object_get_key(
 	const _bijson_object_analysis_t *analysis,
 	const char *key,
 	size_t len,
+	uint64_t hash,
 	bijson_t *result
 ) {
-	// static size_t record_attempts = SIZE_C(0);
-
 	if(!analysis->count)
 		_BIJSON_RETURN_ERROR(bijson_error_key_not_found);
 
@@ -56,41 +69,29 @@ static inline bijson_error_t _bijson_analyzed_object_get_key(
 	}
 
 	_bijson_get_key_entry_t target = {
-		.hash = rapidhash(key, len),
+		.hash = hash,
 		.key = key,
 		.len = len,
 	};
 
-	size_t max_attempts = _bijson_2log64(analysis->count);
 	_bijson_get_key_entry_t lower = {0};
 	_bijson_get_key_entry_t upper = {.index = analysis->count, .hash = UINT64_MAX};
 
-	for(size_t attempt = SIZE_C(0); lower.index != upper.index; attempt++) {
-		// if(attempt > record_attempts) {
-		// 	record_attempts = attempt;
-		// 	fprintf(stderr, "record_attempts: %zu (max_attempts: %zu)\n", record_attempts, max_attempts);
-		// }
+	bijson_error_t error = _bijson_analyzed_object_find_key(analysis, &target, &lower, &upper, NULL, NULL);
+	if(error)
+		_BIJSON_RETURN_ERROR(error);
 
-		_bijson_get_key_entry_t guess = {
-			.index = attempt < max_attempts
-				? _bijson_get_key_guess(&lower, &upper, &target)
-				: lower.index + ((upper.index - lower.index) >> 1U)
-		};
-		_BIJSON_RETURN_ON_ERROR(_bijson_get_key_entry_get(analysis, &guess));
-		int c = _bijson_get_key_entry_cmp(&guess, &target);
-		if(c == 0) {
-			*result = guess.value;
-			return NULL;
-		} else if(c < 0) {
-			lower.hash = guess.hash;
-			lower.index = guess.index + SIZE_C(1);
-		} else {
-			upper.hash = guess.hash;
-			upper.index = guess.index;
-		}
-	}
+	*result = target.value;
+	return NULL;
+}
 
-	_BIJSON_RETURN_ERROR(bijson_error_key_not_found);
+bijson_error_t bijson_key_prepare(bijson_key_t *result, const void *key, size_t len) {
+	if(!result || (!key && len))
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	result->key = key;
+	result->len = len;
+	result->hash = rapidhash(key, len);
+	return NULL;
 }
 
 bijson_error_t bijson_analyzed_object_get_key(
@@ -99,7 +100,7 @@ bijson_error_t bijson_analyzed_object_get_key(
 	size_t len,
 	bijson_t *result
 ) {
-	return _bijson_analyzed_object_get_key((const _bijson_object_analysis_t *)analysis, key, len, result);
+	return _bijson_analyzed_object_get_key((const _bijson_object_analysis_t *)analysis, key, len, rapidhash(key, len), result);
 }
 
 bijson_error_t bijson_object_get_key(
@@ -110,5 +111,164 @@ bijson_error_t bijson_object_get_key(
 ) {
 	_bijson_object_analysis_t analysis;
 	_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
-	return _bijson_analyzed_object_get_key(&analysis, key, len, result);
+	return _bijson_analyzed_object_get_key(&analysis, key, len, rapidhash(key, len), result);
+}
+
+bijson_error_t bijson_analyzed_object_get_prepared_key(
+	const bijson_object_analysis_t *analysis,
+	const bijson_key_t *key,
+	bijson_t *result
+) {
+	return _bijson_analyzed_object_get_key((const _bijson_object_analysis_t *)analysis, key->key, key->len, key->hash, result);
+}
+
+bijson_error_t bijson_object_get_prepared_key(
+	const bijson_t *bijson,
+	const bijson_key_t *key,
+	bijson_t *result
+) {
+	_bijson_object_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
+	return _bijson_analyzed_object_get_key(&analysis, key->key, key->len, key->hash, result);
+}
+
+static int _bijson_key_ptr_cmp(const void *a, const void *b) {
+	const bijson_key_t *a_key = *(const bijson_key_t * const *)a;
+	const bijson_key_t *b_key = *(const bijson_key_t * const *)b;
+	return a_key->hash == b_key->hash
+		? a_key->len == b_key->len
+			? memcmp(a_key->key, b_key->key, a_key->len)
+			: a_key->len < b_key->len ? -1 : 1
+		: a_key->hash < b_key->hash ? -1 : 1;
+}
+
+// Upper bounds found while looking up earlier keys. Since the keys are
+// processed in ascending order, we only ever need the most recent ones
+// (those with the lowest indices), so this is used as a stack.
+#define _BIJSON_GET_KEYS_MAX_UPPER_BOUNDS SIZE_C(64)
+
+typedef struct _bijson_get_keys_upper_bounds {
+	size_t used;
+	size_t index[_BIJSON_GET_KEYS_MAX_UPPER_BOUNDS];
+	uint64_t hash[_BIJSON_GET_KEYS_MAX_UPPER_BOUNDS];
+} _bijson_get_keys_upper_bounds_t;
+
+static void _bijson_get_keys_upper_callback(void *upper_callback_data, const _bijson_get_key_entry_t *upper) {
+	_bijson_get_keys_upper_bounds_t *bounds = upper_callback_data;
+	size_t used = bounds->used;
+	// If we run out of space we simply end up with less tight bounds.
+	if(used < _BIJSON_GET_KEYS_MAX_UPPER_BOUNDS) {
+		bounds->index[used] = upper->index;
+		bounds->hash[used] = upper->hash;
+		bounds->used = used + SIZE_C(1);
+	}
+}
+
+// Sorts the keys by hash and then looks them all up in a single pass over
+// the object, using the result of each lookup as the lower bound for the
+// next one and remembering upper bounds that are still applicable.
+static inline bijson_error_t _bijson_analyzed_object_get_keys(
+	const _bijson_object_analysis_t *analysis,
+	const bijson_key_t *keys,
+	size_t count,
+	bijson_t *results
+) {
+	if(!count)
+		return NULL;
+	if(!keys || !results)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	for(size_t u = 0; u < count; u++)
+		results[u] = bijson_0;
+
+	if(!analysis->count)
+		return NULL;
+
+	const bijson_key_t *small_order[16];
+	const bijson_key_t **order = small_order;
+	if(count > _BIJSON_ARRAY_COUNT(small_order)) {
+		if(count > SIZE_MAX / sizeof *order)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		order = malloc(count * sizeof *order);
+		if(!order)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+	}
+
+	for(size_t u = 0; u < count; u++)
+		order[u] = keys + u;
+	qsort(order, count, sizeof *order, _bijson_key_ptr_cmp);
+
+	_bijson_get_keys_upper_bounds_t bounds = {0};
+	_bijson_get_key_entry_t lower = {0};
+	bijson_error_t error = NULL;
+
+	for(size_t u = 0; u < count; u++) {
+		const bijson_key_t *key = order[u];
+		_bijson_get_key_entry_t target = {
+			.hash = key->hash,
+			.key = key->key,
+			.len = key->len,
+		};
+
+		// Discard upper bounds that are no longer beyond the current key
+		while(bounds.used && bounds.hash[bounds.used - SIZE_C(1)] <= target.hash)
+			bounds.used--;
+		_bijson_get_key_entry_t upper = bounds.used
+			? (_bijson_get_key_entry_t){
+				.index = bounds.index[bounds.used - SIZE_C(1)],
+				.hash = bounds.hash[bounds.used - SIZE_C(1)],
+			}
+			: (_bijson_get_key_entry_t){.index = analysis->count, .hash = UINT64_MAX};
+
+		// Duplicate keys in the batch
+		if(u && !_bijson_key_ptr_cmp(&order[u - SIZE_C(1)], &order[u])) {
+			results[key - keys] = results[order[u - SIZE_C(1)] - keys];
+			continue;
+		}
+
+		_bijson_get_key_entry_t key_lower = lower;
+		error = _bijson_analyzed_object_find_key(
+			analysis,
+			&target,
+			&key_lower,
+			&upper,
+			_bijson_get_keys_upper_callback,
+			&bounds
+		);
+		if(!error) {
+			results[key - keys] = target.value;
+			lower.index = target.index + SIZE_C(1);
+			lower.hash = target.hash;
+		} else if(error == bijson_error_key_not_found) {
+			error = NULL;
+			lower = key_lower;
+		} else {
+			break;
+		}
+	}
+
+	if(order != small_order)
+		free(order);
+
+	return error;
+}
+
+bijson_error_t bijson_analyzed_object_get_keys(
+	const bijson_object_analysis_t *analysis,
+	const bijson_key_t *keys,
+	size_t count,
+	bijson_t *results
+) {
+	return _bijson_analyzed_object_get_keys((const _bijson_object_analysis_t *)analysis, keys, count, results);
+}
+
+bijson_error_t bijson_object_get_keys(
+	const bijson_t *bijson,
+	const bijson_key_t *keys,
+	size_t count,
+	bijson_t *results
+) {
+	_bijson_object_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
+	return _bijson_analyzed_object_get_keys(&analysis, keys, count, results);
 }
@@ -2,6 +2,7 @@
 
 #include "../../common.h"
 #include "../../rapidhash.h"
+#include "../../reader.h"
 #include "../object.h"
 #include "index.h"
 
@@ -20,4 +21,72 @@ static inline bijson_error_t _bijson_get_key_entry_get(const _bijson_object_anal
 }
 
 extern int _bijson_get_key_entry_cmp(const _bijson_get_key_entry_t *a, const _bijson_get_key_entry_t *b);
+
+// Fills in entry (whose index must be set) and compares it to target.
+// If the object has stored key hashes, the key itself is only accessed
+// when the hashes are equal. In that case entry->key and entry->value are
+// not filled in for unequal hashes.
+static inline bijson_error_t _bijson_get_key_entry_compare(
+	const _bijson_object_analysis_t *analysis,
+	_bijson_get_key_entry_t *entry,
+	const _bijson_get_key_entry_t *target,
+	int *result
+) {
+	const byte_t *hash_index = analysis->hash_index;
+	if(hash_index) {
+		uint64_t hash = _bijson_read_minimal_int(hash_index + entry->index * sizeof(uint64_t), sizeof(uint64_t));
+		entry->hash = hash;
+		if(hash != target->hash)
+			return *result = hash < target->hash ? -1 : 1, NULL;
+		_BIJSON_RETURN_ON_ERROR(_bijson_analyzed_object_get_index(analysis, entry->index, &entry->key, &entry->len, &entry->value));
+	} else {
+		_BIJSON_RETURN_ON_ERROR(_bijson_get_key_entry_get(analysis, entry));
+	}
+	*result = _bijson_get_key_entry_cmp(entry, target);
+	return NULL;
+}
 extern size_t _bijson_get_key_guess(_bijson_get_key_entry_t *lower, _bijson_get_key_entry_t *upper, _bijson_get_key_entry_t *target);
+
+// Searches for target in the range [lower->index, upper->index). On return,
+// lower and upper contain the narrowed down bounds. If the key was found,
+// target->index and target->value are filled in.
+// The optional upper_callback is invoked for every new upper bound, so that
+// searches for subsequent keys can reuse them.
+typedef void (*_bijson_get_key_upper_callback_t)(void *upper_callback_data, const _bijson_get_key_entry_t *upper);
+
+static inline bijson_error_t _bijson_analyzed_object_find_key(
+	const _bijson_object_analysis_t *analysis,
+	_bijson_get_key_entry_t *target,
+	_bijson_get_key_entry_t *lower,
+	_bijson_get_key_entry_t *upper,
+	_bijson_get_key_upper_callback_t upper_callback,
+	void *upper_callback_data
+) {
+	size_t range = upper->index - lower->index;
+	size_t max_attempts = range > SIZE_C(1) ? _bijson_2log64(range) : SIZE_C(1);
+
+	for(size_t attempt = SIZE_C(0); lower->index != upper->index; attempt++) {
+		_bijson_get_key_entry_t guess = {
+			.index = attempt < max_attempts
+				? _bijson_get_key_guess(lower, upper, target)
+				: lower->index + ((upper->index - lower->index) >> 1U)
+		};
+		int c;
+		_BIJSON_RETURN_ON_ERROR(_bijson_get_key_entry_compare(analysis, &guess, target, &c));
+		if(c == 0) {
+			target->index = guess.index;
+			target->value = guess.value;
+			return NULL;
+		} else if(c < 0) {
+			lower->hash = guess.hash;
+			lower->index = guess.index + SIZE_C(1);
+		} else {
+			upper->hash = guess.hash;
+			upper->index = guess.index;
+			if(upper_callback)
+				upper_callback(upper_callback_data, upper);
+		}
+	}
+
+	return bijson_error_key_not_found;
+}
@@ -126,6 +126,7 @@ static inline bijson_error_t _bijson_analyzed_object_get_key_range(
 	const _bijson_object_analysis_t *analysis,
 	const char *key,
 	size_t len,
+	uint64_t hash,
 	size_t *start_index,
 	size_t *end_index
 ) {
@@ -146,7 +147,7 @@ static inline bijson_error_t _bijson_analyzed_object_get_key_range(
 	}
 
 	_bijson_get_key_entry_t target = {
-		.hash = rapidhash(key, len),
+		.hash = hash,
 		.key = key,
 		.len = len,
 	};
@@ -161,8 +162,8 @@ static inline bijson_error_t _bijson_analyzed_object_get_key_range(
 				? _bijson_get_key_guess(&lower, &upper, &target)
 				: lower.index + ((upper.index - lower.index) >> 1U)
 		};
-		_BIJSON_RETURN_ON_ERROR(_bijson_get_key_entry_get(analysis, &guess));
-		int c = _bijson_get_key_entry_cmp(&guess, &target);
+		int c;
+		_BIJSON_RETURN_ON_ERROR(_bijson_get_key_entry_compare(analysis, &guess, &target, &c));
 		if(c == 0) {
 			target.index = guess.index;
 			_BIJSON_RETURN_ON_ERROR(_bijson_analyzed_object_get_key_range_lower(analysis, &target, &lower));
@@ -189,7 +190,7 @@ bijson_error_t bijson_analyzed_object_get_key_range(
 	size_t *start_index,
 	size_t *end_index
 ) {
-	return _bijson_analyzed_object_get_key_range((const _bijson_object_analysis_t *)analysis, key, len, start_index, end_index);
+	return _bijson_analyzed_object_get_key_range((const _bijson_object_analysis_t *)analysis, key, len, rapidhash(key, len), start_index, end_index);
 }
 
 bijson_error_t bijson_object_get_key_range(
@@ -201,5 +202,25 @@ bijson_error_t bijson_object_get_key_range(
 ) {
 	_bijson_object_analysis_t analysis;
 	_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
-	return _bijson_analyzed_object_get_key_range(&analysis, key, len, start_index, end_index);
+	return _bijson_analyzed_object_get_key_range(&analysis, key, len, rapidhash(key, len), start_index, end_index);
+}
+
+bijson_error_t bijson_analyzed_object_get_prepared_key_range(
+	const bijson_object_analysis_t *analysis,
+	const bijson_key_t *key,
+	size_t *start_index,
+	size_t *end_index
+) {
+	return _bijson_analyzed_object_get_key_range((const _bijson_object_analysis_t *)analysis, key->key, key->len, key->hash, start_index, end_index);
+}
+
+bijson_error_t bijson_object_get_prepared_key_range(
+	const bijson_t *bijson,
+	const bijson_key_t *key,
+	size_t *start_index,
+	size_t *end_index
+) {
+	_bijson_object_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
+	return _bijson_analyzed_object_get_key_range(&analysis, key->key, key->len, key->hash, start_index, end_index);
 }
@@ -0,0 +1,270 @@
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "../../../include/reader.h"
+
+#include "../../common.h"
+#include "../../reader.h"
+#include "../object.h"
+#include "cursor.h"
+#include "index.h"
+
+// Objects store their entries in hash order. A sorted view is a permutation
+// of the entry indices that puts the keys in byte-lexical order, so that
+// ordered iteration and prefix/range scans only need binary searches.
+// The permutation uses the smallest integer width that fits the object.
+
+struct bijson_object_sorted_view {
+	_bijson_object_analysis_t analysis;
+	size_t width;
+	byte_t permutation[];
+};
+
+typedef struct _bijson_object_sorted_view_entry {
+	// The first 8 bytes of the key, big endian and zero padded, so that
+	// most comparisons do not need to touch the key data at all.
+	uint64_t prefix;
+	const byte_t *key;
+	size_t len;
+	size_t index;
+} _bijson_object_sorted_view_entry_t;
+
+__attribute__((pure))
+static inline int _bijson_object_sorted_view_key_cmp(const void *a, size_t a_len, const void *b, size_t b_len) {
+	int c = memcmp(a, b, _bijson_size_min(a_len, b_len));
+	if(c)
+		return c;
+	return a_len < b_len ? -1 : a_len > b_len;
+}
+
+__attribute__((pure))
+static int _bijson_object_sorted_view_entry_cmp(const void *a, const void *b) {
+	const _bijson_object_sorted_view_entry_t *x = a;
+	const _bijson_object_sorted_view_entry_t *y = b;
+	if(x->prefix != y->prefix)
+		return x->prefix < y->prefix ? -1 : 1;
+	return _bijson_object_sorted_view_key_cmp(x->key, x->len, y->key, y->len);
+}
+
+// Smallest of 1, 2, 4 or 8 bytes that can hold every index below count
+__attribute__((const))
+static inline size_t _bijson_object_sorted_view_width(size_t count) {
+	uint64_t highest = count ? (uint64_t)count - UINT64_C(1) : UINT64_C(0);
+	if(highest <= UINT64_C(0xFF))
+		return SIZE_C(1);
+	if(highest <= UINT64_C(0xFFFF))
+		return SIZE_C(2);
+	if(highest <= UINT64_C(0xFFFFFFFF))
+		return SIZE_C(4);
+	return SIZE_C(8);
+}
+
+__attribute__((pure))
+static inline uint64_t _bijson_object_sorted_view_prefix(const byte_t *key, size_t len) {
+	uint64_t prefix = 0;
+	size_t n = _bijson_size_min(len, SIZE_C(8));
+	for(size_t u = 0; u < n; u++)
+		prefix |= (uint64_t)key[u] << (SIZE_C(56) - u * SIZE_C(8));
+	return prefix;
+}
+
+static bijson_error_t _bijson_analyzed_object_sorted_view_build(
+	bijson_object_sorted_view_t **result,
+	const _bijson_object_analysis_t *analysis
+) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	size_t count = analysis->count;
+	size_t width = _bijson_object_sorted_view_width(count);
+	if(count > (SIZE_MAX - sizeof(bijson_object_sorted_view_t)) / sizeof(_bijson_object_sorted_view_entry_t))
+		_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+
+	bijson_object_sorted_view_t *view = malloc(sizeof *view + count * width);
+	if(!view)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	view->analysis = *analysis;
+	view->width = width;
+
+	if(count < SIZE_C(2)) {
+		if(count)
+			view->permutation[0] = 0;
+		*result = view;
+		return NULL;
+	}
+
+	_bijson_object_sorted_view_entry_t *entries = malloc(count * sizeof *entries);
+	if(!entries) {
+		free(view);
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	}
+
+	_bijson_object_cursor_t cursor;
+	_bijson_object_cursor_init(&cursor, analysis);
+	for(size_t u = 0; u < count; u++) {
+		const void *key;
+		size_t len;
+		bijson_t value;
+		bijson_error_t error = _bijson_object_cursor_next(&cursor, &key, &len, &value);
+		if(error) {
+			free(entries);
+			free(view);
+			return error;
+		}
+		entries[u] = (_bijson_object_sorted_view_entry_t){
+			.prefix = _bijson_object_sorted_view_prefix(key, len),
+			.key = key,
+			.len = len,
+			.index = u,
+		};
+	}
+
+	qsort(entries, count, sizeof *entries, _bijson_object_sorted_view_entry_cmp);
+
+	for(size_t u = 0; u < count; u++) {
+		byte_t *slot = view->permutation + u * width;
+		uint64_t index = entries[u].index;
+		for(size_t b = 0; b < width; b++)
+			slot[b] = (byte_t)(index >> (b * SIZE_C(8)));
+	}
+
+	free(entries);
+
+	// All keys were validated while building the view
+	view->analysis.nocheck = true;
+
+	*result = view;
+	return NULL;
+}
+
+bijson_error_t bijson_analyzed_object_sorted_view_build(
+	bijson_object_sorted_view_t **result,
+	const bijson_object_analysis_t *analysis
+) {
+	if(!analysis)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	return _bijson_analyzed_object_sorted_view_build(result, (const _bijson_object_analysis_t *)analysis);
+}
+
+bijson_error_t bijson_object_sorted_view_build(bijson_object_sorted_view_t **result, const bijson_t *bijson) {
+	_bijson_object_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
+	return _bijson_analyzed_object_sorted_view_build(result, &analysis);
+}
+
+size_t bijson_object_sorted_view_count(const bijson_object_sorted_view_t *view) {
+	return view->analysis.count;
+}
+
+static inline size_t _bijson_object_sorted_view_index(const bijson_object_sorted_view_t *view, size_t position) {
+	return (size_t)_bijson_read_minimal_int(view->permutation + position * view->width, view->width);
+}
+
+static inline bijson_error_t _bijson_object_sorted_view_get_key(
+	const bijson_object_sorted_view_t *view,
+	size_t position,
+	const void **key_buffer_result,
+	size_t *key_size_result
+) {
+	bijson_t value;
+	return _bijson_analyzed_object_get_index(
+		&view->analysis,
+		_bijson_object_sorted_view_index(view, position),
+		key_buffer_result,
+		key_size_result,
+		&value
+	);
+}
+
+bijson_error_t bijson_object_sorted_view_get(
+	const bijson_object_sorted_view_t *view,
+	size_t position,
+	size_t *index_result,
+	const void **key_buffer_result,
+	size_t *key_size_result,
+	bijson_t *value_result
+) {
+	if(!view)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	if(position >= view->analysis.count)
+		_BIJSON_RETURN_ERROR(bijson_error_index_out_of_range);
+
+	size_t index = _bijson_object_sorted_view_index(view, position);
+	const void *key_buffer;
+	size_t key_size;
+	bijson_t value;
+	_BIJSON_RETURN_ON_ERROR(_bijson_analyzed_object_get_index(&view->analysis, index, &key_buffer, &key_size, &value));
+
+	if(index_result)
+		*index_result = index;
+	if(key_buffer_result)
+		*key_buffer_result = key_buffer;
+	if(key_size_result)
+		*key_size_result = key_size;
+	if(value_result)
+		*value_result = value;
+	return NULL;
+}
+
+// Returns the first position for which the key does not sort before the
+// target (or, if upper is true, the first position for which it sorts after
+// it). If prefix is true, keys that start with the target compare as equal.
+static bijson_error_t _bijson_object_sorted_view_search(
+	const bijson_object_sorted_view_t *view,
+	const void *target,
+	size_t target_len,
+	bool prefix,
+	bool upper,
+	size_t *result
+) {
+	size_t low = 0;
+	size_t high = view->analysis.count;
+	while(low < high) {
+		size_t middle = low + ((high - low) >> 1U);
+		const void *key;
+		size_t len;
+		_BIJSON_RETURN_ON_ERROR(_bijson_object_sorted_view_get_key(view, middle, &key, &len));
+		int c = _bijson_object_sorted_view_key_cmp(key, prefix ? _bijson_size_min(len, target_len) : len, target, target_len);
+		if(c < 0 || (upper && !c))
+			low = middle + SIZE_C(1);
+		else
+			high = middle;
+	}
+	*result = low;
+	return NULL;
+}
+
+bijson_error_t bijson_object_sorted_view_lower_bound(
+	const bijson_object_sorted_view_t *view,
+	const void *key,
+	size_t len,
+	size_t *result
+) {
+	if(!view || !result || (!key && len))
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	return _bijson_object_sorted_view_search(view, key, len, false, false, result);
+}
+
+bijson_error_t bijson_object_sorted_view_prefix_range(
+	const bijson_object_sorted_view_t *view,
+	const void *prefix,
+	size_t len,
+	size_t *start_result,
+	size_t *end_result
+) {
+	if(!view || !start_result || !end_result || (!prefix && len))
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	size_t start, end;
+	_BIJSON_RETURN_ON_ERROR(_bijson_object_sorted_view_search(view, prefix, len, true, false, &start));
+	_BIJSON_RETURN_ON_ERROR(_bijson_object_sorted_view_search(view, prefix, len, true, true, &end));
+
+	*start_result = start;
+	*end_result = end;
+	return NULL;
+}
+
+void bijson_object_sorted_view_free(bijson_object_sorted_view_t *view) {
+	free(view);
+}
@@ -0,0 +1,118 @@
+#include <string.h>
+
+#include "../../include/reader.h"
+
+#include "../common.h"
+#include "../reader.h"
+#include "../rapidhash.h"
+#include "pointer.h"
+
+// Parses an RFC 6901 array index ("0" or a number without leading zeroes).
+// Returns SIZE_MAX for anything else, including "-".
+__attribute__((pure))
+static size_t _bijson_pointer_parse_index(const byte_t *segment, size_t len) {
+	if(!len || (len > SIZE_C(1) && *segment == '0'))
+		return SIZE_MAX;
+	size_t index = 0;
+	for(size_t u = 0; u < len; u++) {
+		byte_compute_t c = segment[u];
+		if(c < '0' || c > '9')
+			return SIZE_MAX;
+		size_t digit = c - '0';
+		if(index > (SIZE_MAX - SIZE_C(1) - digit) / SIZE_C(10))
+			return SIZE_MAX;
+		index = index * SIZE_C(10) + digit;
+	}
+	return index;
+}
+
+bijson_error_t bijson_pointer_compile(bijson_pointer_t **result, const char *pointer, size_t len) {
+	if(!result || (!pointer && len))
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	const byte_t *buffer = (const byte_t *)pointer;
+	const byte_t *buffer_end = buffer + len;
+
+	// The empty pointer refers to the whole document, all others must
+	// start with a slash.
+	if(len && *buffer != '/')
+		_BIJSON_RETURN_ERROR(bijson_error_invalid_pointer_syntax);
+
+	size_t count = 0;
+	for(const byte_t *b = buffer; b < buffer_end; b++) {
+		if(*b == '/') {
+			count++;
+		} else if(*b == '~') {
+			if(b + 1 == buffer_end || (b[1] != '0' && b[1] != '1'))
+				_BIJSON_RETURN_ERROR(bijson_error_invalid_pointer_syntax);
+			b++;
+		}
+	}
+
+	// The unescaped keys are never longer than the pointer itself.
+	if(count > (SIZE_MAX - sizeof(bijson_pointer_t) - len) / sizeof(_bijson_pointer_segment_t))
+		_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+	size_t segments_size = count * sizeof(_bijson_pointer_segment_t);
+	bijson_pointer_t *compiled = malloc(sizeof *compiled + segments_size + len);
+	if(!compiled)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+
+	compiled->count = count;
+	byte_t *keys = (byte_t *)compiled->segments + segments_size;
+	byte_t *key = keys;
+	_bijson_pointer_segment_t *segment = compiled->segments;
+
+	// Skip the leading slash of each segment
+	for(const byte_t *b = buffer; b < buffer_end; segment++) {
+		b++;
+		const byte_t *key_start = key;
+		while(b < buffer_end && *b != '/') {
+			if(*b == '~') {
+				*key++ = b[1] == '0' ? (byte_t)'~' : (byte_t)'/';
+				b += 2;
+			} else {
+				*key++ = *b++;
+			}
+		}
+		size_t key_len = _bijson_ptrdiff(key, key_start);
+		segment->key.key = key_start;
+		segment->key.len = key_len;
+		segment->key.hash = rapidhash(key_start, key_len);
+		segment->index = _bijson_pointer_parse_index(key_start, key_len);
+	}
+
+	*result = compiled;
+	return NULL;
+}
+
+bijson_error_t bijson_pointer_resolve(const bijson_pointer_t *pointer, const bijson_t *bijson, bijson_t *result) {
+	if(!pointer || !result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
+
+	bijson_t current = *bijson;
+	size_t count = pointer->count;
+	const _bijson_pointer_segment_t *segments = pointer->segments;
+
+	for(size_t u = 0; u < count; u++) {
+		const _bijson_pointer_segment_t *segment = segments + u;
+		byte_compute_t type = *(const byte_t *)current.buffer;
+		if((type & BYTE_C(0xF0)) == BYTE_C(0x30)) {
+			// Also covers "-", which refers to the (nonexistent) item
+			// after the last one.
+			if(segment->index == SIZE_MAX)
+				_BIJSON_RETURN_ERROR(bijson_error_index_out_of_range);
+			_BIJSON_RETURN_ON_ERROR(bijson_array_get_index(&current, segment->index, &current));
+		} else {
+			// Reports a type mismatch for anything that's not an object.
+			_BIJSON_RETURN_ON_ERROR(bijson_object_get_prepared_key(&current, &segment->key, &current));
+		}
+	}
+
+	*result = current;
+	return NULL;
+}
+
+void bijson_pointer_free(bijson_pointer_t *pointer) {
+	free(pointer);
+}
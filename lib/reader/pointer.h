@@ -0,0 +1,15 @@
+#pragma once
+
+#include "../common.h"
+#include "../reader.h"
+
+typedef struct _bijson_pointer_segment {
+	bijson_key_t key;
+	// SIZE_MAX if the segment is not a valid array index
+	size_t index;
+} _bijson_pointer_segment_t;
+
+struct bijson_pointer {
+	size_t count;
+	_bijson_pointer_segment_t segments[];
+};
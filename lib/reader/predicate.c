@@ -0,0 +1,439 @@
+#include <math.h>
+#include <string.h>
+
+#include "../../include/reader.h"
+
+#include "../common.h"
+#include "../reader.h"
+#include "../parallel.h"
+#include "array.h"
+#include "binary.h"
+#include "decimal.h"
+
+// Arrays with fewer items than this are never split across threads.
+#define _BIJSON_PREDICATE_PARALLEL_THRESHOLD SIZE_C(1024)
+// Threads claim this many bitmap bytes (8 items each) at a time.
+#define _BIJSON_PREDICATE_BLOCK_SIZE SIZE_C(64)
+
+typedef enum _bijson_predicate_kind {
+	_bijson_predicate_kind_exists,
+	_bijson_predicate_kind_type,
+	_bijson_predicate_kind_number,
+	_bijson_predicate_kind_string,
+} _bijson_predicate_kind_t;
+
+typedef struct _bijson_predicate_condition {
+	_bijson_predicate_kind_t kind;
+	bijson_predicate_operator_t op;
+	bijson_key_t field;
+	bijson_value_type_t type;
+	// Numbers are compared as the decimal in string, except for infinity
+	// and NaN, which have no decimal.
+	double number;
+	const char *string;
+	size_t string_len;
+	// Holds the field name followed by the string
+	char *buffer;
+} _bijson_predicate_condition_t;
+
+struct bijson_predicate {
+	_bijson_predicate_condition_t *conditions;
+	size_t count;
+	size_t size;
+};
+
+bijson_error_t bijson_predicate_alloc(bijson_predicate_t **result) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	bijson_predicate_t *predicate = calloc(SIZE_C(1), sizeof *predicate);
+	if(!predicate)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	*result = predicate;
+	return NULL;
+}
+
+void bijson_predicate_free(bijson_predicate_t *predicate) {
+	if(!predicate)
+		return;
+	for(size_t u = 0; u < predicate->count; u++)
+		free(predicate->conditions[u].buffer);
+	free(predicate->conditions);
+	free(predicate);
+}
+
+static bijson_error_t _bijson_predicate_add(
+	bijson_predicate_t *predicate,
+	const void *field,
+	size_t field_len,
+	const void *string,
+	size_t string_len,
+	const _bijson_predicate_condition_t *template
+) {
+	if(!predicate || (!field && field_len) || (!string && string_len))
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	if(template->op > bijson_predicate_operator_ge)
+		_BIJSON_RETURN_ERROR(bijson_error_unsupported_feature);
+
+	if(predicate->count == predicate->size) {
+		size_t size = predicate->size ? predicate->size * SIZE_C(2) : SIZE_C(4);
+		if(size > SIZE_MAX / sizeof *predicate->conditions)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		_bijson_predicate_condition_t *conditions = realloc(predicate->conditions, size * sizeof *conditions);
+		if(!conditions)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+		predicate->conditions = conditions;
+		predicate->size = size;
+	}
+
+	if(field_len > SIZE_MAX - string_len - SIZE_C(1))
+		_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+	char *buffer = malloc(field_len + string_len + SIZE_C(1));
+	if(!buffer)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	if(field_len)
+		memcpy(buffer, field, field_len);
+	if(string_len)
+		memcpy(buffer + field_len, string, string_len);
+
+	_bijson_predicate_condition_t condition = *template;
+	condition.buffer = buffer;
+	condition.string = buffer + field_len;
+	condition.string_len = string_len;
+	bijson_error_t error = bijson_key_prepare(&condition.field, buffer, field_len);
+	if(error) {
+		free(buffer);
+		return error;
+	}
+
+	predicate->conditions[predicate->count++] = condition;
+	return NULL;
+}
+
+bijson_error_t bijson_predicate_add_exists(bijson_predicate_t *predicate, const void *field, size_t field_len) {
+	_bijson_predicate_condition_t condition = {.kind = _bijson_predicate_kind_exists};
+	return _bijson_predicate_add(predicate, field, field_len, NULL, SIZE_C(0), &condition);
+}
+
+bijson_error_t bijson_predicate_add_type(bijson_predicate_t *predicate, const void *field, size_t field_len, bijson_value_type_t type) {
+	_bijson_predicate_condition_t condition = {.kind = _bijson_predicate_kind_type, .type = type};
+	return _bijson_predicate_add(predicate, field, field_len, NULL, SIZE_C(0), &condition);
+}
+
+bijson_error_t bijson_predicate_add_number(
+	bijson_predicate_t *predicate,
+	const void *field,
+	size_t field_len,
+	bijson_predicate_operator_t op,
+	double number
+) {
+	_bijson_predicate_condition_t condition = {
+		.kind = _bijson_predicate_kind_number,
+		.op = op,
+		.number = number,
+	};
+	byte_t small[_BIJSON_BINARY_DECIMAL_SMALL_SIZE];
+	bijson_t decimal = bijson_0;
+	if(isfinite(number))
+		_BIJSON_RETURN_ON_ERROR(_bijson_binary_double_to_decimal(number, small, &decimal));
+	return _bijson_predicate_add(predicate, field, field_len, decimal.buffer, decimal.size, &condition);
+}
+
+bijson_error_t bijson_predicate_add_string(
+	bijson_predicate_t *predicate,
+	const void *field,
+	size_t field_len,
+	bijson_predicate_operator_t op,
+	const void *string,
+	size_t string_len
+) {
+	_bijson_predicate_condition_t condition = {
+		.kind = _bijson_predicate_kind_string,
+		.op = op,
+	};
+	return _bijson_predicate_add(predicate, field, field_len, string, string_len, &condition);
+}
+
+__attribute__((const))
+static inline bool _bijson_predicate_compare(bijson_predicate_operator_t op, int c) {
+	switch(op) {
+		case bijson_predicate_operator_eq:
+			return !c;
+		case bijson_predicate_operator_ne:
+			return c;
+		case bijson_predicate_operator_lt:
+			return c < 0;
+		case bijson_predicate_operator_le:
+			return c <= 0;
+		case bijson_predicate_operator_gt:
+			return c > 0;
+		case bijson_predicate_operator_ge:
+			return c >= 0;
+	}
+	return false;
+}
+
+static bijson_error_t _bijson_predicate_compare_number(
+	const _bijson_predicate_condition_t *condition,
+	const bijson_t *value,
+	bijson_value_type_t type,
+	int *result
+) {
+	byte_t small[_BIJSON_BINARY_DECIMAL_SMALL_SIZE];
+	bijson_t decimal;
+	_BIJSON_RETURN_ON_ERROR(_bijson_binary_as_decimal(value, type, small, &decimal));
+	bijson_t number = {condition->string, condition->string_len};
+	bijson_error_t error = _bijson_decimal_compare(&decimal, &number, result);
+	_bijson_binary_decimal_free(value, small, &decimal);
+	return error;
+}
+
+static bijson_error_t _bijson_predicate_check(
+	const _bijson_predicate_condition_t *condition,
+	const bijson_object_analysis_t *analysis,
+	bool *result
+) {
+	bijson_t value;
+	bijson_error_t error = bijson_analyzed_object_get_prepared_key(analysis, &condition->field, &value);
+	if(error == bijson_error_key_not_found)
+		return *result = false, NULL;
+	_BIJSON_RETURN_ON_ERROR(error);
+
+	if(condition->kind == _bijson_predicate_kind_exists)
+		return *result = true, NULL;
+
+	bijson_value_type_t type;
+	error = bijson_get_value_type(&value, &type);
+	if(error == bijson_error_unsupported_data_type)
+		type = bijson_value_type_undefined;
+	else if(error)
+		return error;
+
+	switch(condition->kind) {
+		case _bijson_predicate_kind_type:
+			return *result = type == condition->type, NULL;
+		case _bijson_predicate_kind_number:
+			if((type == bijson_value_type_decimal || type == bijson_value_type_integer) && !isnan(condition->number)) {
+				int c;
+				if(isinf(condition->number))
+					c = condition->number < 0.0 ? 1 : -1;
+				else
+					_BIJSON_RETURN_ON_ERROR(_bijson_predicate_compare_number(condition, &value, type, &c));
+				return *result = _bijson_predicate_compare(condition->op, c), NULL;
+			}
+			break;
+		case _bijson_predicate_kind_string:
+			if(type == bijson_value_type_string) {
+				const char *string;
+				size_t len;
+				_BIJSON_RETURN_ON_ERROR(bijson_string_get_nocheck(&value, &string, &len));
+				size_t string_len = condition->string_len;
+				int c;
+				if(condition->op == bijson_predicate_operator_eq || condition->op == bijson_predicate_operator_ne) {
+					c = len != string_len || memcmp(string, condition->string, len);
+				} else {
+					c = memcmp(string, condition->string, len < string_len ? len : string_len);
+					if(!c)
+						c = len < string_len ? -1 : len > string_len;
+				}
+				return *result = _bijson_predicate_compare(condition->op, c), NULL;
+			}
+			break;
+		case _bijson_predicate_kind_exists:
+			break;
+	}
+
+	// Values of other types are unequal and unordered
+	*result = condition->op == bijson_predicate_operator_ne;
+	return NULL;
+}
+
+static bijson_error_t _bijson_predicate_match(const bijson_predicate_t *predicate, const bijson_t *item, bool *result) {
+	*result = false;
+
+	bijson_object_analysis_t analysis;
+	bijson_error_t error = bijson_object_analyze(item, &analysis);
+	if(error == bijson_error_type_mismatch)
+		return NULL;
+	_BIJSON_RETURN_ON_ERROR(error);
+
+	for(size_t u = 0; u < predicate->count; u++) {
+		bool match;
+		_BIJSON_RETURN_ON_ERROR(_bijson_predicate_check(predicate->conditions + u, &analysis, &match));
+		if(!match)
+			return NULL;
+	}
+
+	*result = true;
+	return NULL;
+}
+
+typedef struct _bijson_predicate_scan {
+	const _bijson_array_analysis_t *analysis;
+	const bijson_predicate_t *predicate;
+	uint8_t *matches;
+} _bijson_predicate_scan_t;
+
+// Works in units of bitmap bytes (groups of 8 items) so that different
+// threads never write to the same byte.
+static bijson_error_t _bijson_predicate_scan_worker(void *worker_data, size_t thread, size_t start, size_t end) {
+	(void)thread;
+	const _bijson_predicate_scan_t *scan = worker_data;
+	const _bijson_array_analysis_t *analysis = scan->analysis;
+	size_t count = analysis->count;
+
+	for(size_t group = start; group < end; group++) {
+		size_t group_start = group * SIZE_C(8);
+		size_t group_end = _bijson_size_min(group_start + SIZE_C(8), count);
+		uint8_t bits = 0;
+		for(size_t u = group_start; u < group_end; u++) {
+			bijson_t item;
+			_BIJSON_RETURN_ON_ERROR(analysis->get_index(analysis, u, &item));
+			bool match;
+			_BIJSON_RETURN_ON_ERROR(_bijson_predicate_match(scan->predicate, &item, &match));
+			if(match)
+				bits |= (uint8_t)(UINT8_C(1) << (u - group_start));
+		}
+		scan->matches[group] = bits;
+	}
+
+	return NULL;
+}
+
+static bijson_error_t _bijson_analyzed_array_scan(
+	const _bijson_array_analysis_t *analysis,
+	const bijson_predicate_t *predicate,
+	uint8_t *matches,
+	size_t capacity,
+	size_t threads,
+	size_t *count_result
+) {
+	if(!predicate || !matches)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	size_t count = analysis->count;
+	if(capacity < count)
+		_BIJSON_RETURN_ERROR(bijson_error_index_out_of_range);
+
+	_bijson_predicate_scan_t scan = {
+		.analysis = analysis,
+		.predicate = predicate,
+		.matches = matches,
+	};
+
+	size_t groups = (count + SIZE_C(7)) / SIZE_C(8);
+	if(count < _BIJSON_PREDICATE_PARALLEL_THRESHOLD || threads < SIZE_C(2))
+		_BIJSON_RETURN_ON_ERROR(_bijson_predicate_scan_worker(&scan, SIZE_C(0), SIZE_C(0), groups));
+	else
+		_BIJSON_RETURN_ON_ERROR(_bijson_parallel_run_dynamic(groups, _BIJSON_PREDICATE_BLOCK_SIZE, threads, _bijson_predicate_scan_worker, &scan));
+
+	if(count_result) {
+		size_t total = 0;
+		for(size_t group = 0; group < groups; group++)
+			total += (size_t)__builtin_popcount(matches[group]);
+		*count_result = total;
+	}
+
+	return NULL;
+}
+
+bijson_error_t bijson_analyzed_array_scan(
+	const bijson_array_analysis_t *analysis,
+	const bijson_predicate_t *predicate,
+	uint8_t *matches,
+	size_t capacity,
+	size_t threads,
+	size_t *count_result
+) {
+	if(!analysis)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	return _bijson_analyzed_array_scan(
+		(const _bijson_array_analysis_t *)analysis,
+		predicate, matches, capacity, threads, count_result
+	);
+}
+
+bijson_error_t bijson_array_scan(
+	const bijson_t *bijson,
+	const bijson_predicate_t *predicate,
+	uint8_t *matches,
+	size_t capacity,
+	size_t threads,
+	size_t *count_result
+) {
+	_bijson_array_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(bijson, &analysis));
+	return _bijson_analyzed_array_scan(&analysis, predicate, matches, capacity, threads, count_result);
+}
+
+static bijson_error_t _bijson_analyzed_array_scan_indices(
+	const _bijson_array_analysis_t *analysis,
+	const bijson_predicate_t *predicate,
+	size_t threads,
+	size_t **result,
+	size_t *count_result
+) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	size_t count = analysis->count;
+	size_t groups = (count + SIZE_C(7)) / SIZE_C(8);
+	// Never allocate 0 bytes
+	uint8_t *matches = malloc(groups + SIZE_C(1));
+	if(!matches)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+
+	size_t matched;
+	bijson_error_t error = _bijson_analyzed_array_scan(analysis, predicate, matches, count, threads, &matched);
+	if(error) {
+		free(matches);
+		return error;
+	}
+
+	size_t *indices = malloc((matched ? matched : SIZE_C(1)) * sizeof *indices);
+	if(!indices) {
+		free(matches);
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	}
+
+	size_t *index = indices;
+	for(size_t group = 0; group < groups; group++) {
+		unsigned int bits = matches[group];
+		while(bits) {
+			*index++ = group * SIZE_C(8) + (size_t)__builtin_ctz(bits);
+			bits &= bits - 1U;
+		}
+	}
+	free(matches);
+
+	*result = indices;
+	if(count_result)
+		*count_result = matched;
+	return NULL;
+}
+
+bijson_error_t bijson_analyzed_array_scan_indices(
+	const bijson_array_analysis_t *analysis,
+	const bijson_predicate_t *predicate,
+	size_t threads,
+	size_t **result,
+	size_t *count_result
+) {
+	if(!analysis)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	return _bijson_analyzed_array_scan_indices(
+		(const _bijson_array_analysis_t *)analysis,
+		predicate, threads, result, count_result
+	);
+}
+
+bijson_error_t bijson_array_scan_indices(
+	const bijson_t *bijson,
+	const bijson_predicate_t *predicate,
+	size_t threads,
+	size_t **result,
+	size_t *count_result
+) {
+	_bijson_array_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(bijson, &analysis));
+	return _bijson_analyzed_array_scan_indices(&analysis, predicate, threads, result, count_result);
+}
@@ -0,0 +1,201 @@
+#include <string.h>
+
+#include "../../include/reader.h"
+
+#include "../common.h"
+#include "../reader.h"
+#include "../parallel.h"
+#include "array.h"
+#include "binary.h"
+#include "decimal.h"
+
+// Arrays with fewer items than this are never split across threads.
+#define _BIJSON_PROJECT_PARALLEL_THRESHOLD SIZE_C(1024)
+
+typedef struct _bijson_project {
+	const _bijson_array_analysis_t *analysis;
+	const bijson_key_t *key;
+	bijson_projection_type_t type;
+	void *result;
+	uint8_t *present;
+} _bijson_project_t;
+
+// Numbers can be decimals, binary integers or IEEE floats.
+static inline bijson_error_t _bijson_project_int64(const bijson_t *value, int64_t *result) {
+	bijson_value_type_t type;
+	_BIJSON_RETURN_ON_ERROR(bijson_get_value_type(value, &type));
+	switch(type) {
+		case bijson_value_type_integer:
+			return _bijson_binary_integer_to_int64(value, result);
+		case bijson_value_type_iee754_2008_float:
+			return _bijson_binary_float_to_int64(value, result);
+		default:
+			return bijson_decimal_get_int64(value, result);
+	}
+}
+
+static inline bijson_error_t _bijson_project_double(const bijson_t *value, double *result) {
+	bijson_value_type_t type;
+	_BIJSON_RETURN_ON_ERROR(bijson_get_value_type(value, &type));
+	switch(type) {
+		case bijson_value_type_integer:
+			return _bijson_binary_integer_to_double(value, result);
+		case bijson_value_type_iee754_2008_float:
+			return _bijson_binary_float_to_double(value, result);
+		default:
+			return _bijson_decimal_to_double(value, result);
+	}
+}
+
+// Converts a single value. Sets *present to false (and zeroes the result)
+// if the value is missing or cannot be converted.
+static bijson_error_t _bijson_project_value(
+	const _bijson_project_t *project,
+	const bijson_t *item,
+	size_t index,
+	bool *present
+) {
+	bijson_t value;
+	bijson_error_t error = bijson_object_get_prepared_key(item, project->key, &value);
+	if(error && error != bijson_error_key_not_found && error != bijson_error_type_mismatch)
+		return error;
+	bool found = !error;
+	error = NULL;
+
+	switch(project->type) {
+		case bijson_projection_type_int64: {
+			int64_t *result = (int64_t *)project->result + index;
+			if(found)
+				error = _bijson_project_int64(&value, result);
+			if(!found || error) {
+				*result = 0;
+				found = false;
+			}
+		} break;
+		case bijson_projection_type_double: {
+			double *result = (double *)project->result + index;
+			if(found)
+				error = _bijson_project_double(&value, result);
+			if(!found || error) {
+				*result = 0.0;
+				found = false;
+			}
+		} break;
+		case bijson_projection_type_string: {
+			bijson_string_view_t *result = (bijson_string_view_t *)project->result + index;
+			if(found)
+				error = bijson_string_get(&value, &result->buffer, &result->size);
+			if(!found || error) {
+				*result = (bijson_string_view_t){0};
+				found = false;
+			}
+		} break;
+		default:
+			_BIJSON_RETURN_ERROR(bijson_error_unsupported_data_type);
+	}
+
+	// Values that cannot be represented are reported as missing, anything
+	// else is a real problem.
+	if(error
+		&& error != bijson_error_type_mismatch
+		&& error != bijson_error_value_out_of_range
+	)
+		return error;
+
+	*present = found;
+	return NULL;
+}
+
+// Works in units of bitmap bytes (groups of 8 items) so that different
+// threads never write to the same byte.
+static bijson_error_t _bijson_project_worker(void *worker_data, size_t chunk, size_t start, size_t end) {
+	(void)chunk;
+	const _bijson_project_t *project = worker_data;
+	size_t count = project->analysis->count;
+
+	for(size_t group = start; group < end; group++) {
+		size_t group_start = group * SIZE_C(8);
+		size_t group_end = group_start + SIZE_C(8);
+		if(group_end > count)
+			group_end = count;
+		uint8_t bits = 0;
+		for(size_t u = group_start; u < group_end; u++) {
+			bijson_t item;
+			_BIJSON_RETURN_ON_ERROR(project->analysis->get_index(project->analysis, u, &item));
+			bool present;
+			_BIJSON_RETURN_ON_ERROR(_bijson_project_value(project, &item, u, &present));
+			if(present)
+				bits |= (uint8_t)(UINT8_C(1) << (u - group_start));
+		}
+		project->present[group] = bits;
+	}
+
+	return NULL;
+}
+
+static bijson_error_t _bijson_analyzed_array_project(
+	const _bijson_array_analysis_t *analysis,
+	const bijson_key_t *key,
+	bijson_projection_type_t type,
+	void *result,
+	uint8_t *present,
+	size_t capacity,
+	size_t threads
+) {
+	if(!key || !result || !present)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	if(type != bijson_projection_type_int64
+		&& type != bijson_projection_type_double
+		&& type != bijson_projection_type_string
+	)
+		_BIJSON_RETURN_ERROR(bijson_error_unsupported_data_type);
+
+	size_t count = analysis->count;
+	if(capacity < count)
+		_BIJSON_RETURN_ERROR(bijson_error_index_out_of_range);
+
+	_bijson_project_t project = {
+		.analysis = analysis,
+		.key = key,
+		.type = type,
+		.result = result,
+		.present = present,
+	};
+
+	size_t groups = (count + SIZE_C(7)) / SIZE_C(8);
+	if(count < _BIJSON_PROJECT_PARALLEL_THRESHOLD || threads < SIZE_C(2))
+		return _bijson_project_worker(&project, SIZE_C(0), SIZE_C(0), groups);
+
+	return _bijson_parallel_run(groups, threads, _bijson_project_worker, &project);
+}
+
+bijson_error_t bijson_analyzed_array_project(
+	const bijson_array_analysis_t *analysis,
+	const bijson_key_t *key,
+	bijson_projection_type_t type,
+	void *result,
+	uint8_t *present,
+	size_t capacity,
+	size_t threads
+) {
+	if(!analysis)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	return _bijson_analyzed_array_project(
+		(const _bijson_array_analysis_t *)analysis,
+		key, type, result, present, capacity, threads
+	);
+}
+
+bijson_error_t bijson_array_project(
+	const bijson_t *bijson,
+	const bijson_key_t *key,
+	bijson_projection_type_t type,
+	void *result,
+	uint8_t *present,
+	size_t capacity,
+	size_t threads
+) {
+	_bijson_array_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(bijson, &analysis));
+	return _bijson_analyzed_array_project(&analysis, key, type, result, present, capacity, threads);
+}
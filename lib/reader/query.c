@@ -0,0 +1,749 @@
+#include <string.h>
+
+#include "../../include/reader.h"
+#include "../../include/writer.h"
+
+#include "../common.h"
+#include "../reader.h"
+#include "../rapidhash.h"
+#include "../parallel.h"
+#include "array.h"
+#include "binary.h"
+#include "decimal.h"
+#include "object.h"
+#include "object/cursor.h"
+#include "query.h"
+
+// Arrays with fewer items than this are never split across threads.
+#define _BIJSON_QUERY_PARALLEL_THRESHOLD SIZE_C(1024)
+
+////////////////////////////////////////////////////////////////////////////
+// Parsing
+
+typedef struct _bijson_query_parser {
+	const byte_t *pos;
+	const byte_t *end;
+	bijson_query_t *query;
+	size_t steps_size;
+	size_t fields_size;
+	// Next free byte in query->strings
+	char *strings_pos;
+} _bijson_query_parser_t;
+
+__attribute__((pure))
+static inline bool _bijson_query_peek(const _bijson_query_parser_t *parser, byte_compute_t c) {
+	return parser->pos < parser->end && *parser->pos == c;
+}
+
+static inline bool _bijson_query_accept(_bijson_query_parser_t *parser, byte_compute_t c) {
+	if(!_bijson_query_peek(parser, c))
+		return false;
+	parser->pos++;
+	return true;
+}
+
+static inline void _bijson_query_skip_whitespace(_bijson_query_parser_t *parser) {
+	while(_bijson_query_peek(parser, ' ') || _bijson_query_peek(parser, '\t'))
+		parser->pos++;
+}
+
+__attribute__((const))
+static inline bool _bijson_query_is_name_char(byte_compute_t c) {
+	return (c >= 'a' && c <= 'z')
+		|| (c >= 'A' && c <= 'Z')
+		|| (c >= '0' && c <= '9')
+		|| c == '_' || c == '-' || c == '$'
+		|| c >= BYTE_C(0x80);
+}
+
+static bijson_error_t _bijson_query_add_step(_bijson_query_parser_t *parser, _bijson_query_step_t **result) {
+	bijson_query_t *query = parser->query;
+	if(query->steps_count == parser->steps_size) {
+		size_t steps_size = parser->steps_size ? parser->steps_size * SIZE_C(2) : SIZE_C(8);
+		if(steps_size > SIZE_MAX / sizeof *query->steps)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		_bijson_query_step_t *steps = realloc(query->steps, steps_size * sizeof *steps);
+		if(!steps)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+		query->steps = steps;
+		parser->steps_size = steps_size;
+	}
+	_bijson_query_step_t *step = query->steps + query->steps_count++;
+	*step = (_bijson_query_step_t){0};
+	*result = step;
+	return NULL;
+}
+
+static bijson_error_t _bijson_query_add_field(_bijson_query_parser_t *parser, const bijson_key_t *field) {
+	bijson_query_t *query = parser->query;
+	if(query->fields_count == parser->fields_size) {
+		size_t fields_size = parser->fields_size ? parser->fields_size * SIZE_C(2) : SIZE_C(8);
+		if(fields_size > SIZE_MAX / sizeof *query->fields)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		bijson_key_t *fields = realloc(query->fields, fields_size * sizeof *fields);
+		if(!fields)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+		query->fields = fields;
+		parser->fields_size = fields_size;
+	}
+	query->fields[query->fields_count++] = *field;
+	return NULL;
+}
+
+// Unquoted names, as in $.foo
+static bijson_error_t _bijson_query_parse_name(_bijson_query_parser_t *parser, bijson_key_t *result) {
+	const byte_t *start = parser->pos;
+	while(parser->pos < parser->end && _bijson_query_is_name_char(*parser->pos))
+		parser->pos++;
+	size_t len = _bijson_ptrdiff(parser->pos, start);
+	if(!len)
+		_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+	char *key = parser->strings_pos;
+	memcpy(key, start, len);
+	parser->strings_pos += len;
+	return bijson_key_prepare(result, key, len);
+}
+
+// Quoted strings, as in $['foo'] or $["foo"]. Backslash escapes the next
+// character.
+static bijson_error_t _bijson_query_parse_string(_bijson_query_parser_t *parser, bijson_key_t *result) {
+	byte_compute_t quote = *parser->pos++;
+	char *key = parser->strings_pos;
+	char *key_end = key;
+	for(;;) {
+		if(parser->pos == parser->end)
+			_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+		byte_compute_t c = *parser->pos++;
+		if(c == quote)
+			break;
+		if(c == '\\') {
+			if(parser->pos == parser->end)
+				_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+			c = *parser->pos++;
+		}
+		*key_end++ = (char)c;
+	}
+	size_t len = _bijson_ptrdiff(key_end, key);
+	parser->strings_pos = key_end;
+	return bijson_key_prepare(result, key, len);
+}
+
+static bijson_error_t _bijson_query_parse_int(_bijson_query_parser_t *parser, int64_t *result) {
+	bool negative = _bijson_query_accept(parser, '-');
+	if(parser->pos == parser->end || *parser->pos < '0' || *parser->pos > '9')
+		_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+	uint64_t u = 0;
+	while(parser->pos < parser->end && *parser->pos >= '0' && *parser->pos <= '9') {
+		uint64_t digit = (uint64_t)(*parser->pos++ - '0');
+		if(u > (UINT64_C(0x7FFFFFFFFFFFFFFF) - digit) / UINT64_C(10))
+			_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+		u = u * UINT64_C(10) + digit;
+	}
+	*result = negative ? -(int64_t)u : (int64_t)u;
+	return NULL;
+}
+
+static bijson_error_t _bijson_query_parse_number(_bijson_query_parser_t *parser, bijson_t *result) {
+	// Validate using the JSON number syntax, then let the writer encode it
+	// exactly, the same way documents store their numbers.
+	const byte_t *start = parser->pos;
+	_bijson_query_accept(parser, '-');
+	size_t digits = 0;
+	while(parser->pos < parser->end && *parser->pos >= '0' && *parser->pos <= '9')
+		parser->pos++, digits++;
+	if(!digits)
+		_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+	if(_bijson_query_accept(parser, '.')) {
+		digits = 0;
+		while(parser->pos < parser->end && *parser->pos >= '0' && *parser->pos <= '9')
+			parser->pos++, digits++;
+		if(!digits)
+			_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+	}
+	if(_bijson_query_accept(parser, 'e') || _bijson_query_accept(parser, 'E')) {
+		if(!_bijson_query_accept(parser, '+'))
+			_bijson_query_accept(parser, '-');
+		digits = 0;
+		while(parser->pos < parser->end && *parser->pos >= '0' && *parser->pos <= '9')
+			parser->pos++, digits++;
+		if(!digits)
+			_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+	}
+
+	bijson_writer_t *writer;
+	_BIJSON_RETURN_ON_ERROR(bijson_writer_alloc(&writer));
+	bijson_error_t error = bijson_writer_add_decimal_from_string(writer, start, _bijson_ptrdiff(parser->pos, start));
+	if(!error)
+		error = bijson_writer_write_to_malloc(writer, result);
+	bijson_writer_free(writer);
+	return error;
+}
+
+static bool _bijson_query_accept_word(_bijson_query_parser_t *parser, const char *word) {
+	size_t len = strlen(word);
+	if(_bijson_ptrdiff(parser->end, parser->pos) < len || memcmp(parser->pos, word, len))
+		return false;
+	parser->pos += len;
+	return true;
+}
+
+// Parses the part after "[?(" up to and including ")]"
+static bijson_error_t _bijson_query_parse_filter(_bijson_query_parser_t *parser, _bijson_query_step_t *step) {
+	step->selector = _bijson_query_selector_filter;
+	step->fields_start = parser->query->fields_count;
+
+	_bijson_query_skip_whitespace(parser);
+	if(!_bijson_query_accept(parser, '@'))
+		_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+
+	for(;;) {
+		bijson_key_t field;
+		if(_bijson_query_accept(parser, '.')) {
+			_BIJSON_RETURN_ON_ERROR(_bijson_query_parse_name(parser, &field));
+		} else if(_bijson_query_accept(parser, '[')) {
+			if(!_bijson_query_peek(parser, '\'') && !_bijson_query_peek(parser, '"'))
+				_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+			_BIJSON_RETURN_ON_ERROR(_bijson_query_parse_string(parser, &field));
+			if(!_bijson_query_accept(parser, ']'))
+				_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+		} else {
+			break;
+		}
+		_BIJSON_RETURN_ON_ERROR(_bijson_query_add_field(parser, &field));
+	}
+	step->fields_count = parser->query->fields_count - step->fields_start;
+
+	_bijson_query_skip_whitespace(parser);
+	if(_bijson_query_accept_word(parser, "=="))
+		step->op = _bijson_query_operator_eq;
+	else if(_bijson_query_accept_word(parser, "!="))
+		step->op = _bijson_query_operator_ne;
+	else if(_bijson_query_accept_word(parser, "<="))
+		step->op = _bijson_query_operator_le;
+	else if(_bijson_query_accept_word(parser, ">="))
+		step->op = _bijson_query_operator_ge;
+	else if(_bijson_query_accept(parser, '<'))
+		step->op = _bijson_query_operator_lt;
+	else if(_bijson_query_accept(parser, '>'))
+		step->op = _bijson_query_operator_gt;
+	else
+		step->op = _bijson_query_operator_exists;
+
+	if(step->op != _bijson_query_operator_exists) {
+		_bijson_query_skip_whitespace(parser);
+		if(_bijson_query_peek(parser, '\'') || _bijson_query_peek(parser, '"')) {
+			step->literal_type = _bijson_query_literal_string;
+			_BIJSON_RETURN_ON_ERROR(_bijson_query_parse_string(parser, &step->key));
+		} else if(_bijson_query_accept_word(parser, "true")) {
+			step->literal_type = _bijson_query_literal_true;
+		} else if(_bijson_query_accept_word(parser, "false")) {
+			step->literal_type = _bijson_query_literal_false;
+		} else if(_bijson_query_accept_word(parser, "null")) {
+			step->literal_type = _bijson_query_literal_null;
+		} else {
+			step->literal_type = _bijson_query_literal_number;
+			_BIJSON_RETURN_ON_ERROR(_bijson_query_parse_number(parser, &step->number));
+		}
+	}
+
+	_bijson_query_skip_whitespace(parser);
+	if(!_bijson_query_accept(parser, ')') || !_bijson_query_accept(parser, ']'))
+		_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+
+	return NULL;
+}
+
+// Parses the part after "[" up to and including "]"
+static bijson_error_t _bijson_query_parse_bracket(_bijson_query_parser_t *parser, _bijson_query_step_t *step) {
+	if(_bijson_query_accept(parser, '*')) {
+		step->selector = _bijson_query_selector_wildcard;
+	} else if(_bijson_query_peek(parser, '\'') || _bijson_query_peek(parser, '"')) {
+		step->selector = _bijson_query_selector_child;
+		_BIJSON_RETURN_ON_ERROR(_bijson_query_parse_string(parser, &step->key));
+	} else if(_bijson_query_accept(parser, '?')) {
+		if(!_bijson_query_accept(parser, '('))
+			_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+		return _bijson_query_parse_filter(parser, step);
+	} else {
+		step->selector = _bijson_query_selector_index;
+		if(!_bijson_query_peek(parser, ':')) {
+			_BIJSON_RETURN_ON_ERROR(_bijson_query_parse_int(parser, &step->start));
+			step->has_start = true;
+		}
+		if(_bijson_query_accept(parser, ':')) {
+			step->selector = _bijson_query_selector_slice;
+			step->step = 1;
+			if(!_bijson_query_peek(parser, ':') && !_bijson_query_peek(parser, ']')) {
+				_BIJSON_RETURN_ON_ERROR(_bijson_query_parse_int(parser, &step->end));
+				step->has_end = true;
+			}
+			if(_bijson_query_accept(parser, ':') && !_bijson_query_peek(parser, ']'))
+				_BIJSON_RETURN_ON_ERROR(_bijson_query_parse_int(parser, &step->step));
+			// Only forward iteration is supported
+			if(step->step <= 0)
+				_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+		} else if(!step->has_start) {
+			_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+		}
+	}
+
+	if(!_bijson_query_accept(parser, ']'))
+		_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+
+	return NULL;
+}
+
+static bijson_error_t _bijson_query_parse(_bijson_query_parser_t *parser) {
+	if(!_bijson_query_accept(parser, '$'))
+		_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+
+	while(parser->pos < parser->end) {
+		_bijson_query_step_t *step;
+		_BIJSON_RETURN_ON_ERROR(_bijson_query_add_step(parser, &step));
+		if(_bijson_query_accept(parser, '.')) {
+			if(_bijson_query_accept(parser, '.')) {
+				step->descendants = true;
+				if(_bijson_query_accept(parser, '['))
+					_BIJSON_RETURN_ON_ERROR(_bijson_query_parse_bracket(parser, step));
+				else if(_bijson_query_accept(parser, '*'))
+					step->selector = _bijson_query_selector_wildcard;
+				else
+					_BIJSON_RETURN_ON_ERROR(_bijson_query_parse_name(parser, &step->key));
+			} else if(_bijson_query_accept(parser, '*')) {
+				step->selector = _bijson_query_selector_wildcard;
+			} else {
+				_BIJSON_RETURN_ON_ERROR(_bijson_query_parse_name(parser, &step->key));
+			}
+		} else if(_bijson_query_accept(parser, '[')) {
+			_BIJSON_RETURN_ON_ERROR(_bijson_query_parse_bracket(parser, step));
+		} else {
+			_BIJSON_RETURN_ERROR(bijson_error_invalid_query_syntax);
+		}
+	}
+
+	return NULL;
+}
+
+void bijson_query_free(bijson_query_t *query) {
+	if(query) {
+		for(size_t u = 0; u < query->steps_count; u++)
+			free(_bijson_no_const(query->steps[u].number.buffer));
+		free(query->steps);
+		free(query->fields);
+		free(query->strings);
+		free(query);
+	}
+}
+
+bijson_error_t bijson_query_compile(bijson_query_t **result, const char *query, size_t len) {
+	if(!result || (!query && len))
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	bijson_query_t *compiled = calloc(SIZE_C(1), sizeof *compiled);
+	if(!compiled)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+
+	// Unescaped strings are never longer than the query itself.
+	compiled->strings = malloc(len ? len : SIZE_C(1));
+	if(!compiled->strings) {
+		bijson_query_free(compiled);
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	}
+
+	_bijson_query_parser_t parser = {
+		.pos = (const byte_t *)query,
+		.end = (const byte_t *)query + len,
+		.query = compiled,
+		.strings_pos = compiled->strings,
+	};
+
+	bijson_error_t error = _bijson_query_parse(&parser);
+	if(error) {
+		bijson_query_free(compiled);
+		return error;
+	}
+
+	*result = compiled;
+	return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Evaluation
+
+typedef struct _bijson_query_state {
+	const bijson_query_t *query;
+	size_t threads;
+	bijson_query_callback_t callback;
+	void *callback_data;
+} _bijson_query_state_t;
+
+__attribute__((pure))
+static inline bool _bijson_query_is_array(const bijson_t *bijson) {
+	return (*(const byte_t *)bijson->buffer & BYTE_C(0xF0)) == BYTE_C(0x30);
+}
+
+__attribute__((pure))
+static inline bool _bijson_query_is_object(const bijson_t *bijson) {
+	byte_compute_t type = *(const byte_t *)bijson->buffer & BYTE_C(0xC0);
+	return type == BYTE_C(0x40) || type == BYTE_C(0x80);
+}
+
+static bijson_error_t _bijson_query_filter_match(const _bijson_query_state_t *state, const _bijson_query_step_t *step, const bijson_t *candidate, bool *result) {
+	*result = false;
+
+	bijson_t field = *candidate;
+	const bijson_key_t *fields = state->query->fields + step->fields_start;
+	for(size_t u = 0; u < step->fields_count; u++) {
+		if(!_bijson_query_is_object(&field))
+			return NULL;
+		bijson_error_t error = bijson_object_get_prepared_key(&field, fields + u, &field);
+		if(error == bijson_error_key_not_found)
+			return NULL;
+		_BIJSON_RETURN_ON_ERROR(error);
+	}
+
+	_bijson_query_operator_t op = step->op;
+	if(op == _bijson_query_operator_exists)
+		return *result = true, NULL;
+
+	bijson_value_type_t type;
+	bijson_error_t error = bijson_get_value_type(&field, &type);
+	if(error == bijson_error_unsupported_data_type)
+		type = bijson_value_type_undefined;
+	else if(error)
+		return error;
+
+	// Values of different types are unequal and not ordered.
+	bool comparable = false;
+	bool ordered = false;
+	int c = 0;
+	switch(step->literal_type) {
+		case _bijson_query_literal_number:
+			if(type == bijson_value_type_decimal || type == bijson_value_type_integer) {
+				byte_t small[_BIJSON_BINARY_DECIMAL_SMALL_SIZE];
+				bijson_t decimal;
+				_BIJSON_RETURN_ON_ERROR(_bijson_binary_as_decimal(&field, type, small, &decimal));
+				error = _bijson_decimal_compare(&decimal, &step->number, &c);
+				_bijson_binary_decimal_free(&field, small, &decimal);
+				_BIJSON_RETURN_ON_ERROR(error);
+				comparable = ordered = true;
+			}
+			break;
+		case _bijson_query_literal_string:
+			if(type == bijson_value_type_string) {
+				const char *string;
+				size_t len;
+				_BIJSON_RETURN_ON_ERROR(bijson_string_get(&field, &string, &len));
+				size_t key_len = step->key.len;
+				c = memcmp(string, step->key.key, len < key_len ? len : key_len);
+				if(!c)
+					c = len < key_len ? -1 : len > key_len;
+				comparable = ordered = true;
+			}
+			break;
+		case _bijson_query_literal_true:
+			comparable = type == bijson_value_type_true;
+			break;
+		case _bijson_query_literal_false:
+			comparable = type == bijson_value_type_false;
+			break;
+		case _bijson_query_literal_null:
+			comparable = type == bijson_value_type_null;
+			break;
+		case _bijson_query_literal_none:
+			break;
+	}
+
+	bool equal = comparable && !c;
+	switch(op) {
+		case _bijson_query_operator_eq:
+			return *result = equal, NULL;
+		case _bijson_query_operator_ne:
+			return *result = !equal, NULL;
+		case _bijson_query_operator_lt:
+			return *result = ordered && c < 0, NULL;
+		case _bijson_query_operator_le:
+			return *result = equal || (ordered && c < 0), NULL;
+		case _bijson_query_operator_gt:
+			return *result = ordered && c > 0, NULL;
+		case _bijson_query_operator_ge:
+			return *result = equal || (ordered && c > 0), NULL;
+		case _bijson_query_operator_exists:
+			break;
+	}
+
+	return NULL;
+}
+
+static bijson_error_t _bijson_query_eval(const _bijson_query_state_t *state, size_t step_index, const bijson_t *bijson);
+
+static inline bijson_error_t _bijson_query_select_candidate(
+	const _bijson_query_state_t *state,
+	size_t step_index,
+	const _bijson_query_step_t *step,
+	const bijson_t *candidate
+) {
+	if(step->selector == _bijson_query_selector_filter) {
+		bool match;
+		_BIJSON_RETURN_ON_ERROR(_bijson_query_filter_match(state, step, candidate, &match));
+		if(!match)
+			return NULL;
+	}
+	return _bijson_query_eval(state, step_index + SIZE_C(1), candidate);
+}
+
+// Array items first, first + stride, … (count items in total)
+typedef struct _bijson_query_items {
+	const _bijson_query_state_t *state;
+	size_t step_index;
+	const _bijson_array_analysis_t *analysis;
+	size_t first;
+	size_t stride;
+} _bijson_query_items_t;
+
+static bijson_error_t _bijson_query_select_items(const _bijson_query_items_t *items, const _bijson_query_state_t *state, size_t start, size_t end) {
+	const _bijson_query_step_t *step = state->query->steps + items->step_index;
+	for(size_t u = start; u < end; u++) {
+		bijson_t item;
+		_BIJSON_RETURN_ON_ERROR(_bijson_analyzed_array_get_index(items->analysis, items->first + u * items->stride, &item));
+		_BIJSON_RETURN_ON_ERROR(_bijson_query_select_candidate(state, items->step_index, step, &item));
+	}
+	return NULL;
+}
+
+typedef struct _bijson_query_results {
+	bijson_t *results;
+	size_t count;
+	size_t size;
+} _bijson_query_results_t;
+
+static bijson_error_t _bijson_query_results_callback(void *callback_data, const bijson_t *result) {
+	_bijson_query_results_t *results = callback_data;
+	if(results->count == results->size) {
+		size_t size = results->size ? results->size * SIZE_C(2) : SIZE_C(16);
+		if(size > SIZE_MAX / sizeof *results->results)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		bijson_t *buffer = realloc(results->results, size * sizeof *buffer);
+		if(!buffer)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+		results->results = buffer;
+		results->size = size;
+	}
+	results->results[results->count++] = *result;
+	return NULL;
+}
+
+typedef struct _bijson_query_parallel {
+	const _bijson_query_items_t *items;
+	_bijson_query_results_t *results;
+} _bijson_query_parallel_t;
+
+static bijson_error_t _bijson_query_parallel_worker(void *worker_data, size_t chunk, size_t start, size_t end) {
+	const _bijson_query_parallel_t *parallel = worker_data;
+	const _bijson_query_items_t *items = parallel->items;
+	// Collect the results so they can be reported in order afterwards.
+	_bijson_query_state_t state = {
+		.query = items->state->query,
+		.threads = SIZE_C(1),
+		.callback = _bijson_query_results_callback,
+		.callback_data = parallel->results + chunk,
+	};
+	return _bijson_query_select_items(items, &state, start, end);
+}
+
+static bijson_error_t _bijson_query_select_items_parallel(const _bijson_query_items_t *items, size_t count) {
+	const _bijson_query_state_t *state = items->state;
+	size_t threads = state->threads;
+
+	_bijson_query_results_t *results = calloc(threads, sizeof *results);
+	if(!results)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+
+	_bijson_query_parallel_t parallel = {
+		.items = items,
+		.results = results,
+	};
+	bijson_error_t error = _bijson_parallel_run(count, threads, _bijson_query_parallel_worker, &parallel);
+
+	for(size_t u = 0; u < threads; u++) {
+		for(size_t v = 0; v < results[u].count && !error; v++)
+			error = state->callback(state->callback_data, results[u].results + v);
+		free(results[u].results);
+	}
+	free(results);
+
+	return error;
+}
+
+static bijson_error_t _bijson_query_select_array(
+	const _bijson_query_state_t *state,
+	size_t step_index,
+	const _bijson_query_step_t *step,
+	const bijson_t *bijson
+) {
+	_bijson_array_analysis_t analysis;
+	_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(bijson, &analysis));
+	size_t len = analysis.count;
+
+	_bijson_query_items_t items = {
+		.state = state,
+		.step_index = step_index,
+		.analysis = &analysis,
+		.stride = SIZE_C(1),
+	};
+	size_t count = len;
+
+	if(step->selector == _bijson_query_selector_index) {
+		int64_t index = step->start;
+		if(index < 0) {
+			if((uint64_t)-index > len)
+				return NULL;
+			items.first = len - (size_t)-index;
+		} else {
+			if((uint64_t)index >= len)
+				return NULL;
+			items.first = (size_t)index;
+		}
+		count = SIZE_C(1);
+	} else if(step->selector == _bijson_query_selector_slice) {
+		// Python style slices, with negative start/end counting from the end
+		int64_t bounds[2] = {step->start, step->end};
+		size_t clamped[2] = {0, len};
+		for(size_t u = 0; u < SIZE_C(2); u++) {
+			if(!(u ? step->has_end : step->has_start))
+				continue;
+			int64_t bound = bounds[u];
+			if(bound < 0)
+				clamped[u] = (uint64_t)-bound > len ? SIZE_C(0) : len - (size_t)-bound;
+			else
+				clamped[u] = (uint64_t)bound > len ? len : (size_t)bound;
+		}
+		if(clamped[0] >= clamped[1])
+			return NULL;
+		size_t stride = (uint64_t)step->step > len ? len : (size_t)step->step;
+		items.first = clamped[0];
+		items.stride = stride;
+		count = (clamped[1] - clamped[0] - SIZE_C(1)) / stride + SIZE_C(1);
+	}
+
+	if(state->threads > SIZE_C(1) && count >= _BIJSON_QUERY_PARALLEL_THRESHOLD)
+		return _bijson_query_select_items_parallel(&items, count);
+
+	return _bijson_query_select_items(&items, state, SIZE_C(0), count);
+}
+
+static bijson_error_t _bijson_query_select(
+	const _bijson_query_state_t *state,
+	size_t step_index,
+	const _bijson_query_step_t *step,
+	const bijson_t *bijson
+) {
+	if(_bijson_query_is_array(bijson)) {
+		if(step->selector == _bijson_query_selector_child)
+			return NULL;
+		return _bijson_query_select_array(state, step_index, step, bijson);
+	}
+
+	if(!_bijson_query_is_object(bijson))
+		return NULL;
+
+	switch(step->selector) {
+		case _bijson_query_selector_child: {
+			bijson_t value;
+			bijson_error_t error = bijson_object_get_prepared_key(bijson, &step->key, &value);
+			if(error == bijson_error_key_not_found)
+				return NULL;
+			_BIJSON_RETURN_ON_ERROR(error);
+			return _bijson_query_eval(state, step_index + SIZE_C(1), &value);
+		}
+		case _bijson_query_selector_wildcard:
+		case _bijson_query_selector_filter: {
+			_bijson_object_analysis_t analysis;
+			_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
+			_bijson_object_cursor_t cursor;
+			_bijson_object_cursor_init(&cursor, &analysis);
+			for(size_t u = 0; u < analysis.count; u++) {
+				const void *key;
+				size_t key_len;
+				bijson_t value;
+				_BIJSON_RETURN_ON_ERROR(_bijson_object_cursor_next(&cursor, &key, &key_len, &value));
+				_BIJSON_RETURN_ON_ERROR(_bijson_query_select_candidate(state, step_index, step, &value));
+			}
+			return NULL;
+		}
+		case _bijson_query_selector_index:
+		case _bijson_query_selector_slice:
+			break;
+	}
+
+	return NULL;
+}
+
+// Applies a descendant step to all values below the given one.
+static bijson_error_t _bijson_query_descend(const _bijson_query_state_t *state, size_t step_index, const bijson_t *bijson) {
+	if(_bijson_query_is_array(bijson)) {
+		_bijson_array_analysis_t analysis;
+		_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(bijson, &analysis));
+		_bijson_array_cursor_t cursor;
+		_bijson_array_cursor_init(&cursor, &analysis);
+		for(size_t u = 0; u < analysis.count; u++) {
+			bijson_t item;
+			_BIJSON_RETURN_ON_ERROR(_bijson_array_cursor_next(&cursor, &item));
+			_BIJSON_RETURN_ON_ERROR(_bijson_query_eval(state, step_index, &item));
+		}
+	} else if(_bijson_query_is_object(bijson)) {
+		_bijson_object_analysis_t analysis;
+		_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
+		_bijson_object_cursor_t cursor;
+		_bijson_object_cursor_init(&cursor, &analysis);
+		for(size_t u = 0; u < analysis.count; u++) {
+			const void *key;
+			size_t key_len;
+			bijson_t value;
+			_BIJSON_RETURN_ON_ERROR(_bijson_object_cursor_next(&cursor, &key, &key_len, &value));
+			_BIJSON_RETURN_ON_ERROR(_bijson_query_eval(state, step_index, &value));
+		}
+	}
+	return NULL;
+}
+
+static bijson_error_t _bijson_query_eval(const _bijson_query_state_t *state, size_t step_index, const bijson_t *bijson) {
+	const bijson_query_t *query = state->query;
+	if(step_index == query->steps_count)
+		return state->callback(state->callback_data, bijson);
+
+	const _bijson_query_step_t *step = query->steps + step_index;
+	_BIJSON_RETURN_ON_ERROR(_bijson_query_select(state, step_index, step, bijson));
+	if(step->descendants)
+		_BIJSON_RETURN_ON_ERROR(_bijson_query_descend(state, step_index, bijson));
+	return NULL;
+}
+
+bijson_error_t bijson_query_run_parallel(
+	const bijson_query_t *query,
+	const bijson_t *bijson,
+	size_t threads,
+	bijson_query_callback_t callback,
+	void *callback_data
+) {
+	if(!query || !callback)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
+
+	_bijson_query_state_t state = {
+		.query = query,
+		.threads = threads ? threads : SIZE_C(1),
+		.callback = callback,
+		.callback_data = callback_data,
+	};
+	return _bijson_query_eval(&state, SIZE_C(0), bijson);
+}
+
+bijson_error_t bijson_query_run(
+	const bijson_query_t *query,
+	const bijson_t *bijson,
+	bijson_query_callback_t callback,
+	void *callback_data
+) {
+	return bijson_query_run_parallel(query, bijson, SIZE_C(1), callback, callback_data);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../common.h"
+#include "../reader.h"
+
+typedef enum _bijson_query_selector {
+	_bijson_query_selector_child,
+	_bijson_query_selector_wildcard,
+	_bijson_query_selector_index,
+	_bijson_query_selector_slice,
+	_bijson_query_selector_filter,
+} _bijson_query_selector_t;
+
+typedef enum _bijson_query_operator {
+	// Only checks whether the field exists
+	_bijson_query_operator_exists,
+	_bijson_query_operator_eq,
+	_bijson_query_operator_ne,
+	_bijson_query_operator_lt,
+	_bijson_query_operator_le,
+	_bijson_query_operator_gt,
+	_bijson_query_operator_ge,
+} _bijson_query_operator_t;
+
+typedef enum _bijson_query_literal_type {
+	_bijson_query_literal_none,
+	_bijson_query_literal_number,
+	_bijson_query_literal_string,
+	_bijson_query_literal_true,
+	_bijson_query_literal_false,
+	_bijson_query_literal_null,
+} _bijson_query_literal_type_t;
+
+typedef struct _bijson_query_step {
+	_bijson_query_selector_t selector;
+	// Apply the selector to the current value and all its descendants (..)
+	bool descendants;
+	// Child: the key. Filter with a string literal: the string.
+	bijson_key_t key;
+	// Index: the index, negative values count from the end.
+	// Slice: start, end and step. has_start/has_end are false if omitted.
+	int64_t start;
+	int64_t end;
+	int64_t step;
+	bool has_start;
+	bool has_end;
+	// Filter: the field path (relative to each candidate) and comparison.
+	size_t fields_start;
+	size_t fields_count;
+	_bijson_query_operator_t op;
+	_bijson_query_literal_type_t literal_type;
+	// Filter with a number literal: the number, encoded like documents
+	// encode it so that it compares exactly. Allocated.
+	bijson_t number;
+} _bijson_query_step_t;
+
+struct bijson_query {
+	_bijson_query_step_t *steps;
+	size_t steps_count;
+	bijson_key_t *fields;
+	size_t fields_count;
+	// Unescaped keys and strings
+	char *strings;
+};
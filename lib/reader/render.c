@@ -0,0 +1,285 @@
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "../../include/reader.h"
+
+#include "../common.h"
+#include "../io.h"
+#include "../parallel.h"
+#include "../reader.h"
+#include "array.h"
+#include "object.h"
+#include "object/cursor.h"
+#include "string.h"
+
+// Parallel JSON rendering. The entries of large containers are divided into
+// blocks of roughly _BIJSON_RENDER_BLOCK_SIZE bytes of input, which worker
+// threads render into buffers of their own. The buffers are then passed to
+// the output callback in order. To limit memory use only a window of a few
+// blocks per thread is rendered at a time. Entries that are large containers
+// themselves are not put in a block; instead they are descended into and
+// split up in the same way.
+
+#define _BIJSON_RENDER_BLOCK_SIZE SIZE_C(1048576)
+#define _BIJSON_RENDER_BLOCKS_PER_THREAD SIZE_C(4)
+
+typedef union _bijson_render_cursor {
+	_bijson_array_cursor_t array;
+	_bijson_object_cursor_t object;
+} _bijson_render_cursor_t;
+
+typedef struct _bijson_render_block {
+	// Positioned at the first entry of the block
+	_bijson_render_cursor_t cursor;
+	size_t end;
+	byte_t *buffer;
+	size_t size;
+	size_t capacity;
+} _bijson_render_block_t;
+
+typedef struct _bijson_render {
+	size_t threads;
+	bijson_output_callback_t callback;
+	void *callback_data;
+	_bijson_render_block_t *blocks;
+	size_t window;
+} _bijson_render_t;
+
+typedef struct _bijson_render_container {
+	_bijson_render_t *render;
+	bool object;
+	size_t blocks_count;
+} _bijson_render_container_t;
+
+typedef struct _bijson_render_job {
+	const _bijson_render_container_t *container;
+	_bijson_render_block_t *block;
+} _bijson_render_job_t;
+
+static bijson_error_t _bijson_render_block_output_callback(void *callback_data, const void *data, size_t len) {
+	_bijson_render_block_t *block = callback_data;
+	size_t size = block->size;
+	if(len > block->capacity - size) {
+		if(len > SIZE_MAX - size)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		size_t required = size + len;
+		size_t capacity = block->capacity ? block->capacity : _BIJSON_RENDER_BLOCK_SIZE;
+		while(capacity < required) {
+			if(capacity > SIZE_MAX / SIZE_C(2))
+				_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+			capacity *= SIZE_C(2);
+		}
+		byte_t *buffer = realloc(block->buffer, capacity);
+		if(!buffer)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+		block->buffer = buffer;
+		block->capacity = capacity;
+	}
+	memcpy(block->buffer + size, data, len);
+	block->size = size + len;
+	return NULL;
+}
+
+// Renders the entries of a block, each preceded by a comma unless it is the
+// first entry of the container.
+static bijson_error_t _bijson_render_block_action(
+	void *action_callback_data,
+	bijson_output_callback_t callback,
+	void *callback_data
+) {
+	const _bijson_render_job_t *job = action_callback_data;
+	_bijson_render_cursor_t cursor = job->block->cursor;
+	size_t end = job->block->end;
+
+	if(job->container->object) {
+		for(size_t u = cursor.object.index; u < end; u++) {
+			if(u)
+				_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, ",", 1));
+			bijson_t key, value;
+			_BIJSON_RETURN_ON_ERROR(_bijson_object_cursor_next(&cursor.object, &key.buffer, &key.size, &value));
+			_BIJSON_RETURN_ON_ERROR(_bijson_raw_string_to_json(&key, callback, callback_data));
+			_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, ":", 1));
+			_BIJSON_RETURN_ON_ERROR(_bijson_to_json(&value, false, callback, callback_data));
+		}
+	} else {
+		for(size_t u = cursor.array.index; u < end; u++) {
+			if(u)
+				_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, ",", 1));
+			bijson_t item;
+			_BIJSON_RETURN_ON_ERROR(_bijson_array_cursor_next(&cursor.array, &item));
+			_BIJSON_RETURN_ON_ERROR(_bijson_to_json(&item, false, callback, callback_data));
+		}
+	}
+
+	return NULL;
+}
+
+static bijson_error_t _bijson_render_worker(void *worker_data, size_t thread, size_t start, size_t end) {
+	(void)thread;
+	const _bijson_render_container_t *container = worker_data;
+	for(size_t u = start; u < end; u++) {
+		_bijson_render_job_t job = {container, container->render->blocks + u};
+		job.block->size = 0;
+		_BIJSON_RETURN_ON_ERROR(_bijson_io_write_buffered(
+			_bijson_render_block_action,
+			&job,
+			_bijson_render_block_output_callback,
+			job.block
+		));
+	}
+	return NULL;
+}
+
+// Renders the blocks collected so far and outputs them in order.
+static bijson_error_t _bijson_render_flush(_bijson_render_container_t *container) {
+	_bijson_render_t *render = container->render;
+	size_t blocks_count = container->blocks_count;
+	if(!blocks_count)
+		return NULL;
+	container->blocks_count = 0;
+
+	_BIJSON_RETURN_ON_ERROR(_bijson_parallel_run_dynamic(blocks_count, SIZE_C(1), render->threads, _bijson_render_worker, container));
+
+	for(size_t u = 0; u < blocks_count; u++) {
+		const _bijson_render_block_t *block = render->blocks + u;
+		_BIJSON_RETURN_ON_ERROR(_bijson_io_output(render->callback, render->callback_data, block->buffer, block->size));
+	}
+	return NULL;
+}
+
+__attribute__((pure))
+static inline bool _bijson_render_is_container(const bijson_t *bijson) {
+	byte_compute_t type = *(const byte_t *)bijson->buffer;
+	return (type & BYTE_C(0xF0)) == BYTE_C(0x30) || (type >= BYTE_C(0x40) && type < BYTE_C(0xC0));
+}
+
+static bijson_error_t _bijson_render_value(_bijson_render_t *render, const bijson_t *value);
+
+static bijson_error_t _bijson_render_container(_bijson_render_t *render, const bijson_t *bijson) {
+	_bijson_render_container_t container = {
+		.render = render,
+		.object = (*(const byte_t *)bijson->buffer & BYTE_C(0xF0)) != BYTE_C(0x30),
+	};
+
+	_bijson_render_cursor_t cursor;
+	size_t count;
+	if(container.object) {
+		_bijson_object_analysis_t analysis;
+		_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(bijson, &analysis));
+		_bijson_object_cursor_init(&cursor.object, &analysis);
+		count = analysis.count;
+	} else {
+		_bijson_array_analysis_t analysis;
+		_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(bijson, &analysis));
+		_bijson_array_cursor_init(&cursor.array, &analysis);
+		count = analysis.count;
+	}
+
+	_BIJSON_RETURN_ON_ERROR(_bijson_io_output(render->callback, render->callback_data, container.object ? "{" : "[", 1));
+
+	_bijson_render_block_t *block = NULL;
+	size_t block_size = 0;
+	for(size_t u = 0; u < count; u++) {
+		_bijson_render_cursor_t entry_cursor = cursor;
+		bijson_t key = bijson_0, value;
+		if(container.object)
+			_BIJSON_RETURN_ON_ERROR(_bijson_object_cursor_next(&cursor.object, &key.buffer, &key.size, &value));
+		else
+			_BIJSON_RETURN_ON_ERROR(_bijson_array_cursor_next(&cursor.array, &value));
+
+		if(value.size >= _BIJSON_RENDER_BLOCK_SIZE && _bijson_render_is_container(&value)) {
+			if(block) {
+				block->end = u;
+				block = NULL;
+			}
+			_BIJSON_RETURN_ON_ERROR(_bijson_render_flush(&container));
+			if(u)
+				_BIJSON_RETURN_ON_ERROR(_bijson_io_output(render->callback, render->callback_data, ",", 1));
+			if(container.object) {
+				_BIJSON_RETURN_ON_ERROR(_bijson_raw_string_to_json(&key, render->callback, render->callback_data));
+				_BIJSON_RETURN_ON_ERROR(_bijson_io_output(render->callback, render->callback_data, ":", 1));
+			}
+			_BIJSON_RETURN_ON_ERROR(_bijson_render_value(render, &value));
+			continue;
+		}
+
+		if(!block) {
+			block = render->blocks + container.blocks_count++;
+			block->cursor = entry_cursor;
+			block_size = 0;
+		}
+		block_size += key.size + value.size;
+		if(block_size >= _BIJSON_RENDER_BLOCK_SIZE) {
+			block->end = u + SIZE_C(1);
+			block = NULL;
+			if(container.blocks_count == render->window)
+				_BIJSON_RETURN_ON_ERROR(_bijson_render_flush(&container));
+		}
+	}
+
+	if(block)
+		block->end = count;
+	_BIJSON_RETURN_ON_ERROR(_bijson_render_flush(&container));
+
+	return _bijson_io_output(render->callback, render->callback_data, container.object ? "}" : "]", 1);
+}
+
+static bijson_error_t _bijson_render_value(_bijson_render_t *render, const bijson_t *value) {
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(value));
+	if(value->size >= _BIJSON_RENDER_BLOCK_SIZE && _bijson_render_is_container(value))
+		return _bijson_render_container(render, value);
+	return _bijson_to_json(value, false, render->callback, render->callback_data);
+}
+
+typedef struct _bijson_render_state {
+	const bijson_t *bijson;
+	size_t threads;
+} _bijson_render_state_t;
+
+static bijson_error_t _bijson_render_action(
+	void *action_callback_data,
+	bijson_output_callback_t output_callback,
+	void *output_callback_data
+) {
+	const _bijson_render_state_t *state = action_callback_data;
+	size_t threads = state->threads;
+	if(threads < SIZE_C(2))
+		return _bijson_to_json(state->bijson, false, output_callback, output_callback_data);
+
+	if(threads > SIZE_MAX / _BIJSON_RENDER_BLOCKS_PER_THREAD / sizeof(_bijson_render_block_t))
+		_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+	size_t window = threads * _BIJSON_RENDER_BLOCKS_PER_THREAD;
+	_bijson_render_block_t *blocks = calloc(window, sizeof *blocks);
+	if(!blocks)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+
+	_bijson_render_t render = {
+		.threads = threads,
+		.callback = output_callback,
+		.callback_data = output_callback_data,
+		.blocks = blocks,
+		.window = window,
+	};
+	bijson_error_t error = _bijson_render_value(&render, state->bijson);
+
+	for(size_t u = 0; u < window; u++)
+		free(blocks[u].buffer);
+	free(blocks);
+	return error;
+}
+
+bijson_error_t bijson_to_json_parallel(
+	const bijson_t *bijson,
+	size_t threads,
+	bijson_output_callback_t callback,
+	void *callback_data
+) {
+	_bijson_render_state_t state = {bijson, threads};
+	return _bijson_io_write_buffered(_bijson_render_action, &state, callback, callback_data);
+}
+
+bijson_error_t bijson_to_json_parallel_filename(const bijson_t *bijson, size_t threads, const char *filename) {
+	_bijson_render_state_t state = {bijson, threads};
+	return _bijson_io_write_to_filename(_bijson_render_action, &state, filename, NULL);
+}
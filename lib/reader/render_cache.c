@@ -0,0 +1,369 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "../../include/reader.h"
+
+#include "../common.h"
+#include "../io.h"
+#include "../rapidhash.h"
+#include "../reader.h"
+#include "render_cache.h"
+
+// Cached JSON renderings of values, looked up by the address and size of the
+// value (which identify both the mapping and the offset within it) and
+// whether it was rendered without checks. Entries live in a hash table with
+// chaining and on a doubly linked list in order of use, from which the least
+// recently used ones are evicted. Entries are reference counted, so that the
+// output of a hit can be passed to the callback without holding the lock.
+// Small values are not cached: rendering them is as cheap as a lookup.
+
+#define _BIJSON_RENDER_CACHE_MIN_SIZE SIZE_C(256)
+#define _BIJSON_RENDER_CACHE_INITIAL_BUCKETS SIZE_C(64)
+
+typedef struct _bijson_render_cache_entry _bijson_render_cache_entry_t;
+
+struct _bijson_render_cache_entry {
+	const void *buffer;
+	size_t size;
+	bool nocheck;
+	uint64_t hash;
+	// Next entry in the same bucket
+	_bijson_render_cache_entry_t *next;
+	_bijson_render_cache_entry_t *newer;
+	_bijson_render_cache_entry_t *older;
+	// One for the cache itself plus one for each hit being output
+	size_t refs;
+	size_t json_size;
+	byte_t json[];
+};
+
+struct bijson_render_cache {
+	pthread_mutex_t mutex;
+	_bijson_render_cache_entry_t **buckets;
+	size_t buckets_count;
+	_bijson_render_cache_entry_t *newest;
+	_bijson_render_cache_entry_t *oldest;
+	size_t max_bytes;
+	size_t bytes;
+	size_t entries;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+};
+
+static bijson_render_cache_t *_bijson_render_cache_installed;
+
+__attribute__((const))
+static inline uint64_t _bijson_render_cache_hash(uintptr_t buffer, size_t size, bool nocheck) {
+	return rapid_mix(
+		(uint64_t)buffer ^ UINT64_C(0x2D358DCCAA6C78A5),
+		(uint64_t)size ^ (nocheck ? UINT64_C(0x8BB84B93962EACC9) : UINT64_C(0x4B33A62ED433D4A3))
+	);
+}
+
+__attribute__((pure))
+static inline size_t _bijson_render_cache_entry_bytes(const _bijson_render_cache_entry_t *entry) {
+	return sizeof *entry + entry->json_size;
+}
+
+static inline void _bijson_render_cache_release(_bijson_render_cache_entry_t *entry) {
+	if(!--entry->refs)
+		free(entry);
+}
+
+static inline void _bijson_render_cache_unlink(bijson_render_cache_t *cache, _bijson_render_cache_entry_t *entry) {
+	if(entry->newer)
+		entry->newer->older = entry->older;
+	else
+		cache->newest = entry->older;
+	if(entry->older)
+		entry->older->newer = entry->newer;
+	else
+		cache->oldest = entry->newer;
+}
+
+static inline void _bijson_render_cache_link(bijson_render_cache_t *cache, _bijson_render_cache_entry_t *entry) {
+	entry->newer = NULL;
+	entry->older = cache->newest;
+	if(cache->newest)
+		cache->newest->newer = entry;
+	else
+		cache->oldest = entry;
+	cache->newest = entry;
+}
+
+static void _bijson_render_cache_remove(bijson_render_cache_t *cache, _bijson_render_cache_entry_t *entry) {
+	_bijson_render_cache_entry_t **link = cache->buckets + (entry->hash & (cache->buckets_count - SIZE_C(1)));
+	while(*link != entry)
+		link = &(*link)->next;
+	*link = entry->next;
+	_bijson_render_cache_unlink(cache, entry);
+	cache->bytes -= _bijson_render_cache_entry_bytes(entry);
+	cache->entries--;
+	_bijson_render_cache_release(entry);
+}
+
+__attribute__((pure))
+static _bijson_render_cache_entry_t *_bijson_render_cache_find(
+	const bijson_render_cache_t *cache,
+	const bijson_t *bijson,
+	bool nocheck,
+	uint64_t hash
+) {
+	_bijson_render_cache_entry_t *entry = cache->buckets[hash & (cache->buckets_count - SIZE_C(1))];
+	while(entry && (entry->buffer != bijson->buffer || entry->size != bijson->size || entry->nocheck != nocheck))
+		entry = entry->next;
+	return entry;
+}
+
+// Doubles the number of buckets. Failure is harmless: chains just get longer.
+static void _bijson_render_cache_grow(bijson_render_cache_t *cache) {
+	size_t buckets_count = cache->buckets_count * SIZE_C(2);
+	if(buckets_count > SIZE_MAX / sizeof *cache->buckets)
+		return;
+	_bijson_render_cache_entry_t **buckets = calloc(buckets_count, sizeof *buckets);
+	if(!buckets)
+		return;
+	for(_bijson_render_cache_entry_t *entry = cache->newest; entry; entry = entry->older) {
+		_bijson_render_cache_entry_t **bucket = buckets + (entry->hash & (buckets_count - SIZE_C(1)));
+		entry->next = *bucket;
+		*bucket = entry;
+	}
+	free(cache->buckets);
+	cache->buckets = buckets;
+	cache->buckets_count = buckets_count;
+}
+
+static void _bijson_render_cache_insert(bijson_render_cache_t *cache, _bijson_render_cache_entry_t *entry) {
+	size_t bytes = _bijson_render_cache_entry_bytes(entry);
+	while(cache->oldest && bytes > cache->max_bytes - cache->bytes) {
+		_bijson_render_cache_remove(cache, cache->oldest);
+		cache->evictions++;
+	}
+
+	if(cache->entries >= cache->buckets_count)
+		_bijson_render_cache_grow(cache);
+
+	_bijson_render_cache_entry_t **bucket = cache->buckets + (entry->hash & (cache->buckets_count - SIZE_C(1)));
+	entry->next = *bucket;
+	*bucket = entry;
+	_bijson_render_cache_link(cache, entry);
+	entry->refs = SIZE_C(1);
+	cache->bytes += bytes;
+	cache->entries++;
+}
+
+typedef struct _bijson_render_cache_render {
+	const bijson_t *bijson;
+	bool nocheck;
+	_bijson_render_cache_entry_t *entry;
+	size_t capacity;
+} _bijson_render_cache_render_t;
+
+static bijson_error_t _bijson_render_cache_output_callback(void *callback_data, const void *data, size_t len) {
+	_bijson_render_cache_render_t *render = callback_data;
+	_bijson_render_cache_entry_t *entry = render->entry;
+	size_t json_size = entry ? entry->json_size : 0;
+	if(!entry || len > render->capacity - json_size) {
+		if(len > (SIZE_MAX - sizeof *entry) / SIZE_C(2) - json_size)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		size_t capacity = (json_size + len) * SIZE_C(2);
+		entry = realloc(entry, sizeof *entry + capacity);
+		if(!entry)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+		entry->json_size = json_size;
+		render->entry = entry;
+		render->capacity = capacity;
+	}
+	memcpy(entry->json + json_size, data, len);
+	entry->json_size = json_size + len;
+	return NULL;
+}
+
+static bijson_error_t _bijson_render_cache_action(
+	void *action_callback_data,
+	bijson_output_callback_t output_callback,
+	void *output_callback_data
+) {
+	const _bijson_render_cache_render_t *render = action_callback_data;
+	return _bijson_to_json(render->bijson, render->nocheck, output_callback, output_callback_data);
+}
+
+static bijson_error_t _bijson_render_cache_to_json(
+	bijson_render_cache_t *cache,
+	const bijson_t *bijson,
+	bool nocheck,
+	bool count,
+	bijson_output_callback_t callback,
+	void *callback_data
+) {
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
+	if(bijson->size < _BIJSON_RENDER_CACHE_MIN_SIZE || bijson->size > cache->max_bytes)
+		return _bijson_to_json(bijson, nocheck, callback, callback_data);
+
+	uint64_t hash = _bijson_render_cache_hash((uintptr_t)bijson->buffer, bijson->size, nocheck);
+
+	pthread_mutex_lock(&cache->mutex);
+	_bijson_render_cache_entry_t *entry = _bijson_render_cache_find(cache, bijson, nocheck, hash);
+	if(entry) {
+		_bijson_render_cache_unlink(cache, entry);
+		_bijson_render_cache_link(cache, entry);
+		entry->refs++;
+		if(count)
+			cache->hits++;
+	} else if(count) {
+		cache->misses++;
+	}
+	pthread_mutex_unlock(&cache->mutex);
+
+	if(entry) {
+		bijson_error_t error = _bijson_io_output(callback, callback_data, entry->json, entry->json_size);
+		pthread_mutex_lock(&cache->mutex);
+		_bijson_render_cache_release(entry);
+		pthread_mutex_unlock(&cache->mutex);
+		return error;
+	}
+
+	_bijson_render_cache_render_t render = {bijson, nocheck, NULL, 0};
+	bijson_error_t error = _bijson_io_write_buffered(
+		_bijson_render_cache_action,
+		&render,
+		_bijson_render_cache_output_callback,
+		&render
+	);
+	entry = render.entry;
+	if(error || !entry) {
+		free(entry);
+		return error;
+	}
+
+	error = _bijson_io_output(callback, callback_data, entry->json, entry->json_size);
+
+	if(sizeof *entry + entry->json_size > cache->max_bytes) {
+		free(entry);
+		return error;
+	}
+	_bijson_render_cache_entry_t *shrunk = realloc(entry, sizeof *entry + entry->json_size);
+	if(shrunk)
+		entry = shrunk;
+	entry->buffer = bijson->buffer;
+	entry->size = bijson->size;
+	entry->nocheck = nocheck;
+	entry->hash = hash;
+
+	pthread_mutex_lock(&cache->mutex);
+	// Another thread may have rendered the same value in the meantime
+	if(_bijson_render_cache_find(cache, bijson, nocheck, hash))
+		free(entry);
+	else
+		_bijson_render_cache_insert(cache, entry);
+	pthread_mutex_unlock(&cache->mutex);
+
+	return error;
+}
+
+bijson_error_t _bijson_render_cache_to_json_installed(
+	const bijson_t *bijson,
+	bool nocheck,
+	bool count,
+	bijson_output_callback_t callback,
+	void *callback_data
+) {
+	bijson_render_cache_t *cache = __atomic_load_n(&_bijson_render_cache_installed, __ATOMIC_ACQUIRE);
+	if(cache)
+		return _bijson_render_cache_to_json(cache, bijson, nocheck, count, callback, callback_data);
+	return _bijson_to_json(bijson, nocheck, callback, callback_data);
+}
+
+void _bijson_render_cache_invalidate_installed(const bijson_t *bijson) {
+	bijson_render_cache_t *cache = __atomic_load_n(&_bijson_render_cache_installed, __ATOMIC_ACQUIRE);
+	if(cache)
+		bijson_render_cache_invalidate(cache, bijson);
+}
+
+bijson_error_t bijson_render_cache_alloc(bijson_render_cache_t **result, size_t max_bytes) {
+	if(!result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	if(!max_bytes)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_zero);
+
+	bijson_render_cache_t *cache = calloc(SIZE_C(1), sizeof *cache);
+	if(!cache)
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	cache->buckets = calloc(_BIJSON_RENDER_CACHE_INITIAL_BUCKETS, sizeof *cache->buckets);
+	if(!cache->buckets || pthread_mutex_init(&cache->mutex, NULL)) {
+		free(cache->buckets);
+		free(cache);
+		_BIJSON_RETURN_ERROR(bijson_error_system);
+	}
+	cache->buckets_count = _BIJSON_RENDER_CACHE_INITIAL_BUCKETS;
+	cache->max_bytes = max_bytes;
+
+	*result = cache;
+	return NULL;
+}
+
+bijson_error_t bijson_render_cache_to_json(
+	bijson_render_cache_t *cache,
+	const bijson_t *bijson,
+	bijson_output_callback_t callback,
+	void *callback_data
+) {
+	if(!cache)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	return _bijson_render_cache_to_json(cache, bijson, false, true, callback, callback_data);
+}
+
+void bijson_render_cache_install(bijson_render_cache_t *cache) {
+	__atomic_store_n(&_bijson_render_cache_installed, cache, __ATOMIC_RELEASE);
+}
+
+void bijson_render_cache_invalidate(bijson_render_cache_t *cache, const bijson_t *bijson) {
+	if(!cache || !bijson || !bijson->buffer)
+		return;
+	uintptr_t start = (uintptr_t)bijson->buffer;
+	uintptr_t end = start + bijson->size;
+
+	pthread_mutex_lock(&cache->mutex);
+	_bijson_render_cache_entry_t *entry = cache->newest;
+	while(entry) {
+		_bijson_render_cache_entry_t *older = entry->older;
+		uintptr_t buffer = (uintptr_t)entry->buffer;
+		if(buffer >= start && buffer < end)
+			_bijson_render_cache_remove(cache, entry);
+		entry = older;
+	}
+	pthread_mutex_unlock(&cache->mutex);
+}
+
+void bijson_render_cache_clear(bijson_render_cache_t *cache) {
+	if(!cache)
+		return;
+	pthread_mutex_lock(&cache->mutex);
+	while(cache->oldest)
+		_bijson_render_cache_remove(cache, cache->oldest);
+	pthread_mutex_unlock(&cache->mutex);
+}
+
+void bijson_render_cache_get_stats(bijson_render_cache_t *cache, bijson_render_cache_stats_t *result) {
+	if(!cache || !result)
+		return;
+	pthread_mutex_lock(&cache->mutex);
+	result->hits = cache->hits;
+	result->misses = cache->misses;
+	result->evictions = cache->evictions;
+	result->entries = cache->entries;
+	result->bytes = cache->bytes;
+	pthread_mutex_unlock(&cache->mutex);
+}
+
+void bijson_render_cache_free(bijson_render_cache_t *cache) {
+	if(!cache)
+		return;
+	bijson_render_cache_clear(cache);
+	pthread_mutex_destroy(&cache->mutex);
+	free(cache->buckets);
+	free(cache);
+}
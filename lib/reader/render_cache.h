@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../common.h"
+#include "../reader.h"
+
+// Like _bijson_to_json(), but uses the installed render cache, if any.
+// Unless count is set, the lookup is left out of the hit and miss counts.
+extern bijson_error_t _bijson_render_cache_to_json_installed(
+	const bijson_t *bijson,
+	bool nocheck,
+	bool count,
+	bijson_output_callback_t callback,
+	void *callback_data
+);
+// Drops the cached renderings of values in this buffer from the installed
+// render cache, if any, because the buffer is about to go away.
+extern void _bijson_render_cache_invalidate_installed(const bijson_t *bijson);
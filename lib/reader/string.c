@@ -1,65 +1,261 @@
+#include <string.h>
+
+#include "../../include/reader.h"
+
 #include "../common.h"
+#include "../reader.h"
+#include "../io.h"
 #include "string.h"
 
+#if defined(HAVE_BUILTIN_CPU_SUPPORTS) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define _BIJSON_STRING_X86
+#endif
+
 static const byte_t _bijson_hex[16] = "0123456789ABCDEF";
 
-bijson_error_t _bijson_raw_string_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data) {
+// Escapes, short runs of clean bytes and the quotes are collected in a
+// buffer of this size, so that short strings and strings with many escapes
+// need few callbacks. Longer runs are passed to the callback directly.
+#define _BIJSON_STRING_BUFFER_SIZE SIZE_C(256)
+#define _BIJSON_STRING_DIRECT_RUN SIZE_C(64)
+// The longest escape, \u00XX
+#define _BIJSON_STRING_ESCAPE_MAX SIZE_C(6)
+
+#define _BIJSON_STRING_ONES UINT64_C(0x0101010101010101)
+#define _BIJSON_STRING_HIGHS UINT64_C(0x8080808080808080)
+
+__attribute__((const))
+static inline bool _bijson_string_needs_escape(byte_compute_t c) {
+	return c < BYTE_C(0x20) || c == '"' || c == '\\';
+}
+
+// Nonzero if any of the 8 bytes needs escaping. Bytes are checked using the
+// usual tricks for finding zero bytes (or bytes below some value) in a word.
+__attribute__((const))
+static inline uint64_t _bijson_string_word_needs_escape(uint64_t word) {
+	uint64_t quotes = word ^ (_BIJSON_STRING_ONES * UINT64_C(0x22));
+	uint64_t backslashes = word ^ (_BIJSON_STRING_ONES * UINT64_C(0x5C));
+	return (
+		((word - _BIJSON_STRING_ONES * UINT64_C(0x20)) & ~word)
+		| ((quotes - _BIJSON_STRING_ONES) & ~quotes)
+		| ((backslashes - _BIJSON_STRING_ONES) & ~backslashes)
+	) & _BIJSON_STRING_HIGHS;
+}
+
+// Each scanner returns the first byte that needs escaping, or string_end.
+
+__attribute__((pure))
+static const byte_t *_bijson_string_scan_swar(const byte_t *string, const byte_t *string_end) {
+	while(_bijson_ptrdiff(string_end, string) >= sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, string, sizeof word);
+		if(_bijson_string_word_needs_escape(word))
+			break;
+		string += sizeof word;
+	}
+	while(string < string_end && !_bijson_string_needs_escape(*string))
+		string++;
+	return string;
+}
+
+#ifdef _BIJSON_STRING_X86
+// Bytes below 0x20 are found by checking whether min(byte, 0x1F) == byte,
+// because SSE2 only has signed byte comparisons.
+__attribute__((pure, target("sse2")))
+static const byte_t *_bijson_string_scan_sse2(const byte_t *string, const byte_t *string_end) {
+	const __m128i controls = _mm_set1_epi8(0x1F);
+	const __m128i quotes = _mm_set1_epi8('"');
+	const __m128i backslashes = _mm_set1_epi8('\\');
+	while(_bijson_ptrdiff(string_end, string) >= sizeof(__m128i)) {
+		__m128i block = _mm_loadu_si128((const __m128i *)string);
+		__m128i special = _mm_or_si128(
+			_mm_cmpeq_epi8(_mm_min_epu8(block, controls), block),
+			_mm_or_si128(_mm_cmpeq_epi8(block, quotes), _mm_cmpeq_epi8(block, backslashes))
+		);
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(special);
+		if(mask)
+			return string + __builtin_ctz(mask);
+		string += sizeof(__m128i);
+	}
+	return _bijson_string_scan_swar(string, string_end);
+}
+
+__attribute__((pure, target("avx2")))
+static const byte_t *_bijson_string_scan_avx2(const byte_t *string, const byte_t *string_end) {
+	const __m256i controls = _mm256_set1_epi8(0x1F);
+	const __m256i quotes = _mm256_set1_epi8('"');
+	const __m256i backslashes = _mm256_set1_epi8('\\');
+	while(_bijson_ptrdiff(string_end, string) >= sizeof(__m256i)) {
+		__m256i block = _mm256_loadu_si256((const __m256i *)string);
+		__m256i special = _mm256_or_si256(
+			_mm256_cmpeq_epi8(_mm256_min_epu8(block, controls), block),
+			_mm256_or_si256(_mm256_cmpeq_epi8(block, quotes), _mm256_cmpeq_epi8(block, backslashes))
+		);
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(special);
+		if(mask)
+			return string + __builtin_ctz(mask);
+		string += sizeof(__m256i);
+	}
+	return _bijson_string_scan_sse2(string, string_end);
+}
+#endif
+
+typedef const byte_t *(*_bijson_string_scan_t)(const byte_t *string, const byte_t *string_end);
+
+static inline _bijson_string_scan_t _bijson_string_scan_select(void) {
+#ifdef _BIJSON_STRING_X86
+	if(__builtin_cpu_supports("avx2"))
+		return _bijson_string_scan_avx2;
+	if(__builtin_cpu_supports("sse2"))
+		return _bijson_string_scan_sse2;
+#endif
+	return _bijson_string_scan_swar;
+}
+
+// Escapes a string, optionally preceded and/or followed by a quote
+__attribute__((always_inline))
+static inline bijson_error_t _bijson_string_escape(
+	const bijson_t *bijson,
+	bool open,
+	bool close,
+	bijson_output_callback_t callback,
+	void *callback_data
+) {
 	const byte_t *string = bijson->buffer;
-	size_t len = bijson->size;
-	const byte_t *previously_written = string;
-	byte_t escape[2] = "\\";
-	byte_t unicode_escape[6] = "\\u00";
-	_BIJSON_RETURN_ON_ERROR(callback(callback_data, "\"", 1));
-	const byte_t *string_end = string + len;
-	while(string < string_end) {
-		const byte_t *string_pos = string;
-		int c = *string++;
-		byte_t plain_escape = 0;
-		switch(c) {
-			case '"':
-				plain_escape = '"';
-				break;
-			case '\\':
-				plain_escape = '\\';
-				break;
-			case '\b':
-				plain_escape = 'b';
-				break;
-			case '\f':
-				plain_escape = 'f';
-				break;
-			case '\n':
-				plain_escape = 'n';
-				break;
-			case '\r':
-				plain_escape = 'r';
-				break;
-			case '\t':
-				plain_escape = 't';
-				break;
-			default:
-				if(c >= 32)
-					continue;
+	const byte_t *string_end = string + bijson->size;
+	// Very short strings are not worth a vectorized scan
+	_bijson_string_scan_t scan = bijson->size < sizeof(uint64_t)
+		? _bijson_string_scan_swar
+		: _bijson_string_scan_select();
+
+	byte_t buffer[_BIJSON_STRING_BUFFER_SIZE];
+	size_t buffer_len = 0;
+	if(open)
+		buffer[buffer_len++] = '"';
+
+	for(;;) {
+		const byte_t *clean_end = scan(string, string_end);
+		size_t clean_len = _bijson_ptrdiff(clean_end, string);
+		if(clean_len >= _BIJSON_STRING_DIRECT_RUN) {
+			if(buffer_len)
+				_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, buffer, buffer_len));
+			buffer_len = 0;
+			_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, string, clean_len));
+		} else if(clean_len) {
+			if(clean_len > sizeof buffer - buffer_len) {
+				_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, buffer, buffer_len));
+				buffer_len = 0;
+			}
+			memcpy(buffer + buffer_len, string, clean_len);
+			buffer_len += clean_len;
 		}
-		if(string_pos > previously_written)
-			_BIJSON_RETURN_ON_ERROR(callback(callback_data, previously_written, _bijson_ptrdiff(string_pos, previously_written)));
-		previously_written = string;
-		if(plain_escape) {
-			escape[1] = plain_escape;
-			_BIJSON_RETURN_ON_ERROR(callback(callback_data, escape, sizeof escape));
-		} else {
-			unicode_escape[4] = _bijson_hex[(size_t)c >> 4U];
-			unicode_escape[5] = _bijson_hex[(size_t)c & SIZE_C(0xF)];
-			_BIJSON_RETURN_ON_ERROR(callback(callback_data, unicode_escape, sizeof unicode_escape));
+		string = clean_end;
+		if(string == string_end)
+			break;
+
+		while(string < string_end && _bijson_string_needs_escape(*string)) {
+			if(buffer_len > sizeof buffer - _BIJSON_STRING_ESCAPE_MAX) {
+				_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, buffer, buffer_len));
+				buffer_len = 0;
+			}
+			byte_compute_t c = *string++;
+			byte_t plain_escape = 0;
+			switch(c) {
+				case '"':
+					plain_escape = '"';
+					break;
+				case '\\':
+					plain_escape = '\\';
+					break;
+				case '\b':
+					plain_escape = 'b';
+					break;
+				case '\f':
+					plain_escape = 'f';
+					break;
+				case '\n':
+					plain_escape = 'n';
+					break;
+				case '\r':
+					plain_escape = 'r';
+					break;
+				case '\t':
+					plain_escape = 't';
+					break;
+			}
+			buffer[buffer_len++] = '\\';
+			if(plain_escape) {
+				buffer[buffer_len++] = plain_escape;
+			} else {
+				buffer[buffer_len++] = 'u';
+				buffer[buffer_len++] = '0';
+				buffer[buffer_len++] = '0';
+				buffer[buffer_len++] = _bijson_hex[(size_t)c >> 4U];
+				buffer[buffer_len++] = _bijson_hex[(size_t)c & SIZE_C(0xF)];
+			}
 		}
 	}
-	if(string > previously_written)
-		_BIJSON_RETURN_ON_ERROR(callback(callback_data, previously_written, (size_t)(string - previously_written)));
-	return callback(callback_data, "\"", SIZE_C(1));
+
+	if(!close)
+		return buffer_len ? _bijson_io_output(callback, callback_data, buffer, buffer_len) : NULL;
+
+	if(buffer_len == sizeof buffer) {
+		_BIJSON_RETURN_ON_ERROR(_bijson_io_output(callback, callback_data, buffer, buffer_len));
+		buffer_len = 0;
+	}
+	buffer[buffer_len++] = '"';
+	return _bijson_io_output(callback, callback_data, buffer, buffer_len);
+}
+
+bijson_error_t _bijson_raw_string_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data) {
+	return _bijson_string_escape(bijson, true, true, callback, callback_data);
 }
 
-bijson_error_t _bijson_string_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *userdata) {
+bijson_error_t _bijson_raw_string_part_to_json(
+	const bijson_t *bijson,
+	bool first,
+	bool last,
+	bijson_output_callback_t callback,
+	void *callback_data
+) {
+	return _bijson_string_escape(bijson, first, last, callback, callback_data);
+}
+
+bijson_error_t _bijson_string_to_json(const bijson_t *bijson, bool nocheck, bijson_output_callback_t callback, void *userdata) {
 	bijson_t raw_string = { .buffer = (const byte_t *)bijson->buffer + SIZE_C(1), .size = bijson->size - SIZE_C(1) };
-	_BIJSON_RETURN_ON_ERROR(_bijson_check_valid_utf8(raw_string.buffer, raw_string.size));
+	if(!nocheck)
+		_BIJSON_RETURN_ON_ERROR(_bijson_check_valid_utf8(raw_string.buffer, raw_string.size));
 	return _bijson_raw_string_to_json(&raw_string, callback, userdata);
 }
+
+__attribute__((pure))
+bijson_error_t _bijson_string_verify(const bijson_t *bijson) {
+	// We could return an UTF-8 error but it's the file that's at fault here:
+	bijson_error_t error = _bijson_check_valid_utf8((const byte_t *)bijson->buffer + SIZE_C(1), bijson->size - SIZE_C(1));
+	if(error == bijson_error_invalid_utf8)
+		_BIJSON_RETURN_ERROR(bijson_error_file_format_error);
+	return error;
+}
+
+static inline bijson_error_t _bijson_string_get(const bijson_t *bijson, bool nocheck, const char **result, size_t *size_result) {
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(bijson));
+	if(!result || !size_result)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+	const byte_t *buffer = bijson->buffer;
+	if(*buffer != BYTE_C(0x08))
+		_BIJSON_RETURN_ERROR(bijson_error_type_mismatch);
+	if(!nocheck)
+		_BIJSON_RETURN_ON_ERROR(_bijson_string_verify(bijson));
+	*result = (const char *)buffer + SIZE_C(1);
+	*size_result = bijson->size - SIZE_C(1);
+	return NULL;
+}
+
+bijson_error_t bijson_string_get(const bijson_t *bijson, const char **result, size_t *size_result) {
+	return _bijson_string_get(bijson, false, result, size_result);
+}
+
+bijson_error_t bijson_string_get_nocheck(const bijson_t *bijson, const char **result, size_t *size_result) {
+	return _bijson_string_get(bijson, true, result, size_result);
+}
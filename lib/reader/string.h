@@ -3,4 +3,14 @@
 #include "../common.h"
 
 extern bijson_error_t _bijson_raw_string_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *callback_data);
-extern bijson_error_t _bijson_string_to_json(const bijson_t *bijson, bijson_output_callback_t callback, void *userdata);
+// Escapes part of a string. The opening quote is only output for the first
+// part and the closing quote only for the last one.
+extern bijson_error_t _bijson_raw_string_part_to_json(
+	const bijson_t *bijson,
+	bool first,
+	bool last,
+	bijson_output_callback_t callback,
+	void *callback_data
+);
+extern bijson_error_t _bijson_string_to_json(const bijson_t *bijson, bool nocheck, bijson_output_callback_t callback, void *userdata);
+extern bijson_error_t _bijson_string_verify(const bijson_t *bijson);
@@ -0,0 +1,148 @@
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "../../include/reader.h"
+
+#include "../common.h"
+#include "../reader.h"
+#include "array.h"
+#include "object.h"
+#include "object/cursor.h"
+
+// Containers that are being visited are kept on a heap allocated stack
+// instead of the C stack, so the nesting depth is limited only by memory.
+// Each container is analyzed once and its entries are visited using a
+// cursor, so every offset is read exactly once.
+
+#define _BIJSON_WALK_INITIAL_DEPTH SIZE_C(32)
+
+typedef struct _bijson_walk_frame {
+	union {
+		_bijson_array_cursor_t array;
+		_bijson_object_cursor_t object;
+	} cursor;
+	bool object;
+} _bijson_walk_frame_t;
+
+typedef struct _bijson_walk {
+	const bijson_walk_callbacks_t *callbacks;
+	void *callback_data;
+	bool nocheck;
+	_bijson_walk_frame_t *stack;
+	size_t depth;
+	size_t capacity;
+} _bijson_walk_t;
+
+static bijson_error_t _bijson_walk_push(_bijson_walk_t *walk, _bijson_walk_frame_t **result) {
+	if(walk->depth == walk->capacity) {
+		size_t capacity = walk->capacity ? walk->capacity * SIZE_C(2) : _BIJSON_WALK_INITIAL_DEPTH;
+		if(capacity > SIZE_MAX / sizeof *walk->stack)
+			_BIJSON_RETURN_ERROR(bijson_error_out_of_virtual_memory);
+		_bijson_walk_frame_t *stack = realloc(walk->stack, capacity * sizeof *stack);
+		if(!stack)
+			_BIJSON_RETURN_ERROR(bijson_error_system);
+		walk->stack = stack;
+		walk->capacity = capacity;
+	}
+	*result = walk->stack + walk->depth++;
+	return NULL;
+}
+
+// Reports a scalar, or reports the start of a container and pushes it.
+static bijson_error_t _bijson_walk_value(_bijson_walk_t *walk, const bijson_t *value) {
+	_BIJSON_RETURN_ON_ERROR(_bijson_check_bijson(value));
+	const bijson_walk_callbacks_t *callbacks = walk->callbacks;
+	const byte_compute_t type = *(const byte_t *)value->buffer;
+
+	if((type & BYTE_C(0xF0)) == BYTE_C(0x30)) {
+		_bijson_array_analysis_t analysis;
+		_BIJSON_RETURN_ON_ERROR(_bijson_array_analyze(value, &analysis));
+		if(callbacks->begin_array)
+			_BIJSON_RETURN_ON_ERROR(callbacks->begin_array(walk->callback_data, analysis.count));
+		_bijson_walk_frame_t *frame;
+		_BIJSON_RETURN_ON_ERROR(_bijson_walk_push(walk, &frame));
+		_bijson_array_cursor_init(&frame->cursor.array, &analysis);
+		frame->object = false;
+	} else if(type >= BYTE_C(0x40) && type < BYTE_C(0xC0)) {
+		_bijson_object_analysis_t analysis;
+		_BIJSON_RETURN_ON_ERROR(_bijson_object_analyze(value, &analysis));
+		analysis.nocheck = walk->nocheck;
+		if(callbacks->begin_object)
+			_BIJSON_RETURN_ON_ERROR(callbacks->begin_object(walk->callback_data, analysis.count));
+		_bijson_walk_frame_t *frame;
+		_BIJSON_RETURN_ON_ERROR(_bijson_walk_push(walk, &frame));
+		_bijson_object_cursor_init(&frame->cursor.object, &analysis);
+		frame->object = true;
+	} else if(callbacks->scalar) {
+		return callbacks->scalar(walk->callback_data, value);
+	}
+
+	return NULL;
+}
+
+static bijson_error_t _bijson_walk_run(_bijson_walk_t *walk, const bijson_t *bijson) {
+	const bijson_walk_callbacks_t *callbacks = walk->callbacks;
+	void *callback_data = walk->callback_data;
+
+	_BIJSON_RETURN_ON_ERROR(_bijson_walk_value(walk, bijson));
+
+	while(walk->depth) {
+		// Only valid until the next push
+		_bijson_walk_frame_t *frame = walk->stack + walk->depth - SIZE_C(1);
+		bijson_t value;
+		if(frame->object) {
+			_bijson_object_cursor_t *cursor = &frame->cursor.object;
+			if(cursor->index == cursor->analysis.count) {
+				walk->depth--;
+				if(callbacks->end_object)
+					_BIJSON_RETURN_ON_ERROR(callbacks->end_object(callback_data));
+				continue;
+			}
+			const void *key;
+			size_t key_size;
+			_BIJSON_RETURN_ON_ERROR(_bijson_object_cursor_next(cursor, &key, &key_size, &value));
+			if(callbacks->key)
+				_BIJSON_RETURN_ON_ERROR(callbacks->key(callback_data, key, key_size));
+		} else {
+			_bijson_array_cursor_t *cursor = &frame->cursor.array;
+			if(cursor->index == cursor->analysis.count) {
+				walk->depth--;
+				if(callbacks->end_array)
+					_BIJSON_RETURN_ON_ERROR(callbacks->end_array(callback_data));
+				continue;
+			}
+			_BIJSON_RETURN_ON_ERROR(_bijson_array_cursor_next(cursor, &value));
+		}
+		_BIJSON_RETURN_ON_ERROR(_bijson_walk_value(walk, &value));
+	}
+
+	return NULL;
+}
+
+static bijson_error_t _bijson_walk(
+	const bijson_t *bijson,
+	bool nocheck,
+	const bijson_walk_callbacks_t *callbacks,
+	void *callback_data
+) {
+	if(!callbacks)
+		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
+
+	_bijson_walk_t walk = {
+		.callbacks = callbacks,
+		.callback_data = callback_data,
+		.nocheck = nocheck,
+	};
+	bijson_error_t error = _bijson_walk_run(&walk, bijson);
+	free(walk.stack);
+	return error;
+}
+
+bijson_error_t bijson_walk(const bijson_t *bijson, const bijson_walk_callbacks_t *callbacks, void *callback_data) {
+	return _bijson_walk(bijson, false, callbacks, callback_data);
+}
+
+bijson_error_t bijson_walk_nocheck(const bijson_t *bijson, const bijson_walk_callbacks_t *callbacks, void *callback_data) {
+	return _bijson_walk(bijson, true, callbacks, callback_data);
+}
@@ -20,6 +20,11 @@ void bijson_writer_free(bijson_writer_t *writer) {
 	}
 }
 
+void bijson_writer_set_hashed_object_threshold(bijson_writer_t *writer, size_t threshold) {
+	if(writer)
+		writer->hashed_object_threshold = threshold;
+}
+
 bijson_error_t bijson_writer_alloc(bijson_writer_t **result) {
 	if(!result)
 		_BIJSON_RETURN_ERROR(bijson_error_parameter_is_null);
@@ -63,12 +68,15 @@ bijson_error_t _bijson_writer_write_value(
 		case _bijson_spool_type_scalar:
 			return _bijson_writer_write_scalar(writer, write, write_data, spool);
 		case _bijson_spool_type_object:
-			return _bijson_writer_write_object(writer, write, write_data, spool);
+			return _bijson_writer_write_object(writer, write, write_data, spool, false);
+		case _bijson_spool_type_hashed_object:
+			return _bijson_writer_write_object(writer, write, write_data, spool, true);
 		case _bijson_spool_type_array:
 			return _bijson_writer_write_array(writer, write, write_data, spool);
 		default:
 			assert(spool_type == _bijson_spool_type_scalar
 				|| spool_type == _bijson_spool_type_object
+				|| spool_type == _bijson_spool_type_hashed_object
 				|| spool_type == _bijson_spool_type_array);
 			abort();
 	}
@@ -9,6 +9,9 @@ typedef enum _bijson_spool_type_t {
 	_bijson_spool_type_scalar,
 	_bijson_spool_type_object,
 	_bijson_spool_type_array,
+	// An object that will be written with key hashes; bijson_writer_end_object()
+	// changes the type of an object to this if it is large enough.
+	_bijson_spool_type_hashed_object,
 } _bijson_spool_type_t;
 
 // These values are for use in writer->expect.
@@ -41,6 +44,9 @@ struct bijson_writer {
 	// What to put into `expect` after writing a value.
 	// Doubles as a way to see if we're inside an array or object (or neither).
 	_bijson_writer_expect_t expect_after_value;
+	// Objects with at least this many items are written with key hashes.
+	// 0 means never.
+	size_t hashed_object_threshold;
 	bool failed;
 };
 
@@ -63,9 +69,9 @@ static inline size_t _bijson_optimal_storage_size_bytes(byte_compute_t storage_s
 }
 
 static inline size_t _bijson_fit_uint64(uint64_t value) {
-	return value > UINT64_C(0xFFFFFFFFF)
-		? value > UINT64_C(0xFFFFFFFFFFFFF)
-			? value > UINT64_C(0xFFFFFFFFFFFFFFF)
+	return value > UINT64_C(0xFFFFFFFF)
+		? value > UINT64_C(0xFFFFFFFFFFFF)
+			? value > UINT64_C(0xFFFFFFFFFFFFFF)
 				? 8
 				: 7
 			: value > UINT64_C(0xFFFFFFFFFF)
@@ -29,6 +29,7 @@ size_t _bijson_writer_size_value(bijson_writer_t *writer, size_t spool_offset) {
 		return _bijson_buffer_read_size(&writer->spool, spool_offset);
 	} else {
 		assert(spool_type == _bijson_spool_type_object
+			|| spool_type == _bijson_spool_type_hashed_object
 			|| spool_type == _bijson_spool_type_array);
 		return _bijson_buffer_read_size(&writer->spool, spool_offset + sizeof(size_t));
 	}
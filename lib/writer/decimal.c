@@ -43,13 +43,6 @@ static inline bijson_error_t _bijson_shift_digits(const byte_t *start, size_t le
 
 	uint64_t magnitude = _bijson_uint64_pow10((unsigned int)shift);
 
-	if(write == _bijson_io_bytecounter_output_callback) {
-		// crude hack
-		size_t skip = len / SIZE_C(19);
-		*(size_t *)write_data += skip * sizeof(uint64_t);
-		len -= skip * SIZE_C(19);
-	}
-
 	const byte_t *s = start + len;
 	uint64_t word = 0;
 	while(s-- != start) {
@@ -59,7 +52,7 @@ static inline bijson_error_t _bijson_shift_digits(const byte_t *start, size_t le
 		if(magnitude == UINT64_C(10000000000000000000)) {
 			_BIJSON_RETURN_ON_ERROR(_bijson_writer_write_minimal_int(write, write_data, word, sizeof word));
 			word = value;
-			magnitude = UINT64_C(1);
+			magnitude = UINT64_C(10);
 		} else {
 			word += value * magnitude;
 			magnitude *= UINT64_C(10);
@@ -115,7 +108,8 @@ static bijson_error_t _bijson_add_digits(const byte_t *a_start, size_t a_len, co
 
 	assert(word);
 
-	return _bijson_writer_write_minimal_int(write, write_data, word, _bijson_fit_uint64(word - 1));
+	word--;
+	return _bijson_writer_write_minimal_int(write, write_data, word, _bijson_fit_uint64(word));
 }
 
 static bijson_error_t _bijson_subtract_digits(const byte_t *a_start, size_t a_len, const byte_t *b_start, size_t b_len, bijson_output_callback_t write, void *write_data) {
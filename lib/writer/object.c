@@ -147,6 +147,12 @@ bijson_error_t bijson_writer_end_object(bijson_writer_t *writer) {
 			+ keys_output_size + values_output_size
 		: 1;
 
+	size_t hashed_object_threshold = writer->hashed_object_threshold;
+	if(hashed_object_threshold && count >= hashed_object_threshold) {
+		_bijson_buffer_write_byte(&writer->spool, current_container - SIZE_C(1), _bijson_spool_type_hashed_object);
+		container.output_size += count * sizeof(uint64_t);
+	}
+
 	_bijson_buffer_write(&writer->spool, current_container, &container, sizeof container);
 
 	writer->current_container = _bijson_buffer_pop_size(&writer->stack);
@@ -177,7 +183,7 @@ static int _bijson_writer_object_object_item_cmp(const void *a, const void *b) {
 	return a_item < b_item ? -1 : a_item != b_item;
 }
 
-bijson_error_t _bijson_writer_write_object(bijson_writer_t *writer, bijson_output_callback_t write, void *write_data, const byte_t *spool) {
+bijson_error_t _bijson_writer_write_object(bijson_writer_t *writer, bijson_output_callback_t write, void *write_data, const byte_t *spool, bool hashed) {
 	_bijson_container_t container;
 	memcpy(&container, spool, sizeof container);
 	spool += sizeof container;
@@ -232,11 +238,21 @@ bijson_error_t _bijson_writer_write_object(bijson_writer_t *writer, bijson_outpu
 	byte_compute_t count_width = _bijson_optimal_storage_size(count_1);
 	byte_compute_t key_offsets_width = _bijson_optimal_storage_size(keys_output_size);
 	byte_compute_t value_offsets_width = _bijson_optimal_storage_size(values_output_size);
-	byte_t output_type = (byte_t)(BYTE_C(0x40) | (value_offsets_width << 4U) | (key_offsets_width << 2U) | count_width);
+	byte_t output_type = (byte_t)((hashed ? BYTE_C(0x80) : BYTE_C(0x40)) | (value_offsets_width << 4U) | (key_offsets_width << 2U) | count_width);
 
 	_BIJSON_RETURN_ON_ERROR(write(write_data, &output_type, sizeof output_type));
 	_BIJSON_RETURN_ON_ERROR(_bijson_writer_write_compact_int(write, write_data, count_1, count_width));
 
+	// Write the key hashes
+	if(hashed) {
+		for(size_t z = 0; z < count; z++) {
+			object_item = object_items[z];
+			memcpy(&key_size, object_item, sizeof key_size);
+			object_item += sizeof key_size;
+			_BIJSON_RETURN_ON_ERROR(_bijson_writer_write_minimal_int(write, write_data, rapidhash(object_item, key_size), sizeof(uint64_t)));
+		}
+	}
+
 	// Write the key offsets
 	size_t key_offset = 0;
 	for(size_t z = 0; z < count; z++) {
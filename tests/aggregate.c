@@ -0,0 +1,123 @@
+#include <math.h>
+
+#include "common.h"
+
+#ifdef __SIZEOF_INT128__
+
+static void aggregate(const char *json, bijson_aggregate_t *result) {
+	bijson_t bijson;
+	PARSE(json, &bijson);
+	_c(__FILE__, __LINE__, json, bijson_array_aggregate(&bijson, result));
+	bijson_free(&bijson);
+}
+
+static void check_sum(const char *json, size_t count, bool exact, double expected) {
+	bijson_aggregate_t result;
+	aggregate(json, &result);
+	if(result.count != count)
+		errx(EX_SOFTWARE, "%s: count is %zu, not %zu", json, result.count, count);
+	if(result.sum_exact != exact)
+		errx(EX_SOFTWARE, "%s: sum is %sexact", json, result.sum_exact ? "" : "not ");
+	if(result.sum_double != expected)
+		errx(EX_SOFTWARE, "%s: sum is %.17g, not %.17g", json, result.sum_double, expected);
+}
+
+// Checks which items are reported as the minimum and maximum.
+static void check_extremes(const char *json, size_t min, size_t max) {
+	bijson_t bijson, expected;
+	PARSE(json, &bijson);
+	bijson_aggregate_t result;
+	_c(__FILE__, __LINE__, json, bijson_array_aggregate(&bijson, &result));
+	C(bijson_array_get_index(&bijson, min, &expected));
+	if(result.min.buffer != expected.buffer)
+		errx(EX_SOFTWARE, "%s: wrong minimum", json);
+	C(bijson_array_get_index(&bijson, max, &expected));
+	if(result.max.buffer != expected.buffer)
+		errx(EX_SOFTWARE, "%s: wrong maximum", json);
+	bijson_free(&bijson);
+}
+
+#endif
+
+int main(void) {
+#ifdef __SIZEOF_INT128__
+	fprintf(stderr, "checking aggregates...\n");
+	fflush(stderr);
+
+	// Exact sums are rounded correctly
+	check_sum("[0.1,0.2]", 2, true, 0.3);
+	check_sum("[-0.1,-0.2]", 2, true, -0.3);
+	// 1e23 is exactly halfway between two doubles and rounds to even, but
+	// anything above it rounds up
+	check_sum("[1e23]", 1, true, 0x1.52d02c7e14af6p+76);
+	check_sum("[1,2.5,-3,1e23,0.1,0.2]", 6, true, 0x1.52d02c7e14af7p+76);
+	check_sum("[1e23,-0.8]", 2, true, 0x1.52d02c7e14af6p+76);
+	check_sum("[1e-400,1e-400]", 2, true, 0.0);
+	check_sum("[1e400]", 1, true, HUGE_VAL);
+	// 2^64 + 2^11 is halfway between two doubles and has 20 digits
+	check_sum("[9223372036854775808,9223372036854777856]", 2, true, 0x1p64);
+	check_sum("[9223372036854775808,9223372036854777857]", 2, true, 0x1p64 + 0x1p12);
+
+	bijson_aggregate_t result;
+	aggregate("[0.1,0.2]", &result);
+	if(result.sum != 3 || result.sum_exponent != -1)
+		errx(EX_SOFTWARE, "[0.1,0.2]: sum is not 3e-1");
+
+	// Long runs of numbers with the same exponent are summed in batches
+	char json[8192] = "[";
+	for(size_t u = 0; u < SIZE_C(1000); u++)
+		strcat(json, u ? ",0.1" : "0.1");
+	strcat(json, "]");
+	check_sum(json, 1000, true, 100.0);
+
+	// Cancellation
+	check_sum("[1e20,1,-1e20]", 3, true, 1.0);
+	check_sum("[0.5,-0.25,-0.25]", 3, true, 0.0);
+	aggregate("[1e20,-1e20]", &result);
+	if(result.sum)
+		errx(EX_SOFTWARE, "[1e20,-1e20]: sum is not zero");
+
+	// The sum no longer fits in 128 bits
+	check_sum("[1e30,1e-30]", 2, false, 1e30);
+	check_sum("[1e30,1e-30,1,2]", 4, false, 1e30);
+	check_sum("[1e38,1]", 2, true, 1e38);
+	check_sum("[2e38,1]", 2, false, 2e38);
+	check_sum("[1e38,1e38]", 2, true, 2e38);
+	// A number with more than 19 significant digits
+	check_sum("[0.5,1.00000000000000000001]", 2, false, 1.5);
+	aggregate("[1e30,1e-30]", &result);
+	if(result.sum || result.sum_exponent)
+		errx(EX_SOFTWARE, "[1e30,1e-30]: inexact sum is not zero");
+
+	// Empty arrays and arrays without numbers
+	aggregate("[]", &result);
+	if(result.count || result.skipped || !result.sum_exact || result.sum || result.sum_double != 0.0 || result.min.buffer || result.max.buffer)
+		errx(EX_SOFTWARE, "[]: wrong aggregate");
+	aggregate("[\"1\",null,[2],{\"3\":4},true]", &result);
+	if(result.count || result.skipped != SIZE_C(5) || !result.sum_exact || result.min.buffer || result.max.buffer)
+		errx(EX_SOFTWARE, "array without numbers: wrong aggregate");
+	check_sum("[\"1\",2,null]", 1, true, 2.0);
+
+	// Minimum and maximum are compared exactly, also for numbers that
+	// don't survive a conversion to double
+	check_extremes("[3,1,2]", 1, 0);
+	check_extremes("[1,\"x\",1.00000000000000000001,0.99999999999999999999,1]", 3, 2);
+	check_extremes("[1.00000000000000000001,1.00000000000000000002,1.00000000000000000003]", 0, 2);
+	check_extremes("[100000000000000000001,100000000000000000000,1e20]", 1, 0);
+	check_extremes("[-1e-400,1e-400,0]", 0, 1);
+	check_extremes("[-12345678901234567890,-12345678901234567891,5]", 1, 2);
+
+	bijson_t bijson;
+	PARSE("{}", &bijson);
+	E(bijson_error_type_mismatch, bijson_array_aggregate(&bijson, &result));
+	bijson_free(&bijson);
+	PARSE("[]", &bijson);
+	E(bijson_error_parameter_is_null, bijson_array_aggregate(&bijson, NULL));
+	bijson_free(&bijson);
+
+	fprintf(stderr, "aggregates OK.\n");
+	fflush(stderr);
+#endif
+
+	return 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <err.h>
+#include <sysexits.h>
+
+#include "../include/writer.h"
+#include "../include/reader.h"
+
+#include "../lib/common.h"
+
+inline static void _c(const char *file, int line, const char *body, bijson_error_t error) {
+	if(error == bijson_error_system)
+		err(EX_OSERR, "%s:%d: %s", file, line, body);
+	else if(error)
+		errx(EX_SOFTWARE, "%s:%d: %s: %s", file, line, body, error);
+}
+#define C(error) do { _c(__FILE__, __LINE__, #error, (error)); } while(0)
+
+// Expects a specific error (or NULL for success).
+inline static void _e(const char *file, int line, const char *body, bijson_error_t expected, bijson_error_t error) {
+	if(error != expected)
+		errx(EX_SOFTWARE, "%s:%d: %s: expected %s, got %s", file, line, body,
+			expected ? expected : "success", error ? error : "success");
+}
+#define E(expected, error) do { _e(__FILE__, __LINE__, #error, (expected), (error)); } while(0)
+
+// Converts JSON text to bijson. Free the result with bijson_free().
+inline static void _parse(const char *file, int line, const char *json, bijson_t *result) {
+	bijson_writer_t *writer;
+	_c(file, line, "bijson_writer_alloc", bijson_writer_alloc(&writer));
+	_c(file, line, json, bijson_parse_json(writer, json, strlen(json), NULL));
+	_c(file, line, json, bijson_writer_write_to_malloc(writer, result));
+	bijson_writer_free(writer);
+}
+#define PARSE(json, result) _parse(__FILE__, __LINE__, (json), (result))
+
+// Checks that a value is output as exactly the given JSON text.
+inline static void _expect_json(const char *file, int line, const bijson_t *bijson, const char *expected) {
+	const void *buffer;
+	size_t size;
+	_c(file, line, expected, bijson_to_json_malloc(bijson, &buffer, &size));
+	if(size != strlen(expected) || memcmp(buffer, expected, size))
+		errx(EX_SOFTWARE, "%s:%d: expected %s, got %.*s", file, line, expected, (int)size, (const char *)buffer);
+	free(_bijson_no_const(buffer));
+}
+#define EXPECT_JSON(bijson, expected) _expect_json(__FILE__, __LINE__, (bijson), (expected))
+
+// Checks that JSON text survives a trip through bijson, possibly normalized.
+inline static void _roundtrip(const char *file, int line, const char *json, const char *expected) {
+	bijson_t bijson;
+	_parse(file, line, json, &bijson);
+	_expect_json(file, line, &bijson, expected);
+	bijson_free(&bijson);
+}
+#define ROUNDTRIP(json, expected) _roundtrip(__FILE__, __LINE__, (json), (expected))
@@ -0,0 +1,110 @@
+#include "common.h"
+
+// Items are strings of the given length, so that large arrays and objects
+// need wider offsets.
+static void write_container(bool object, size_t count, size_t item_size, bijson_t *result) {
+	char *item = malloc(item_size + SIZE_C(32));
+	if(!item)
+		err(EX_OSERR, "malloc");
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	C(object ? bijson_writer_begin_object(writer) : bijson_writer_begin_array(writer));
+	for(size_t u = 0; u < count; u++) {
+		size_t len = (size_t)sprintf(item, "%zu:", u);
+		memset(item + len, 'x', item_size);
+		if(object)
+			C(bijson_writer_add_key(writer, item, len));
+		C(bijson_writer_add_string(writer, item, len + item_size));
+	}
+	C(object ? bijson_writer_end_object(writer) : bijson_writer_end_array(writer));
+	C(bijson_writer_write_to_malloc(writer, result));
+	bijson_writer_free(writer);
+	free(item);
+}
+
+static void check_array(size_t count, size_t item_size) {
+	bijson_t bijson;
+	write_container(false, count, item_size, &bijson);
+
+	bijson_array_analysis_t analysis;
+	C(bijson_array_analyze(&bijson, &analysis));
+	bijson_array_cursor_t cursor, analyzed_cursor;
+	C(bijson_array_cursor_init(&cursor, &bijson));
+	C(bijson_analyzed_array_cursor_init(&analyzed_cursor, &analysis));
+	for(size_t u = 0; u < count; u++) {
+		bijson_t item, analyzed_item, expected;
+		C(bijson_array_cursor_next(&cursor, &item));
+		C(bijson_array_cursor_next(&analyzed_cursor, &analyzed_item));
+		C(bijson_analyzed_array_get_index(&analysis, u, &expected));
+		if(item.buffer != expected.buffer || item.size != expected.size
+		|| analyzed_item.buffer != expected.buffer || analyzed_item.size != expected.size)
+			errx(EX_SOFTWARE, "array cursor item %zu of %zu differs", u, count);
+	}
+	bijson_t item;
+	E(bijson_error_index_out_of_range, bijson_array_cursor_next(&cursor, &item));
+	E(bijson_error_index_out_of_range, bijson_array_cursor_next(&cursor, &item));
+	E(bijson_error_index_out_of_range, bijson_array_cursor_next(&analyzed_cursor, &item));
+
+	bijson_free(&bijson);
+}
+
+static void check_object(size_t count, size_t item_size) {
+	bijson_t bijson;
+	write_container(true, count, item_size, &bijson);
+
+	bijson_object_analysis_t analysis, analysis_nocheck;
+	C(bijson_object_analyze(&bijson, &analysis));
+	C(bijson_object_analyze_nocheck(&bijson, &analysis_nocheck));
+	bijson_object_cursor_t cursor, nocheck_cursor;
+	C(bijson_object_cursor_init(&cursor, &bijson));
+	C(bijson_analyzed_object_cursor_init(&nocheck_cursor, &analysis_nocheck));
+	for(size_t u = 0; u < count; u++) {
+		const void *key, *nocheck_key, *expected_key;
+		size_t len, nocheck_len, expected_len;
+		bijson_t value, nocheck_value, expected;
+		C(bijson_object_cursor_next(&cursor, &key, &len, &value));
+		C(bijson_object_cursor_next(&nocheck_cursor, &nocheck_key, &nocheck_len, &nocheck_value));
+		C(bijson_analyzed_object_get_index(&analysis, u, &expected_key, &expected_len, &expected));
+		if(key != expected_key || len != expected_len || nocheck_key != expected_key || nocheck_len != expected_len)
+			errx(EX_SOFTWARE, "object cursor key %zu of %zu differs", u, count);
+		if(value.buffer != expected.buffer || value.size != expected.size
+		|| nocheck_value.buffer != expected.buffer || nocheck_value.size != expected.size)
+			errx(EX_SOFTWARE, "object cursor value %zu of %zu differs", u, count);
+	}
+	const void *key;
+	size_t len;
+	bijson_t value;
+	E(bijson_error_index_out_of_range, bijson_object_cursor_next(&cursor, &key, &len, &value));
+	E(bijson_error_index_out_of_range, bijson_object_cursor_next(&nocheck_cursor, &key, &len, &value));
+
+	bijson_free(&bijson);
+}
+
+int main(void) {
+	fprintf(stderr, "checking cursors...\n");
+	fflush(stderr);
+
+	// Offsets of 1, 2 and 4 bytes
+	static const size_t sizes[][2] = {{0, 0}, {1, 0}, {2, 1}, {10, 5}, {300, 100}, {300, 300}};
+	for(size_t u = 0; u < _BIJSON_ARRAY_COUNT(sizes); u++) {
+		check_array(sizes[u][0], sizes[u][1]);
+		check_object(sizes[u][0], sizes[u][1]);
+	}
+
+	bijson_t bijson;
+	bijson_array_cursor_t array_cursor;
+	bijson_object_cursor_t object_cursor;
+	PARSE("{}", &bijson);
+	E(bijson_error_type_mismatch, bijson_array_cursor_init(&array_cursor, &bijson));
+	E(bijson_error_parameter_is_null, bijson_object_cursor_init(NULL, &bijson));
+	bijson_free(&bijson);
+	PARSE("[]", &bijson);
+	E(bijson_error_type_mismatch, bijson_object_cursor_init(&object_cursor, &bijson));
+	E(bijson_error_parameter_is_null, bijson_array_cursor_init(NULL, &bijson));
+	bijson_free(&bijson);
+
+	fprintf(stderr, "cursors OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
@@ -0,0 +1,47 @@
+#include "common.h"
+
+int main(void) {
+	fprintf(stderr, "checking decimal round trips...\n");
+	fflush(stderr);
+
+	// Significands that need 33-36, 49-52 and 57-60 bits were truncated
+	ROUNDTRIP("4294967296", "4294967296");
+	ROUNDTRIP("8589934592", "8589934592");
+	ROUNDTRIP("34359738368", "34359738368");
+	ROUNDTRIP("68719476735", "68719476735");
+	ROUNDTRIP("68719476736", "68719476736");
+	ROUNDTRIP("281474976710657", "281474976710657");
+	ROUNDTRIP("562949953421312", "562949953421312");
+	ROUNDTRIP("4503599627370495", "4503599627370495");
+	ROUNDTRIP("4503599627370496", "4503599627370496");
+	ROUNDTRIP("72057594037927939", "72057594037927939");
+	ROUNDTRIP("144115188075855872", "144115188075855872");
+	ROUNDTRIP("1152921504606846975", "1152921504606846975");
+	ROUNDTRIP("1152921504606846976", "1152921504606846976");
+	ROUNDTRIP("-34359738368", "-34359738368");
+	ROUNDTRIP("34359738368e-3", "34359738368e-3");
+	ROUNDTRIP("288230376151711744e5", "28823037615171174400000");
+
+	// Significands of 19 digits and more span several words
+	ROUNDTRIP("9999999999999999999", "9999999999999999999");
+	ROUNDTRIP("10000000000000000000", "1e19");
+	ROUNDTRIP("99999999999999999999", "99999999999999999999");
+	ROUNDTRIP("12345678901234567890123", "12345678901234567890123");
+	ROUNDTRIP("-12345678901234567890123", "-12345678901234567890123");
+	ROUNDTRIP("1.2345678901234567890123", "12345678901234567890123e-22");
+	ROUNDTRIP("0.12345678901234567890123", "12345678901234567890123e-23");
+	ROUNDTRIP("1234567890123456789.5", "12345678901234567895e-1");
+	ROUNDTRIP("12345678901234567890123e-30", "12345678901234567890123e-30");
+	ROUNDTRIP("12345678901234567890123e30", "12345678901234567890123e30");
+	ROUNDTRIP("10000000000000000000000000000000000000001", "10000000000000000000000000000000000000001");
+	ROUNDTRIP("123456789012345678901234567890123456789012", "123456789012345678901234567890123456789012");
+	ROUNDTRIP(
+		"98765432109876543210987654321098765432109876543210.123456789",
+		"98765432109876543210987654321098765432109876543210123456789e-9"
+	);
+
+	fprintf(stderr, "decimals OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
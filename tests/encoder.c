@@ -0,0 +1,180 @@
+#include "common.h"
+
+// Deeper than the initial stack of the encoder, so that it has to grow
+#define DEPTH SIZE_C(100)
+// Longer than the slices in which the encoder escapes strings
+#define STRING_SIZE SIZE_C(20000)
+
+// A string that needs escaping throughout, with multibyte UTF-8 sequences
+// of every length. The pieces don't add up to a multiple of the slice size,
+// so slices end in the middle of sequences.
+static size_t fill_string(char *string) {
+	static const char *pieces[] = {"\"", "\\", "\n", "\x01", "\x1F", "/", "\xC3\xA9", "\xE3\x81\x82", "\xF0\x9F\x98\x80", "plain text"};
+	size_t len = 0;
+	for(size_t u = 0;; u++) {
+		const char *piece = pieces[u % (sizeof pieces / sizeof *pieces)];
+		size_t piece_len = strlen(piece);
+		if(len + piece_len > STRING_SIZE)
+			return len;
+		memcpy(string + len, piece, piece_len);
+		len += piece_len;
+	}
+}
+
+static void write_document(bijson_writer_t *writer) {
+	static char string[STRING_SIZE];
+	size_t len = fill_string(string);
+
+	C(bijson_writer_begin_array(writer));
+	C(bijson_writer_add_string(writer, string, len));
+	for(size_t u = 0; u < DEPTH; u++) {
+		if(u % SIZE_C(2)) {
+			C(bijson_writer_begin_array(writer));
+			C(bijson_writer_add_decimal_from_string(writer, "-12.5e-7", 8));
+			C(bijson_writer_add_null(writer));
+		} else {
+			C(bijson_writer_begin_object(writer));
+			C(bijson_writer_add_key(writer, string, len));
+			C(bijson_writer_add_string(writer, "plain text", u % SIZE_C(11)));
+			C(bijson_writer_add_key(writer, "nested", 6));
+		}
+	}
+	C(bijson_writer_begin_object(writer));
+	C(bijson_writer_end_object(writer));
+	for(size_t u = DEPTH; u--;) {
+		if(u % SIZE_C(2)) {
+			C(bijson_writer_add_true(writer));
+			C(bijson_writer_end_array(writer));
+		} else {
+			C(bijson_writer_add_key(writer, "~", 1));
+			C(bijson_writer_add_decimal_from_string(writer, "123456789012345678901234567890", 30));
+			C(bijson_writer_end_object(writer));
+		}
+	}
+	C(bijson_writer_add_string(writer, string, len));
+	C(bijson_writer_add_false(writer));
+	C(bijson_writer_end_array(writer));
+}
+
+// Steps through the output with the given buffer size and compares it to
+// the expected JSON text.
+static void check_steps(const bijson_t *bijson, bool nocheck, size_t size, const char *expected, size_t expected_size) {
+	bijson_encoder_t *encoder;
+	if(nocheck)
+		C(bijson_encoder_new_nocheck(&encoder, bijson));
+	else
+		C(bijson_encoder_new(&encoder, bijson));
+
+	char *buffer = malloc(size);
+	if(!buffer)
+		err(EX_OSERR, "malloc");
+
+	size_t offset = 0;
+	for(bool pending = true; pending;) {
+		size_t len;
+		C(bijson_encoder_step(encoder, buffer, size, &len, &pending));
+		if(len > size || (pending && len < size))
+			errx(EX_SOFTWARE, "step of %zu bytes output %zu bytes (%s)", size, len, pending ? "pending" : "done");
+		if(len > expected_size - offset || memcmp(buffer, expected + offset, len))
+			errx(EX_SOFTWARE, "step of %zu bytes differs at offset %zu", size, offset);
+		offset += len;
+	}
+	if(offset != expected_size)
+		errx(EX_SOFTWARE, "steps of %zu bytes output %zu bytes instead of %zu", size, offset, expected_size);
+
+	// Done is done
+	size_t len;
+	bool pending;
+	C(bijson_encoder_step(encoder, buffer, size, &len, &pending));
+	if(len || pending)
+		errx(EX_SOFTWARE, "step of %zu bytes after the end output %zu bytes", size, len);
+
+	free(buffer);
+	bijson_encoder_free(encoder);
+}
+
+int main(void) {
+	fprintf(stderr, "checking encoder...\n");
+	fflush(stderr);
+
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	write_document(writer);
+	bijson_t document;
+	C(bijson_writer_write_to_malloc(writer, &document));
+	bijson_writer_free(writer);
+
+	const void *expected;
+	size_t expected_size;
+	C(bijson_to_json_malloc(&document, &expected, &expected_size));
+
+	static const size_t sizes[] = {1, 2, 3, 5, 7, 64, 4095, 4096, 4097, 65536, 1048576};
+	for(size_t u = 0; u < sizeof sizes / sizeof *sizes; u++) {
+		check_steps(&document, false, sizes[u], expected, expected_size);
+		check_steps(&document, true, sizes[u], expected, expected_size);
+	}
+	free(_bijson_no_const(expected));
+
+	// Small values
+	static const char *small[] = {"0", "\"\"", "[]", "{}", "[[[]]]", "{\"\":{\"\":null}}", "\"\\u0000\""};
+	for(size_t u = 0; u < sizeof small / sizeof *small; u++) {
+		bijson_t bijson;
+		PARSE(small[u], &bijson);
+		C(bijson_to_json_malloc(&bijson, &expected, &expected_size));
+		check_steps(&bijson, false, SIZE_C(1), expected, expected_size);
+		check_steps(&bijson, false, SIZE_C(4096), expected, expected_size);
+		free(_bijson_no_const(expected));
+		bijson_free(&bijson);
+	}
+
+	// Parameters
+	bijson_encoder_t *encoder;
+	char buffer[16];
+	size_t len;
+	bool pending;
+	E(bijson_error_parameter_is_null, bijson_encoder_new(NULL, &document));
+	C(bijson_encoder_new(&encoder, &document));
+	E(bijson_error_parameter_is_zero, bijson_encoder_step(encoder, buffer, 0, &len, &pending));
+	E(bijson_error_parameter_is_null, bijson_encoder_step(encoder, NULL, sizeof buffer, &len, &pending));
+	bijson_encoder_free(encoder);
+	bijson_encoder_free(NULL);
+	bijson_free(&document);
+
+	// Errors are sticky: damage the last string of a document, so that the
+	// first steps succeed and a later one fails, and every step after that
+	// fails the same way.
+	PARSE("[\"aaaaaaaaaaaaaaaa\",\"ab\"]", &document);
+	byte_t damaged_buffer[64];
+	if(document.size > sizeof damaged_buffer)
+		errx(EX_SOFTWARE, "unexpected document size");
+	memcpy(damaged_buffer, document.buffer, document.size);
+	const byte_t *found = memmem(damaged_buffer, document.size, "ab", 2);
+	if(!found)
+		errx(EX_SOFTWARE, "unexpected array layout");
+	damaged_buffer[_bijson_ptrdiff(found, damaged_buffer)] = BYTE_C(0xC0);
+	damaged_buffer[_bijson_ptrdiff(found, damaged_buffer) + SIZE_C(1)] = BYTE_C(0x80);
+	bijson_t damaged = {damaged_buffer, document.size};
+
+	// The same error as when outputting all at once
+	bijson_error_t expected_error = bijson_to_json_malloc(&damaged, &(const void *){NULL}, &(size_t){0});
+	E(bijson_error_invalid_utf8, expected_error);
+
+	C(bijson_encoder_new(&encoder, &damaged));
+	C(bijson_encoder_step(encoder, buffer, SIZE_C(4), &len, &pending));
+	if(len != SIZE_C(4) || !pending || memcmp(buffer, "[\"aa", 4))
+		errx(EX_SOFTWARE, "unexpected output before the damage");
+	bijson_error_t error = NULL;
+	for(size_t u = 0; u < SIZE_C(100) && !error; u++) {
+		error = bijson_encoder_step(encoder, buffer, SIZE_C(4), &len, &pending);
+		if(!error && !pending)
+			errx(EX_SOFTWARE, "damaged string was output");
+	}
+	E(expected_error, error);
+	for(size_t u = 0; u < SIZE_C(3); u++)
+		E(expected_error, bijson_encoder_step(encoder, buffer, sizeof buffer, &len, &pending));
+	bijson_encoder_free(encoder);
+	bijson_free(&document);
+
+	fprintf(stderr, "encoder OK.\n");
+	return 0;
+}
@@ -0,0 +1,186 @@
+#include "common.h"
+
+static void parse_with_threshold(const char *json, size_t threshold, bijson_t *result) {
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	bijson_writer_set_hashed_object_threshold(writer, threshold);
+	_c(__FILE__, __LINE__, json, bijson_parse_json(writer, json, strlen(json), NULL));
+	C(bijson_writer_write_to_malloc(writer, result));
+	bijson_writer_free(writer);
+}
+
+static void check_equal(const bijson_t *a, const bijson_t *b, bool expected, const char *what) {
+	bool equal;
+	C(bijson_equal(a, b, &equal));
+	if(equal != expected)
+		errx(EX_SOFTWARE, "%s: %s instead of %s", what, equal ? "equal" : "not equal", expected ? "equal" : "not equal");
+	C(bijson_equal(b, a, &equal));
+	if(equal != expected)
+		errx(EX_SOFTWARE, "%s: not symmetric", what);
+	uint64_t hash_a, hash_b;
+	C(bijson_content_hash(a, &hash_a));
+	C(bijson_content_hash(b, &hash_b));
+	if(expected && hash_a != hash_b)
+		errx(EX_SOFTWARE, "%s: equal values hash differently", what);
+	// Not guaranteed, but a collision among these few values would be a bug
+	if(!expected && hash_a == hash_b)
+		errx(EX_SOFTWARE, "%s: different values hash the same", what);
+}
+
+static void check_json(const char *a, const char *b, bool expected) {
+	bijson_t bijson_a, bijson_b;
+	PARSE(a, &bijson_a);
+	PARSE(b, &bijson_b);
+	char what[256];
+	snprintf(what, sizeof what, "%s vs %s", a, b);
+	check_equal(&bijson_a, &bijson_b, expected, what);
+	bijson_free(&bijson_a);
+	bijson_free(&bijson_b);
+}
+
+// Numbers encoded by hand, in ways the writer does not produce
+static void _check_bytes(int line, const byte_t *a, size_t a_size, const byte_t *b, size_t b_size, bool expected) {
+	bijson_t bijson_a = {a, a_size}, bijson_b = {b, b_size};
+	char what[64];
+	snprintf(what, sizeof what, "%s:%d", __FILE__, line);
+	check_equal(&bijson_a, &bijson_b, expected, what);
+}
+#define CHECK_BYTES(a, b, expected) _check_bytes(__LINE__, (a), sizeof (a), (b), sizeof (b), (expected))
+
+static void check_numbers(void) {
+	static const byte_t zero_binary[] = {0x18};
+	static const byte_t zero_decimal[] = {0x1A};
+	static const byte_t negative_zero_binary[] = {0x19};
+	static const byte_t negative_zero_decimal[] = {0x1B};
+	CHECK_BYTES(zero_binary, zero_decimal, true);
+	CHECK_BYTES(negative_zero_binary, negative_zero_decimal, true);
+	CHECK_BYTES(zero_binary, negative_zero_binary, false);
+
+	static const byte_t five_binary[] = {0x18, 0x05};
+	// Zero bytes at the most significant end
+	static const byte_t five_padded[] = {0x18, 0x05, 0x00, 0x00};
+	static const byte_t five_decimal[] = {0x1A, 0x04};
+	// 50000000000000000000e-19, with a zero low word
+	static const byte_t five_scaled[] = {0x28, 0x00, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04};
+	static const byte_t six_decimal[] = {0x1A, 0x05};
+	static const byte_t minus_five_binary[] = {0x19, 0x05};
+	static const byte_t minus_five_decimal[] = {0x1B, 0x04};
+	CHECK_BYTES(five_binary, five_padded, true);
+	CHECK_BYTES(five_binary, five_decimal, true);
+	CHECK_BYTES(five_binary, five_scaled, true);
+	CHECK_BYTES(five_padded, five_scaled, true);
+	CHECK_BYTES(five_decimal, five_scaled, true);
+	CHECK_BYTES(minus_five_binary, minus_five_decimal, true);
+	CHECK_BYTES(five_binary, six_decimal, false);
+	CHECK_BYTES(five_binary, minus_five_decimal, false);
+	CHECK_BYTES(minus_five_binary, five_decimal, false);
+
+	// 50 and 5e1
+	static const byte_t fifty_binary[] = {0x18, 0x32};
+	static const byte_t fifty_exponent[] = {0x20, 0x00, 0x00, 0x04};
+	CHECK_BYTES(fifty_binary, fifty_exponent, true);
+	CHECK_BYTES(five_decimal, fifty_exponent, false);
+
+	// 150e-2 and 15e-1
+	static const byte_t one_and_a_half_long[] = {0x28, 0x00, 0x01, 0x95};
+	static const byte_t one_and_a_half_short[] = {0x28, 0x00, 0x00, 0x0E};
+	CHECK_BYTES(one_and_a_half_long, one_and_a_half_short, true);
+
+	// 2^64, and 2^64 + 1
+	static const byte_t two_64_binary[] = {0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
+	static const byte_t two_64_decimal[] = {0x1A, 0x00, 0x00, 0x18, 0x76, 0xFB, 0xDC, 0x38, 0x75, 0x00};
+	static const byte_t two_64_plus_1_binary[] = {0x18, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
+	CHECK_BYTES(two_64_binary, two_64_decimal, true);
+	CHECK_BYTES(two_64_plus_1_binary, two_64_decimal, false);
+	CHECK_BYTES(two_64_plus_1_binary, two_64_binary, false);
+
+	// 10^40 and 1e40
+	static const byte_t ten_40_binary[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x61, 0xF5, 0xB9, 0xAB, 0xBF, 0xA4, 0x5C, 0xC3, 0xF1, 0x29, 0x63, 0x1D,
+	};
+	static const byte_t ten_40_exponent[] = {0x20, 0x00, 0x27, 0x00};
+	CHECK_BYTES(ten_40_binary, ten_40_exponent, true);
+	CHECK_BYTES(ten_40_binary, two_64_binary, false);
+
+	// Other types are never equal to numbers
+	static const byte_t five_string[] = {0x08, '5'};
+	CHECK_BYTES(five_binary, five_string, false);
+}
+
+// Objects with and without stored key hashes
+static void check_thresholds(const char *json) {
+	bijson_t plain, hashed;
+	parse_with_threshold(json, 0, &plain);
+	parse_with_threshold(json, 1, &hashed);
+	check_equal(&plain, &hashed, true, json);
+	bijson_free(&plain);
+	bijson_free(&hashed);
+}
+
+int main(void) {
+	fprintf(stderr, "checking equality...\n");
+	fflush(stderr);
+
+	check_json("null", "null", true);
+	check_json("\"abc\"", "\"abc\"", true);
+	check_json("1.50", "15e-1", true);
+	check_json("{\"a\":1,\"b\":[2,3]}", "{\"b\":[2,3],\"a\":1}", true);
+	check_json("[[],{},[[{}]]]", "[[],{},[[{}]]]", true);
+
+	check_json("null", "false", false);
+	check_json("0", "-0", false);
+	check_json("1", "\"1\"", false);
+	check_json("[1,2]", "[2,1]", false);
+	check_json("[1,2]", "[1,2,3]", false);
+	check_json("[]", "{}", false);
+	check_json("[[]]", "[{}]", false);
+	check_json("{\"a\":1}", "{\"a\":2}", false);
+	check_json("{\"a\":1}", "{\"b\":1}", false);
+	check_json("{\"a\":1}", "[\"a\",1]", false);
+	check_json("[[1],2]", "[1,[2]]", false);
+	check_json("[[1,2]]", "[[1],[2]]", false);
+
+	check_numbers();
+
+	check_thresholds("{}");
+	check_thresholds("{\"a\":1}");
+	check_thresholds("{\"a\":{\"b\":{\"c\":[{\"d\":1,\"e\":2}]}},\"f\":[{}],\"g\":\"\"}");
+	check_thresholds("[{\"x\":1,\"x\":1},{\"y\":[1,2,3]},[{\"z\":null}]]");
+
+	// A large object, nested in one that has a hash index either way
+	size_t size = SIZE_C(3000) * SIZE_C(32) + SIZE_C(64);
+	char *json = malloc(size);
+	if(!json)
+		err(EX_OSERR, "malloc");
+	size_t len = (size_t)sprintf(json, "{\"outer\":{");
+	for(size_t u = 0; u < SIZE_C(3000); u++)
+		len += (size_t)sprintf(json + len, "%s\"key%zu\":[%zu]", u ? "," : "", u, u);
+	strcpy(json + len, "}}");
+	bijson_t plain, hashed, other;
+	parse_with_threshold(json, 0, &plain);
+	parse_with_threshold(json, 4, &hashed);
+	check_equal(&plain, &hashed, true, "3000 keys");
+	json[len - SIZE_C(2)] = '0';
+	parse_with_threshold(json, 4, &other);
+	check_equal(&plain, &other, false, "3000 keys, one changed");
+	check_equal(&hashed, &other, false, "3000 hashed keys, one changed");
+	bijson_free(&plain);
+	bijson_free(&hashed);
+	bijson_free(&other);
+	free(json);
+
+	bijson_t bijson;
+	bool equal;
+	uint64_t hash;
+	PARSE("[]", &bijson);
+	E(bijson_error_parameter_is_null, bijson_equal(&bijson, &bijson, NULL));
+	E(bijson_error_parameter_is_null, bijson_content_hash(&bijson, NULL));
+	C(bijson_equal(&bijson, &bijson, &equal));
+	C(bijson_content_hash(&bijson, &hash));
+	bijson_free(&bijson);
+
+	fprintf(stderr, "equality OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
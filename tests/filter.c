@@ -0,0 +1,110 @@
+#include "common.h"
+
+#define KEYS 10000U
+#define ABSENT 100000U
+
+static void check(size_t threshold) {
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	bijson_writer_set_hashed_object_threshold(writer, threshold);
+	C(bijson_writer_begin_object(writer));
+	for(unsigned int u = 0; u < KEYS; u++) {
+		char key[16];
+		size_t len = (size_t)sprintf(key, "present%u", u);
+		C(bijson_writer_add_key(writer, key, len));
+		C(bijson_writer_add_decimal_from_string(writer, key + 7, len - SIZE_C(7)));
+	}
+	C(bijson_writer_end_object(writer));
+	bijson_t bijson;
+	C(bijson_writer_write_to_malloc(writer, &bijson));
+	bijson_writer_free(writer);
+
+	bijson_object_analysis_t analysis;
+	C(bijson_object_analyze(&bijson, &analysis));
+	bijson_object_filter_t *filter, *analyzed_filter;
+	C(bijson_object_filter_build(&filter, &bijson));
+	C(bijson_analyzed_object_filter_build(&analyzed_filter, &analysis));
+
+	// No false negatives
+	for(unsigned int u = 0; u < KEYS; u++) {
+		char name[16];
+		bijson_key_t key;
+		C(bijson_key_prepare(&key, name, (size_t)sprintf(name, "present%u", u)));
+		bool maybe, analyzed_maybe;
+		C(bijson_object_filter_check(filter, &key, &maybe));
+		C(bijson_object_filter_check(analyzed_filter, &key, &analyzed_maybe));
+		if(!maybe || !analyzed_maybe)
+			errx(EX_SOFTWARE, "filter rejects %s", name);
+		bijson_t value, expected;
+		C(bijson_analyzed_object_get_filtered_key(&analysis, filter, &key, &value));
+		C(bijson_analyzed_object_get_prepared_key(&analysis, &key, &expected));
+		if(value.buffer != expected.buffer || value.size != expected.size)
+			errx(EX_SOFTWARE, "filtered lookup of %s differs", name);
+	}
+
+	// Few false positives, and absent keys are never found
+	size_t false_positives = 0;
+	for(unsigned int u = 0; u < ABSENT; u++) {
+		char name[16];
+		bijson_key_t key;
+		C(bijson_key_prepare(&key, name, (size_t)sprintf(name, "absent%u", u)));
+		bool maybe;
+		C(bijson_object_filter_check(filter, &key, &maybe));
+		if(maybe)
+			false_positives++;
+		bijson_t value;
+		E(bijson_error_key_not_found, bijson_analyzed_object_get_filtered_key(&analysis, filter, &key, &value));
+	}
+	if(false_positives > ABSENT / 100U)
+		errx(EX_SOFTWARE, "%zu false positives out of %u", false_positives, ABSENT);
+
+	bijson_object_filter_free(filter);
+	bijson_object_filter_free(analyzed_filter);
+	bijson_free(&bijson);
+}
+
+int main(void) {
+	fprintf(stderr, "checking object filters...\n");
+	fflush(stderr);
+
+	check(0);
+	check(1);
+
+	// Nothing passes the filter of an empty object
+	bijson_t bijson;
+	PARSE("{}", &bijson);
+	bijson_object_filter_t *filter;
+	C(bijson_object_filter_build(&filter, &bijson));
+	bijson_key_t key;
+	C(bijson_key_prepare(&key, "", 0));
+	bool maybe;
+	C(bijson_object_filter_check(filter, &key, &maybe));
+	if(maybe)
+		errx(EX_SOFTWARE, "empty filter accepts a key");
+
+	bijson_object_analysis_t analysis;
+	C(bijson_object_analyze(&bijson, &analysis));
+	bijson_t value;
+	E(bijson_error_parameter_is_null, bijson_object_filter_check(NULL, &key, &maybe));
+	E(bijson_error_parameter_is_null, bijson_object_filter_check(filter, NULL, &maybe));
+	E(bijson_error_parameter_is_null, bijson_object_filter_check(filter, &key, NULL));
+	E(bijson_error_parameter_is_null, bijson_analyzed_object_get_filtered_key(NULL, filter, &key, &value));
+	E(bijson_error_parameter_is_null, bijson_analyzed_object_get_filtered_key(&analysis, NULL, &key, &value));
+	E(bijson_error_parameter_is_null, bijson_analyzed_object_get_filtered_key(&analysis, filter, NULL, &value));
+	E(bijson_error_parameter_is_null, bijson_analyzed_object_get_filtered_key(&analysis, filter, &key, NULL));
+	E(bijson_error_key_not_found, bijson_analyzed_object_get_filtered_key(&analysis, filter, &key, &value));
+	bijson_object_filter_free(filter);
+	E(bijson_error_parameter_is_null, bijson_object_filter_build(NULL, &bijson));
+	E(bijson_error_parameter_is_null, bijson_analyzed_object_filter_build(&filter, NULL));
+	bijson_free(&bijson);
+
+	PARSE("[]", &bijson);
+	E(bijson_error_type_mismatch, bijson_object_filter_build(&filter, &bijson));
+	bijson_free(&bijson);
+	bijson_object_filter_free(NULL);
+
+	fprintf(stderr, "object filters OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
@@ -0,0 +1,137 @@
+#include "common.h"
+
+#define THRESHOLD SIZE_C(4)
+
+// Writes an object with count distinct keys plus three copies of "dup".
+static void write_object(size_t threshold, size_t count, bijson_t *result) {
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	bijson_writer_set_hashed_object_threshold(writer, threshold);
+	C(bijson_writer_begin_array(writer));
+	C(bijson_writer_begin_object(writer));
+	for(size_t u = 0; u < count; u++) {
+		char key[32];
+		size_t len = (size_t)sprintf(key, u % 3 ? "key%zu" : "\xc3\xa9l\xc3\xa9ment %zu", u);
+		C(bijson_writer_add_key(writer, key, len));
+		C(bijson_writer_add_decimal_from_string(writer, key + len - SIZE_C(1), SIZE_C(1)));
+	}
+	for(size_t u = 0; u < SIZE_C(3); u++) {
+		C(bijson_writer_add_key(writer, "dup", 3));
+		C(bijson_writer_add_string(writer, "dup", 3));
+	}
+	C(bijson_writer_end_object(writer));
+	C(bijson_writer_end_array(writer));
+	C(bijson_writer_write_to_malloc(writer, result));
+	bijson_writer_free(writer);
+}
+
+static void same_value(const bijson_t *a, const bijson_t *b, const char *what) {
+	const void *a_json, *b_json;
+	size_t a_size, b_size;
+	C(bijson_to_json_malloc(a, &a_json, &a_size));
+	C(bijson_to_json_malloc(b, &b_json, &b_size));
+	if(a_size != b_size || memcmp(a_json, b_json, a_size))
+		errx(EX_SOFTWARE, "%s: %.*s != %.*s", what, (int)a_size, (const char *)a_json, (int)b_size, (const char *)b_json);
+	free(_bijson_no_const(a_json));
+	free(_bijson_no_const(b_json));
+}
+
+static void check(size_t count) {
+	bijson_t plain_document, hashed_document, plain, hashed;
+	write_object(0, count, &plain_document);
+	write_object(THRESHOLD, count, &hashed_document);
+	C(bijson_verify(&plain_document));
+	C(bijson_verify(&hashed_document));
+	same_value(&plain_document, &hashed_document, "document");
+
+	C(bijson_array_get_index(&plain_document, 0, &plain));
+	C(bijson_array_get_index(&hashed_document, 0, &hashed));
+	byte_t type = *(const byte_t *)hashed.buffer;
+	if((type & BYTE_C(0xC0)) != (count + SIZE_C(3) >= THRESHOLD ? BYTE_C(0x80) : BYTE_C(0x40)))
+		errx(EX_SOFTWARE, "object with %zu keys has type 0x%02X", count + SIZE_C(3), (unsigned int)type);
+
+	bijson_object_analysis_t plain_analysis, hashed_analysis;
+	C(bijson_object_analyze(&plain, &plain_analysis));
+	C(bijson_object_analyze(&hashed, &hashed_analysis));
+	size_t plain_count, hashed_count;
+	C(bijson_analyzed_object_count(&plain_analysis, &plain_count));
+	C(bijson_analyzed_object_count(&hashed_analysis, &hashed_count));
+	if(plain_count != hashed_count)
+		errx(EX_SOFTWARE, "count %zu != %zu", plain_count, hashed_count);
+
+	bijson_object_cursor_t plain_cursor, hashed_cursor;
+	C(bijson_analyzed_object_cursor_init(&plain_cursor, &plain_analysis));
+	C(bijson_analyzed_object_cursor_init(&hashed_cursor, &hashed_analysis));
+	for(size_t u = 0; u < plain_count; u++) {
+		const void *plain_key, *hashed_key;
+		size_t plain_len, hashed_len;
+		bijson_t plain_value, hashed_value, found;
+		C(bijson_object_cursor_next(&plain_cursor, &plain_key, &plain_len, &plain_value));
+		C(bijson_object_cursor_next(&hashed_cursor, &hashed_key, &hashed_len, &hashed_value));
+		if(plain_len != hashed_len || memcmp(plain_key, hashed_key, plain_len))
+			errx(EX_SOFTWARE, "key %zu differs", u);
+		same_value(&plain_value, &hashed_value, "cursor value");
+
+		C(bijson_analyzed_object_get_key(&hashed_analysis, hashed_key, hashed_len, &found));
+		same_value(&plain_value, &found, "lookup");
+		bijson_key_t key;
+		C(bijson_key_prepare(&key, hashed_key, hashed_len));
+		C(bijson_analyzed_object_get_prepared_key(&hashed_analysis, &key, &found));
+		same_value(&plain_value, &found, "prepared lookup");
+
+		size_t plain_start, plain_end, hashed_start, hashed_end;
+		C(bijson_analyzed_object_get_key_range(&plain_analysis, plain_key, plain_len, &plain_start, &plain_end));
+		C(bijson_analyzed_object_get_key_range(&hashed_analysis, hashed_key, hashed_len, &hashed_start, &hashed_end));
+		if(plain_start != hashed_start || plain_end != hashed_end || hashed_start > u || hashed_end <= u)
+			errx(EX_SOFTWARE, "range of key %zu differs", u);
+	}
+	bijson_t value;
+	const void *key;
+	size_t len;
+	E(bijson_error_index_out_of_range, bijson_object_cursor_next(&hashed_cursor, &key, &len, &value));
+
+	size_t start, end;
+	C(bijson_analyzed_object_get_key_range(&hashed_analysis, "dup", 3, &start, &end));
+	if(end - start != SIZE_C(3))
+		errx(EX_SOFTWARE, "found %zu copies of dup", end - start);
+	E(bijson_error_key_not_found, bijson_analyzed_object_get_key(&hashed_analysis, "missing", 7, &value));
+	E(bijson_error_key_not_found, bijson_analyzed_object_get_key(&hashed_analysis, "key", 3, &value));
+
+	bijson_free(&plain_document);
+	bijson_free(&hashed_document);
+}
+
+int main(void) {
+	fprintf(stderr, "checking hashed objects...\n");
+	fflush(stderr);
+
+	// The threshold counts the dup keys too
+	for(size_t count = 0; count < SIZE_C(20); count++)
+		check(count);
+	check(SIZE_C(255));
+	check(SIZE_C(256));
+	check(SIZE_C(3000));
+
+	// Nested objects, written through the parser
+	const char json[] = "{\"a\":{\"b\":1,\"c\":2,\"d\":3,\"e\":{\"x\":[{},{\"y\":null,\"z\":true,\"w\":false,\"v\":\"\"}]}},\"f\":[],\"g\":0,\"h\":\"\"}";
+	bijson_t plain, hashed;
+	PARSE(json, &plain);
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	bijson_writer_set_hashed_object_threshold(writer, THRESHOLD);
+	C(bijson_parse_json(writer, json, sizeof json - SIZE_C(1), NULL));
+	C(bijson_writer_write_to_malloc(writer, &hashed));
+	bijson_writer_free(writer);
+	C(bijson_verify(&hashed));
+	same_value(&plain, &hashed, "nested");
+	bijson_free(&plain);
+	bijson_free(&hashed);
+
+	// Ignored without a writer
+	bijson_writer_set_hashed_object_threshold(NULL, THRESHOLD);
+
+	fprintf(stderr, "hashed objects OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
@@ -0,0 +1,196 @@
+#include <unistd.h>
+
+#include "common.h"
+
+#define ITEMS SIZE_C(5000)
+#define NAMES SIZE_C(50)
+
+// Every seventh item is not an object and every eleventh lacks a name.
+static void write_items(size_t count, bijson_t *result) {
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	C(bijson_writer_begin_array(writer));
+	for(size_t u = 0; u < count; u++) {
+		char text[32];
+		if(u % SIZE_C(7) == SIZE_C(6)) {
+			C(bijson_writer_add_string(writer, "n1", 2));
+			continue;
+		}
+		C(bijson_writer_begin_object(writer));
+		C(bijson_writer_add_key(writer, "id", 2));
+		C(bijson_writer_add_decimal_from_string(writer, text, (size_t)sprintf(text, "%zu", u)));
+		if(u % SIZE_C(11)) {
+			C(bijson_writer_add_key(writer, "name", 4));
+			C(bijson_writer_add_string(writer, text, (size_t)sprintf(text, "n%zu", u % NAMES)));
+		}
+		C(bijson_writer_end_object(writer));
+	}
+	C(bijson_writer_end_array(writer));
+	C(bijson_writer_write_to_malloc(writer, result));
+	bijson_writer_free(writer);
+}
+
+typedef struct matches {
+	const bijson_t *bijson;
+	bool seen[ITEMS];
+	size_t count;
+} matches_t;
+
+static bijson_error_t collect(void *callback_data, size_t index, const bijson_t *item) {
+	matches_t *matches = callback_data;
+	bijson_t expected;
+	C(bijson_array_get_index(matches->bijson, index, &expected));
+	if(item->buffer != expected.buffer || item->size != expected.size)
+		errx(EX_SOFTWARE, "item %zu does not match its index", index);
+	if(matches->seen[index])
+		errx(EX_SOFTWARE, "item %zu reported twice", index);
+	matches->seen[index] = true;
+	matches->count++;
+	return NULL;
+}
+
+static void check_name(const bijson_t *bijson, const bijson_index_t *index, size_t name) {
+	char text[32];
+	static matches_t matches;
+	memset(&matches, 0, sizeof matches);
+	matches.bijson = bijson;
+	C(bijson_index_lookup_string(index, text, (size_t)sprintf(text, "n%zu", name), collect, &matches));
+	for(size_t u = 0; u < ITEMS; u++) {
+		bool expected = u % SIZE_C(7) != SIZE_C(6) && u % SIZE_C(11) && u % NAMES == name;
+		if(matches.seen[u] != expected)
+			errx(EX_SOFTWARE, "lookup of %s: item %zu %s", text, u, expected ? "missing" : "unexpected");
+	}
+}
+
+static void check_id(const bijson_t *bijson, const bijson_index_t *index, const char *id, size_t expected) {
+	bijson_t value;
+	PARSE(id, &value);
+	static matches_t matches;
+	memset(&matches, 0, sizeof matches);
+	matches.bijson = bijson;
+	C(bijson_index_lookup(index, &value, collect, &matches));
+	if(expected == ITEMS ? matches.count != SIZE_C(0) : (matches.count != SIZE_C(1) || !matches.seen[expected]))
+		errx(EX_SOFTWARE, "lookup of id %s: %zu matches", id, matches.count);
+	bijson_free(&value);
+}
+
+// Runs bin/bijson and returns its output.
+static char *run(const char *command) {
+	FILE *fh = popen(command, "r");
+	if(!fh)
+		err(EX_OSERR, "popen(%s)", command);
+	static char output[4096];
+	size_t len = fread(output, 1, sizeof output - SIZE_C(1), fh);
+	output[len] = '\0';
+	if(pclose(fh))
+		errx(EX_SOFTWARE, "%s failed", command);
+	return output;
+}
+
+int main(void) {
+	fprintf(stderr, "checking indexes...\n");
+	fflush(stderr);
+
+	const char *tmpdir = getenv("TMPDIR");
+	char filename[4096];
+	snprintf(filename, sizeof filename, "%s/bijson-test-XXXXXX", tmpdir ? tmpdir : "/tmp");
+	int fd = mkstemp(filename);
+	if(fd == -1)
+		err(EX_OSERR, "mkstemp(%s)", filename);
+	close(fd);
+
+	bijson_t bijson;
+	write_items(ITEMS, &bijson);
+
+	// String values
+	C(bijson_index_build(&bijson, "/name", 5, filename));
+	bijson_index_t *index;
+	C(bijson_index_open(&index, &bijson, filename));
+	for(size_t name = 0; name < NAMES; name++)
+		check_name(&bijson, index, name);
+	// Not present (items that are strings themselves are not indexed)
+	static matches_t matches;
+	matches.bijson = &bijson;
+	C(bijson_index_lookup_string(index, "n50", 3, collect, &matches));
+	C(bijson_index_lookup_string(index, "", 0, collect, &matches));
+	if(matches.count)
+		errx(EX_SOFTWARE, "missing values found");
+	bijson_index_close(index);
+
+	// Numeric values
+	C(bijson_index_build(&bijson, "/id", 3, filename));
+	C(bijson_index_open(&index, &bijson, filename));
+	check_id(&bijson, index, "0", 0);
+	check_id(&bijson, index, "1234", 1234);
+	check_id(&bijson, index, "4999", 4999);
+	check_id(&bijson, index, "6", ITEMS);
+	check_id(&bijson, index, "5000", ITEMS);
+	check_id(&bijson, index, "\"1234\"", ITEMS);
+	E(bijson_error_parameter_is_null, bijson_index_lookup(index, &bijson, NULL, NULL));
+	bijson_index_close(index);
+	bijson_index_close(NULL);
+
+	// Another document
+	bijson_t other;
+	write_items(ITEMS - SIZE_C(1), &other);
+	E(bijson_error_index_mismatch, bijson_index_open(&index, &other, filename));
+	bijson_free(&other);
+
+	// The same document, changed without changing its size
+	write_items(ITEMS, &other);
+	bijson_t item, id;
+	C(bijson_array_get_index(&other, SIZE_C(1234), &item));
+	C(bijson_object_get_key(&item, "id", 2, &id));
+	byte_t *last = (byte_t *)_bijson_no_const(id.buffer) + id.size - SIZE_C(1);
+	(*last)++;
+	E(bijson_error_index_mismatch, bijson_index_open(&index, &other, filename));
+	(*last)--;
+	C(bijson_index_open(&index, &other, filename));
+	bijson_index_close(index);
+	bijson_free(&other);
+
+	// The command line tool, if it was built next to the tests
+	if(!access("bin/bijson", X_OK)) {
+		char json[4096];
+		snprintf(json, sizeof json, "%s.json", filename);
+		char document[4096];
+		snprintf(document, sizeof document, "%s.bijson", filename);
+		FILE *fh = fopen(json, "w");
+		if(!fh)
+			err(EX_OSERR, "fopen(%s)", json);
+		fputs("[[\"a\",1],[\"b\",2],[\"a\",3],[4],5]", fh);
+		if(fclose(fh))
+			err(EX_OSERR, "fclose(%s)", json);
+
+		char command[16384];
+		snprintf(command, sizeof command, "./bin/bijson load-json '%s' '%s'", json, document);
+		run(command);
+		snprintf(command, sizeof command, "./bin/bijson index '%s' /0 '%s'", document, filename);
+		run(command);
+		snprintf(command, sizeof command, "./bin/bijson lookup '%s' '%s' '\"a\"'", document, filename);
+		const char *output = run(command);
+		if(strcmp(output, "[\"a\",1]\n[\"a\",3]\n"))
+			errx(EX_SOFTWARE, "bijson lookup printed %s", output);
+		snprintf(command, sizeof command, "./bin/bijson lookup '%s' '%s' '\"c\"'", document, filename);
+		output = run(command);
+		if(*output)
+			errx(EX_SOFTWARE, "bijson lookup printed %s", output);
+		snprintf(command, sizeof command, "./bin/bijson index '%s' /1 '%s'", document, filename);
+		run(command);
+		snprintf(command, sizeof command, "./bin/bijson lookup '%s' '%s' 2", document, filename);
+		output = run(command);
+		if(strcmp(output, "[\"b\",2]\n"))
+			errx(EX_SOFTWARE, "bijson lookup printed %s", output);
+
+		unlink(json);
+		unlink(document);
+	}
+
+	unlink(filename);
+	bijson_free(&bijson);
+
+	fprintf(stderr, "indexes OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
@@ -0,0 +1,137 @@
+#include "common.h"
+
+#define KEYS 200
+#define REQUESTS 150
+
+// Compares the plain and prepared key range lookups on an object with
+// repeated keys, with and without stored key hashes.
+static void check_ranges(size_t a, size_t b, size_t c, size_t threshold) {
+	static const char *const names[] = {"foo", "bar", "baz", "qux"};
+	size_t counts[] = {a, b, c, 0};
+
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	bijson_writer_set_hashed_object_threshold(writer, threshold);
+	C(bijson_writer_begin_object(writer));
+	for(size_t n = 0; n < _BIJSON_ARRAY_COUNT(names); n++) {
+		for(size_t u = 0; u < counts[n]; u++) {
+			C(bijson_writer_add_key(writer, names[n], 3));
+			C(bijson_writer_add_null(writer));
+		}
+	}
+	C(bijson_writer_end_object(writer));
+	bijson_t bijson;
+	C(bijson_writer_write_to_malloc(writer, &bijson));
+	bijson_writer_free(writer);
+
+	bijson_object_analysis_t analysis;
+	C(bijson_object_analyze(&bijson, &analysis));
+	for(size_t n = 0; n < _BIJSON_ARRAY_COUNT(names); n++) {
+		bijson_key_t key;
+		C(bijson_key_prepare(&key, names[n], 3));
+		size_t start = 0, end = 0, prepared_start = 0, prepared_end = 0;
+		bijson_error_t error = bijson_analyzed_object_get_key_range(&analysis, names[n], 3, &start, &end);
+		E(error, bijson_analyzed_object_get_prepared_key_range(&analysis, &key, &prepared_start, &prepared_end));
+		E(error, bijson_object_get_prepared_key_range(&bijson, &key, &prepared_start, &prepared_end));
+		if(!counts[n]) {
+			E(bijson_error_key_not_found, error);
+			continue;
+		}
+		C(error);
+		if(end - start != counts[n])
+			errx(EX_SOFTWARE, "%zu/%zu/%zu: %s count is %zu", a, b, c, names[n], end - start);
+		if(prepared_start != start || prepared_end != end)
+			errx(EX_SOFTWARE, "%zu/%zu/%zu: prepared %s range [%zu, %zu) instead of [%zu, %zu)",
+				a, b, c, names[n], prepared_start, prepared_end, start, end);
+		for(size_t u = start; u < end; u++) {
+			const void *found;
+			size_t len;
+			bijson_t value;
+			C(bijson_object_get_index(&bijson, u, &found, &len, &value));
+			if(len != SIZE_C(3) || memcmp(found, names[n], len))
+				errx(EX_SOFTWARE, "%zu/%zu/%zu: %s range includes another key", a, b, c, names[n]);
+		}
+	}
+	bijson_free(&bijson);
+}
+
+int main(void) {
+	fprintf(stderr, "checking multi-key lookups...\n");
+	fflush(stderr);
+
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	C(bijson_writer_begin_object(writer));
+	for(unsigned int u = 0; u < KEYS; u++) {
+		char key[16];
+		size_t len = (size_t)sprintf(key, "k%u", u);
+		C(bijson_writer_add_key(writer, key, len));
+		C(bijson_writer_add_decimal_from_string(writer, key + 1, len - SIZE_C(1)));
+	}
+	C(bijson_writer_end_object(writer));
+	bijson_t bijson;
+	C(bijson_writer_write_to_malloc(writer, &bijson));
+	bijson_writer_free(writer);
+
+	// A mix of present and missing keys, with duplicates, in an order that
+	// has nothing to do with the order in the object. There are more of
+	// them than fit in the lookup's stack buffer.
+	static char names[REQUESTS][16];
+	static bijson_key_t keys[REQUESTS];
+	static bijson_t results[REQUESTS];
+	size_t present = 0;
+	for(unsigned int u = 0; u < REQUESTS; u++) {
+		unsigned int n = u * 7U % 300U;
+		if(u % 10U == 9U)
+			n = (u - 5U) * 7U % 300U;
+		if(n < KEYS)
+			present++;
+		size_t len = (size_t)sprintf(names[u], "k%u", n);
+		C(bijson_key_prepare(&keys[u], names[u], len));
+	}
+
+	bijson_object_analysis_t analysis;
+	C(bijson_object_analyze(&bijson, &analysis));
+	for(size_t count = 0; count <= REQUESTS; count += count < 20 ? 1 : 13) {
+		C(bijson_analyzed_object_get_keys(&analysis, keys, count, results));
+		for(size_t u = 0; u < count; u++) {
+			bijson_t expected = bijson_0;
+			bijson_error_t error = bijson_analyzed_object_get_key(&analysis, keys[u].key, keys[u].len, &expected);
+			if(error != bijson_error_key_not_found)
+				C(error);
+			if(results[u].buffer != expected.buffer || results[u].size != expected.size)
+				errx(EX_SOFTWARE, "batch lookup of %s differs (batch of %zu)", names[u], count);
+		}
+	}
+
+	C(bijson_object_get_keys(&bijson, keys, REQUESTS, results));
+	size_t found = 0;
+	for(size_t u = 0; u < REQUESTS; u++)
+		if(results[u].buffer)
+			found++;
+	if(found != present)
+		errx(EX_SOFTWARE, "found %zu keys instead of %zu", found, present);
+
+	C(bijson_analyzed_object_get_keys(&analysis, NULL, 0, NULL));
+	E(bijson_error_parameter_is_null, bijson_analyzed_object_get_keys(&analysis, keys, 1, NULL));
+	bijson_free(&bijson);
+
+	// Nothing is found in an empty object
+	PARSE("{}", &bijson);
+	results[0].buffer = &bijson;
+	C(bijson_object_get_keys(&bijson, keys, 2, results));
+	if(results[0].buffer || results[1].buffer)
+		errx(EX_SOFTWARE, "found a key in an empty object");
+	bijson_free(&bijson);
+
+	for(size_t a = SIZE_C(1); a < SIZE_C(10); a += SIZE_C(2))
+		for(size_t b = SIZE_C(1); b < SIZE_C(10); b += SIZE_C(3))
+			for(size_t c = SIZE_C(1); c < SIZE_C(10); c++)
+				for(size_t threshold = 0; threshold < SIZE_C(2); threshold++)
+					check_ranges(a, b, c, threshold);
+
+	fprintf(stderr, "multi-key lookups OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
@@ -0,0 +1,159 @@
+#include <unistd.h>
+
+#include "common.h"
+
+// Collects output in a growing buffer.
+typedef struct output {
+	char *buffer;
+	size_t size;
+	size_t capacity;
+} output_t;
+
+static bijson_error_t collect(void *callback_data, const void *data, size_t len) {
+	output_t *output = callback_data;
+	if(output->size + len > output->capacity) {
+		size_t capacity = output->capacity ? output->capacity : SIZE_C(65536);
+		while(capacity < output->size + len)
+			capacity *= SIZE_C(2);
+		char *buffer = realloc(output->buffer, capacity);
+		if(!buffer)
+			err(EX_OSERR, "realloc");
+		output->buffer = buffer;
+		output->capacity = capacity;
+	}
+	memcpy(output->buffer + output->size, data, len);
+	output->size += len;
+	return NULL;
+}
+
+static void add_items(bijson_writer_t *writer, size_t count, size_t seed) {
+	C(bijson_writer_begin_array(writer));
+	for(size_t u = 0; u < count; u++) {
+		char text[64];
+		C(bijson_writer_begin_object(writer));
+		C(bijson_writer_add_key(writer, "id", 2));
+		C(bijson_writer_add_decimal_from_string(writer, text, (size_t)sprintf(text, "%zu.%zu", seed, u)));
+		C(bijson_writer_add_key(writer, "name", 4));
+		C(bijson_writer_add_string(writer, text, (size_t)sprintf(text, "item \"%zu\"\n\t\xc3\xa9", u)));
+		C(bijson_writer_add_key(writer, "tags", 4));
+		C(bijson_writer_begin_array(writer));
+		for(size_t v = 0; v < u % SIZE_C(4); v++)
+			C(bijson_writer_add_string(writer, text, (size_t)sprintf(text, "t%zu", v)));
+		C(bijson_writer_end_array(writer));
+		if(u % SIZE_C(5) == SIZE_C(0)) {
+			C(bijson_writer_add_key(writer, "flag", 4));
+			if(u % SIZE_C(2))
+				C(bijson_writer_add_true(writer));
+			else
+				C(bijson_writer_add_false(writer));
+		}
+		C(bijson_writer_end_object(writer));
+	}
+	C(bijson_writer_end_array(writer));
+}
+
+// An object with several entries that are larger than a block, one of which
+// contains such entries itself, around small entries.
+static void write_document(bijson_t *result) {
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	C(bijson_writer_begin_object(writer));
+	C(bijson_writer_add_key(writer, "small", 5));
+	C(bijson_writer_add_null(writer));
+	C(bijson_writer_add_key(writer, "items", 5));
+	add_items(writer, SIZE_C(40000), SIZE_C(1));
+	C(bijson_writer_add_key(writer, "nested", 6));
+	C(bijson_writer_begin_array(writer));
+	C(bijson_writer_add_string(writer, "before", 6));
+	add_items(writer, SIZE_C(30000), SIZE_C(2));
+	for(size_t u = 0; u < SIZE_C(1000); u++)
+		C(bijson_writer_add_decimal_from_string(writer, "-1.5e-7", 7));
+	C(bijson_writer_begin_object(writer));
+	for(size_t u = 0; u < SIZE_C(60000); u++) {
+		char key[32];
+		C(bijson_writer_add_key(writer, key, (size_t)sprintf(key, "key%zu", u)));
+		C(bijson_writer_add_string(writer, key, (size_t)sprintf(key, "value\\%zu", u)));
+	}
+	C(bijson_writer_end_object(writer));
+	C(bijson_writer_add_string(writer, "after", 5));
+	C(bijson_writer_end_array(writer));
+	C(bijson_writer_add_key(writer, "empty", 5));
+	C(bijson_writer_begin_array(writer));
+	C(bijson_writer_end_array(writer));
+	C(bijson_writer_end_object(writer));
+	C(bijson_writer_write_to_malloc(writer, result));
+	bijson_writer_free(writer);
+}
+
+static void compare(const char *expected, size_t expected_size, const char *buffer, size_t size, const char *what, size_t threads) {
+	if(size != expected_size)
+		errx(EX_SOFTWARE, "%s with %zu threads: %zu bytes instead of %zu", what, threads, size, expected_size);
+	for(size_t u = 0; u < size; u++)
+		if(buffer[u] != expected[u])
+			errx(EX_SOFTWARE, "%s with %zu threads: output differs at byte %zu", what, threads, u);
+}
+
+int main(void) {
+	fprintf(stderr, "checking parallel rendering...\n");
+	fflush(stderr);
+
+	const char *tmpdir = getenv("TMPDIR");
+	char filename[4096];
+	snprintf(filename, sizeof filename, "%s/bijson-test-XXXXXX", tmpdir ? tmpdir : "/tmp");
+	int fd = mkstemp(filename);
+	if(fd == -1)
+		err(EX_OSERR, "mkstemp(%s)", filename);
+	close(fd);
+
+	bijson_t bijson;
+	write_document(&bijson);
+	if(bijson.size < SIZE_C(4) * SIZE_C(1048576))
+		errx(EX_SOFTWARE, "test document is only %zu bytes", bijson.size);
+
+	const void *expected;
+	size_t expected_size;
+	C(bijson_to_json_malloc(&bijson, &expected, &expected_size));
+
+	static const size_t thread_counts[] = {0, 1, 2, 3, 4, 8, 17};
+	for(size_t t = 0; t < _BIJSON_ARRAY_COUNT(thread_counts); t++) {
+		size_t threads = thread_counts[t];
+
+		output_t output = {0};
+		C(bijson_to_json_parallel(&bijson, threads, collect, &output));
+		compare(expected, expected_size, output.buffer, output.size, "bijson_to_json_parallel", threads);
+		free(output.buffer);
+
+		C(bijson_to_json_parallel_filename(&bijson, threads, filename));
+		FILE *fh = fopen(filename, "r");
+		if(!fh)
+			err(EX_OSERR, "fopen(%s)", filename);
+		char *buffer = malloc(expected_size + SIZE_C(1));
+		if(!buffer)
+			err(EX_OSERR, "malloc");
+		size_t size = fread(buffer, 1, expected_size + SIZE_C(1), fh);
+		if(ferror(fh))
+			err(EX_OSERR, "fread(%s)", filename);
+		fclose(fh);
+		compare(expected, expected_size, buffer, size, "bijson_to_json_parallel_filename", threads);
+		free(buffer);
+	}
+
+	// Values too small to be split up
+	static const char small_json[] = "[1,{\"a\":[true]},\"x\"]";
+	bijson_t small;
+	PARSE(small_json, &small);
+	output_t output = {0};
+	C(bijson_to_json_parallel(&small, 4, collect, &output));
+	compare(small_json, strlen(small_json), output.buffer, output.size, "small value", 4);
+	free(output.buffer);
+	bijson_free(&small);
+
+	unlink(filename);
+	free(_bijson_no_const(expected));
+	bijson_free(&bijson);
+
+	fprintf(stderr, "parallel rendering OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include "common.h"
+
+static void resolve(const bijson_t *bijson, const char *pointer, bijson_error_t error, const char *expected) {
+	bijson_pointer_t *compiled;
+	_c(__FILE__, __LINE__, pointer, bijson_pointer_compile(&compiled, pointer, strlen(pointer)));
+	bijson_t result;
+	bijson_error_t resolve_error = bijson_pointer_resolve(compiled, bijson, &result);
+	if(resolve_error != error)
+		errx(EX_SOFTWARE, "%s: expected %s, got %s", pointer,
+			error ? error : "success", resolve_error ? resolve_error : "success");
+	if(!error)
+		EXPECT_JSON(&result, expected);
+	bijson_pointer_free(compiled);
+}
+
+static void syntax_error(const char *pointer) {
+	bijson_pointer_t *compiled = NULL;
+	if(bijson_pointer_compile(&compiled, pointer, strlen(pointer)) != bijson_error_invalid_pointer_syntax)
+		errx(EX_SOFTWARE, "%s: expected a syntax error", pointer);
+	if(compiled)
+		errx(EX_SOFTWARE, "%s: result was set", pointer);
+}
+
+int main(void) {
+	fprintf(stderr, "checking JSON pointers...\n");
+	fflush(stderr);
+
+	// The example document from RFC 6901
+	bijson_t bijson;
+	PARSE(
+		"{\"foo\":[\"bar\",\"baz\"],\"\":0,\"a/b\":1,\"c%d\":2,\"e^f\":3,\"g|h\":4,"
+		"\"i\\\\j\":5,\"k\\\"l\":6,\" \":7,\"m~n\":8}",
+		&bijson
+	);
+	resolve(&bijson, "/foo", NULL, "[\"bar\",\"baz\"]");
+	resolve(&bijson, "/foo/0", NULL, "\"bar\"");
+	resolve(&bijson, "/foo/1", NULL, "\"baz\"");
+	resolve(&bijson, "/", NULL, "0");
+	resolve(&bijson, "/a~1b", NULL, "1");
+	resolve(&bijson, "/c%d", NULL, "2");
+	resolve(&bijson, "/e^f", NULL, "3");
+	resolve(&bijson, "/g|h", NULL, "4");
+	resolve(&bijson, "/i\\j", NULL, "5");
+	resolve(&bijson, "/k\"l", NULL, "6");
+	resolve(&bijson, "/ ", NULL, "7");
+	resolve(&bijson, "/m~0n", NULL, "8");
+
+	resolve(&bijson, "/missing", bijson_error_key_not_found, NULL);
+	resolve(&bijson, "/foo/2", bijson_error_index_out_of_range, NULL);
+	resolve(&bijson, "/foo/-", bijson_error_index_out_of_range, NULL);
+	resolve(&bijson, "/foo/01", bijson_error_index_out_of_range, NULL);
+	resolve(&bijson, "/foo/x", bijson_error_index_out_of_range, NULL);
+	resolve(&bijson, "/foo/99999999999999999999999", bijson_error_index_out_of_range, NULL);
+	resolve(&bijson, "/foo/0/x", bijson_error_type_mismatch, NULL);
+	bijson_free(&bijson);
+
+	// The empty pointer is the whole document
+	PARSE("[{\"0\":[true,{\"~/\":null}]}]", &bijson);
+	resolve(&bijson, "", NULL, "[{\"0\":[true,{\"~/\":null}]}]");
+	resolve(&bijson, "/0/0/1/~0~1", NULL, "null");
+	resolve(&bijson, "/0/0/0", NULL, "true");
+	bijson_free(&bijson);
+
+	syntax_error("foo");
+	syntax_error("/foo~");
+	syntax_error("/foo~2");
+	syntax_error("/~/");
+
+	bijson_pointer_t *compiled;
+	E(bijson_error_parameter_is_null, bijson_pointer_compile(NULL, "/", 1));
+	E(bijson_error_parameter_is_null, bijson_pointer_compile(&compiled, NULL, 1));
+	C(bijson_pointer_compile(&compiled, NULL, 0));
+	E(bijson_error_parameter_is_null, bijson_pointer_resolve(NULL, &bijson_0, &bijson));
+	bijson_pointer_free(compiled);
+	bijson_pointer_free(NULL);
+
+	fprintf(stderr, "JSON pointers OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
@@ -0,0 +1,248 @@
+#include <math.h>
+
+#include "common.h"
+
+// Every tenth item is a number instead of an object. Objects have an "id",
+// a "status" of "active" or "idle" and a "score" that is usually a number,
+// but sometimes a string or missing.
+static void write_items(size_t count, bijson_t *result) {
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	C(bijson_writer_begin_array(writer));
+	for(size_t u = 0; u < count; u++) {
+		char digits[32];
+		size_t len = (size_t)sprintf(digits, "%zu", u);
+		if(u % SIZE_C(10) == SIZE_C(9)) {
+			C(bijson_writer_add_decimal_from_string(writer, digits, len));
+			continue;
+		}
+		C(bijson_writer_begin_object(writer));
+		C(bijson_writer_add_key(writer, "id", 2));
+		C(bijson_writer_add_decimal_from_string(writer, digits, len));
+		C(bijson_writer_add_key(writer, "status", 6));
+		if(u % SIZE_C(3))
+			C(bijson_writer_add_string(writer, "idle", 4));
+		else
+			C(bijson_writer_add_string(writer, "active", 6));
+		if(u % SIZE_C(7) == SIZE_C(0)) {
+			C(bijson_writer_add_key(writer, "score", 5));
+			C(bijson_writer_add_string(writer, "high", 4));
+		} else if(u % SIZE_C(7) != SIZE_C(1)) {
+			C(bijson_writer_add_key(writer, "score", 5));
+			C(bijson_writer_add_decimal_from_string(writer, digits, (size_t)sprintf(digits, "%zu", u % SIZE_C(100))));
+		}
+		C(bijson_writer_end_object(writer));
+	}
+	C(bijson_writer_end_array(writer));
+	C(bijson_writer_write_to_malloc(writer, result));
+	bijson_writer_free(writer);
+}
+
+typedef enum test_predicate {
+	score_gt_50,
+	score_ne_10,
+	active_and_score_ge_90,
+	score_exists,
+	score_is_string,
+	status_lt_b,
+	status_ne_number,
+	test_predicate_count,
+} test_predicate_t;
+
+static bijson_predicate_t *build(test_predicate_t which) {
+	bijson_predicate_t *predicate;
+	C(bijson_predicate_alloc(&predicate));
+	switch(which) {
+		case score_gt_50:
+			C(bijson_predicate_add_number(predicate, "score", 5, bijson_predicate_operator_gt, 50.0));
+			break;
+		case score_ne_10:
+			C(bijson_predicate_add_number(predicate, "score", 5, bijson_predicate_operator_ne, 10.0));
+			break;
+		case active_and_score_ge_90:
+			C(bijson_predicate_add_string(predicate, "status", 6, bijson_predicate_operator_eq, "active", 6));
+			C(bijson_predicate_add_number(predicate, "score", 5, bijson_predicate_operator_ge, 90.0));
+			break;
+		case score_exists:
+			C(bijson_predicate_add_exists(predicate, "score", 5));
+			break;
+		case score_is_string:
+			C(bijson_predicate_add_type(predicate, "score", 5, bijson_value_type_string));
+			break;
+		case status_lt_b:
+			C(bijson_predicate_add_string(predicate, "status", 6, bijson_predicate_operator_lt, "b", 1));
+			break;
+		case status_ne_number:
+			C(bijson_predicate_add_number(predicate, "status", 6, bijson_predicate_operator_ne, 1.0));
+			break;
+		default:
+			errx(EX_SOFTWARE, "unknown predicate %d", (int)which);
+	}
+	return predicate;
+}
+
+static bool expected(test_predicate_t which, size_t u) {
+	if(u % SIZE_C(10) == SIZE_C(9))
+		return false;
+	bool active = !(u % SIZE_C(3));
+	bool has_score = u % SIZE_C(7) != SIZE_C(1);
+	bool string_score = !(u % SIZE_C(7));
+	size_t score = u % SIZE_C(100);
+	switch(which) {
+		case score_gt_50:
+			return has_score && !string_score && score > SIZE_C(50);
+		case score_ne_10:
+			// Values of another type satisfy ne
+			return has_score && (string_score || score != SIZE_C(10));
+		case active_and_score_ge_90:
+			return active && has_score && !string_score && score >= SIZE_C(90);
+		case score_exists:
+			return has_score;
+		case score_is_string:
+			return string_score;
+		case status_lt_b:
+			return active;
+		case status_ne_number:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static void check(size_t count) {
+	bijson_t bijson;
+	write_items(count, &bijson);
+	bijson_array_analysis_t analysis;
+	C(bijson_array_analyze(&bijson, &analysis));
+
+	size_t bitmap_size = count / SIZE_C(8) + SIZE_C(1);
+	uint8_t *matches = malloc(bitmap_size);
+	if(!matches)
+		err(EX_OSERR, "malloc");
+
+	static const size_t thread_counts[] = {0, 1, 2, 3, 4, 8};
+	for(test_predicate_t which = 0; which < test_predicate_count; which++) {
+		bijson_predicate_t *predicate = build(which);
+		size_t expected_count = 0;
+		for(size_t u = 0; u < count; u++)
+			if(expected(which, u))
+				expected_count++;
+
+		for(size_t t = 0; t < _BIJSON_ARRAY_COUNT(thread_counts); t++) {
+			size_t threads = thread_counts[t];
+
+			size_t matched;
+			memset(matches, 0, bitmap_size);
+			C(bijson_array_scan(&bijson, predicate, matches, count, threads, &matched));
+			if(matched != expected_count)
+				errx(EX_SOFTWARE, "predicate %d on %zu items with %zu threads: %zu matches instead of %zu",
+					(int)which, count, threads, matched, expected_count);
+			for(size_t u = 0; u < count; u++)
+				if(!(matches[u / SIZE_C(8)] >> (u % SIZE_C(8)) & 1U) != !expected(which, u))
+					errx(EX_SOFTWARE, "predicate %d on %zu items with %zu threads: item %zu is wrong",
+						(int)which, count, threads, u);
+
+			memset(matches, 0, bitmap_size);
+			C(bijson_analyzed_array_scan(&analysis, predicate, matches, count, threads, NULL));
+			for(size_t u = 0; u < count; u++)
+				if(!(matches[u / SIZE_C(8)] >> (u % SIZE_C(8)) & 1U) != !expected(which, u))
+					errx(EX_SOFTWARE, "predicate %d on %zu analyzed items with %zu threads: item %zu is wrong",
+						(int)which, count, threads, u);
+
+			size_t *indices;
+			C(bijson_array_scan_indices(&bijson, predicate, threads, &indices, &matched));
+			if(matched != expected_count)
+				errx(EX_SOFTWARE, "predicate %d on %zu items with %zu threads: %zu indices instead of %zu",
+					(int)which, count, threads, matched, expected_count);
+			size_t next = 0;
+			for(size_t u = 0; u < count; u++)
+				if(expected(which, u) && indices[next++] != u)
+					errx(EX_SOFTWARE, "predicate %d on %zu items with %zu threads: index %zu is wrong",
+						(int)which, count, threads, next - SIZE_C(1));
+			free(indices);
+
+			C(bijson_analyzed_array_scan_indices(&analysis, predicate, threads, &indices, &matched));
+			if(matched != expected_count)
+				errx(EX_SOFTWARE, "predicate %d on %zu analyzed items with %zu threads: %zu indices instead of %zu",
+					(int)which, count, threads, matched, expected_count);
+			free(indices);
+		}
+
+		// The bitmap must have room for every item
+		if(count)
+			E(bijson_error_index_out_of_range, bijson_array_scan(&bijson, predicate, matches, count - SIZE_C(1), 4, NULL));
+		C(bijson_array_scan(&bijson, predicate, matches, bitmap_size * SIZE_C(8), 4, NULL));
+
+		bijson_predicate_free(predicate);
+	}
+
+	free(matches);
+	bijson_free(&bijson);
+}
+
+// Numbers are compared exactly; the double is taken as the shortest decimal
+// that converts back to it.
+static void check_number(bijson_predicate_operator_t op, double number, unsigned int expected) {
+	bijson_t bijson;
+	PARSE(
+		"[{\"n\":9007199254740992},{\"n\":9007199254740993},{\"n\":0.1},{\"n\":1e400},"
+		"{\"n\":-0},{\"n\":\"1\"},{\"n\":100000000000000000000000000001}]",
+		&bijson
+	);
+	bijson_predicate_t *predicate;
+	C(bijson_predicate_alloc(&predicate));
+	C(bijson_predicate_add_number(predicate, "n", 1, op, number));
+	uint8_t matches = 0;
+	C(bijson_array_scan(&bijson, predicate, &matches, 8, 1, NULL));
+	if(matches != expected)
+		errx(EX_SOFTWARE, "operator %d, %.17g: matches 0x%02X instead of 0x%02X",
+			(int)op, number, (unsigned int)matches, expected);
+	bijson_predicate_free(predicate);
+	bijson_free(&bijson);
+}
+
+int main(void) {
+	fprintf(stderr, "checking predicates...\n");
+	fflush(stderr);
+
+	// Too small to be split across threads, and large enough
+	check(0);
+	check(1);
+	check(100);
+	check(10007);
+
+	check_number(bijson_predicate_operator_gt, 9007199254740992.0, 0x4AU);
+	check_number(bijson_predicate_operator_eq, 9007199254740992.0, 0x01U);
+	check_number(bijson_predicate_operator_eq, 0.1, 0x04U);
+	check_number(bijson_predicate_operator_lt, 0.1, 0x10U);
+	check_number(bijson_predicate_operator_eq, -0.0, 0x10U);
+	check_number(bijson_predicate_operator_ge, 1e29, 0x48U);
+	check_number(bijson_predicate_operator_lt, HUGE_VAL, 0x5FU);
+	check_number(bijson_predicate_operator_gt, -HUGE_VAL, 0x5FU);
+	check_number(bijson_predicate_operator_ne, NAN, 0x7FU);
+	check_number(bijson_predicate_operator_eq, NAN, 0x00U);
+
+	bijson_t bijson;
+	bijson_predicate_t *predicate;
+	C(bijson_predicate_alloc(&predicate));
+	// Without conditions, every object matches
+	PARSE("[{},1,{\"a\":null},[]]", &bijson);
+	uint8_t matches = 0;
+	size_t matched;
+	C(bijson_array_scan(&bijson, predicate, &matches, 8, 1, &matched));
+	if(matched != SIZE_C(2) || matches != UINT8_C(5))
+		errx(EX_SOFTWARE, "empty predicate matches 0x%02X", (unsigned int)matches);
+	E(bijson_error_parameter_is_null, bijson_array_scan(&bijson, NULL, &matches, 8, 1, NULL));
+	bijson_free(&bijson);
+
+	PARSE("{}", &bijson);
+	E(bijson_error_type_mismatch, bijson_array_scan(&bijson, predicate, &matches, 8, 1, NULL));
+	bijson_free(&bijson);
+	bijson_predicate_free(predicate);
+	bijson_predicate_free(NULL);
+
+	fprintf(stderr, "predicates OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
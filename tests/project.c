@@ -0,0 +1,301 @@
+#include <math.h>
+
+#include "common.h"
+
+// Every item of the test arrays is one of these kinds, in turn. Item u has
+// the value u where the kind has a numeric value.
+typedef enum kind {
+	kind_decimal,
+	kind_fraction,
+	kind_large_decimal,
+	kind_string,
+	kind_missing,
+	kind_null,
+	kind_not_an_object,
+	kind_binary_integer,
+	kind_negative_binary_integer,
+	kind_large_binary_integer,
+	kind_half,
+	kind_double,
+	kind_infinity,
+	kinds,
+} kind_t;
+
+typedef struct expected {
+	bool int64_present;
+	int64_t int64;
+	bool double_present;
+	double double_value;
+	bool string_present;
+	char string[16];
+} expected_t;
+
+static expected_t expect(size_t u) {
+	expected_t e = {0};
+	switch((kind_t)(u % kinds)) {
+		case kind_decimal:
+		case kind_binary_integer:
+			e.int64_present = e.double_present = true;
+			e.int64 = (int64_t)u;
+			e.double_value = (double)u;
+			break;
+		case kind_negative_binary_integer:
+			e.int64_present = e.double_present = true;
+			e.int64 = -(int64_t)u;
+			e.double_value = -(double)u;
+			break;
+		case kind_fraction:
+		case kind_double:
+			e.double_present = true;
+			e.double_value = (double)u + 0.5;
+			break;
+		case kind_large_decimal:
+			e.double_present = true;
+			e.double_value = 1e30;
+			break;
+		case kind_large_binary_integer:
+			// 2^64 + 1, rounded
+			e.double_present = true;
+			e.double_value = 18446744073709551616.0;
+			break;
+		case kind_half:
+			e.int64_present = e.double_present = true;
+			e.int64 = 1;
+			e.double_value = 1.0;
+			break;
+		case kind_string:
+			e.string_present = true;
+			sprintf(e.string, "s%zu", u);
+			break;
+		default:
+			break;
+	}
+	return e;
+}
+
+// The writer has no way to add binary integers or IEEE floats, so these are
+// written as bytes of the same size and retyped afterwards.
+static void retype(const bijson_t *array, size_t u, byte_t type) {
+	bijson_t item, value;
+	C(bijson_array_get_index(array, u, &item));
+	C(bijson_object_get_key(&item, "v", 1, &value));
+	byte_t *buffer = _bijson_no_const(value.buffer);
+	if(*buffer != BYTE_C(0x09))
+		errx(EX_SOFTWARE, "item %zu: unexpected type 0x%02X", u, (unsigned int)*buffer);
+	*buffer = type;
+}
+
+static void write_array(size_t count, bijson_t *result) {
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	C(bijson_writer_begin_array(writer));
+	for(size_t u = 0; u < count; u++) {
+		kind_t kind = (kind_t)(u % kinds);
+		if(kind == kind_not_an_object) {
+			C(bijson_writer_add_decimal_from_string(writer, "42", 2));
+			continue;
+		}
+		C(bijson_writer_begin_object(writer));
+		C(bijson_writer_add_key(writer, "other", 5));
+		C(bijson_writer_add_true(writer));
+		if(kind != kind_missing)
+			C(bijson_writer_add_key(writer, "v", 1));
+		char text[32];
+		byte_t payload[9] = {0};
+		switch(kind) {
+			case kind_decimal:
+				C(bijson_writer_add_decimal_from_string(writer, text, (size_t)sprintf(text, "%zu", u)));
+				break;
+			case kind_fraction:
+				C(bijson_writer_add_decimal_from_string(writer, text, (size_t)sprintf(text, "%zu.5", u)));
+				break;
+			case kind_large_decimal:
+				C(bijson_writer_add_decimal_from_string(writer, "1e30", 4));
+				break;
+			case kind_string:
+				C(bijson_writer_add_string(writer, text, (size_t)sprintf(text, "s%zu", u)));
+				break;
+			case kind_null:
+				C(bijson_writer_add_null(writer));
+				break;
+			case kind_binary_integer:
+			case kind_negative_binary_integer:
+				payload[0] = (byte_t)u;
+				payload[1] = (byte_t)(u >> 8U);
+				// Zero bytes at the most significant end are allowed
+				C(bijson_writer_add_bytes(writer, payload, SIZE_C(3)));
+				break;
+			case kind_large_binary_integer:
+				payload[0] = payload[8] = BYTE_C(1);
+				C(bijson_writer_add_bytes(writer, payload, SIZE_C(9)));
+				break;
+			case kind_half:
+				payload[1] = BYTE_C(0x3C);
+				C(bijson_writer_add_bytes(writer, payload, SIZE_C(2)));
+				break;
+			case kind_double:
+			case kind_infinity: {
+				double value = kind == kind_double ? (double)u + 0.5 : HUGE_VAL;
+				uint64_t bits;
+				memcpy(&bits, &value, sizeof bits);
+				for(size_t b = 0; b < sizeof bits; b++)
+					payload[b] = (byte_t)(bits >> (b * SIZE_C(8)));
+				C(bijson_writer_add_bytes(writer, payload, sizeof bits));
+			} break;
+			default:
+				break;
+		}
+		C(bijson_writer_end_object(writer));
+	}
+	C(bijson_writer_end_array(writer));
+	C(bijson_writer_write_to_malloc(writer, result));
+	bijson_writer_free(writer);
+
+	for(size_t u = 0; u < count; u++) {
+		switch((kind_t)(u % kinds)) {
+			case kind_binary_integer:
+			case kind_large_binary_integer:
+				retype(result, u, BYTE_C(0x18));
+				break;
+			case kind_negative_binary_integer:
+				retype(result, u, BYTE_C(0x19));
+				break;
+			case kind_half:
+			case kind_double:
+			case kind_infinity:
+				retype(result, u, BYTE_C(0x0A));
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+static size_t result_size(bijson_projection_type_t type) {
+	switch(type) {
+		case bijson_projection_type_int64:
+			return sizeof(int64_t);
+		case bijson_projection_type_double:
+			return sizeof(double);
+		default:
+			return sizeof(bijson_string_view_t);
+	}
+}
+
+static void check_item(size_t u, bijson_projection_type_t type, const void *results, const uint8_t *present) {
+	expected_t e = expect(u);
+	bool is_present = (present[u / SIZE_C(8)] >> (u % SIZE_C(8))) & 1U;
+	switch(type) {
+		case bijson_projection_type_int64: {
+			int64_t value = ((const int64_t *)results)[u];
+			if(is_present != e.int64_present || value != (e.int64_present ? e.int64 : 0))
+				errx(EX_SOFTWARE, "item %zu: int64 %s%"PRId64, u, is_present ? "" : "missing ", value);
+		} break;
+		case bijson_projection_type_double: {
+			double value = ((const double *)results)[u];
+			if(is_present != e.double_present || value != (e.double_present ? e.double_value : 0.0))
+				errx(EX_SOFTWARE, "item %zu: double %s%.17g", u, is_present ? "" : "missing ", value);
+		} break;
+		default: {
+			bijson_string_view_t view = ((const bijson_string_view_t *)results)[u];
+			if(is_present != e.string_present)
+				errx(EX_SOFTWARE, "item %zu: string %spresent", u, is_present ? "" : "not ");
+			if(e.string_present
+				? view.size != strlen(e.string) || memcmp(view.buffer, e.string, view.size)
+				: view.buffer || view.size
+			)
+				errx(EX_SOFTWARE, "item %zu: string %.*s", u, (int)view.size, view.buffer ? view.buffer : "");
+		} break;
+	}
+}
+
+static void check(size_t count) {
+	bijson_t array;
+	write_array(count, &array);
+	bijson_array_analysis_t analysis;
+	C(bijson_array_analyze(&array, &analysis));
+	bijson_key_t key;
+	C(bijson_key_prepare(&key, "v", 1));
+
+	size_t bitmap_size = (count + SIZE_C(7)) / SIZE_C(8);
+	static const bijson_projection_type_t types[] = {
+		bijson_projection_type_int64,
+		bijson_projection_type_double,
+		bijson_projection_type_string,
+	};
+	for(size_t t = 0; t < sizeof types / sizeof *types; t++) {
+		bijson_projection_type_t type = types[t];
+		size_t size = result_size(type) * count;
+		// One more, so that empty arrays don't need special treatment
+		void *serial = malloc(size + SIZE_C(1));
+		void *parallel = malloc(size + SIZE_C(1));
+		uint8_t *serial_present = malloc(bitmap_size + SIZE_C(1));
+		uint8_t *parallel_present = malloc(bitmap_size + SIZE_C(1));
+		if(!serial || !parallel || !serial_present || !parallel_present)
+			err(EX_OSERR, "malloc");
+		// Every byte of the results must be written
+		memset(serial, 0xAA, size);
+		memset(serial_present, 0xAA, bitmap_size);
+
+		C(bijson_array_project(&array, &key, type, serial, serial_present, count, 1));
+		for(size_t u = 0; u < count; u++)
+			check_item(u, type, serial, serial_present);
+		// Bits beyond the last item are clear
+		if(count % SIZE_C(8) && serial_present[bitmap_size - SIZE_C(1)] >> (count % SIZE_C(8)))
+			errx(EX_SOFTWARE, "%zu items: stray bits in the present bitmap", count);
+
+		C(bijson_analyzed_array_project(&analysis, &key, type, parallel, parallel_present, count, 4));
+		if(memcmp(serial, parallel, size) || memcmp(serial_present, parallel_present, bitmap_size))
+			errx(EX_SOFTWARE, "%zu items: parallel projection differs", count);
+
+		if(count) {
+			E(bijson_error_index_out_of_range,
+				bijson_array_project(&array, &key, type, serial, serial_present, count - SIZE_C(1), 1));
+		}
+		E(bijson_error_parameter_is_null, bijson_array_project(&array, NULL, type, serial, serial_present, count, 1));
+		E(bijson_error_parameter_is_null, bijson_array_project(&array, &key, type, NULL, serial_present, count, 1));
+		E(bijson_error_parameter_is_null, bijson_array_project(&array, &key, type, serial, NULL, count, 1));
+
+		free(serial);
+		free(parallel);
+		free(serial_present);
+		free(parallel_present);
+	}
+
+	int64_t unused;
+	uint8_t unused_present;
+	E(bijson_error_unsupported_data_type,
+		bijson_array_project(&array, &key, (bijson_projection_type_t)99, &unused, &unused_present, count, 1));
+	E(bijson_error_parameter_is_null,
+		bijson_analyzed_array_project(NULL, &key, bijson_projection_type_int64, &unused, &unused_present, count, 1));
+
+	bijson_free(&array);
+}
+
+int main(void) {
+	fprintf(stderr, "checking projections...\n");
+	fflush(stderr);
+
+	check(0);
+	check(SIZE_C(1));
+	check(SIZE_C(13));
+	check(SIZE_C(16));
+	// Above the threshold for splitting the work across threads
+	check(SIZE_C(1031));
+	check(SIZE_C(5000));
+
+	bijson_t bijson;
+	PARSE("{}", &bijson);
+	bijson_key_t key;
+	C(bijson_key_prepare(&key, "v", 1));
+	int64_t unused;
+	uint8_t unused_present;
+	E(bijson_error_type_mismatch,
+		bijson_array_project(&bijson, &key, bijson_projection_type_int64, &unused, &unused_present, 1, 1));
+	bijson_free(&bijson);
+
+	fprintf(stderr, "projections OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
@@ -0,0 +1,244 @@
+#include "common.h"
+
+// Collects the results of a query as comma separated JSON.
+typedef struct results {
+	char *buffer;
+	size_t size;
+	size_t count;
+} results_t;
+
+static bijson_error_t collect(void *callback_data, const bijson_t *result) {
+	results_t *results = callback_data;
+	const void *json;
+	size_t size;
+	C(bijson_to_json_malloc(result, &json, &size));
+	char *buffer = realloc(results->buffer, results->size + size + SIZE_C(2));
+	if(!buffer)
+		err(EX_OSERR, "realloc");
+	if(results->count)
+		buffer[results->size++] = ',';
+	memcpy(buffer + results->size, json, size);
+	results->size += size;
+	buffer[results->size] = '\0';
+	results->buffer = buffer;
+	results->count++;
+	free(_bijson_no_const(json));
+	return NULL;
+}
+
+static results_t run(const bijson_t *bijson, const char *query, size_t threads) {
+	bijson_query_t *compiled;
+	_c(__FILE__, __LINE__, query, bijson_query_compile(&compiled, query, strlen(query)));
+	results_t results = {NULL, 0, 0};
+	if(threads)
+		_c(__FILE__, __LINE__, query, bijson_query_run_parallel(compiled, bijson, threads, collect, &results));
+	else
+		_c(__FILE__, __LINE__, query, bijson_query_run(compiled, bijson, collect, &results));
+	bijson_query_free(compiled);
+	return results;
+}
+
+static int compare_strings(const void *a, const void *b) {
+	return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// The order of object members depends on how keys are stored, so results
+// from several members of one object can be compared sorted.
+static void check_query(const bijson_t *bijson, const char *query, const char *expected, bool sorted) {
+	results_t results = run(bijson, query, 0);
+	const char *actual = results.buffer ? results.buffer : "";
+	if(sorted && results.count > SIZE_C(1)) {
+		char **parts = malloc(results.count * sizeof *parts);
+		if(!parts)
+			err(EX_OSERR, "malloc");
+		// Results in these tests never contain commas themselves
+		size_t count = 0;
+		for(char *part = strtok(results.buffer, ","); part; part = strtok(NULL, ","))
+			parts[count++] = part;
+		qsort(parts, count, sizeof *parts, compare_strings);
+		char *joined = malloc(results.size + SIZE_C(1));
+		if(!joined)
+			err(EX_OSERR, "malloc");
+		*joined = '\0';
+		for(size_t u = 0; u < count; u++) {
+			if(u)
+				strcat(joined, ",");
+			strcat(joined, parts[u]);
+		}
+		free(parts);
+		free(results.buffer);
+		results.buffer = joined;
+		actual = joined;
+	}
+	if(strcmp(actual, expected))
+		errx(EX_SOFTWARE, "%s: expected %s, got %s", query, expected, actual);
+	free(results.buffer);
+}
+#define Q(query, expected) check_query(&bijson, (query), (expected), false)
+#define QS(query, expected) check_query(&bijson, (query), (expected), true)
+
+static void syntax_error(const char *query) {
+	bijson_query_t *compiled = NULL;
+	bijson_error_t error = bijson_query_compile(&compiled, query, strlen(query));
+	if(error != bijson_error_invalid_query_syntax)
+		errx(EX_SOFTWARE, "%s: expected a syntax error, got %s", query, error ? error : "success");
+}
+
+int main(void) {
+	fprintf(stderr, "checking queries...\n");
+	fflush(stderr);
+
+	bijson_t bijson;
+	PARSE(
+		"{\"store\":{\"book\":["
+			"{\"category\":\"reference\",\"author\":\"Rees\",\"title\":\"Sayings\",\"price\":8,\"meta\":{\"pages\":100}},"
+			"{\"category\":\"fiction\",\"author\":\"Waugh\",\"title\":\"Sword\",\"price\":12.5,\"meta\":{\"pages\":300}},"
+			"{\"category\":\"fiction\",\"author\":\"Melville\",\"title\":\"Moby\",\"isbn\":\"0-553\",\"price\":9,\"used\":true},"
+			"{\"category\":\"fiction\",\"author\":\"Tolkien\",\"title\":\"LOTR\",\"isbn\":\"0-395\",\"price\":22,\"used\":false,\"note\":null}"
+		"],\"bicycle\":{\"color\":\"red\",\"price\":19}},"
+		"\"nums\":[0,1,2,3,4,5,6,7,8,9],"
+		"\"odd key\":{\"it's\":1}}",
+		&bijson
+	);
+
+	// Members
+	Q("$.store.bicycle.color", "\"red\"");
+	Q("$['store']['bicycle']['color']", "\"red\"");
+	Q("$.store['bicycle'].price", "19");
+	Q("$['odd key']['it\\'s']", "1");
+	Q("$.store.missing", "");
+	Q("$.nums.x", "");
+	results_t root = run(&bijson, "$", 0);
+	if(root.count != SIZE_C(1))
+		errx(EX_SOFTWARE, "$ returned %zu results", root.count);
+	free(root.buffer);
+
+	// Wildcards
+	Q("$.nums[*]", "0,1,2,3,4,5,6,7,8,9");
+	Q("$.nums.*", "0,1,2,3,4,5,6,7,8,9");
+	Q("$.store.book[*].title", "\"Sayings\",\"Sword\",\"Moby\",\"LOTR\"");
+	QS("$.store.bicycle.*", "\"red\",19");
+	QS("$.store.bicycle[*]", "\"red\",19");
+
+	// Descendants
+	QS("$..price", "125e-1,19,22,8,9");
+	QS("$.store..pages", "100,300");
+	Q("$..book[2].title", "\"Moby\"");
+	QS("$..color", "\"red\"");
+	Q("$..nothing", "");
+
+	// Indexes and slices
+	Q("$.nums[0]", "0");
+	Q("$.nums[9]", "9");
+	Q("$.nums[10]", "");
+	Q("$.nums[-1]", "9");
+	Q("$.nums[-10]", "0");
+	Q("$.nums[-11]", "");
+	Q("$.store.book[-1].title", "\"LOTR\"");
+	Q("$.nums[1:5]", "1,2,3,4");
+	Q("$.nums[:3]", "0,1,2");
+	Q("$.nums[7:]", "7,8,9");
+	Q("$.nums[-3:]", "7,8,9");
+	Q("$.nums[:-8]", "0,1");
+	Q("$.nums[::3]", "0,3,6,9");
+	Q("$.nums[1:8:2]", "1,3,5,7");
+	Q("$.nums[5:2]", "");
+	Q("$.nums[20:30]", "");
+	Q("$.nums[-100:2]", "0,1");
+
+	// Filters with each operator and type of literal
+	Q("$.store.book[?(@.price < 9)].title", "\"Sayings\"");
+	Q("$.store.book[?(@.price <= 9)].title", "\"Sayings\",\"Moby\"");
+	Q("$.store.book[?(@.price > 12.5)].title", "\"LOTR\"");
+	Q("$.store.book[?(@.price >= 12.5)].title", "\"Sword\",\"LOTR\"");
+	Q("$.store.book[?(@.price == 125e-1)].title", "\"Sword\"");
+	Q("$.store.book[?(@.price != 22)].title", "\"Sayings\",\"Sword\",\"Moby\"");
+	Q("$.store.book[?(@.price > -1)].title", "\"Sayings\",\"Sword\",\"Moby\",\"LOTR\"");
+	Q("$.store.book[?(@.category == 'reference')].author", "\"Rees\"");
+	Q("$.store.book[?(@.category != 'reference')].author", "\"Waugh\",\"Melville\",\"Tolkien\"");
+	Q("$.store.book[?(@.author < 'R')].author", "\"Melville\"");
+	Q("$.store.book[?(@.used == true)].title", "\"Moby\"");
+	Q("$.store.book[?(@.used == false)].title", "\"LOTR\"");
+	Q("$.store.book[?(@.note == null)].title", "\"LOTR\"");
+	Q("$.store.book[?(@.isbn)].title", "\"Moby\",\"LOTR\"");
+	Q("$.store.book[?(@.meta.pages > 200)].title", "\"Sword\"");
+	Q("$.store.book[?(@['meta']['pages'] == 100)].title", "\"Sayings\"");
+	// Values of a different type never compare equal, nor in order
+	Q("$.store.book[?(@.price == '8')].title", "");
+	Q("$.store.book[?(@.price < 'z')].title", "");
+	Q("$.store.book[?(@.used == null)].title", "");
+	Q("$.nums[?(@ > 6)]", "7,8,9");
+	Q("$..[?(@.color)].price", "19");
+
+	// Numbers are compared exactly, also beyond the precision of doubles
+	bijson_t numbers;
+	PARSE("[9007199254740992,9007199254740993,1e400,-1e400,0.1,-0,100000000000000000000000000001]", &numbers);
+	check_query(&numbers, "$[?(@ > 9007199254740992)]", "9007199254740993,1e400,100000000000000000000000000001", false);
+	check_query(&numbers, "$[?(@ == 9007199254740993)]", "9007199254740993", false);
+	check_query(&numbers, "$[?(@ <= 90071992547409920e-1)]", "9007199254740992,-1e400,1e-1,-0", false);
+	check_query(&numbers, "$[?(@ < -1e399)]", "-1e400", false);
+	check_query(&numbers, "$[?(@ == 0.10)]", "1e-1", false);
+	check_query(&numbers, "$[?(@ == 0)]", "-0", false);
+	check_query(&numbers, "$[?(@ == 1E+29)]", "", false);
+	check_query(&numbers, "$[?(@ > 1E+29)]", "1e400,100000000000000000000000000001", false);
+	bijson_free(&numbers);
+
+	syntax_error("");
+	syntax_error("store");
+	syntax_error("$.");
+	syntax_error("$[");
+	syntax_error("$[1");
+	syntax_error("$['unterminated]");
+	syntax_error("$[::0]");
+	syntax_error("$[::-1]");
+	syntax_error("$[?(@.a ==)]");
+	syntax_error("$[?(@.a === 1)]");
+	syntax_error("$[?(@.a == 'x)]");
+	syntax_error("$[?(@.a == 1]");
+	syntax_error("$[?(@.a == nope)]");
+	syntax_error("$..");
+	syntax_error("$.a b");
+
+	// Like bijson_pointer_compile(), an empty query may be passed as NULL
+	bijson_query_t *compiled = NULL;
+	E(bijson_error_invalid_query_syntax, bijson_query_compile(&compiled, NULL, 0));
+	E(bijson_error_parameter_is_null, bijson_query_compile(&compiled, NULL, 1));
+	E(bijson_error_parameter_is_null, bijson_query_compile(NULL, "$", 1));
+
+	bijson_free(&bijson);
+
+	// Parallel runs report the same results in the same order
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	C(bijson_writer_begin_array(writer));
+	for(unsigned int u = 0; u < 5000U; u++) {
+		char digits[16];
+		C(bijson_writer_begin_object(writer));
+		C(bijson_writer_add_key(writer, "i", 1));
+		C(bijson_writer_add_decimal_from_string(writer, digits, (size_t)sprintf(digits, "%u", u)));
+		C(bijson_writer_add_key(writer, "v", 1));
+		C(bijson_writer_add_decimal_from_string(writer, digits, (size_t)sprintf(digits, "%u", u % 7U)));
+		C(bijson_writer_end_object(writer));
+	}
+	C(bijson_writer_end_array(writer));
+	C(bijson_writer_write_to_malloc(writer, &bijson));
+	bijson_writer_free(writer);
+
+	static const char *const parallel_queries[] = {"$[?(@.v == 3)].i", "$..i", "$[*].v", "$[100:4000:3]", "$[-5:]"};
+	for(size_t q = 0; q < _BIJSON_ARRAY_COUNT(parallel_queries); q++) {
+		results_t serial = run(&bijson, parallel_queries[q], 0);
+		for(size_t threads = SIZE_C(1); threads <= SIZE_C(8); threads++) {
+			results_t parallel = run(&bijson, parallel_queries[q], threads);
+			if(parallel.count != serial.count || strcmp(parallel.buffer, serial.buffer))
+				errx(EX_SOFTWARE, "%s: results with %zu threads differ", parallel_queries[q], threads);
+			free(parallel.buffer);
+		}
+		free(serial.buffer);
+	}
+	bijson_free(&bijson);
+
+	fprintf(stderr, "queries OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
@@ -0,0 +1,193 @@
+#include <unistd.h>
+
+#include "common.h"
+
+// Each item of the document is an array that renders to more than 4 KiB of
+// JSON, so that bijson_to_json_malloc() runs its action twice.
+#define ITEMS SIZE_C(4)
+#define STRINGS SIZE_C(50)
+#define STRING_SIZE SIZE_C(100)
+
+static void write_document(bijson_writer_t *writer) {
+	C(bijson_writer_begin_array(writer));
+	for(size_t u = 0; u < ITEMS; u++) {
+		char string[STRING_SIZE];
+		memset(string, 'a' + (int)u, sizeof string);
+		C(bijson_writer_begin_array(writer));
+		for(size_t v = 0; v < STRINGS; v++)
+			C(bijson_writer_add_string(writer, string, sizeof string));
+		C(bijson_writer_end_array(writer));
+	}
+	// Too small to be cached
+	C(bijson_writer_add_string(writer, "small", 5));
+	C(bijson_writer_end_array(writer));
+}
+
+static void _expect_stats(int line, bijson_render_cache_t *cache, uint64_t hits, uint64_t misses, uint64_t evictions, size_t entries) {
+	bijson_render_cache_stats_t stats;
+	bijson_render_cache_get_stats(cache, &stats);
+	if(stats.hits != hits || stats.misses != misses || stats.evictions != evictions || stats.entries != entries)
+		errx(EX_SOFTWARE, "%s:%d: %"PRIu64" hits, %"PRIu64" misses, %"PRIu64" evictions, %zu entries"
+			" instead of %"PRIu64", %"PRIu64", %"PRIu64", %zu", __FILE__, line,
+			stats.hits, stats.misses, stats.evictions, stats.entries, hits, misses, evictions, entries);
+	if(!entries && stats.bytes)
+		errx(EX_SOFTWARE, "%s:%d: %zu bytes in an empty cache", __FILE__, line, stats.bytes);
+}
+#define EXPECT_STATS(cache, hits, misses, evictions, entries) \
+	_expect_stats(__LINE__, (cache), UINT64_C(hits), UINT64_C(misses), UINT64_C(evictions), SIZE_C(entries))
+
+// Renders without the cache, for comparison
+static void render_uncached(const bijson_t *bijson, char **result, size_t *result_size) {
+	bijson_render_cache_install(NULL);
+	const void *buffer;
+	C(bijson_to_json_malloc(bijson, &buffer, result_size));
+	*result = _bijson_no_const(buffer);
+}
+
+static void _render(int line, const bijson_t *bijson, const char *expected, size_t expected_size) {
+	const void *buffer;
+	size_t size;
+	C(bijson_to_json_malloc(bijson, &buffer, &size));
+	if(size != expected_size || memcmp(buffer, expected, size))
+		errx(EX_SOFTWARE, "%s:%d: output differs from the uncached output", __FILE__, line);
+	free(_bijson_no_const(buffer));
+}
+#define RENDER(bijson, expected, expected_size) _render(__LINE__, (bijson), (expected), (expected_size))
+
+typedef struct output {
+	char *buffer;
+	size_t size;
+} output_t;
+
+static bijson_error_t collect(void *callback_data, const void *data, size_t len) {
+	output_t *output = callback_data;
+	char *buffer = realloc(output->buffer, output->size + len);
+	if(!buffer)
+		err(EX_OSERR, "realloc");
+	memcpy(buffer + output->size, data, len);
+	output->buffer = buffer;
+	output->size += len;
+	return NULL;
+}
+
+int main(void) {
+	fprintf(stderr, "checking render caches...\n");
+	fflush(stderr);
+
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	write_document(writer);
+	bijson_t document;
+	C(bijson_writer_write_to_malloc(writer, &document));
+
+	bijson_t items[ITEMS + SIZE_C(1)];
+	char *expected[ITEMS + SIZE_C(1)];
+	size_t expected_sizes[ITEMS + SIZE_C(1)];
+	for(size_t u = 0; u <= ITEMS; u++) {
+		C(bijson_array_get_index(&document, u, items + u));
+		render_uncached(items + u, expected + u, expected_sizes + u);
+	}
+	if(expected_sizes[0] <= SIZE_C(4096))
+		errx(EX_SOFTWARE, "items render to only %zu bytes", expected_sizes[0]);
+	char *expected_document;
+	size_t expected_document_size;
+	render_uncached(&document, &expected_document, &expected_document_size);
+
+	// Room for two items, but not for three
+	bijson_render_cache_t *cache;
+	C(bijson_render_cache_alloc(&cache, expected_sizes[0] * SIZE_C(2) + SIZE_C(1024)));
+	bijson_render_cache_install(cache);
+	EXPECT_STATS(cache, 0, 0, 0, 0);
+
+	RENDER(items + 0, expected[0], expected_sizes[0]);
+	EXPECT_STATS(cache, 0, 1, 0, 1);
+	RENDER(items + 0, expected[0], expected_sizes[0]);
+	EXPECT_STATS(cache, 1, 1, 0, 1);
+	RENDER(items + 1, expected[1], expected_sizes[1]);
+	EXPECT_STATS(cache, 1, 2, 0, 2);
+	// Makes item 1 the least recently used
+	RENDER(items + 0, expected[0], expected_sizes[0]);
+	EXPECT_STATS(cache, 2, 2, 0, 2);
+	RENDER(items + 2, expected[2], expected_sizes[2]);
+	EXPECT_STATS(cache, 2, 3, 1, 2);
+	RENDER(items + 0, expected[0], expected_sizes[0]);
+	EXPECT_STATS(cache, 3, 3, 1, 2);
+	RENDER(items + 1, expected[1], expected_sizes[1]);
+	EXPECT_STATS(cache, 3, 4, 2, 2);
+	RENDER(items + 2, expected[2], expected_sizes[2]);
+	EXPECT_STATS(cache, 3, 5, 3, 2);
+	RENDER(items + 1, expected[1], expected_sizes[1]);
+	EXPECT_STATS(cache, 4, 5, 3, 2);
+
+	// Not cached at all
+	RENDER(items + ITEMS, expected[ITEMS], expected_sizes[ITEMS]);
+	RENDER(&document, expected_document, expected_document_size);
+	EXPECT_STATS(cache, 4, 5, 3, 2);
+
+	// Other ways to render (the byte counter adds to the given size)
+	size_t size = 0;
+	C(bijson_to_json_bytecounter(items + 1, &size));
+	if(size != expected_sizes[1])
+		errx(EX_SOFTWARE, "bijson_to_json_bytecounter() counted %zu bytes instead of %zu", size, expected_sizes[1]);
+	EXPECT_STATS(cache, 5, 5, 3, 2);
+	output_t output = {0};
+	C(bijson_to_json_buffered(items + 2, collect, &output));
+	if(output.size != expected_sizes[2] || memcmp(output.buffer, expected[2], output.size))
+		errx(EX_SOFTWARE, "bijson_to_json_buffered() output differs from the uncached output");
+	free(output.buffer);
+	EXPECT_STATS(cache, 6, 5, 3, 2);
+	output = (output_t){0};
+	C(bijson_render_cache_to_json(cache, items + 3, collect, &output));
+	if(output.size != expected_sizes[3] || memcmp(output.buffer, expected[3], output.size))
+		errx(EX_SOFTWARE, "bijson_render_cache_to_json() output differs from the uncached output");
+	free(output.buffer);
+	EXPECT_STATS(cache, 6, 6, 4, 2);
+
+	bijson_render_cache_invalidate(cache, items + 2);
+	EXPECT_STATS(cache, 6, 6, 4, 1);
+	bijson_render_cache_clear(cache);
+	EXPECT_STATS(cache, 6, 6, 4, 0);
+
+	// bijson_free() drops the entries for its buffer
+	RENDER(items + 0, expected[0], expected_sizes[0]);
+	RENDER(items + 1, expected[1], expected_sizes[1]);
+	EXPECT_STATS(cache, 6, 8, 4, 2);
+	bijson_free(&document);
+	EXPECT_STATS(cache, 6, 8, 4, 0);
+
+	// And so does bijson_close()
+	const char *tmpdir = getenv("TMPDIR");
+	char filename[4096];
+	snprintf(filename, sizeof filename, "%s/bijson-test-XXXXXX", tmpdir ? tmpdir : "/tmp");
+	int fd = mkstemp(filename);
+	if(fd == -1)
+		err(EX_OSERR, "mkstemp(%s)", filename);
+	close(fd);
+	C(bijson_writer_write_to_filename(writer, filename));
+	C(bijson_open_filename(&document, filename));
+	for(size_t u = 0; u < ITEMS; u++)
+		C(bijson_array_get_index(&document, u, items + u));
+	RENDER(items + 0, expected[0], expected_sizes[0]);
+	RENDER(items + 3, expected[3], expected_sizes[3]);
+	RENDER(items + 3, expected[3], expected_sizes[3]);
+	EXPECT_STATS(cache, 7, 10, 4, 2);
+	bijson_close(&document);
+	EXPECT_STATS(cache, 7, 10, 4, 0);
+	unlink(filename);
+
+	bijson_render_cache_install(NULL);
+	bijson_render_cache_free(cache);
+	bijson_writer_free(writer);
+	for(size_t u = 0; u <= ITEMS; u++)
+		free(expected[u]);
+	free(expected_document);
+
+	E(bijson_error_parameter_is_null, bijson_render_cache_alloc(NULL, 1));
+	E(bijson_error_parameter_is_zero, bijson_render_cache_alloc(&cache, 0));
+	bijson_render_cache_free(NULL);
+
+	fprintf(stderr, "render caches OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
@@ -0,0 +1,151 @@
+#include "common.h"
+
+typedef struct test_key {
+	char buffer[16];
+	size_t len;
+} test_key_t;
+
+__attribute__((pure))
+static int compare_keys(const void *a, const void *b) {
+	const test_key_t *key_a = a, *key_b = b;
+	int cmp = memcmp(key_a->buffer, key_b->buffer, key_a->len < key_b->len ? key_a->len : key_b->len);
+	if(cmp)
+		return cmp;
+	return key_a->len < key_b->len ? -1 : key_a->len > key_b->len;
+}
+
+static bool has_prefix(const test_key_t *key, const char *prefix, size_t len) {
+	return key->len >= len && !memcmp(key->buffer, prefix, len);
+}
+
+// Pieces of keys, including NUL bytes and multibyte characters
+static const char *const pieces[] = {"", "\0", "a", "b", "\x7f", "\xc3\xa9", "\xf4\x8f\xbf\xbf"};
+static const size_t piece_lens[] = {0, 1, 1, 1, 1, 2, 4};
+
+// Keys and prefixes to look for, most of which are not in the object
+static const char *const probes[] = {
+	"", "\0", "\0\0", "a", "a\0", "aa", "ab", "b", "c", "\x7f", "\x80", "\xc3", "\xc3\xa9",
+	"\xc3\xa9\0", "\xc4", "\xf4\x8f\xbf\xbf", "\xf4\x90", "\xff", "a\xff", "\xff\xff",
+};
+static const size_t probe_lens[] = {0, 1, 2, 1, 2, 2, 2, 1, 1, 1, 1, 1, 2, 3, 1, 4, 2, 1, 2, 2};
+
+static void check(size_t count, unsigned int seed) {
+	test_key_t *keys = malloc((count ? count : SIZE_C(1)) * sizeof *keys);
+	if(!keys)
+		err(EX_OSERR, "malloc");
+
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	C(bijson_writer_begin_object(writer));
+	for(size_t u = 0; u < count; u++) {
+		test_key_t *key = keys + u;
+		key->len = 0;
+		for(unsigned int p = 0; p < 3U; p++) {
+			seed = seed * 1103515245U + 12345U;
+			size_t piece = (seed >> 16U) % _BIJSON_ARRAY_COUNT(pieces);
+			memcpy(key->buffer + key->len, pieces[piece], piece_lens[piece]);
+			key->len += piece_lens[piece];
+		}
+		C(bijson_writer_add_key(writer, key->buffer, key->len));
+		C(bijson_writer_add_null(writer));
+	}
+	C(bijson_writer_end_object(writer));
+	bijson_t bijson;
+	C(bijson_writer_write_to_malloc(writer, &bijson));
+	bijson_writer_free(writer);
+
+	qsort(keys, count, sizeof *keys, compare_keys);
+
+	bijson_object_sorted_view_t *view;
+	C(bijson_object_sorted_view_build(&view, &bijson));
+	if(bijson_object_sorted_view_count(view) != count)
+		errx(EX_SOFTWARE, "sorted view of %zu keys has %zu entries", count, bijson_object_sorted_view_count(view));
+
+	// Byte-lexical order, and each position refers to the right entry
+	for(size_t u = 0; u < count; u++) {
+		size_t index, len, expected_len;
+		const void *key, *expected_key;
+		bijson_t value, expected_value;
+		C(bijson_object_sorted_view_get(view, u, &index, &key, &len, &value));
+		if(len != keys[u].len || memcmp(key, keys[u].buffer, len))
+			errx(EX_SOFTWARE, "position %zu of %zu has the wrong key", u, count);
+		C(bijson_object_get_index(&bijson, index, &expected_key, &expected_len, &expected_value));
+		if(key != expected_key || len != expected_len || value.buffer != expected_value.buffer)
+			errx(EX_SOFTWARE, "position %zu of %zu refers to the wrong entry", u, count);
+		C(bijson_object_sorted_view_get(view, u, NULL, NULL, NULL, NULL));
+	}
+	E(bijson_error_index_out_of_range, bijson_object_sorted_view_get(view, count, NULL, NULL, NULL, NULL));
+
+	for(size_t p = 0; p < _BIJSON_ARRAY_COUNT(probes); p++) {
+		test_key_t probe;
+		memcpy(probe.buffer, probes[p], probe_lens[p]);
+		probe.len = probe_lens[p];
+
+		size_t lower_bound = 0;
+		while(lower_bound < count && compare_keys(keys + lower_bound, &probe) < 0)
+			lower_bound++;
+		size_t position;
+		C(bijson_object_sorted_view_lower_bound(view, probe.buffer, probe.len, &position));
+		if(position != lower_bound)
+			errx(EX_SOFTWARE, "lower bound of probe %zu among %zu keys is %zu instead of %zu", p, count, position, lower_bound);
+
+		// Keys with the prefix never sort before it
+		size_t start = lower_bound;
+		size_t end = start;
+		while(end < count && has_prefix(keys + end, probe.buffer, probe.len))
+			end++;
+		size_t range_start, range_end;
+		C(bijson_object_sorted_view_prefix_range(view, probe.buffer, probe.len, &range_start, &range_end));
+		if(range_start != start || range_end != end)
+			errx(EX_SOFTWARE, "prefix range of probe %zu among %zu keys is [%zu, %zu) instead of [%zu, %zu)",
+				p, count, range_start, range_end, start, end);
+	}
+
+	// The empty prefix covers everything
+	size_t start, end;
+	C(bijson_object_sorted_view_prefix_range(view, NULL, 0, &start, &end));
+	if(start || end != count)
+		errx(EX_SOFTWARE, "empty prefix among %zu keys is [%zu, %zu)", count, start, end);
+
+	bijson_object_sorted_view_free(view);
+	bijson_free(&bijson);
+	free(keys);
+}
+
+int main(void) {
+	fprintf(stderr, "checking sorted views...\n");
+	fflush(stderr);
+
+	check(0, 1U);
+	check(1, 2U);
+	check(2, 3U);
+	check(20, 4U);
+	check(300, 5U);
+	check(3000, 6U);
+
+	bijson_t bijson;
+	bijson_object_sorted_view_t *view;
+	PARSE("{\"b\":1,\"a\\u0000\":2,\"a\":3,\"\":4,\"a\":5}", &bijson);
+	C(bijson_object_sorted_view_build(&view, &bijson));
+	static const char *const expected[] = {"", "a", "a", "a\0"};
+	static const size_t expected_lens[] = {0, 1, 1, 2};
+	for(size_t u = 0; u < _BIJSON_ARRAY_COUNT(expected); u++) {
+		const void *key;
+		size_t len;
+		C(bijson_object_sorted_view_get(view, u, NULL, &key, &len, NULL));
+		if(len != expected_lens[u] || memcmp(key, expected[u], len))
+			errx(EX_SOFTWARE, "position %zu has the wrong key", u);
+	}
+	bijson_object_sorted_view_free(view);
+	bijson_free(&bijson);
+
+	PARSE("[]", &bijson);
+	E(bijson_error_type_mismatch, bijson_object_sorted_view_build(&view, &bijson));
+	bijson_free(&bijson);
+	bijson_object_sorted_view_free(NULL);
+
+	fprintf(stderr, "sorted views OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
@@ -0,0 +1,162 @@
+#include "common.h"
+
+// Makes a modifiable copy of a document, so that it can be damaged.
+static bijson_t copy(const bijson_t *bijson, byte_t *buffer) {
+	memcpy(buffer, bijson->buffer, bijson->size);
+	return (bijson_t){buffer, bijson->size};
+}
+
+static void check_nocheck(const char *json) {
+	bijson_t bijson;
+	PARSE(json, &bijson);
+	C(bijson_verify(&bijson));
+
+	const void *checked, *unchecked;
+	size_t checked_size, unchecked_size;
+	C(bijson_to_json_malloc(&bijson, &checked, &checked_size));
+	C(bijson_to_json_nocheck_malloc(&bijson, &unchecked, &unchecked_size));
+	if(checked_size != unchecked_size || memcmp(checked, unchecked, checked_size))
+		errx(EX_SOFTWARE, "nocheck output differs for %s", json);
+	free(_bijson_no_const(checked));
+	free(_bijson_no_const(unchecked));
+
+	bijson_object_analysis_t analysis, analysis_nocheck;
+	if(!bijson_object_analyze(&bijson, &analysis)) {
+		C(bijson_object_analyze_nocheck(&bijson, &analysis_nocheck));
+		size_t count;
+		C(bijson_analyzed_object_count(&analysis, &count));
+		for(size_t u = 0; u < count; u++) {
+			const void *key;
+			size_t len;
+			bijson_t value, check;
+			C(bijson_analyzed_object_get_index(&analysis, u, &key, &len, &value));
+			C(bijson_analyzed_object_get_key(&analysis_nocheck, key, len, &check));
+			if(value.buffer != check.buffer)
+				errx(EX_SOFTWARE, "nocheck lookup of key %zu differs for %s", u, json);
+		}
+		bijson_t value;
+		E(bijson_error_key_not_found, bijson_analyzed_object_get_key(&analysis_nocheck, "missing", 7, &value));
+	}
+
+	bijson_free(&bijson);
+}
+
+int main(void) {
+	fprintf(stderr, "checking verification...\n");
+	fflush(stderr);
+
+	byte_t buffer[64];
+	bijson_t bijson, damaged, value;
+
+	check_nocheck("[\"aaaa\",\"bbbb\",\"cccc\"]");
+	check_nocheck("{\"ab\":1,\"cd\":\"xy\",\"\xc3\xa9\":[true,null,{}]}");
+	check_nocheck("[1.5,-2e-300,123456789012345678901234567890,\"\xe3\x81\x82\"]");
+
+	// Decimal words hold at most 19 digits. The top word is stored minus
+	// one, so it can't be 9999999999999999999 either.
+	PARSE("99999999999999999999999999999999999999", &bijson);
+	if(bijson.size != SIZE_C(17))
+		errx(EX_SOFTWARE, "unexpected decimal layout");
+	damaged = copy(&bijson, buffer);
+	C(bijson_verify(&damaged));
+	buffer[9]++;
+	E(bijson_error_file_format_error, bijson_verify(&damaged));
+	E(bijson_error_file_format_error, bijson_to_json_malloc(&damaged, &(const void *){NULL}, &(size_t){0}));
+	damaged = copy(&bijson, buffer);
+	// 9999999999999999999 + 1 in the low word
+	memcpy(buffer + 1, (const byte_t[]){0x00, 0x00, 0xE8, 0x89, 0x04, 0x23, 0xC7, 0x8A}, 8);
+	E(bijson_error_file_format_error, bijson_verify(&damaged));
+	bijson_free(&bijson);
+
+	// Array item offsets: type, count, two one byte offsets, then the items
+	PARSE("[\"aaaa\",\"bbbb\",\"cccc\"]", &bijson);
+	if(bijson.size != SIZE_C(19) || ((const byte_t *)bijson.buffer)[2] != BYTE_C(4))
+		errx(EX_SOFTWARE, "unexpected array layout");
+	damaged = copy(&bijson, buffer);
+	C(bijson_verify(&damaged));
+	buffer[2] = BYTE_C(0x30);
+	E(bijson_error_file_format_error, bijson_verify(&damaged));
+	E(bijson_error_file_format_error, bijson_array_get_index(&damaged, 1, &value));
+	damaged = copy(&bijson, buffer);
+	buffer[2] = BYTE_C(0x09);
+	E(bijson_error_file_format_error, bijson_verify(&damaged));
+	// Truncated documents
+	damaged = copy(&bijson, buffer);
+	damaged.size = SIZE_C(4);
+	E(bijson_error_file_format_error, bijson_verify(&damaged));
+	damaged.size = SIZE_C(0);
+	E(bijson_error_parameter_is_zero, bijson_verify(&damaged));
+	bijson_free(&bijson);
+
+	// Object keys and strings must be valid UTF-8; if not, that's reported
+	// as a format error. With a single key, damaging it doesn't
+	// break the key order.
+	PARSE("{\"ab\":1}", &bijson);
+	const byte_t *found = memmem(bijson.buffer, bijson.size, "ab", 2);
+	if(!found)
+		errx(EX_SOFTWARE, "unexpected object layout");
+	damaged = copy(&bijson, buffer);
+	C(bijson_verify(&damaged));
+	buffer[_bijson_ptrdiff(found, bijson.buffer)] = BYTE_C(0xC0);
+	buffer[_bijson_ptrdiff(found, bijson.buffer) + SIZE_C(1)] = BYTE_C(0x80);
+	E(bijson_error_file_format_error, bijson_verify(&damaged));
+	E(bijson_error_file_format_error, bijson_to_json_malloc(&damaged, &(const void *){NULL}, &(size_t){0}));
+	E(bijson_error_file_format_error, bijson_object_get_key(&damaged, "x", 1, &value));
+	bijson_free(&bijson);
+
+	PARSE("{\"ab\":1,\"cd\":\"xy\"}", &bijson);
+	found = memmem(bijson.buffer, bijson.size, "xy", 2);
+	if(!found)
+		errx(EX_SOFTWARE, "unexpected object layout");
+	damaged = copy(&bijson, buffer);
+	C(bijson_verify(&damaged));
+	buffer[_bijson_ptrdiff(found, bijson.buffer) + SIZE_C(1)] = BYTE_C(0xFF);
+	E(bijson_error_file_format_error, bijson_verify(&damaged));
+	C(bijson_object_get_key(&damaged, "cd", 2, &value));
+	E(bijson_error_file_format_error, bijson_string_get(&value, &(const char *){NULL}, &(size_t){0}));
+	// Damaging a key of a larger object breaks the key order instead
+	found = memmem(bijson.buffer, bijson.size, "ab", 2);
+	damaged = copy(&bijson, buffer);
+	buffer[_bijson_ptrdiff(found, bijson.buffer)] = BYTE_C(0xC0);
+	buffer[_bijson_ptrdiff(found, bijson.buffer) + SIZE_C(1)] = BYTE_C(0x80);
+	if(!bijson_verify(&damaged))
+		errx(EX_SOFTWARE, "damaged key not detected");
+	bijson_free(&bijson);
+
+	// Values of a fixed size, with and without a trailing byte
+	static const struct {
+		byte_t type;
+		size_t sizes[3];
+	} fixed[] = {
+		{BYTE_C(0x01), {1, 1, 1}},
+		{BYTE_C(0x02), {1, 1, 1}},
+		{BYTE_C(0x03), {1, 1, 1}},
+		{BYTE_C(0x04), {1, 1, 1}},
+		{BYTE_C(0x0A), {3, 5, 9}},
+		{BYTE_C(0x0B), {5, 9, 17}},
+		{BYTE_C(0x0C), {5, 9, 17}},
+		{BYTE_C(0x10), {1, 1, 1}},
+		{BYTE_C(0x13), {1, 1, 1}},
+		{BYTE_C(0x15), {1, 1, 1}},
+	};
+	memset(buffer, 0, sizeof buffer);
+	for(size_t u = 0; u < _BIJSON_ARRAY_COUNT(fixed); u++) {
+		buffer[0] = fixed[u].type;
+		for(size_t size = SIZE_C(1); size <= SIZE_C(18); size++) {
+			damaged = (bijson_t){buffer, size};
+			bool valid = size == fixed[u].sizes[0] || size == fixed[u].sizes[1] || size == fixed[u].sizes[2];
+			E(valid ? NULL : bijson_error_file_format_error, bijson_verify(&damaged));
+		}
+	}
+	// Also inside containers: [null] with a trailing byte in the item
+	static const byte_t array[] = {BYTE_C(0x30), BYTE_C(0x00), BYTE_C(0x01), BYTE_C(0x00)};
+	damaged = (bijson_t){array, sizeof array};
+	E(bijson_error_file_format_error, bijson_verify(&damaged));
+	damaged.size--;
+	C(bijson_verify(&damaged));
+
+	fprintf(stderr, "verification OK.\n");
+	fflush(stderr);
+
+	return 0;
+}
@@ -0,0 +1,238 @@
+#include "common.h"
+
+// Records the events of a walk as text.
+typedef struct trace {
+	char *buffer;
+	size_t size;
+	size_t events;
+	// Stop the walk with an error at this event (if not zero)
+	size_t stop;
+} trace_t;
+
+static const char trace_stopped[] = "stopped";
+
+static bijson_error_t record(trace_t *trace, const char *prefix, const void *data, size_t len) {
+	size_t prefix_len = strlen(prefix);
+	char *buffer = realloc(trace->buffer, trace->size + prefix_len + len + SIZE_C(2));
+	if(!buffer)
+		err(EX_OSERR, "realloc");
+	memcpy(buffer + trace->size, prefix, prefix_len);
+	if(len)
+		memcpy(buffer + trace->size + prefix_len, data, len);
+	trace->size += prefix_len + len;
+	buffer[trace->size++] = '\n';
+	buffer[trace->size] = '\0';
+	trace->buffer = buffer;
+	if(++trace->events == trace->stop)
+		return trace_stopped;
+	return NULL;
+}
+
+static bijson_error_t record_count(trace_t *trace, const char *prefix, size_t count) {
+	char text[32];
+	return record(trace, prefix, text, (size_t)sprintf(text, "%zu", count));
+}
+
+static bijson_error_t begin_array(void *callback_data, size_t count) {
+	return record_count(callback_data, "[", count);
+}
+
+static bijson_error_t end_array(void *callback_data) {
+	return record(callback_data, "]", NULL, 0);
+}
+
+static bijson_error_t begin_object(void *callback_data, size_t count) {
+	return record_count(callback_data, "{", count);
+}
+
+static bijson_error_t end_object(void *callback_data) {
+	return record(callback_data, "}", NULL, 0);
+}
+
+static bijson_error_t key(void *callback_data, const char *key, size_t len) {
+	bijson_error_t error = record_count(callback_data, "k", len);
+	if(error)
+		return error;
+	return record(callback_data, ":", key, len);
+}
+
+static bijson_error_t scalar(void *callback_data, const bijson_t *value) {
+	const void *json;
+	size_t size;
+	C(bijson_to_json_malloc(value, &json, &size));
+	bijson_error_t error = record(callback_data, "=", json, size);
+	free(_bijson_no_const(json));
+	return error;
+}
+
+static const bijson_walk_callbacks_t callbacks = {begin_array, end_array, begin_object, end_object, key, scalar};
+
+// The same events, produced recursively using the cursors.
+static void reference(const bijson_t *bijson, trace_t *trace) {
+	bijson_value_type_t type;
+	C(bijson_get_value_type(bijson, &type));
+	if(type == bijson_value_type_array) {
+		bijson_array_analysis_t analysis;
+		C(bijson_array_analyze(bijson, &analysis));
+		size_t count;
+		C(bijson_analyzed_array_count(&analysis, &count));
+		C(begin_array(trace, count));
+		bijson_array_cursor_t cursor;
+		C(bijson_analyzed_array_cursor_init(&cursor, &analysis));
+		for(size_t u = 0; u < count; u++) {
+			bijson_t item;
+			C(bijson_array_cursor_next(&cursor, &item));
+			reference(&item, trace);
+		}
+		C(end_array(trace));
+	} else if(type == bijson_value_type_object) {
+		bijson_object_analysis_t analysis;
+		C(bijson_object_analyze(bijson, &analysis));
+		size_t count;
+		C(bijson_analyzed_object_count(&analysis, &count));
+		C(begin_object(trace, count));
+		bijson_object_cursor_t cursor;
+		C(bijson_analyzed_object_cursor_init(&cursor, &analysis));
+		for(size_t u = 0; u < count; u++) {
+			const void *key_buffer;
+			size_t len;
+			bijson_t value;
+			C(bijson_object_cursor_next(&cursor, &key_buffer, &len, &value));
+			C(key(trace, key_buffer, len));
+			reference(&value, trace);
+		}
+		C(end_object(trace));
+	} else {
+		C(scalar(trace, bijson));
+	}
+}
+
+static void check(const bijson_t *bijson, const char *what) {
+	trace_t expected = {0}, walked = {0}, walked_nocheck = {0};
+	reference(bijson, &expected);
+	C(bijson_walk(bijson, &callbacks, &walked));
+	C(bijson_walk_nocheck(bijson, &callbacks, &walked_nocheck));
+	if(walked.size != expected.size || memcmp(walked.buffer, expected.buffer, expected.size))
+		errx(EX_SOFTWARE, "%s: walk differs:\n%s\ninstead of:\n%s", what, walked.buffer, expected.buffer);
+	if(walked_nocheck.size != expected.size || memcmp(walked_nocheck.buffer, expected.buffer, expected.size))
+		errx(EX_SOFTWARE, "%s: unchecked walk differs", what);
+
+	// Stopping at each of the events
+	for(size_t stop = SIZE_C(1); stop <= expected.events; stop++) {
+		trace_t stopped = {.stop = stop};
+		E(trace_stopped, bijson_walk(bijson, &callbacks, &stopped));
+		if(stopped.events != stop || memcmp(stopped.buffer, expected.buffer, stopped.size))
+			errx(EX_SOFTWARE, "%s: walk went on after event %zu", what, stop);
+		free(stopped.buffer);
+	}
+
+	free(expected.buffer);
+	free(walked.buffer);
+	free(walked_nocheck.buffer);
+}
+
+static void check_json(const char *json) {
+	bijson_t bijson;
+	PARSE(json, &bijson);
+	check(&bijson, json);
+	bijson_free(&bijson);
+}
+
+// Only counts containers, to follow deeply nested ones.
+typedef struct depth {
+	size_t depth;
+	size_t max_depth;
+	size_t scalars;
+} depth_t;
+
+static bijson_error_t depth_begin(void *callback_data, size_t count) {
+	(void)count;
+	depth_t *depth = callback_data;
+	if(++depth->depth > depth->max_depth)
+		depth->max_depth = depth->depth;
+	return NULL;
+}
+
+static bijson_error_t depth_end(void *callback_data) {
+	depth_t *depth = callback_data;
+	depth->depth--;
+	return NULL;
+}
+
+static bijson_error_t depth_scalar(void *callback_data, const bijson_t *value) {
+	(void)value;
+	depth_t *depth = callback_data;
+	depth->scalars++;
+	return NULL;
+}
+
+int main(void) {
+	fprintf(stderr, "checking walks...\n");
+	fflush(stderr);
+
+	check_json("null");
+	check_json("\"\"");
+	check_json("-12.5e-3");
+	check_json("[]");
+	check_json("{}");
+	check_json("[[],{},[[]],[{}]]");
+	check_json("{\"a\":[1,2,{\"b\":null}],\"\":\"\",\"c\\u0000d\":{\"e\":{\"f\":[true,false]}},\"g\":[]}");
+	check_json("[{\"x\":1,\"x\":2},[\"\\u00e9\",\"\\ud83d\\ude00\"],1e400,-0,0.0]");
+
+	// Large containers and hashed objects
+	bijson_writer_t *writer;
+	C(bijson_writer_alloc(&writer));
+	bijson_writer_set_hashed_object_threshold(writer, 4);
+	C(bijson_writer_begin_array(writer));
+	for(size_t u = 0; u < SIZE_C(300); u++) {
+		char digits[32], name[32];
+		size_t len = (size_t)sprintf(digits, "%zu", u);
+		C(bijson_writer_begin_object(writer));
+		for(size_t v = 0; v < u % SIZE_C(9); v++) {
+			C(bijson_writer_add_key(writer, name, (size_t)sprintf(name, "key%zu", v)));
+			if(v % SIZE_C(2)) {
+				C(bijson_writer_add_decimal_from_string(writer, digits, len));
+			} else {
+				C(bijson_writer_begin_array(writer));
+				C(bijson_writer_end_array(writer));
+			}
+		}
+		C(bijson_writer_end_object(writer));
+	}
+	C(bijson_writer_end_array(writer));
+	bijson_t bijson;
+	C(bijson_writer_write_to_malloc(writer, &bijson));
+	bijson_writer_free(writer);
+	check(&bijson, "large array");
+	bijson_free(&bijson);
+
+	// Nesting is not limited by the C stack. The document is encoded by
+	// hand (arrays with a single item, around a null) so that the writer's
+	// own limits don't matter.
+	static const size_t deep = SIZE_C(200000);
+	byte_t *buffer = malloc(deep * SIZE_C(2) + SIZE_C(1));
+	if(!buffer)
+		err(EX_OSERR, "malloc");
+	for(size_t u = 0; u < deep; u++) {
+		buffer[u * SIZE_C(2)] = BYTE_C(0x30);
+		buffer[u * SIZE_C(2) + SIZE_C(1)] = BYTE_C(0x00);
+	}
+	buffer[deep * SIZE_C(2)] = BYTE_C(0x01);
+	bijson.buffer = buffer;
+	bijson.size = deep * SIZE_C(2) + SIZE_C(1);
+	static const bijson_walk_callbacks_t depth_callbacks = {depth_begin, depth_end, depth_begin, depth_end, NULL, depth_scalar};
+	depth_t depth = {0};
+	C(bijson_walk(&bijson, &depth_callbacks, &depth));
+	if(depth.depth || depth.max_depth != deep || depth.scalars != SIZE_C(1))
+		errx(EX_SOFTWARE, "deep walk reached depth %zu", depth.max_depth);
+	// Without any callbacks
+	static const bijson_walk_callbacks_t no_callbacks = {0};
+	C(bijson_walk(&bijson, &no_callbacks, NULL));
+	E(bijson_error_parameter_is_null, bijson_walk(&bijson, NULL, NULL));
+	free(buffer);
+
+	fprintf(stderr, "walks OK.\n");
+	fflush(stderr);
+
+	return 0;
+}